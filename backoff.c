@@ -0,0 +1,39 @@
+/*
+File: backoff.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Provides the exponential reconnect delay with jitter used by network.c.
+
+Responsibilities:
+- Double the delay after each failure, up to a cap
+- Subtract random jitter from each delay
+- Start over after a success
+
+Requires the following modules:
+- backoff.h: for interface definitions
+*/
+
+#include "backoff.h"
+
+void backoff_init(backoff *b, uint32_t min_ms, uint32_t max_ms) {
+    b->min_ms = min_ms;
+    b->max_ms = max_ms;
+    b->delay_ms = min_ms;
+}
+
+uint32_t backoff_next(backoff *b, uint32_t random) {
+    uint32_t delay = b->delay_ms;
+    uint32_t jitter = delay / 4;
+    if (jitter > 0) {
+        delay -= random % (jitter + 1);
+    }
+
+    b->delay_ms = (b->delay_ms > b->max_ms / 2) ? b->max_ms : b->delay_ms * 2;
+    return delay;
+}
+
+void backoff_reset(backoff *b) {
+    b->delay_ms = b->min_ms;
+}
@@ -0,0 +1,55 @@
+/*
+File: backoff.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the reconnect delay shared by the MQTT
+    client and WiFi station mode in network.c. The delay doubles after
+    each failure, up to a cap, with random jitter so that many devices
+    that lost the same broker or access point don't retry in step.
+
+    This module has no hardware dependencies so it can be unit tested on
+    the host (see test_backoff.c).
+*/
+
+#ifndef BACKOFF_H
+#define BACKOFF_H
+
+#include <stdint.h>
+
+/**
+ * @brief Reconnect delay that doubles after each failure
+ */
+typedef struct {
+    uint32_t min_ms;
+    uint32_t max_ms;
+    uint32_t delay_ms;    // Delay before the next attempt, before jitter
+} backoff;
+
+/**
+ * @brief Start a backoff at its minimum delay
+ *
+ * @param b       Backoff state
+ * @param min_ms  First delay
+ * @param max_ms  Largest delay
+ */
+void backoff_init(backoff *b, uint32_t min_ms, uint32_t max_ms);
+
+/**
+ * @brief Delay before the next attempt
+ *
+ * Returns the current delay with up to 25% of it subtracted as jitter,
+ * then doubles the delay for the next failure.
+ *
+ * @param b       Backoff state
+ * @param random  Any random value, used for the jitter
+ * @return Delay in ms
+ */
+uint32_t backoff_next(backoff *b, uint32_t random);
+
+/**
+ * @brief An attempt succeeded; the next failure starts over at the minimum
+ */
+void backoff_reset(backoff *b);
+
+#endif // BACKOFF_H
@@ -0,0 +1,50 @@
+/*
+File: board_pins.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: GPIO assignments for every peripheral on the board, kept in
+    one place so they can be checked against each other when compiling:
+    I2C pins must be ones the chosen I2C block can use, no GPIO may be
+    claimed twice, and WiFi builds must leave the CYW43's pins alone.
+
+    Wiring
+    ** I2C0 bus (100 kHz) **
+    GPIO 4 (pin 6) -> SDA on DHT20 and LCD1602 backpack
+    GPIO 5 (pin 7) -> SCL on DHT20 and LCD1602 backpack
+    ** WS2812 RGB 8 LED Strip **
+    GPIO 2 (pin 4) -> DIN (data in) on LED strip
+*/
+
+#ifndef BOARD_PINS_H
+#define BOARD_PINS_H
+
+// I2C0: DHT20 (0x38) and LCD1602 (0x27) share the bus
+#define I2C0_SDA_PIN   4
+#define I2C0_SCL_PIN   5
+#define I2C0_FREQ      100000
+
+// WS2812 data line, driven by PIO
+#define LED_PIN        2
+
+#define BOARD_GPIO_COUNT 30   // GPIO 0-29 on RP2040 and RP2350A
+
+// An I2C pin's block and role follow from its number: GPIO n is I2C((n / 2) % 2),
+// SDA when n is even and SCL when it is odd
+#define I2C_PIN_IS_SDA(pin, block) ((pin) % 4 == (block) * 2)
+#define I2C_PIN_IS_SCL(pin, block) ((pin) % 4 == (block) * 2 + 1)
+
+_Static_assert(I2C0_SDA_PIN < BOARD_GPIO_COUNT && I2C0_SCL_PIN < BOARD_GPIO_COUNT &&
+               LED_PIN < BOARD_GPIO_COUNT, "GPIO out of range");
+_Static_assert(I2C_PIN_IS_SDA(I2C0_SDA_PIN, 0), "I2C0_SDA_PIN cannot carry I2C0 SDA");
+_Static_assert(I2C_PIN_IS_SCL(I2C0_SCL_PIN, 0), "I2C0_SCL_PIN cannot carry I2C0 SCL");
+_Static_assert(LED_PIN != I2C0_SDA_PIN && LED_PIN != I2C0_SCL_PIN, "LED_PIN is used by I2C0");
+
+#ifdef ENABLE_WIFI
+// Pico W / Pico 2 W: GPIO 23, 24, 25 and 29 talk to the CYW43 radio
+#define BOARD_PIN_IS_CYW43(pin) ((pin) == 23 || (pin) == 24 || (pin) == 25 || (pin) == 29)
+_Static_assert(!BOARD_PIN_IS_CYW43(I2C0_SDA_PIN) && !BOARD_PIN_IS_CYW43(I2C0_SCL_PIN) &&
+               !BOARD_PIN_IS_CYW43(LED_PIN), "GPIO reserved for the CYW43 radio");
+#endif
+
+#endif // BOARD_PINS_H
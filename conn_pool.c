@@ -0,0 +1,113 @@
+/*
+File: conn_pool.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Tracks the lifecycle of the web server's connection slots (see conn_pool.h).
+
+Responsibilities:
+- Hand out free slots and give them back exactly once
+- Keep each connection's reading/writing/closing state
+- Decide when a connection whose close keeps failing must be aborted
+- Count how connections end so leaks show up
+
+Requires the following modules:
+- conn_pool.h: for interface definitions
+*/
+
+#include <string.h>
+#include "conn_pool.h"
+
+void conn_pool_init(conn_pool *pool, size_t size) {
+    memset(pool, 0, sizeof(*pool));
+    pool->size = (uint8_t)((size < CONN_POOL_MAX) ? size : CONN_POOL_MAX);
+}
+
+// True if slot is a valid index of an open connection
+static bool slot_open(const conn_pool *pool, int slot) {
+    return slot >= 0 && slot < pool->size && pool->state[slot] != CONN_CLOSED;
+}
+
+int conn_pool_alloc(conn_pool *pool) {
+    for (int i = 0; i < pool->size; i++) {
+        if (pool->state[i] == CONN_CLOSED) {
+            pool->state[i] = CONN_READING;
+            pool->close_failures[i] = 0;
+            pool->opened++;
+            return i;
+        }
+    }
+    return -1;
+}
+
+conn_state conn_pool_state(const conn_pool *pool, int slot) {
+    return slot_open(pool, slot) ? (conn_state)pool->state[slot] : CONN_CLOSED;
+}
+
+void conn_pool_set_state(conn_pool *pool, int slot, conn_state state) {
+    if (!slot_open(pool, slot) || state == CONN_CLOSED || state >= CONN_STATE_COUNT) return;
+    if (pool->state[slot] == CONN_CLOSING) return;
+    pool->state[slot] = (uint8_t)state;
+}
+
+// Free a slot that was in use
+static void slot_free(conn_pool *pool, int slot) {
+    pool->state[slot] = CONN_CLOSED;
+    pool->close_failures[slot] = 0;
+}
+
+conn_close_action conn_pool_close_result(conn_pool *pool, int slot, bool closed) {
+    if (!slot_open(pool, slot)) return CONN_CLOSE_DONE;
+
+    if (closed) {
+        slot_free(pool, slot);
+        pool->closed++;
+        return CONN_CLOSE_DONE;
+    }
+
+    // The first failure plus CONN_CLOSE_RETRIES retries, then give up
+    if (pool->close_failures[slot] >= CONN_CLOSE_RETRIES) {
+        slot_free(pool, slot);
+        pool->aborted++;
+        return CONN_CLOSE_ABORT;
+    }
+    pool->close_failures[slot]++;
+    pool->state[slot] = CONN_CLOSING;
+    return CONN_CLOSE_RETRY;
+}
+
+uint8_t conn_pool_close_failures(const conn_pool *pool, int slot) {
+    return slot_open(pool, slot) ? pool->close_failures[slot] : 0;
+}
+
+void conn_pool_release(conn_pool *pool, int slot) {
+    if (!slot_open(pool, slot)) return;
+    slot_free(pool, slot);
+    pool->errored++;
+}
+
+size_t conn_pool_count(const conn_pool *pool, conn_state state) {
+    size_t count = 0;
+    for (int i = 0; i < pool->size; i++) {
+        if (pool->state[i] == state) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool conn_pool_balanced(const conn_pool *pool) {
+    uint32_t open = (uint32_t)(pool->size - conn_pool_count(pool, CONN_CLOSED));
+    return pool->opened == pool->closed + pool->aborted + pool->errored + open;
+}
+
+const char *conn_state_name(conn_state state) {
+    switch (state) {
+        case CONN_CLOSED:  return "closed";
+        case CONN_READING: return "reading";
+        case CONN_WRITING: return "writing";
+        case CONN_CLOSING: return "closing";
+        default:           return "unknown";
+    }
+}
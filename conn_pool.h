@@ -0,0 +1,153 @@
+/*
+File: conn_pool.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the connection lifecycle bookkeeping
+    used by the web server in network.c. The server keeps its connection
+    contexts in a fixed, statically allocated array; this module tracks
+    which slots are in use and what state each connection is in, and
+    decides what to do when lwIP can't close a connection.
+
+    Every connection that is opened ends exactly one way: closed, aborted
+    after its close kept failing, or released after a TCP error. Counting
+    the three lets a leaked slot be spotted as opened connections that
+    never ended.
+
+    This module has no lwIP dependencies so it can be unit tested on the
+    host (see test_conn_pool.c).
+*/
+
+#ifndef CONN_POOL_H
+#define CONN_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define CONN_POOL_MAX       16   // Largest number of slots a pool can manage
+#define CONN_CLOSE_RETRIES  4    // Failed close retries before a connection is aborted
+
+/**
+ * @brief Lifecycle state of one connection slot
+ */
+typedef enum {
+    CONN_CLOSED = 0,    // Slot is free
+    CONN_READING,       // Waiting for or parsing a request
+    CONN_WRITING,       // Response data queued or not yet acknowledged
+    CONN_CLOSING,       // Close requested; waiting for data to drain or a retry
+    CONN_STATE_COUNT
+} conn_state;
+
+/**
+ * @brief What the caller must do after trying to close a connection
+ */
+typedef enum {
+    CONN_CLOSE_DONE = 0,    // Closed; the slot is free again
+    CONN_CLOSE_RETRY,       // Close failed; keep the connection and try again later
+    CONN_CLOSE_ABORT,       // Close failed too often; abort it (the slot is free again)
+} conn_close_action;
+
+/**
+ * @brief Slot states and lifetime counters
+ */
+typedef struct {
+    uint8_t state[CONN_POOL_MAX];           // conn_state of each slot
+    uint8_t close_failures[CONN_POOL_MAX];  // Failed close attempts of each slot
+    uint8_t size;                           // Slots in use by this pool
+    uint32_t opened;                        // Connections ever allocated
+    uint32_t closed;                        // ... that ended with a clean close
+    uint32_t aborted;                       // ... that were aborted
+    uint32_t errored;                       // ... that ended with a TCP error
+} conn_pool;
+
+/**
+ * @brief Set up a pool with every slot free
+ *
+ * @param pool  Pool to set up
+ * @param size  Number of slots, at most CONN_POOL_MAX
+ */
+void conn_pool_init(conn_pool *pool, size_t size);
+
+/**
+ * @brief Take a free slot for a new connection, in CONN_READING
+ *
+ * @param pool  Connection pool
+ * @return Index of the slot, or -1 if every slot is in use
+ */
+int conn_pool_alloc(conn_pool *pool);
+
+/**
+ * @brief State of a slot
+ *
+ * @param pool  Connection pool
+ * @param slot  Slot index
+ * @return The slot's state; CONN_CLOSED for a free slot
+ */
+conn_state conn_pool_state(const conn_pool *pool, int slot);
+
+/**
+ * @brief Move an open connection to CONN_READING, CONN_WRITING or CONN_CLOSING
+ *
+ * Free slots are left alone, and a connection that is already closing
+ * stays closing.
+ *
+ * @param pool   Connection pool
+ * @param slot   Slot index
+ * @param state  New state
+ */
+void conn_pool_set_state(conn_pool *pool, int slot, conn_state state);
+
+/**
+ * @brief Record the outcome of an attempt to close a connection
+ *
+ * @param pool    Connection pool
+ * @param slot    Slot index
+ * @param closed  true if the close succeeded
+ * @return What to do next; the slot is free again unless CONN_CLOSE_RETRY
+ */
+conn_close_action conn_pool_close_result(conn_pool *pool, int slot, bool closed);
+
+/**
+ * @brief Failed close attempts of a connection that is waiting to retry
+ *
+ * @param pool  Connection pool
+ * @param slot  Slot index
+ * @return Number of failed attempts; 0 if no close has been tried yet
+ */
+uint8_t conn_pool_close_failures(const conn_pool *pool, int slot);
+
+/**
+ * @brief Free the slot of a connection that ended with a TCP error
+ *
+ * @param pool  Connection pool
+ * @param slot  Slot index
+ */
+void conn_pool_release(conn_pool *pool, int slot);
+
+/**
+ * @brief Number of slots in a state
+ *
+ * @param pool   Connection pool
+ * @param state  State to count
+ * @return Slots currently in that state
+ */
+size_t conn_pool_count(const conn_pool *pool, conn_state state);
+
+/**
+ * @brief Check that every opened connection is either still open or ended once
+ *
+ * @param pool  Connection pool
+ * @return false if slots have leaked or been released twice
+ */
+bool conn_pool_balanced(const conn_pool *pool);
+
+/**
+ * @brief Short lowercase name of a state, for logs and metrics labels
+ *
+ * @param state  A conn_state
+ * @return The name, or "unknown"
+ */
+const char *conn_state_name(conn_state state);
+
+#endif // CONN_POOL_H
@@ -0,0 +1,351 @@
+/*
+File: dhcp_server.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Provides the DHCP server used on the WiFi access point (RFC 2131, with
+    the options from RFC 2132 that clients need to reach the device). The
+    lease table is a fixed array; slot i always leases the address
+    DHCP_FIRST_HOST + i, so looking up an address never needs a search.
+
+Responsibilities:
+- Parse DHCP requests and their options
+- Offer, acknowledge, refuse, release and block addresses in the lease table
+- Build the reply messages
+- Report how many clients hold a lease and when the next one expires
+
+Requires the following modules:
+- dhcp_server.h: for interface definitions
+*/
+
+#include "dhcp_server.h"
+
+#include <string.h>
+
+// BOOTP message layout
+#define BOOTP_OP        0
+#define BOOTP_HTYPE     1
+#define BOOTP_HLEN      2
+#define BOOTP_XID       4
+#define BOOTP_FLAGS     10
+#define BOOTP_CIADDR    12
+#define BOOTP_YIADDR    16
+#define BOOTP_GIADDR    24
+#define BOOTP_CHADDR    28
+#define BOOTP_COOKIE    236
+#define BOOTP_OPTIONS   240
+#define BOOTP_MIN_LEN   300     // Some clients ignore shorter replies
+
+#define BOOTP_REQUEST   1
+#define BOOTP_REPLY     2
+#define BOOTP_BROADCAST 0x80    // High bit of the flags field
+
+// Option codes
+#define OPT_PAD          0
+#define OPT_SUBNET_MASK  1
+#define OPT_ROUTER       3
+#define OPT_REQUESTED_IP 50
+#define OPT_LEASE_TIME   51
+#define OPT_MSG_TYPE     53
+#define OPT_SERVER_ID    54
+#define OPT_RENEWAL_T1   58
+#define OPT_REBIND_T2    59
+#define OPT_END          255
+
+static const uint8_t MAGIC_COOKIE[4] = { 99, 130, 83, 99 };
+
+// Options of interest in a request
+typedef struct {
+    uint8_t type;
+    bool has_requested_ip;
+    uint8_t requested_ip[4];
+    bool has_server_id;
+    uint8_t server_id[4];
+} dhcp_options;
+
+void dhcp_server_init(dhcp_server *s, const uint8_t server_ip[4], const uint8_t netmask[4],
+                      uint32_t lease_time_s) {
+    memset(s, 0, sizeof(*s));
+    memcpy(s->server_ip, server_ip, 4);
+    memcpy(s->netmask, netmask, 4);
+    s->lease_time_s = lease_time_s;
+}
+
+static bool parse_options(const uint8_t *msg, size_t len, dhcp_options *opts) {
+    memset(opts, 0, sizeof(*opts));
+    size_t i = BOOTP_OPTIONS;
+    while (i < len) {
+        uint8_t code = msg[i++];
+        if (code == OPT_PAD) continue;
+        if (code == OPT_END) break;
+        if (i >= len || i + 1 + msg[i] > len) {
+            return false;  // Option runs past the end of the message
+        }
+        uint8_t opt_len = msg[i++];
+        const uint8_t *data = &msg[i];
+        if (code == OPT_MSG_TYPE && opt_len == 1) {
+            opts->type = data[0];
+        } else if (code == OPT_REQUESTED_IP && opt_len == 4) {
+            opts->has_requested_ip = true;
+            memcpy(opts->requested_ip, data, 4);
+        } else if (code == OPT_SERVER_ID && opt_len == 4) {
+            opts->has_server_id = true;
+            memcpy(opts->server_id, data, 4);
+        }
+        i += opt_len;
+    }
+    return opts->type != 0;
+}
+
+static bool lease_active(const dhcp_lease *l, uint32_t now_ms) {
+    return l->state != DHCP_LEASE_FREE && (int32_t)(l->expires_ms - now_ms) > 0;
+}
+
+// Slot leasing the given address, or -1 if the address isn't one of ours
+static int slot_for_ip(const dhcp_server *s, const uint8_t ip[4]) {
+    if (memcmp(ip, s->server_ip, 3) != 0) {
+        return -1;
+    }
+    int slot = ip[3] - DHCP_FIRST_HOST;
+    return (slot >= 0 && slot < DHCP_LEASE_MAX) ? slot : -1;
+}
+
+// Slot last used by this client, whether or not its lease is still running
+static int slot_for_mac(const dhcp_server *s, const uint8_t *mac) {
+    for (int i = 0; i < DHCP_LEASE_MAX; i++) {
+        const dhcp_lease *l = &s->leases[i];
+        if (l->state != DHCP_LEASE_DECLINED && memcmp(l->mac, mac, 6) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Slot for a client without one: never used first, so returning clients
+// keep their old address as long as possible, then the longest expired
+static int slot_unused(const dhcp_server *s, uint32_t now_ms) {
+    static const uint8_t no_mac[6] = { 0 };
+    int best = -1;
+    for (int i = 0; i < DHCP_LEASE_MAX; i++) {
+        const dhcp_lease *l = &s->leases[i];
+        if (lease_active(l, now_ms)) continue;
+        if (l->state == DHCP_LEASE_FREE && memcmp(l->mac, no_mac, 6) == 0) {
+            return i;
+        }
+        if (best < 0 || (int32_t)(l->expires_ms - s->leases[best].expires_ms) < 0) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+static void slot_ip(const dhcp_server *s, int slot, uint8_t ip[4]) {
+    memcpy(ip, s->server_ip, 3);
+    ip[3] = (uint8_t)(DHCP_FIRST_HOST + slot);
+}
+
+static uint8_t *put_option(uint8_t *p, uint8_t code, const void *data, uint8_t len) {
+    *p++ = code;
+    *p++ = len;
+    memcpy(p, data, len);
+    return p + len;
+}
+
+static uint8_t *put_option_u32(uint8_t *p, uint8_t code, uint32_t value) {
+    uint8_t be[4] = { (uint8_t)(value >> 24), (uint8_t)(value >> 16),
+                      (uint8_t)(value >> 8), (uint8_t)value };
+    return put_option(p, code, be, 4);
+}
+
+// Build a reply to msg. yiaddr is NULL for NAK and INFORM replies, which
+// don't assign an address.
+static size_t build_reply(const dhcp_server *s, const uint8_t *msg, uint8_t type,
+                          const uint8_t *yiaddr, uint8_t *reply) {
+    memset(reply, 0, DHCP_MSG_MAX);
+    reply[BOOTP_OP] = BOOTP_REPLY;
+    reply[BOOTP_HTYPE] = msg[BOOTP_HTYPE];
+    reply[BOOTP_HLEN] = msg[BOOTP_HLEN];
+    memcpy(&reply[BOOTP_XID], &msg[BOOTP_XID], 4);
+    memcpy(&reply[BOOTP_FLAGS], &msg[BOOTP_FLAGS], 2);
+    if (type != DHCP_NAK) {
+        memcpy(&reply[BOOTP_CIADDR], &msg[BOOTP_CIADDR], 4);
+    }
+    if (yiaddr) {
+        memcpy(&reply[BOOTP_YIADDR], yiaddr, 4);
+    }
+    memcpy(&reply[BOOTP_GIADDR], &msg[BOOTP_GIADDR], 4);
+    memcpy(&reply[BOOTP_CHADDR], &msg[BOOTP_CHADDR], 16);
+    memcpy(&reply[BOOTP_COOKIE], MAGIC_COOKIE, 4);
+
+    uint8_t *p = &reply[BOOTP_OPTIONS];
+    p = put_option(p, OPT_MSG_TYPE, &type, 1);
+    p = put_option(p, OPT_SERVER_ID, s->server_ip, 4);
+    if (type != DHCP_NAK) {
+        p = put_option(p, OPT_SUBNET_MASK, s->netmask, 4);
+        p = put_option(p, OPT_ROUTER, s->server_ip, 4);
+    }
+    if (yiaddr) {
+        p = put_option_u32(p, OPT_LEASE_TIME, s->lease_time_s);
+        p = put_option_u32(p, OPT_RENEWAL_T1, s->lease_time_s / 2);
+        p = put_option_u32(p, OPT_REBIND_T2, s->lease_time_s / 8 * 7);
+    }
+    *p++ = OPT_END;
+
+    size_t len = (size_t)(p - reply);
+    return len < BOOTP_MIN_LEN ? BOOTP_MIN_LEN : len;
+}
+
+static size_t handle_discover(dhcp_server *s, const uint8_t *msg, const dhcp_options *opts,
+                              uint32_t now_ms, uint8_t *reply) {
+    const uint8_t *mac = &msg[BOOTP_CHADDR];
+    int slot = slot_for_mac(s, mac);
+    if (slot < 0 && opts->has_requested_ip) {
+        // A client that remembers its address (e.g. after we restarted) keeps it if it's free
+        int wanted = slot_for_ip(s, opts->requested_ip);
+        if (wanted >= 0 && !lease_active(&s->leases[wanted], now_ms)) {
+            slot = wanted;
+        }
+    }
+    if (slot < 0) {
+        slot = slot_unused(s, now_ms);
+    }
+    if (slot < 0) {
+        return 0;  // Every address is leased
+    }
+
+    dhcp_lease *l = &s->leases[slot];
+    if (!(l->state == DHCP_LEASE_BOUND && lease_active(l, now_ms))) {
+        memcpy(l->mac, mac, 6);
+        l->state = DHCP_LEASE_OFFERED;
+        l->expires_ms = now_ms + DHCP_OFFER_HOLD_MS;
+    }
+
+    uint8_t ip[4];
+    slot_ip(s, slot, ip);
+    return build_reply(s, msg, DHCP_OFFER, ip, reply);
+}
+
+static size_t handle_request(dhcp_server *s, const uint8_t *msg, const dhcp_options *opts,
+                             uint32_t now_ms, uint8_t *reply) {
+    const uint8_t *mac = &msg[BOOTP_CHADDR];
+    if (opts->has_server_id && memcmp(opts->server_id, s->server_ip, 4) != 0) {
+        // The client accepted another server's offer; release ours
+        int slot = slot_for_mac(s, mac);
+        if (slot >= 0 && s->leases[slot].state == DHCP_LEASE_OFFERED) {
+            s->leases[slot].state = DHCP_LEASE_FREE;
+        }
+        return 0;
+    }
+
+    // SELECTING and INIT-REBOOT clients name the address in an option,
+    // RENEWING and REBINDING clients in ciaddr
+    const uint8_t *requested = opts->has_requested_ip ? opts->requested_ip : &msg[BOOTP_CIADDR];
+    int slot = slot_for_ip(s, requested);
+    if (slot < 0) {
+        return build_reply(s, msg, DHCP_NAK, NULL, reply);
+    }
+    dhcp_lease *l = &s->leases[slot];
+    if (lease_active(l, now_ms) && memcmp(l->mac, mac, 6) != 0) {
+        return build_reply(s, msg, DHCP_NAK, NULL, reply);  // Someone else's, or declined
+    }
+
+    // A client holds one address; drop any other slot it had
+    int old = slot_for_mac(s, mac);
+    if (old >= 0 && old != slot) {
+        s->leases[old].state = DHCP_LEASE_FREE;
+    }
+
+    memcpy(l->mac, mac, 6);
+    l->state = DHCP_LEASE_BOUND;
+    l->expires_ms = now_ms + s->lease_time_s * 1000u;
+
+    uint8_t ip[4];
+    slot_ip(s, slot, ip);
+    return build_reply(s, msg, DHCP_ACK, ip, reply);
+}
+
+size_t dhcp_server_handle(dhcp_server *s, const uint8_t *msg, size_t len, uint32_t now_ms,
+                          uint8_t *reply, bool *unicast) {
+    *unicast = false;
+    dhcp_options opts;
+    if (len < BOOTP_OPTIONS || msg[BOOTP_OP] != BOOTP_REQUEST ||
+        msg[BOOTP_HTYPE] != 1 || msg[BOOTP_HLEN] != 6 ||
+        memcmp(&msg[BOOTP_COOKIE], MAGIC_COOKIE, 4) != 0 ||
+        !parse_options(msg, len, &opts)) {
+        return 0;
+    }
+
+    const uint8_t *mac = &msg[BOOTP_CHADDR];
+    static const uint8_t no_ip[4] = { 0 };
+    bool has_ciaddr = memcmp(&msg[BOOTP_CIADDR], no_ip, 4) != 0;
+    bool wants_broadcast = (msg[BOOTP_FLAGS] & BOOTP_BROADCAST) != 0;
+    size_t reply_len = 0;
+
+    switch (opts.type) {
+        case DHCP_DISCOVER:
+            return handle_discover(s, msg, &opts, now_ms, reply);
+
+        case DHCP_REQUEST:
+            reply_len = handle_request(s, msg, &opts, now_ms, reply);
+            // A renewing client already has its address and can take the ACK
+            // directly (the message type is the first option in the reply)
+            *unicast = reply_len > 0 && reply[BOOTP_OPTIONS + 2] == DHCP_ACK &&
+                       has_ciaddr && !wants_broadcast;
+            return reply_len;
+
+        case DHCP_INFORM:
+            // Configured manually; only wants the other parameters
+            *unicast = has_ciaddr;
+            return build_reply(s, msg, DHCP_ACK, NULL, reply);
+
+        case DHCP_DECLINE: {
+            // The client found the address in use by a device we don't know about
+            int slot = opts.has_requested_ip ? slot_for_ip(s, opts.requested_ip) : -1;
+            if (slot >= 0 && memcmp(s->leases[slot].mac, mac, 6) == 0) {
+                dhcp_lease *l = &s->leases[slot];
+                memset(l->mac, 0, 6);
+                l->state = DHCP_LEASE_DECLINED;
+                l->expires_ms = now_ms + s->lease_time_s * 1000u;
+            }
+            return 0;
+        }
+
+        case DHCP_RELEASE: {
+            int slot = slot_for_ip(s, &msg[BOOTP_CIADDR]);
+            if (slot >= 0 && memcmp(s->leases[slot].mac, mac, 6) == 0) {
+                s->leases[slot].state = DHCP_LEASE_FREE;
+            }
+            return 0;
+        }
+
+        default:
+            return 0;
+    }
+}
+
+size_t dhcp_server_client_count(const dhcp_server *s, uint32_t now_ms) {
+    size_t count = 0;
+    for (int i = 0; i < DHCP_LEASE_MAX; i++) {
+        const dhcp_lease *l = &s->leases[i];
+        if (l->state == DHCP_LEASE_BOUND && lease_active(l, now_ms)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool dhcp_server_next_expiry(const dhcp_server *s, uint32_t now_ms, uint32_t *out_ms) {
+    bool found = false;
+    for (int i = 0; i < DHCP_LEASE_MAX; i++) {
+        const dhcp_lease *l = &s->leases[i];
+        if (l->state == DHCP_LEASE_BOUND && lease_active(l, now_ms)) {
+            uint32_t left = l->expires_ms - now_ms;
+            if (!found || left < *out_ms) {
+                *out_ms = left;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
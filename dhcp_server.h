@@ -0,0 +1,123 @@
+/*
+File: dhcp_server.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the DHCP server that hands out addresses
+    to clients of the WiFi access point. This module only turns a request
+    message into a reply and keeps the lease table; network.c receives the
+    requests on UDP port 67 of the AP interface and sends the replies.
+
+    Each lease slot owns one fixed address (DHCP_FIRST_HOST + slot in the
+    server's /24, e.g. 192.168.4.16 to .23), so a client that comes back
+    gets its old address as long as the slot hasn't been reused.
+
+    This module has no hardware or lwIP dependencies so it can be unit
+    tested on the host (see test_dhcp_server.c).
+*/
+
+#ifndef DHCP_SERVER_H
+#define DHCP_SERVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DHCP_LEASE_MAX      8       // Clients with an address at once
+#define DHCP_FIRST_HOST     16      // Host part of the first leased address (x.x.x.16)
+#define DHCP_LEASE_TIME_S   7200    // Lease length offered to clients
+#define DHCP_OFFER_HOLD_MS  10000   // How long an offered address stays reserved
+#define DHCP_MSG_MAX        312     // Largest reply (BOOTP header plus options)
+#define DHCP_REQUEST_MAX    576     // Largest request read; every client must accept this size
+
+#define DHCP_SERVER_PORT    67
+#define DHCP_CLIENT_PORT    68
+
+/**
+ * @brief DHCP message types (option 53)
+ */
+typedef enum {
+    DHCP_DISCOVER = 1,
+    DHCP_OFFER    = 2,
+    DHCP_REQUEST  = 3,
+    DHCP_DECLINE  = 4,
+    DHCP_ACK      = 5,
+    DHCP_NAK      = 6,
+    DHCP_RELEASE  = 7,
+    DHCP_INFORM   = 8,
+} dhcp_msg_type;
+
+/**
+ * @brief State of one lease slot
+ */
+typedef enum {
+    DHCP_LEASE_FREE = 0,
+    DHCP_LEASE_OFFERED,     // Offered, waiting for the client's REQUEST
+    DHCP_LEASE_BOUND,       // Acknowledged until expires_ms
+    DHCP_LEASE_DECLINED,    // A client found the address in use; kept out of use until expires_ms
+} dhcp_lease_state;
+
+/**
+ * @brief One lease slot
+ */
+typedef struct {
+    uint8_t mac[6];
+    uint8_t state;          // dhcp_lease_state
+    uint32_t expires_ms;    // End of the offer hold or lease
+} dhcp_lease;
+
+/**
+ * @brief Server configuration and lease table
+ */
+typedef struct {
+    uint8_t server_ip[4];   // AP interface address, also the router given to clients
+    uint8_t netmask[4];
+    uint32_t lease_time_s;
+    dhcp_lease leases[DHCP_LEASE_MAX];
+} dhcp_server;
+
+/**
+ * @brief Reset the server with an empty lease table
+ *
+ * @param s             Server state
+ * @param server_ip     AP interface address, e.g. 192.168.4.1
+ * @param netmask       AP subnet mask, e.g. 255.255.255.0
+ * @param lease_time_s  Lease length offered to clients
+ */
+void dhcp_server_init(dhcp_server *s, const uint8_t server_ip[4], const uint8_t netmask[4],
+                      uint32_t lease_time_s);
+
+/**
+ * @brief Handle one message received on the server port
+ *
+ * Answers DISCOVER with OFFER, REQUEST with ACK or NAK and INFORM with ACK,
+ * and frees or blocks addresses on RELEASE and DECLINE.
+ *
+ * @param s        Server state
+ * @param msg      Received UDP payload
+ * @param len      Length of msg
+ * @param now_ms   Current time, for lease expiry
+ * @param reply    Buffer for the reply; at least DHCP_MSG_MAX bytes
+ * @param unicast  Set to true if the reply should go to the client's own
+ *                 address (bytes 12..15 of reply) rather than be broadcast
+ * @return Length of the reply, or 0 if there is nothing to send
+ */
+size_t dhcp_server_handle(dhcp_server *s, const uint8_t *msg, size_t len, uint32_t now_ms,
+                          uint8_t *reply, bool *unicast);
+
+/**
+ * @brief Number of clients holding an unexpired lease
+ */
+size_t dhcp_server_client_count(const dhcp_server *s, uint32_t now_ms);
+
+/**
+ * @brief Time until the soonest lease expires
+ *
+ * @param s       Server state
+ * @param now_ms  Current time
+ * @param out_ms  Milliseconds until that lease expires
+ * @return false if no client holds a lease
+ */
+bool dhcp_server_next_expiry(const dhcp_server *s, uint32_t now_ms, uint32_t *out_ms);
+
+#endif // DHCP_SERVER_H
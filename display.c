@@ -21,9 +21,11 @@ Responsibilities:
 
 Requires the following modules:
 - display.h: for interface definitions
+- i2c_bus.h: for access to the shared I2C bus
 
 Wiring configuration
 ** LCD1602 Display **
+I2C0 bus, shared with the DHT20 (see board_pins.h)
 GPIO 4 (pin 6)  -> SDA on LCD1602
 GPIO 5 (pin 7) -> SCL on LCD1602
 3.3v (pin 36)   -> VCC on LCD1602
@@ -31,9 +33,8 @@ GND (pin 38)    -> GND on LCD1602
 */
 
 #include <stdio.h>
-#include "pico/stdlib.h"
-#include "hardware/i2c.h"
 #include "display.h"
+#include "i2c_bus.h"
 
 const int LCD_CLEARDISPLAY = 0x01;
 const int LCD_ENTRYMODESET = 0x04;
@@ -52,59 +53,39 @@ const int LCD_ENABLE_BIT = 0x04;
 #define MAX_LINES      2
 #define MAX_CHARS      16
 #define DELAY_US       600  // Delay in microseconds  
+#define CLEAR_US       2000 // Time the LCD needs to clear itself
 
-static i2c_inst_t *s_i2c = NULL;   // Pointer to active I2C instance
-static uint8_t     s_addr = 0x27;  // I2C address of the LCD
-
-// Send one byte (command or data) to LCD via I2C
-static inline void i2c_write_byte(uint8_t v) {
-    i2c_write_blocking(s_i2c, s_addr, &v, 1, false);
-}
-
-// Pulse the LCD's Enable line to latch data
-static void lcd_toggle_enable(uint8_t val) {
-    sleep_us(DELAY_US);
-    i2c_write_byte(val | LCD_ENABLE_BIT);
-    sleep_us(DELAY_US);
-    i2c_write_byte(val & ~LCD_ENABLE_BIT);
-    sleep_us(DELAY_US);
-}
-
-static void lcd_send_byte(uint8_t val, uint8_t mode) {
+// Queue one byte (command or data) for the LCD as a single low-priority bus
+// transaction, holding the bus for hold_us afterwards
+static void lcd_send_byte_hold(uint8_t val, uint8_t mode, uint16_t hold_us) {
     // Split byte value into two halves
     uint8_t high = mode | (val & 0xF0) | LCD_BACKLIGHT;
     uint8_t low = mode | ((val << 4) & 0xF0) | LCD_BACKLIGHT;
 
-    // Send each half and toggle Enable so LCD latches the data
-    i2c_write_byte(high);
-    lcd_toggle_enable(high);
-    i2c_write_byte(low);
-    lcd_toggle_enable(low);
+    // Send each half and toggle Enable so LCD latches the data; each
+    // write is followed by DELAY_US
+    i2c_txn txn = {
+        .device = I2C_DEV_LCD, .priority = I2C_PRIORITY_LOW, .addr = LCD_I2C_ADDR,
+        .tx = { high, high | LCD_ENABLE_BIT, high & ~LCD_ENABLE_BIT,
+                low, low | LCD_ENABLE_BIT, low & ~LCD_ENABLE_BIT },
+        .tx_len = 6, .chunk = 1, .gap_us = DELAY_US, .hold_us = hold_us,
+    };
+    i2c_bus_submit(&txn);
 }
 
-bool display_init(void) {
-    i2c_inst_t *i2c = LCD_I2C_PORT;
-    uint sda        = LCD_I2C_SDA_PIN;
-    uint scl        = LCD_I2C_SCL_PIN;
-    uint8_t addr    = LCD_I2C_ADDR;
-
-    i2c_init(i2c, LCD_I2C_FREQ);  // Enable I2C at 100 kHz
-
-    // Configure SDA and SCL pins for I2C
-    gpio_set_function(sda, GPIO_FUNC_I2C);
-    gpio_set_function(scl, GPIO_FUNC_I2C);
-    gpio_pull_up(sda);
-    gpio_pull_up(scl);
+static void lcd_send_byte(uint8_t val, uint8_t mode) {
+    lcd_send_byte_hold(val, mode, 0);
+}
 
-    // Store I2C instance and LCD address
-    s_i2c = i2c;
-    s_addr = addr;
+bool display_init(void) {
+    i2c_bus_init();  // Shared bus, set up once (i2c_bus.c)
 
     // Probe the LCD by sending a dummy byte
-    uint8_t probe = 0x00;
-    int result = i2c_write_blocking(i2c, addr, &probe, 1, false);
+    i2c_txn probe = { .device = I2C_DEV_LCD, .priority = I2C_PRIORITY_LOW, .addr = LCD_I2C_ADDR,
+                      .tx = { 0x00 }, .tx_len = 1 };
+    int result = i2c_bus_transfer(&probe);
     if (result < 0) {
-        printf("LCD not responding at address 0x%02X\n", addr);
+        printf("LCD not responding at address 0x%02X\n", LCD_I2C_ADDR);
         return false;
     }
 
@@ -118,15 +99,13 @@ bool display_init(void) {
     lcd_send_byte(LCD_ENTRYMODESET   | LCD_ENTRYLEFT, LCD_COMMAND);
     lcd_send_byte(LCD_FUNCTIONSET    | LCD_2LINE, LCD_COMMAND);
     lcd_send_byte(LCD_DISPLAYCONTROL | LCD_DISPLAYON, LCD_COMMAND);
-    lcd_send_byte(LCD_CLEARDISPLAY, LCD_COMMAND);
-    sleep_ms(2);  // Allow LCD time to finish clear
+    lcd_send_byte_hold(LCD_CLEARDISPLAY, LCD_COMMAND, CLEAR_US);  // Allow LCD time to finish clear
 
     return true;
 }
 
 void display_clear(void){
-    lcd_send_byte(LCD_CLEARDISPLAY, LCD_COMMAND);
-    sleep_ms(2);  // Allow LCD time to finish clear
+    lcd_send_byte_hold(LCD_CLEARDISPLAY, LCD_COMMAND, CLEAR_US);  // Allow LCD time to finish clear
 }
 
 // Moves the LCD cursor to a specific line/position
@@ -143,4 +122,19 @@ void display_print(const char *s) {
     while (*s) {
         lcd_send_byte((uint8_t)(*s++), LCD_CHARACTER);
     }
+}
+
+// Redraw the whole screen with a reading
+void display_show_reading(float humidity, float temp_fahrenheit) {
+    display_clear(); // Clear previous display
+    display_set_cursor(0, 0); // Go to the top line of display
+    char line1[MAX_CHARS + 1];
+    snprintf(line1, sizeof(line1), "Humidity: %.1f%%", humidity);
+    display_print(line1);
+
+    // Display temperature in fahrenheit on LCD
+    display_set_cursor(0, 1);
+    char line2[MAX_CHARS + 1];
+    snprintf(line2, sizeof(line2), "Temp: %.1fF", temp_fahrenheit);
+    display_print(line2);
 }
\ No newline at end of file
@@ -12,15 +12,11 @@ Description: Provides the public interface for controlling the LCD1602
 #ifndef DISPLAY_H
 #define DISPLAY_H
 
-#include "pico/stdlib.h"
-#include "hardware/i2c.h"
 #include <stdbool.h>
+#include <stdint.h>
 
-#define LCD_I2C_PORT      i2c0
-#define LCD_I2C_SDA_PIN   2
-#define LCD_I2C_SCL_PIN   3
+// The LCD's backpack sits on I2C0 with the DHT20 (pins in board_pins.h)
 #define LCD_I2C_ADDR      0x27
-#define LCD_I2C_FREQ      100000
 
 /**
  * @brief Initialize the LCD1602 display using provided I2C instance
@@ -31,6 +27,9 @@ bool display_init(void);
 
 /**
  * @brief Clear the LCD display and reset the cursor to home position
+ *
+ * This and the functions below queue their bus writes once the I2C bus
+ * is attached to an async_context (i2c_bus.h), and return straight away.
  */
 void display_clear(void);
 
@@ -49,4 +48,12 @@ void display_set_cursor(uint8_t col, uint8_t row);
  */
 void display_print(const char *text);
 
+/**
+ * @brief Show a reading: humidity on the top line, temperature on the bottom
+ * 
+ * @param humidity         Relative humidity in percent
+ * @param temp_fahrenheit  Temperature in Fahrenheit
+ */
+void display_show_reading(float humidity, float temp_fahrenheit);
+
 #endif  // DISPLAY_H
@@ -0,0 +1,461 @@
+/*
+File: hal.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Hardware abstraction layer. The device drivers (sensor.c,
+    display.c, led_array.c), the I2C bus manager (i2c_bus.c) and the web
+    server (network.c) reach the platform only through this header, so
+    the same code runs on the Pico and on Linux.
+
+    Backends
+    ** Pico (pico-sdk) **
+    hal_pico.c      -> time from the system timer, LED strip on PIO,
+                       I2C controllers driven from their interrupts
+    hal_tcp_pico.c  -> TCP on lwIP's raw API over the CYW43 radio
+    ** Linux (HOST_BUILD) **
+    hal_linux.c     -> monotonic or virtual clock, LED frames kept by a WS2812 model,
+                       I2C to DHT20 and PCF8574/HD44780 models (sim_devices.c)
+    hal_tcp_linux.c -> TCP on loopback sockets or virtual clients (sim_network.h)
+    sdk_linux.c     -> the pico-sdk calls main.c makes (host/)
+*/
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define HAL_I2C_FIFO_DEPTH 16   // Bytes one background transfer may move (the controller's FIFO)
+
+/**
+ * @brief Microseconds since boot (or since the host program started)
+ *
+ * @return Time in microseconds; wraps after about 71 minutes
+ */
+uint32_t hal_time_us(void);
+
+/**
+ * @brief Microseconds since boot, without wrapping
+ *
+ * @return Time in microseconds
+ */
+uint64_t hal_time_us_64(void);
+
+/**
+ * @brief Milliseconds since boot (or since the host program started)
+ *
+ * @return Time in milliseconds
+ */
+uint32_t hal_time_ms(void);
+
+/**
+ * @brief Wait for a number of microseconds
+ *
+ * @param us  Microseconds to wait
+ */
+void hal_sleep_us(uint32_t us);
+
+/**
+ * @brief Wait for a number of milliseconds
+ *
+ * @param ms  Milliseconds to wait
+ */
+void hal_sleep_ms(uint32_t ms);
+
+/**
+ * @brief Set up the WS2812 LED strip output
+ *
+ * @return true on success, false if the output could not be claimed
+ */
+bool hal_leds_init(void);
+
+/**
+ * @brief Send one frame to the LED strip
+ *
+ * Returns once the frame has been latched by the strip.
+ * @param grb    Colors in 0x00GGRRBB order, one per LED
+ * @param count  Number of LEDs
+ */
+void hal_leds_show(const uint32_t *grb, size_t count);
+
+/**
+ * @brief Wait until the LED strip output has shifted out every queued bit
+ */
+void hal_leds_wait_idle(void);
+
+/**
+ * @brief Keep the strip's bit timing after clk_sys changes
+ */
+void hal_leds_clock_changed(void);
+
+// ---- I2C ----
+
+/**
+ * @brief Called when a transfer started with hal_i2c_start_write() or
+ *        hal_i2c_start_read() has finished
+ *
+ * Runs from the I2C interrupt on the Pico and from the bus thread on
+ * Linux, with the I2C lock held (hal_i2c_lock()). It may start the next
+ * transfer.
+ * @param result  Bytes transferred, or a negative value if the device didn't answer
+ */
+typedef void (*hal_i2c_done_fn)(int result);
+
+/**
+ * @brief Called when a wait started with hal_i2c_call_after_us() is over
+ *
+ * Runs in the same context as hal_i2c_done_fn, with the I2C lock held.
+ */
+typedef void (*hal_i2c_timer_fn)(void);
+
+/**
+ * @brief Set up an I2C controller and its pins
+ *
+ * @param bus      Controller number (0 for I2C0)
+ * @param sda_pin  GPIO carrying SDA
+ * @param scl_pin  GPIO carrying SCL
+ * @param freq     Bus speed in Hz
+ */
+void hal_i2c_init(uint8_t bus, uint8_t sda_pin, uint8_t scl_pin, uint32_t freq);
+
+/**
+ * @brief Write to a device, waiting until the STOP condition
+ *
+ * @param bus   Controller number
+ * @param addr  7-bit device address
+ * @param src   Bytes to write
+ * @param len   Number of bytes
+ * @return Bytes written, or a negative value if the device didn't answer
+ */
+int hal_i2c_write_blocking(uint8_t bus, uint8_t addr, const uint8_t *src, size_t len);
+
+/**
+ * @brief Read from a device, waiting until the STOP condition
+ *
+ * @param bus   Controller number
+ * @param addr  7-bit device address
+ * @param dst   Where to store the bytes read
+ * @param len   Number of bytes
+ * @return Bytes read, or a negative value if the device didn't answer
+ */
+int hal_i2c_read_blocking(uint8_t bus, uint8_t addr, uint8_t *dst, size_t len);
+
+/**
+ * @brief Run transfers in the background from here on
+ *
+ * Call on the core (or thread) that will start them. Every controller set
+ * up with hal_i2c_init() reports to done.
+ * @param done  Called as each background transfer finishes
+ * @return true if background transfers are available, false if every
+ *         transfer has to stay blocking
+ */
+bool hal_i2c_attach(hal_i2c_done_fn done);
+
+/**
+ * @brief Start a write that ends in a STOP condition, and return
+ *
+ * Call with the I2C lock held. Only one transfer or wait is outstanding
+ * at a time; done is called when it has finished.
+ * @param bus   Controller number
+ * @param addr  7-bit device address
+ * @param src   Bytes to write; must stay valid until done is called
+ * @param len   Number of bytes, at most HAL_I2C_FIFO_DEPTH
+ */
+void hal_i2c_start_write(uint8_t bus, uint8_t addr, const uint8_t *src, uint8_t len);
+
+/**
+ * @brief Start a read that ends in a STOP condition, and return
+ *
+ * Call with the I2C lock held. dst is filled in before done is called.
+ * @param bus   Controller number
+ * @param addr  7-bit device address
+ * @param dst   Where to store the bytes read
+ * @param len   Number of bytes, at most HAL_I2C_FIFO_DEPTH
+ */
+void hal_i2c_start_read(uint8_t bus, uint8_t addr, uint8_t *dst, uint8_t len);
+
+/**
+ * @brief Call fn after a wait, in place of a transfer
+ *
+ * Call with the I2C lock held, with no transfer outstanding.
+ * @param us  Microseconds to wait
+ * @param fn  Called once the wait is over
+ */
+void hal_i2c_call_after_us(uint32_t us, hal_i2c_timer_fn fn);
+
+/**
+ * @brief Keep the background transfers' callbacks out
+ *
+ * Disables interrupts on the Pico; takes a mutex on Linux. Not recursive.
+ * @return Value to pass to hal_i2c_unlock()
+ */
+uint32_t hal_i2c_lock(void);
+
+/**
+ * @brief Let the background transfers' callbacks in again
+ *
+ * @param saved  Value returned by hal_i2c_lock()
+ */
+void hal_i2c_unlock(uint32_t saved);
+
+/**
+ * @brief Wake a caller waiting in hal_i2c_wait()
+ *
+ * Call with the I2C lock held, normally from a callback.
+ */
+void hal_i2c_notify(void);
+
+/**
+ * @brief Sleep until the next hal_i2c_notify()
+ *
+ * May return early (on the Pico any event wakes the core), so callers
+ * check what they are waiting for and wait again.
+ */
+void hal_i2c_wait(void);
+
+/**
+ * @brief Hold an idle controller in reset with clk_sys to it gated off
+ *
+ * @param bus  Controller number
+ */
+void hal_i2c_sleep(uint8_t bus);
+
+/**
+ * @brief Bring a controller out of hal_i2c_sleep() at the current clk_sys
+ *
+ * @param bus   Controller number
+ * @param freq  Bus speed in Hz
+ */
+void hal_i2c_wake(uint8_t bus, uint32_t freq);
+
+/**
+ * @brief Keep a controller's bus speed after clk_sys changes
+ *
+ * @param bus   Controller number
+ * @param freq  Bus speed in Hz
+ */
+void hal_i2c_set_baudrate(uint8_t bus, uint32_t freq);
+
+// ---- TCP ----
+//
+// The web server's view of the TCP stack: lwIP's raw API on the Pico, cut
+// down to what network.c uses. Every call is made with the TCP lock held
+// (hal_tcp_lock()), which the callbacks already hold. Results are
+// lwIP's err_t values.
+
+#define HAL_TCP_OK          0     // ERR_OK
+#define HAL_TCP_ERR_MEM     (-1)  // ERR_MEM: no room now; try again later
+#define HAL_TCP_ERR_CONN    (-11) // ERR_CONN: the connection can't take data
+#define HAL_TCP_ABORTED     (-13) // ERR_ABRT: the connection was aborted
+#define HAL_TCP_ERR_RESET   (-14) // ERR_RST: the peer reset the connection
+
+#define HAL_TCP_WRITE_COPY  0x01  // Copy the data; without it the data must stay put until acknowledged
+#define HAL_TCP_WRITE_MORE  0x02  // More data follows right away
+
+#define HAL_TCP_POLL_MS     500   // Unit of the poll interval
+
+typedef struct hal_tcp_conn hal_tcp_conn;   // One connection (a tcp_pcb on the Pico)
+typedef struct hal_tcp_data hal_tcp_data;   // Received data, a chain of pieces (a pbuf chain)
+
+/**
+ * @brief What a connection reports to its owner
+ *
+ * Each is called with the arg given to hal_tcp_attach(). A callback that
+ * aborted its connection, directly or through a close, returns
+ * HAL_TCP_ABORTED.
+ */
+typedef struct {
+    int (*recv)(void *arg, hal_tcp_data *data);   // Data arrived (now owned by the callee), or NULL: the peer closed
+    int (*sent)(void *arg, uint16_t len);         // The peer acknowledged len more bytes
+    int (*poll)(void *arg);                       // The poll interval elapsed
+    void (*error)(void *arg, int err);            // The connection is gone (reset or aborted); don't use it again
+} hal_tcp_callbacks;
+
+/**
+ * @brief Called for each new connection on a listening port
+ *
+ * @param conn  The new connection
+ * @return HAL_TCP_OK to keep it, HAL_TCP_ABORTED if it was aborted;
+ *         anything else aborts it
+ */
+typedef int (*hal_tcp_accept_fn)(hal_tcp_conn *conn);
+
+/**
+ * @brief Listen for connections on a port
+ *
+ * Accepted connections are the first the stack gives up when it runs out
+ * of connections.
+ * @param port     TCP port
+ * @param backlog  Connections waiting to be accepted
+ * @param accept   Called for each new connection
+ * @return true if listening, false on error
+ */
+bool hal_tcp_listen(uint16_t port, uint8_t backlog, hal_tcp_accept_fn accept);
+
+/**
+ * @brief Send a connection's events to callbacks
+ *
+ * @param conn           Connection
+ * @param arg            Passed to every callback
+ * @param callbacks      Callbacks; must stay valid while attached
+ * @param poll_interval  Calls to poll, in HAL_TCP_POLL_MS units
+ */
+void hal_tcp_attach(hal_tcp_conn *conn, void *arg, const hal_tcp_callbacks *callbacks,
+                    uint8_t poll_interval);
+
+/**
+ * @brief Stop sending a connection's events anywhere
+ *
+ * Data still arriving is taken and dropped, and the peer's close closes it.
+ * @param conn  Connection
+ */
+void hal_tcp_detach(hal_tcp_conn *conn);
+
+/**
+ * @brief Queue bytes to send
+ *
+ * @param conn   Connection
+ * @param data   Bytes
+ * @param len    Number of bytes
+ * @param flags  HAL_TCP_WRITE_* flags
+ * @return HAL_TCP_OK, HAL_TCP_ERR_MEM if the send buffer, its queue or
+ *         the stack's memory is full, or another error
+ */
+int hal_tcp_write(hal_tcp_conn *conn, const void *data, uint16_t len, uint8_t flags);
+
+/**
+ * @brief Send what has been queued, as far as the peer has room
+ *
+ * @param conn  Connection
+ * @return HAL_TCP_OK or an error
+ */
+int hal_tcp_output(hal_tcp_conn *conn);
+
+/**
+ * @brief Bytes hal_tcp_write() can take now
+ *
+ * @param conn  Connection
+ * @return Free space in the send buffer
+ */
+uint16_t hal_tcp_send_space(const hal_tcp_conn *conn);
+
+/**
+ * @brief Writes hal_tcp_write() can take now
+ *
+ * Each write may need an entry of the send queue, which is shorter than
+ * the send buffer suggests when writes are small.
+ * @param conn  Connection
+ * @return Free entries in the send queue
+ */
+uint16_t hal_tcp_send_slots(const hal_tcp_conn *conn);
+
+/**
+ * @brief Reopen the receive window for bytes the owner has used
+ *
+ * @param conn  Connection
+ * @param len   Bytes used
+ */
+void hal_tcp_recved(hal_tcp_conn *conn, uint16_t len);
+
+/**
+ * @brief Send small writes at once instead of waiting to fill a segment
+ *
+ * @param conn  Connection
+ */
+void hal_tcp_nodelay(hal_tcp_conn *conn);
+
+/**
+ * @brief Close a connection once queued data has been sent
+ *
+ * Detach it first. Unread data left behind resets the connection instead.
+ * @param conn  Connection; not to be used again once this succeeds
+ * @return HAL_TCP_OK, or HAL_TCP_ERR_MEM if the stack had no memory to
+ *         close it, in which case the connection is unchanged
+ */
+int hal_tcp_close(hal_tcp_conn *conn);
+
+/**
+ * @brief Reset a connection and free it at once
+ *
+ * An attached connection's error callback is called with HAL_TCP_ABORTED.
+ * @param conn  Connection; not to be used again
+ */
+void hal_tcp_abort(hal_tcp_conn *conn);
+
+/**
+ * @brief True once the stack's memory for queued data is filling up
+ *
+ * @param percent  Use, in percent, that counts as low
+ * @return true if the heap or the segment pool is at least that full
+ */
+bool hal_tcp_pools_low(uint8_t percent);
+
+/**
+ * @brief Take and release the TCP lock (cyw43_arch_lwip_begin/end on the Pico)
+ *
+ * Recursive; held while callbacks run.
+ */
+void hal_tcp_lock(void);
+void hal_tcp_unlock(void);
+
+/**
+ * @brief Bytes in a chain of received data
+ *
+ * @param data  First piece
+ * @return Bytes in it and every piece after it
+ */
+uint16_t hal_tcp_data_total(const hal_tcp_data *data);
+
+/**
+ * @brief Bytes of one piece of received data
+ *
+ * @param data  Piece
+ * @param len   Receives the number of bytes
+ * @return The bytes
+ */
+const uint8_t *hal_tcp_data_bytes(const hal_tcp_data *data, uint16_t *len);
+
+/**
+ * @brief Next piece in a chain of received data
+ *
+ * @param data  Piece
+ * @return Next piece, or NULL after the last
+ */
+hal_tcp_data *hal_tcp_data_next(const hal_tcp_data *data);
+
+/**
+ * @brief Add a chain of received data to the end of another
+ *
+ * @param head  Chain to add to
+ * @param tail  Chain added; now owned by head
+ */
+void hal_tcp_data_append(hal_tcp_data *head, hal_tcp_data *tail);
+
+/**
+ * @brief Free a chain of received data
+ *
+ * @param data  First piece
+ */
+void hal_tcp_data_free(hal_tcp_data *data);
+
+#ifdef HOST_BUILD
+/**
+ * @brief Stop following the monotonic clock (host build only)
+ *
+ * From here on time only moves in hal_advance_us() and the sleeps, so
+ * tests of timers and timeouts run fast and repeat exactly. Call before
+ * anything reads the time.
+ */
+void hal_use_virtual_time(void);
+
+/**
+ * @brief Move virtual time forward (host build only)
+ *
+ * @param us  Microseconds to advance
+ */
+void hal_advance_us(uint64_t us);
+#endif
+
+#endif // HAL_H
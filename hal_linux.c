@@ -0,0 +1,294 @@
+/*
+File: hal_linux.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Linux backend of the hardware abstraction layer (see hal.h), used by
+    the host build of the firmware (host_main.c). Time comes from the
+    monotonic clock, counted from when the program started, or is
+    virtual and only moves when a test advances it. The LED strip and
+    the I2C devices are the models in sim_devices.c.
+
+    I2C transfers take as long as they would on a 100 kHz bus, so the
+    drivers see the real timing. Once attached, a bus thread stands in
+    for the controller and its interrupt: it carries out the one
+    outstanding transfer or wait and calls back with the I2C lock held.
+    sim_i2c_set_blocking() refuses to attach, so transfers stay blocking.
+
+Responsibilities:
+- Read the time and sleep with POSIX calls, or on virtual time
+- Pass LED frames to the simulated strip
+- Route each I2C transfer to the simulated device at its address and
+  model the time it holds the bus
+- Run background I2C transfers and waits on a bus thread
+
+Requires the following modules:
+- hal.h: for interface definitions
+- sim_devices.h: for the simulated devices
+- board_pins.h: for the I2C bus speed
+*/
+
+#define _POSIX_C_SOURCE 199309L
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "hal.h"
+#include "sim_devices.h"
+#include "board_pins.h"   // I2C0_FREQ
+
+#define I2C_ERROR (-1)    // What the pico-sdk returns when a device doesn't answer
+
+static sim_board s_board;
+static pthread_once_t s_board_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t s_board_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static bool s_virtual = false;
+static _Atomic uint64_t s_virtual_us = 0;
+
+// The transfer or wait handed to the bus thread
+typedef enum { I2C_JOB_NONE, I2C_JOB_WRITE, I2C_JOB_READ, I2C_JOB_WAIT } i2c_job_kind;
+
+typedef struct {
+    i2c_job_kind kind;
+    uint8_t addr;
+    const uint8_t *src;
+    uint8_t *dst;
+    uint8_t len;
+    uint32_t us;
+    hal_i2c_timer_fn fn;
+} i2c_job;
+
+static bool s_i2c_blocking = false;          // Refuse to attach
+static hal_i2c_done_fn s_i2c_done = NULL;
+static pthread_mutex_t s_i2c_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_i2c_changed = PTHREAD_COND_INITIALIZER;
+static i2c_job s_i2c_job;                    // Waiting for the bus thread
+static bool s_i2c_event = false;             // hal_i2c_notify() since the last hal_i2c_wait()
+
+static void board_init(void) {
+    sim_board_init(&s_board, 45.0f, 21.0f);
+}
+
+sim_board *sim_board_get(void) {
+    pthread_once(&s_board_once, board_init);
+    return &s_board;
+}
+
+void sim_board_lock(void) {
+    pthread_mutex_lock(&s_board_lock);
+}
+
+void sim_board_unlock(void) {
+    pthread_mutex_unlock(&s_board_lock);
+}
+
+// Nanoseconds on the monotonic clock since the first call
+static uint64_t elapsed_ns(void) {
+    static _Atomic uint64_t start_ns = 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t now_ns = (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+    uint64_t unset = 0;
+    atomic_compare_exchange_strong(&start_ns, &unset, now_ns);
+    return now_ns - start_ns;
+}
+
+uint64_t hal_time_us_64(void) {
+    return s_virtual ? s_virtual_us : elapsed_ns() / 1000u;
+}
+
+uint32_t hal_time_us(void) {
+    return (uint32_t)hal_time_us_64();
+}
+
+uint32_t hal_time_ms(void) {
+    return (uint32_t)(hal_time_us_64() / 1000u);
+}
+
+void hal_sleep_us(uint32_t us) {
+    if (s_virtual) {
+        hal_advance_us(us);
+        return;
+    }
+    struct timespec ts = { .tv_sec = us / 1000000u, .tv_nsec = (long)(us % 1000000u) * 1000 };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+        // Interrupted by a signal; sleep for the rest
+    }
+}
+
+void hal_sleep_ms(uint32_t ms) {
+    hal_sleep_us(ms * 1000u);
+}
+
+void hal_use_virtual_time(void) {
+    s_virtual = true;
+}
+
+void hal_advance_us(uint64_t us) {
+    s_virtual_us += us;
+}
+
+bool hal_leds_init(void) {
+    return true;
+}
+
+void hal_leds_show(const uint32_t *grb, size_t count) {
+    sim_board *board = sim_board_get();
+    sim_board_lock();
+    sim_ws2812_show(&board->leds, grb, count);
+    sim_board_unlock();
+}
+
+void hal_leds_wait_idle(void) {
+    // Frames reach the WS2812 model as soon as they are shown
+}
+
+void hal_leds_clock_changed(void) {
+    // The host clock doesn't change
+}
+
+// ---- I2C ----
+
+void sim_i2c_set_blocking(bool blocking) {
+    s_i2c_blocking = blocking;
+}
+
+void hal_i2c_init(uint8_t bus, uint8_t sda_pin, uint8_t scl_pin, uint32_t freq) {
+    (void)bus;
+    (void)sda_pin;
+    (void)scl_pin;
+    (void)freq;
+    sim_board_get();
+}
+
+// Time a transfer of len bytes holds the bus: address and data bytes of
+// 9 bits each, plus the start and stop conditions
+static uint32_t bus_time_us(size_t len) {
+    return (uint32_t)(((len + 1) * 9 + 2) * 1000000ull / I2C0_FREQ);
+}
+
+int hal_i2c_write_blocking(uint8_t bus, uint8_t addr, const uint8_t *src, size_t len) {
+    (void)bus;
+    hal_sleep_us(bus_time_us(len));
+    sim_board_lock();
+    int n = sim_board_i2c_write(sim_board_get(), addr, src, len, hal_time_us());
+    sim_board_unlock();
+    return n < 0 ? I2C_ERROR : n;
+}
+
+int hal_i2c_read_blocking(uint8_t bus, uint8_t addr, uint8_t *dst, size_t len) {
+    (void)bus;
+    hal_sleep_us(bus_time_us(len));
+    sim_board_lock();
+    int n = sim_board_i2c_read(sim_board_get(), addr, dst, len, hal_time_us());
+    sim_board_unlock();
+    return n < 0 ? I2C_ERROR : n;
+}
+
+// In place of the controller and its interrupt: carry out each job, then
+// call back with the lock held as the interrupt would run
+static void *i2c_bus_thread(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&s_i2c_lock);
+    while (true) {
+        while (s_i2c_job.kind == I2C_JOB_NONE) {
+            pthread_cond_wait(&s_i2c_changed, &s_i2c_lock);
+        }
+        i2c_job job = s_i2c_job;
+        s_i2c_job.kind = I2C_JOB_NONE;
+        pthread_mutex_unlock(&s_i2c_lock);
+
+        int result = 0;
+        if (job.kind == I2C_JOB_WRITE) {
+            result = hal_i2c_write_blocking(0, job.addr, job.src, job.len);
+        } else if (job.kind == I2C_JOB_READ) {
+            result = hal_i2c_read_blocking(0, job.addr, job.dst, job.len);
+        } else {
+            hal_sleep_us(job.us);
+        }
+
+        pthread_mutex_lock(&s_i2c_lock);
+        if (job.kind == I2C_JOB_WAIT) {
+            job.fn();
+        } else {
+            s_i2c_done(result);
+        }
+    }
+    return NULL;
+}
+
+bool hal_i2c_attach(hal_i2c_done_fn done) {
+    if (s_i2c_blocking) {
+        printf("I2C: transfers stay blocking\n");
+        return false;
+    }
+    s_i2c_done = done;
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, i2c_bus_thread, NULL) != 0) {
+        printf("ERROR: Failed to start the I2C bus thread; transfers stay blocking\n");
+        return false;
+    }
+    pthread_detach(thread);
+    return true;
+}
+
+static void i2c_hand_over(i2c_job job) {
+    s_i2c_job = job;
+    pthread_cond_broadcast(&s_i2c_changed);
+}
+
+void hal_i2c_start_write(uint8_t bus, uint8_t addr, const uint8_t *src, uint8_t len) {
+    (void)bus;
+    i2c_hand_over((i2c_job){ .kind = I2C_JOB_WRITE, .addr = addr, .src = src, .len = len });
+}
+
+void hal_i2c_start_read(uint8_t bus, uint8_t addr, uint8_t *dst, uint8_t len) {
+    (void)bus;
+    i2c_hand_over((i2c_job){ .kind = I2C_JOB_READ, .addr = addr, .dst = dst, .len = len });
+}
+
+void hal_i2c_call_after_us(uint32_t us, hal_i2c_timer_fn fn) {
+    i2c_hand_over((i2c_job){ .kind = I2C_JOB_WAIT, .us = us, .fn = fn });
+}
+
+uint32_t hal_i2c_lock(void) {
+    pthread_mutex_lock(&s_i2c_lock);
+    return 0;
+}
+
+void hal_i2c_unlock(uint32_t saved) {
+    (void)saved;
+    pthread_mutex_unlock(&s_i2c_lock);
+}
+
+void hal_i2c_notify(void) {
+    s_i2c_event = true;
+    pthread_cond_broadcast(&s_i2c_changed);
+}
+
+void hal_i2c_wait(void) {
+    pthread_mutex_lock(&s_i2c_lock);
+    while (!s_i2c_event) {
+        pthread_cond_wait(&s_i2c_changed, &s_i2c_lock);
+    }
+    s_i2c_event = false;
+    pthread_mutex_unlock(&s_i2c_lock);
+}
+
+void hal_i2c_sleep(uint8_t bus) {
+    (void)bus;   // The simulated buses draw nothing while idle
+}
+
+void hal_i2c_wake(uint8_t bus, uint32_t freq) {
+    (void)bus;
+    (void)freq;
+}
+
+void hal_i2c_set_baudrate(uint8_t bus, uint32_t freq) {
+    (void)bus;   // The simulated bus keeps its speed whatever clk_sys is
+    (void)freq;
+}
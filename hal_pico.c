@@ -0,0 +1,263 @@
+/*
+File: hal_pico.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Pico backend of the hardware abstraction layer (see hal.h).
+
+    The WS2812 output was moved here from led_array.c. Its low-level PIO
+    setup is adapted from the official Raspberry Pi Pico SDK "ws2812" pio
+    example, which is licensed as follows:
+    Copyright (c) 2020 Raspberry Pi (Trading) Ltd.
+    SPDX-License-Identifier: BSD-3-Clause
+    Source: https://github.com/raspberrypi/pico-examples/tree/master/pio/ws2812
+
+Responsibilities:
+- Read the time and sleep using the pico-sdk timer
+- Drive the WS2812 strip from a PIO state machine
+- Run I2C transfers from the controller's FIFO and interrupt, and time the
+  waits between them with alarms on the attached core's own alarm pool
+- Hold idle I2C controllers in reset with their clk_sys gated off
+
+Requires the following modules:
+- hal.h: for interface definitions
+- board_pins.h: for the LED data pin
+*/
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "ws2812.pio.h"
+
+#include "hal.h"
+#include "board_pins.h"   // LED_PIN
+
+#define LED_FREQ_HZ 800000  // WS2812 bit rate
+#define LED_RESET_US 100    // Low time that latches a frame
+
+static PIO pio = pio0;      // PIO block used to drive LEDs
+static int sm = -1;         // State machine index for LED control
+
+#define I2C_ALARMS 2        // Alarms on the attached core's pool; one wait is pending at a time
+
+// The background transfer on the bus, shared with the I2C interrupt
+typedef struct {
+    i2c_hw_t *hw;
+    uint8_t *dst;           // Where a read's bytes go (NULL for a write)
+    uint8_t len;
+    bool failed;            // TX_ABRT: the device didn't answer
+} i2c_transfer;
+
+static uint8_t s_i2c_used = 0;          // Bit per controller set up by hal_i2c_init()
+static hal_i2c_done_fn s_i2c_done = NULL;
+static hal_i2c_timer_fn s_i2c_timer = NULL;   // Waiting for the alarm
+static alarm_pool_t *s_i2c_alarms = NULL;
+static i2c_transfer s_i2c;
+
+uint32_t hal_time_us(void) {
+    return time_us_32();
+}
+
+uint64_t hal_time_us_64(void) {
+    return time_us_64();
+}
+
+uint32_t hal_time_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+void hal_sleep_us(uint32_t us) {
+    sleep_us(us);
+}
+
+void hal_sleep_ms(uint32_t ms) {
+    sleep_ms(ms);
+}
+
+bool hal_leds_init(void) {
+    // Load PIO program
+    uint offset = pio_add_program(pio, &ws2812_program);
+    if (offset == (uint)-1) {
+        return false;
+    }
+    // Claim unused state machine
+    sm = pio_claim_unused_sm(pio, false);
+    if (sm < 0) {
+        return false;
+    }
+    // Initialize WS2812 driver at 800 kHz
+    ws2812_program_init(pio, sm, offset, LED_PIN, LED_FREQ_HZ, false);
+    return true;
+}
+
+void hal_leds_show(const uint32_t *grb, size_t count) {
+    for (size_t i = 0; i < count; ++i)
+        pio_sm_put_blocking(pio, sm, grb[i] << 8);
+    sleep_us(LED_RESET_US);
+}
+
+// hal_leds_show() returns with up to a FIFO's worth of colors still queued.
+// Wait for the FIFO to empty, then for the state machine to stall on it,
+// which it only does once the last bit has left the output shift register.
+void hal_leds_wait_idle(void) {
+    if (sm < 0) return;
+    while (!pio_sm_is_tx_fifo_empty(pio, sm)) {
+        tight_loop_contents();
+    }
+    uint32_t stall = 1u << (PIO_FDEBUG_TXSTALL_LSB + sm);
+    pio->fdebug = stall;   // Write 1 to clear
+    while (!(pio->fdebug & stall)) {
+        tight_loop_contents();
+    }
+}
+
+// Recompute the PIO divider that ws2812_program_init() derived from clk_sys
+void hal_leds_clock_changed(void) {
+    if (sm < 0) return;
+    int cycles_per_bit = ws2812_T1 + ws2812_T2 + ws2812_T3;
+    pio_sm_set_clkdiv(pio, sm, clock_get_hz(clk_sys) / ((float)LED_FREQ_HZ * cycles_per_bit));
+}
+
+// ---- I2C ----
+
+void hal_i2c_init(uint8_t bus, uint8_t sda_pin, uint8_t scl_pin, uint32_t freq) {
+    i2c_init(i2c_get_instance(bus), freq);
+    gpio_set_function(sda_pin, GPIO_FUNC_I2C);
+    gpio_set_function(scl_pin, GPIO_FUNC_I2C);
+    gpio_pull_up(sda_pin);
+    gpio_pull_up(scl_pin);
+    s_i2c_used |= 1u << bus;
+}
+
+int hal_i2c_write_blocking(uint8_t bus, uint8_t addr, const uint8_t *src, size_t len) {
+    return i2c_write_blocking(i2c_get_instance(bus), addr, src, len, false);
+}
+
+int hal_i2c_read_blocking(uint8_t bus, uint8_t addr, uint8_t *dst, size_t len) {
+    return i2c_read_blocking(i2c_get_instance(bus), addr, dst, len, false);
+}
+
+// STOP_DET ends every write and read; TX_ABRT comes first if the device didn't answer
+static void i2c_irq(void) {
+    i2c_hw_t *hw = s_i2c.hw;
+    uint32_t status = hw->intr_stat;
+
+    if (status & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        (void)hw->clr_tx_abrt;
+        s_i2c.failed = true;
+    }
+    if (status & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+        (void)hw->clr_stop_det;
+        if (s_i2c.dst) {
+            // Empty the RX FIFO even after an abort so the next read starts clean
+            for (uint8_t i = 0; hw->rxflr > 0; i++) {
+                uint8_t byte = (uint8_t)hw->data_cmd;
+                if (i < s_i2c.len) {
+                    s_i2c.dst[i] = byte;
+                }
+            }
+        }
+        hw->intr_mask = 0;
+        s_i2c_done(s_i2c.failed ? PICO_ERROR_GENERIC : s_i2c.len);
+    }
+}
+
+bool hal_i2c_attach(hal_i2c_done_fn done) {
+    // Alarms and interrupts are serviced on the core that sets them up
+    s_i2c_done = done;
+    s_i2c_alarms = alarm_pool_create_with_unused_hardware_alarm(I2C_ALARMS);
+    for (uint8_t bus = 0; bus < NUM_I2CS; bus++) {
+        if (!(s_i2c_used & (1u << bus))) continue;
+        uint irq = I2C0_IRQ + bus;
+        i2c_get_hw(i2c_get_instance(bus))->intr_mask = 0;
+        irq_set_exclusive_handler(irq, i2c_irq);
+        irq_set_enabled(irq, true);
+    }
+    return true;
+}
+
+// Load the whole write or read into the FIFO; the STOP interrupt reports
+// when the bus is done with it
+static void i2c_start(uint8_t bus, uint8_t addr, const uint8_t *src, uint8_t *dst, uint8_t len) {
+    i2c_hw_t *hw = i2c_get_hw(i2c_get_instance(bus));
+    s_i2c = (i2c_transfer){ .hw = hw, .dst = dst, .len = len };
+
+    if (hw->tar != addr) {
+        hw->enable = 0;
+        hw->tar = addr;
+        hw->enable = 1;
+    }
+    hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+    for (uint8_t i = 0; i < len; i++) {
+        uint32_t stop = (i + 1 == len) ? I2C_IC_DATA_CMD_STOP_BITS : 0;
+        hw->data_cmd = dst ? (I2C_IC_DATA_CMD_CMD_BITS | stop) : (src[i] | stop);
+    }
+}
+
+void hal_i2c_start_write(uint8_t bus, uint8_t addr, const uint8_t *src, uint8_t len) {
+    i2c_start(bus, addr, src, NULL, len);
+}
+
+void hal_i2c_start_read(uint8_t bus, uint8_t addr, uint8_t *dst, uint8_t len) {
+    i2c_start(bus, addr, NULL, dst, len);
+}
+
+static int64_t i2c_alarm(alarm_id_t id, void *user_data) {
+    (void)id;
+    (void)user_data;
+    s_i2c_timer();
+    return 0;
+}
+
+void hal_i2c_call_after_us(uint32_t us, hal_i2c_timer_fn fn) {
+    s_i2c_timer = fn;
+    if (alarm_pool_add_alarm_in_us(s_i2c_alarms, us, i2c_alarm, NULL, true) < 0) {
+        busy_wait_us_32(us);   // Pool exhausted; should not happen with one wait at a time
+        fn();
+    }
+}
+
+uint32_t hal_i2c_lock(void) {
+    return save_and_disable_interrupts();
+}
+
+void hal_i2c_unlock(uint32_t saved) {
+    restore_interrupts(saved);
+}
+
+void hal_i2c_notify(void) {
+    __sev();
+}
+
+void hal_i2c_wait(void) {
+    __wfe();   // The I2C interrupt or an alarm wakes the core
+}
+
+// clk_sys enable bits of a controller, for wake and sleep mode
+static uint32_t i2c_clock_bits(uint8_t bus) {
+    return bus ? CLOCKS_WAKE_EN0_CLK_SYS_I2C1_BITS : CLOCKS_WAKE_EN0_CLK_SYS_I2C0_BITS;
+}
+
+void hal_i2c_sleep(uint8_t bus) {
+    // The pull-ups hold both lines high, as on an idle bus
+    i2c_deinit(i2c_get_instance(bus));
+    hw_clear_bits(&clocks_hw->wake_en0, i2c_clock_bits(bus));
+    hw_clear_bits(&clocks_hw->sleep_en0, i2c_clock_bits(bus));
+}
+
+// i2c_init() takes the controller out of reset and sets the baud rate from
+// the current clk_sys
+void hal_i2c_wake(uint8_t bus, uint32_t freq) {
+    hw_set_bits(&clocks_hw->wake_en0, i2c_clock_bits(bus));
+    hw_set_bits(&clocks_hw->sleep_en0, i2c_clock_bits(bus));
+    i2c_init(i2c_get_instance(bus), freq);
+}
+
+void hal_i2c_set_baudrate(uint8_t bus, uint32_t freq) {
+    i2c_set_baudrate(i2c_get_instance(bus), freq);
+}
@@ -0,0 +1,1125 @@
+/*
+File: hal_tcp_linux.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    The hal_tcp_* functions of hal.h for the host build (HOST_BUILD).
+    Connections are carried over loopback sockets or to virtual clients
+    (see sim_network.h), and are kept with the limits the Pico's
+    lwipopts.h sets, so network.c's flow control, connection pool and
+    error paths meet what they meet on the Pico:
+
+    - Each connection has an 8 * MSS send buffer and a queue of
+      TCP_SND_QUEUELEN segments, filled as lwIP fills them (a write tops
+      up the last segment that hasn't started to leave, then starts new
+      ones of up to one MSS), and 32 segments are shared by every
+      connection as MEMP_TCP_SEG is.
+    - Data is delivered one MSS at a time against an 8 * MSS receive
+      window; refused data is offered again every 250 ms, and poll runs
+      every HAL_TCP_POLL_MS.
+    - At most MEMP_NUM_TCP_PCB connections exist; more are refused.
+    - Closing sends FIN after the queued data, or RST if unread data is
+      left behind, and data arriving after the close aborts the
+      connection, as lwIP does. A closed connection is gone once the
+      peer has acknowledged everything; there is no TIME_WAIT.
+
+    There are no retransmissions, no Nagle delay and no congestion
+    window: a segment leaves as soon as the peer has room.
+
+Responsibilities:
+- Keep connections, their send queues and windows, and call their callbacks
+- Carry their bytes over loopback sockets or to virtual clients
+- Run the TCP timers from a background thread, or from sim_network_run()
+
+Requires the following modules:
+- hal.h: for the interface and the time
+- sim_network.h: for the host controls
+*/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <linux/sockios.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+#include "hal.h"
+#include "sim_network.h"
+
+// The Pico's lwipopts.h
+#define MSS                 1460
+#define SND_BUF             (8 * MSS)
+#define SND_QUEUELEN        32
+#define SEGMENTS            32      // MEMP_NUM_TCP_SEG, shared by every connection
+#define RCV_WND             (8 * MSS)
+#define CONNS_MAX           8       // MEMP_NUM_TCP_PCB
+
+// lwIP's timers
+#define TICK_MS             250     // Refused data is offered again every tick
+#define CLOSE_TIMEOUT_MS    120000  // A closed connection whose peer stops acknowledging is dropped
+
+// Host transport
+#define LISTENERS_MAX       2
+#define SOCKET_SNDBUF       8192    // Small, so a slow reader pushes back on the stack
+#define LISTEN_BACKLOG      8
+#define ACCEPTS_PER_STEP    4
+#define SEGMENTS_PER_STEP   8
+#define ACK_POLL_MS         2       // Socket acks don't wake poll(); look again this soon
+#define STEPS_PER_WAKE      64
+#define FREED_CONNS_KEPT    64      // Freed connections kept to catch late calls on them
+
+#define PEER_FIN  (-1)
+#define PEER_RST  (-2)
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+struct hal_tcp_data {
+    hal_tcp_data *next;
+    uint16_t len;
+    uint8_t bytes[];
+};
+
+// A queued segment: stream offsets of its first byte and of the byte after it
+typedef struct {
+    uint32_t start;
+    uint32_t end;
+} tcp_segment;
+
+struct hal_tcp_conn {
+    hal_tcp_conn *next;
+    bool freed;                 // Gone; kept a while to catch late calls
+    void *arg;
+    const hal_tcp_callbacks *callbacks;
+    uint8_t poll_interval;
+    uint8_t poll_ticks;
+    uint8_t tx[SND_BUF];        // Unacknowledged bytes, at stream offset % SND_BUF
+    uint32_t written;           // Stream offsets: bytes queued,
+    uint32_t sent;              // handed to the peer,
+    uint32_t acked;             // and acknowledged by it
+    tcp_segment segs[SND_QUEUELEN];
+    uint8_t seg_head;
+    uint8_t seg_count;
+    uint16_t rcv_wnd;
+    hal_tcp_data *refused;      // Data recv turned down, offered again from the timer
+    bool closed;                // The owner closed; data arriving now aborts the connection
+    bool fin_queued;
+    bool fin_sent;
+    bool fin_acked;
+    bool peer_fin;
+    uint64_t closed_us;
+    int fd;                     // Loopback socket, -1 if none
+    struct sim_tcp_client *client;
+};
+
+typedef struct {
+    uint16_t port;
+    hal_tcp_accept_fn accept;
+    int fd;
+} tcp_listener;
+
+// A virtual client (sim_network.h)
+struct sim_tcp_client {
+    bool used;
+    uint16_t port;
+    bool accepted;
+    hal_tcp_conn *conn;
+    uint8_t *rx;                // Bytes from the device
+    size_t rx_len, rx_pos, rx_cap;
+    uint8_t *tx;                // Bytes for the device
+    size_t tx_len, tx_pos, tx_cap;
+    size_t window;
+    bool acking;
+    uint32_t delivered;
+    uint32_t acked;
+    bool fin_out;               // The client sent FIN
+    bool fin_in;                // The device sent FIN
+    bool fin_in_acked;
+    bool rst_out;               // The client reset the connection
+    bool rst_in;                // Refused or reset by the device
+};
+
+static pthread_mutex_t s_lock;
+static pthread_once_t s_lock_once = PTHREAD_ONCE_INIT;
+static bool s_started = false;
+static bool s_virtual = false;
+static uint16_t s_port_offset = SIM_DEFAULT_PORT_OFFSET;
+static int s_wake_fd = -1;
+static uint32_t s_stale_calls = 0;
+static uint32_t s_fail_closes = 0;
+static uint64_t s_next_tick_us = 0;
+static uint32_t s_ticks = 0;
+
+static tcp_listener s_listeners[LISTENERS_MAX];
+static uint8_t s_listener_count = 0;
+static hal_tcp_conn *s_conns = NULL;
+static uint8_t s_segments_used = 0;
+static uint32_t s_data_pieces = 0;
+static struct sim_tcp_client s_clients[SIM_TCP_CLIENTS_MAX];
+
+// ---------------------------------------------------------------------------
+// Lock and mode
+// ---------------------------------------------------------------------------
+
+static void lock_init(void) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&s_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void hal_tcp_lock(void) {
+    pthread_once(&s_lock_once, lock_init);
+    pthread_mutex_lock(&s_lock);
+}
+
+void hal_tcp_unlock(void) {
+    pthread_mutex_unlock(&s_lock);
+}
+
+// Make the stack's thread look at its sockets and timers again
+static void stack_wake(void) {
+    if (s_wake_fd >= 0) {
+        uint64_t one = 1;
+        ssize_t n = write(s_wake_fd, &one, sizeof(one));
+        (void)n;
+    }
+}
+
+static void *xcalloc(size_t size) {
+    void *mem = calloc(1, size);
+    if (!mem) {
+        printf("ERROR: out of host memory\n");
+        abort();
+    }
+    return mem;
+}
+
+void sim_network_use_virtual(void) {
+    s_virtual = true;
+    hal_use_virtual_time();
+}
+
+void sim_network_set_port_offset(uint16_t offset) {
+    s_port_offset = offset;
+}
+
+uint16_t sim_network_host_port(uint16_t port) {
+    return (port < SIM_PORT_MAP_SPAN) ? (uint16_t)(port + s_port_offset) : port;
+}
+
+uint32_t sim_network_stale_calls(void) {
+    return s_stale_calls;
+}
+
+// ---------------------------------------------------------------------------
+// Received data
+// ---------------------------------------------------------------------------
+
+static hal_tcp_data *data_new(const uint8_t *bytes, uint16_t len) {
+    hal_tcp_data *data = xcalloc(sizeof(*data) + len);
+    data->len = len;
+    memcpy(data->bytes, bytes, len);
+    s_data_pieces++;
+    return data;
+}
+
+uint16_t hal_tcp_data_total(const hal_tcp_data *data) {
+    uint32_t total = 0;
+    for (; data; data = data->next) {
+        total += data->len;
+    }
+    return (uint16_t)MIN(total, 0xffffu);
+}
+
+const uint8_t *hal_tcp_data_bytes(const hal_tcp_data *data, uint16_t *len) {
+    *len = data->len;
+    return data->bytes;
+}
+
+hal_tcp_data *hal_tcp_data_next(const hal_tcp_data *data) {
+    return data->next;
+}
+
+void hal_tcp_data_append(hal_tcp_data *head, hal_tcp_data *tail) {
+    while (head->next) {
+        head = head->next;
+    }
+    head->next = tail;
+}
+
+void hal_tcp_data_free(hal_tcp_data *data) {
+    while (data) {
+        hal_tcp_data *next = data->next;
+        free(data);
+        s_data_pieces--;
+        data = next;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Connections and the peer behind each one
+// ---------------------------------------------------------------------------
+
+// True, with an error, for a call on a connection already freed
+static bool conn_stale(const hal_tcp_conn *conn, const char *fn) {
+    if (!conn || !conn->freed) return false;
+    s_stale_calls++;
+    printf("ERROR: %s() on a freed connection\n", fn);
+    return true;
+}
+
+static void buffer_append(uint8_t **buf, size_t *len, size_t *cap, const void *data, size_t n) {
+    if (n == 0) return;
+    if (*len + n > *cap) {
+        size_t cap_new = *cap ? *cap : 1024;
+        while (cap_new < *len + n) {
+            cap_new *= 2;
+        }
+        uint8_t *grown = realloc(*buf, cap_new);
+        if (!grown) {
+            printf("ERROR: out of host memory\n");
+            abort();
+        }
+        *buf = grown;
+        *cap = cap_new;
+    }
+    memcpy(*buf + *len, data, n);
+    *len += n;
+}
+
+// Hand bytes to the peer; returns how many it took
+static size_t peer_send(hal_tcp_conn *conn, const uint8_t *data, size_t len) {
+    if (conn->fd >= 0) {
+        ssize_t n = send(conn->fd, data, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+        return n > 0 ? (size_t)n : 0;
+    }
+    struct sim_tcp_client *c = conn->client;
+    if (!c || c->rst_in) return 0;
+    size_t unread = c->rx_len - c->rx_pos;
+    size_t room = c->window > unread ? c->window - unread : 0;
+    size_t n = MIN(len, room);
+    buffer_append(&c->rx, &c->rx_len, &c->rx_cap, data, n);
+    c->delivered += (uint32_t)n;
+    if (c->acking) {
+        c->acked = c->delivered;
+    }
+    return n;
+}
+
+// Stream bytes the peer acknowledged
+static uint32_t peer_acked(hal_tcp_conn *conn) {
+    if (conn->fd >= 0) {
+        int outq = 0;
+        if (ioctl(conn->fd, SIOCOUTQ, &outq) != 0) return conn->acked;
+        if (conn->fin_sent && outq > 0) {
+            outq--;     // The FIN takes a sequence number of its own
+        }
+        return conn->sent - (uint32_t)outq;
+    }
+    struct sim_tcp_client *c = conn->client;
+    if (!c) return conn->acked;
+    if (c->acking) {
+        c->acked = c->delivered;
+    }
+    return c->acked;
+}
+
+static bool peer_fin_acked(hal_tcp_conn *conn) {
+    if (conn->fd >= 0) {
+        int outq = 0;
+        return ioctl(conn->fd, SIOCOUTQ, &outq) == 0 && outq == 0;
+    }
+    struct sim_tcp_client *c = conn->client;
+    if (c && c->fin_in && c->acking) {
+        c->fin_in_acked = true;
+    }
+    return !c || c->fin_in_acked;
+}
+
+static void peer_send_fin(hal_tcp_conn *conn) {
+    if (conn->fd >= 0) {
+        shutdown(conn->fd, SHUT_WR);
+    } else if (conn->client) {
+        conn->client->fin_in = true;
+    }
+}
+
+// Look at up to max bytes from the peer without taking them: the count,
+// 0 if nothing is waiting, PEER_FIN or PEER_RST
+static int peer_peek(hal_tcp_conn *conn, uint8_t *buf, size_t max) {
+    if (conn->fd >= 0) {
+        ssize_t n = recv(conn->fd, buf, max, MSG_PEEK | MSG_DONTWAIT);
+        if (n > 0) return (int)n;
+        if (n == 0) return PEER_FIN;
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : PEER_RST;
+    }
+    struct sim_tcp_client *c = conn->client;
+    if (!c || c->rst_out) return PEER_RST;
+    size_t avail = c->tx_len - c->tx_pos;
+    if (avail > 0) {
+        size_t n = MIN(avail, max);
+        memcpy(buf, c->tx + c->tx_pos, n);
+        return (int)n;
+    }
+    return c->fin_out ? PEER_FIN : 0;
+}
+
+static void peer_consume(hal_tcp_conn *conn, size_t n) {
+    if (conn->fd >= 0) {
+        uint8_t discard[MSS];
+        ssize_t got = recv(conn->fd, discard, MIN(n, sizeof(discard)), MSG_DONTWAIT);
+        (void)got;
+    } else if (conn->client) {
+        struct sim_tcp_client *c = conn->client;
+        c->tx_pos += n;
+        if (c->tx_pos == c->tx_len) {
+            c->tx_pos = c->tx_len = 0;   // All taken: start the buffer over
+        }
+    }
+}
+
+// Let go of the peer: with reset, it sees RST; otherwise the connection just ends
+static void peer_close(hal_tcp_conn *conn, bool reset) {
+    if (conn->fd >= 0) {
+        if (reset) {
+            struct linger lg = { .l_onoff = 1, .l_linger = 0 };
+            setsockopt(conn->fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+        }
+        close(conn->fd);
+        conn->fd = -1;
+    }
+    if (conn->client) {
+        if (reset) {
+            conn->client->rst_in = true;
+        }
+        conn->client->conn = NULL;
+        conn->client = NULL;
+    }
+}
+
+// Let go of a connection's peer, queue and data; its memory is kept until conns_reap()
+static void conn_free(hal_tcp_conn *conn, bool reset) {
+    peer_close(conn, reset);
+    s_segments_used = (uint8_t)(s_segments_used - conn->seg_count);
+    conn->seg_count = 0;
+    hal_tcp_data_free(conn->refused);
+    conn->refused = NULL;
+    conn->callbacks = NULL;
+    conn->freed = true;
+}
+
+// Free the memory of the oldest freed connections, keeping the newest to catch late calls
+static void conns_reap(void) {
+    unsigned kept = 0;
+    for (hal_tcp_conn **at = &s_conns; *at;) {
+        hal_tcp_conn *conn = *at;
+        if (conn->freed && ++kept > FREED_CONNS_KEPT) {
+            *at = conn->next;
+            free(conn);
+        } else {
+            at = &conn->next;
+        }
+    }
+}
+
+static unsigned conns_live(void) {
+    unsigned count = 0;
+    for (hal_tcp_conn *conn = s_conns; conn; conn = conn->next) {
+        if (!conn->freed) count++;
+    }
+    return count;
+}
+
+uint32_t sim_network_tcp_conns(void) {
+    hal_tcp_lock();
+    uint32_t count = conns_live();
+    hal_tcp_unlock();
+    return count;
+}
+
+uint32_t sim_network_tcp_buffers(void) {
+    hal_tcp_lock();
+    uint32_t count = s_segments_used + s_data_pieces;
+    hal_tcp_unlock();
+    return count;
+}
+
+// Free a connection, resetting the peer, and tell its owner why
+static void conn_fail(hal_tcp_conn *conn, bool reset, int err) {
+    const hal_tcp_callbacks *callbacks = conn->callbacks;
+    void *arg = conn->arg;
+    conn_free(conn, reset);
+    if (callbacks && callbacks->error) {
+        callbacks->error(arg, err);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// The owner's calls (hal.h)
+// ---------------------------------------------------------------------------
+
+void hal_tcp_attach(hal_tcp_conn *conn, void *arg, const hal_tcp_callbacks *callbacks,
+                    uint8_t poll_interval) {
+    if (conn_stale(conn, "hal_tcp_attach")) return;
+    conn->arg = arg;
+    conn->callbacks = callbacks;
+    conn->poll_interval = poll_interval;
+    conn->poll_ticks = 0;
+}
+
+void hal_tcp_detach(hal_tcp_conn *conn) {
+    if (conn_stale(conn, "hal_tcp_detach")) return;
+    conn->arg = NULL;
+    conn->callbacks = NULL;
+}
+
+static uint16_t send_space(const hal_tcp_conn *conn) {
+    return (uint16_t)(SND_BUF - (conn->written - conn->acked));
+}
+
+uint16_t hal_tcp_send_space(const hal_tcp_conn *conn) {
+    return conn_stale(conn, "hal_tcp_send_space") ? 0 : send_space(conn);
+}
+
+uint16_t hal_tcp_send_slots(const hal_tcp_conn *conn) {
+    return conn_stale(conn, "hal_tcp_send_slots") ? 0 : (uint16_t)(SND_QUEUELEN - conn->seg_count);
+}
+
+int hal_tcp_write(hal_tcp_conn *conn, const void *data, uint16_t len, uint8_t flags) {
+    (void)flags;   // Always copied, and nothing waits for more
+    if (conn_stale(conn, "hal_tcp_write")) return HAL_TCP_ERR_CONN;
+    if (conn->fin_queued) return HAL_TCP_ERR_CONN;
+    if (len == 0) return HAL_TCP_OK;
+    if (len > send_space(conn)) return HAL_TCP_ERR_MEM;
+
+    // Top up the last segment if none of it has left, then start new ones
+    tcp_segment *last = NULL;
+    if (conn->seg_count > 0) {
+        last = &conn->segs[(conn->seg_head + conn->seg_count - 1) % SND_QUEUELEN];
+        if (last->start < conn->sent || last->end - last->start >= MSS) last = NULL;
+    }
+    uint16_t fill = last ? (uint16_t)MIN(MSS - (last->end - last->start), len) : 0;
+    unsigned needed = (unsigned)(len - fill + MSS - 1) / MSS;
+    if (conn->seg_count + needed > SND_QUEUELEN || s_segments_used + needed > SEGMENTS) {
+        return HAL_TCP_ERR_MEM;
+    }
+
+    const uint8_t *bytes = data;
+    for (uint16_t done = 0; done < len;) {
+        uint32_t at = (conn->written + done) % SND_BUF;
+        uint16_t n = (uint16_t)MIN((uint32_t)(len - done), SND_BUF - at);
+        memcpy(conn->tx + at, bytes + done, n);
+        done = (uint16_t)(done + n);
+    }
+    if (last) {
+        last->end += fill;
+    }
+    for (uint32_t start = conn->written + fill; start < conn->written + len; start += MSS) {
+        tcp_segment *seg = &conn->segs[(conn->seg_head + conn->seg_count) % SND_QUEUELEN];
+        seg->start = start;
+        seg->end = MIN(start + MSS, conn->written + len);
+        conn->seg_count++;
+        s_segments_used++;
+    }
+    conn->written += len;
+    return HAL_TCP_OK;
+}
+
+// Hand queued data, then the FIN, to the peer as far as it has room; true if anything moved
+static bool conn_push(hal_tcp_conn *conn) {
+    bool moved = false;
+    while (conn->sent != conn->written) {
+        uint32_t at = conn->sent % SND_BUF;
+        size_t n = MIN((size_t)(conn->written - conn->sent), (size_t)(SND_BUF - at));
+        size_t taken = peer_send(conn, conn->tx + at, n);
+        conn->sent += (uint32_t)taken;
+        moved |= taken > 0;
+        if (taken < n) break;
+    }
+    if (conn->fin_queued && !conn->fin_sent && conn->sent == conn->written) {
+        peer_send_fin(conn);
+        conn->fin_sent = true;
+        moved = true;
+    }
+    if (moved) {
+        stack_wake();
+    }
+    return moved;
+}
+
+int hal_tcp_output(hal_tcp_conn *conn) {
+    if (conn_stale(conn, "hal_tcp_output")) return HAL_TCP_ERR_CONN;
+    conn_push(conn);
+    return HAL_TCP_OK;
+}
+
+void hal_tcp_recved(hal_tcp_conn *conn, uint16_t len) {
+    if (conn_stale(conn, "hal_tcp_recved")) return;
+    conn->rcv_wnd = (uint16_t)MIN((uint32_t)conn->rcv_wnd + len, RCV_WND);
+    stack_wake();
+}
+
+void hal_tcp_nodelay(hal_tcp_conn *conn) {
+    // Accepted sockets already have TCP_NODELAY, and nothing waits for virtual clients
+    conn_stale(conn, "hal_tcp_nodelay");
+}
+
+int hal_tcp_close(hal_tcp_conn *conn) {
+    if (conn_stale(conn, "hal_tcp_close")) return HAL_TCP_ERR_CONN;
+    // lwIP marks the connection closed for receiving even when it can't queue the FIN
+    conn->closed = true;
+    if (s_fail_closes > 0) {
+        s_fail_closes--;
+        return HAL_TCP_ERR_MEM;
+    }
+    if (conn->fin_queued) return HAL_TCP_OK;
+    // Unread data left behind: tell the peer with RST rather than FIN
+    if (conn->refused || conn->rcv_wnd != RCV_WND) {
+        conn_free(conn, true);
+        return HAL_TCP_OK;
+    }
+    conn->fin_queued = true;
+    conn->closed_us = hal_time_us_64();
+    conn_push(conn);
+    return HAL_TCP_OK;
+}
+
+void hal_tcp_abort(hal_tcp_conn *conn) {
+    if (!conn_stale(conn, "hal_tcp_abort")) {
+        conn_fail(conn, true, HAL_TCP_ABORTED);
+    }
+}
+
+bool hal_tcp_pools_low(uint8_t percent) {
+    // Segments are the only pool modelled; the heap is the host's
+    return (uint32_t)s_segments_used * 100u >= (uint32_t)SEGMENTS * percent;
+}
+
+void sim_tcp_fail_closes(uint32_t count) {
+    hal_tcp_lock();
+    s_fail_closes = count;
+    hal_tcp_unlock();
+}
+
+// ---------------------------------------------------------------------------
+// Input, acknowledgements and timers
+// ---------------------------------------------------------------------------
+
+// Take what the peer acknowledged off the queue and tell the owner
+static bool conn_input_ack(hal_tcp_conn *conn) {
+    uint32_t acked = peer_acked(conn);
+    uint32_t delta = acked - conn->acked;
+    bool fin_acked = conn->fin_sent && !conn->fin_acked && peer_fin_acked(conn);
+    if (delta == 0 && !fin_acked) return false;
+
+    conn->acked = acked;
+    conn->fin_acked |= fin_acked;
+    while (conn->seg_count > 0 && conn->segs[conn->seg_head].end <= acked) {
+        conn->seg_head = (uint8_t)((conn->seg_head + 1) % SND_QUEUELEN);
+        conn->seg_count--;
+        s_segments_used--;
+    }
+    if (conn->fin_acked && acked == conn->written) {
+        // Everything is through; the peer's FIN, if it comes, has nobody to go to
+        conn_free(conn, false);
+        return true;
+    }
+    if (delta > 0 && conn->callbacks && conn->callbacks->sent) {
+        conn->callbacks->sent(conn->arg, (uint16_t)delta);
+    }
+    return true;
+}
+
+// Offer data to the owner: recv, or take and drop it if nobody is attached
+static int conn_deliver(hal_tcp_conn *conn, hal_tcp_data *data) {
+    if (conn->callbacks && conn->callbacks->recv) {
+        return conn->callbacks->recv(conn->arg, data);
+    }
+    hal_tcp_recved(conn, hal_tcp_data_total(data));
+    hal_tcp_data_free(data);
+    return HAL_TCP_OK;
+}
+
+// The peer's FIN, after all its data: recv of NULL, or a close if nobody is attached
+static void conn_input_fin(hal_tcp_conn *conn) {
+    conn->peer_fin = true;
+    if (conn->callbacks && conn->callbacks->recv) {
+        conn->callbacks->recv(conn->arg, NULL);
+    } else {
+        hal_tcp_close(conn);
+    }
+}
+
+// Offer refused data to the owner again; false if it is still refused
+static bool conn_retry_refused(hal_tcp_conn *conn) {
+    hal_tcp_data *refused = conn->refused;
+    conn->refused = NULL;
+    int err = conn_deliver(conn, refused);
+    if (err != HAL_TCP_OK && err != HAL_TCP_ABORTED && !conn->freed) {
+        conn->refused = refused;
+        return false;
+    }
+    return true;
+}
+
+// Data and FIN from the peer; true if anything was taken
+static bool conn_input_data(hal_tcp_conn *conn) {
+    bool progress = false;
+    if (conn->refused) {
+        if (!conn_retry_refused(conn)) return false;
+        progress = true;
+    }
+    for (int i = 0; i < SEGMENTS_PER_STEP; i++) {
+        if (conn->freed || conn->peer_fin || conn->refused) break;
+
+        uint8_t buf[MSS];
+        uint16_t max = (uint16_t)MIN(MSS, conn->rcv_wnd);
+        int n = peer_peek(conn, buf, max ? max : 1);
+        if (n == PEER_RST) {
+            conn_fail(conn, false, HAL_TCP_ERR_RESET);
+            return true;
+        }
+        if (n == PEER_FIN) {
+            conn_input_fin(conn);
+            return true;
+        }
+        if (n == 0 || max == 0) break;
+
+        peer_consume(conn, (size_t)n);
+        if (conn->closed) {
+            // Data for an owner that closed: it can't be delivered
+            hal_tcp_abort(conn);
+            return true;
+        }
+        conn->rcv_wnd = (uint16_t)(conn->rcv_wnd - n);
+        progress = true;
+
+        hal_tcp_data *data = data_new(buf, (uint16_t)n);
+        int err = conn_deliver(conn, data);
+        if (err == HAL_TCP_ABORTED) return true;
+        if (err != HAL_TCP_OK && !conn->freed) {
+            conn->refused = data;
+        }
+    }
+    return progress;
+}
+
+// Move everything that is ready on one connection; true if anything moved
+static bool conn_service(hal_tcp_conn *conn) {
+    bool progress = conn_input_ack(conn);
+    if (conn->freed) return progress;
+    progress |= conn_input_data(conn);
+    if (conn->freed) return true;
+    progress |= conn_push(conn);
+    return progress;
+}
+
+static bool client_take_pending(uint16_t port, struct sim_tcp_client **out);
+static void stack_start(void);
+
+// Accept waiting connections on a listener
+static bool listener_input(tcp_listener *listener) {
+    bool progress = false;
+    for (int i = 0; i < ACCEPTS_PER_STEP; i++) {
+        int fd = -1;
+        struct sim_tcp_client *c = NULL;
+        if (listener->fd >= 0) {
+            fd = accept4(listener->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) break;
+            int one = 1;
+            int sndbuf = SOCKET_SNDBUF;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        } else if (!client_take_pending(listener->port, &c)) {
+            break;
+        }
+        progress = true;
+
+        if (conns_live() >= CONNS_MAX) {
+            // Out of connections: the peer is refused
+            if (fd >= 0) {
+                struct linger lg = { .l_onoff = 1, .l_linger = 0 };
+                setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+                close(fd);
+            } else {
+                c->rst_in = true;
+            }
+            continue;
+        }
+        hal_tcp_conn *conn = xcalloc(sizeof(*conn));
+        conn->rcv_wnd = RCV_WND;
+        conn->fd = fd;
+        if (c) {
+            conn->client = c;
+            c->conn = conn;
+        }
+        conn->next = s_conns;
+        s_conns = conn;
+        int err = listener->accept(conn);
+        if (err != HAL_TCP_OK && err != HAL_TCP_ABORTED && !conn->freed) {
+            hal_tcp_abort(conn);
+        }
+    }
+    return progress;
+}
+
+bool hal_tcp_listen(uint16_t port, uint8_t backlog, hal_tcp_accept_fn accept) {
+    (void)backlog;
+    hal_tcp_lock();
+    bool ok = false;
+    for (uint8_t i = 0; i < s_listener_count; i++) {
+        if (s_listeners[i].port == port) {
+            printf("ERROR: port %u is already listening\n", port);
+            goto done;
+        }
+    }
+    if (s_listener_count >= LISTENERS_MAX) {
+        printf("ERROR: no room for another listener\n");
+        goto done;
+    }
+    int fd = -1;
+    if (!s_virtual) {
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        struct sockaddr_in addr = {
+            .sin_family = AF_INET,
+            .sin_port = htons(sim_network_host_port(port)),
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+        };
+        if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+            listen(fd, LISTEN_BACKLOG) != 0) {
+            printf("ERROR: can't listen on 127.0.0.1:%u for port %u: %s\n",
+                   sim_network_host_port(port), port, strerror(errno));
+            if (fd >= 0) close(fd);
+            goto done;
+        }
+    }
+    s_listeners[s_listener_count++] = (tcp_listener){ .port = port, .accept = accept, .fd = fd };
+    ok = true;
+    stack_start();
+    stack_wake();
+done:
+    hal_tcp_unlock();
+    return ok;
+}
+
+// Every TICK_MS: offer refused data again; every other tick, poll and drop stuck closes
+static void tcp_tick(void) {
+    bool slow = ++s_ticks % (HAL_TCP_POLL_MS / TICK_MS) == 0;
+    uint64_t now_us = hal_time_us_64();
+    for (hal_tcp_conn *conn = s_conns; conn; conn = conn->next) {
+        if (conn->freed) continue;
+        if (conn->refused) {
+            conn_retry_refused(conn);
+            if (conn->freed) continue;
+        }
+        if (!slow) continue;
+        if (conn->fin_queued && now_us - conn->closed_us > CLOSE_TIMEOUT_MS * 1000ull) {
+            conn_free(conn, false);
+            continue;
+        }
+        if (conn->callbacks && conn->callbacks->poll && ++conn->poll_ticks >= conn->poll_interval) {
+            conn->poll_ticks = 0;
+            if (conn->callbacks->poll(conn->arg) == HAL_TCP_OK && !conn->freed) {
+                conn_push(conn);
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Virtual clients
+// ---------------------------------------------------------------------------
+
+static struct sim_tcp_client *client_get(int id) {
+    if (id < 0 || id >= SIM_TCP_CLIENTS_MAX || !s_clients[id].used) return NULL;
+    return &s_clients[id];
+}
+
+// A client waiting to connect to a port, taken off the wait
+static bool client_take_pending(uint16_t port, struct sim_tcp_client **out) {
+    for (int i = 0; i < SIM_TCP_CLIENTS_MAX; i++) {
+        struct sim_tcp_client *c = &s_clients[i];
+        if (c->used && !c->accepted && !c->rst_in && c->port == port) {
+            c->accepted = true;   // Taken, even if the stack then refuses it
+            *out = c;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Refuse clients waiting on ports nothing listens on
+static void clients_refuse_unheard(void) {
+    for (int i = 0; i < SIM_TCP_CLIENTS_MAX; i++) {
+        struct sim_tcp_client *c = &s_clients[i];
+        if (!c->used || c->accepted || c->rst_in) continue;
+        bool heard = false;
+        for (uint8_t l = 0; l < s_listener_count; l++) {
+            heard |= s_listeners[l].port == c->port;
+        }
+        if (!heard) {
+            c->rst_in = true;
+        }
+    }
+}
+
+int sim_tcp_connect(uint16_t port) {
+    hal_tcp_lock();
+    int id = -1;
+    for (int i = 0; i < SIM_TCP_CLIENTS_MAX && id < 0; i++) {
+        if (!s_clients[i].used) id = i;
+    }
+    if (id >= 0) {
+        struct sim_tcp_client *c = &s_clients[id];
+        memset(c, 0, sizeof(*c));
+        c->used = true;
+        c->port = port;
+        c->window = SIM_TCP_DEFAULT_WINDOW;
+        c->acking = true;
+    }
+    hal_tcp_unlock();
+    return id;
+}
+
+size_t sim_tcp_send(int id, const void *data, size_t len) {
+    hal_tcp_lock();
+    struct sim_tcp_client *c = client_get(id);
+    if (!c || c->fin_out || c->rst_out || c->rst_in) {
+        len = 0;
+    } else {
+        buffer_append(&c->tx, &c->tx_len, &c->tx_cap, data, len);
+    }
+    hal_tcp_unlock();
+    return len;
+}
+
+size_t sim_tcp_read(int id, void *buf, size_t size) {
+    hal_tcp_lock();
+    struct sim_tcp_client *c = client_get(id);
+    size_t n = 0;
+    if (c) {
+        n = MIN(size, c->rx_len - c->rx_pos);
+        if (buf && n) memcpy(buf, c->rx + c->rx_pos, n);
+        c->rx_pos += n;
+        if (c->rx_pos == c->rx_len) {
+            c->rx_pos = c->rx_len = 0;   // All read: start the buffer over
+        }
+    }
+    hal_tcp_unlock();
+    return n;
+}
+
+size_t sim_tcp_unread(int id) {
+    hal_tcp_lock();
+    struct sim_tcp_client *c = client_get(id);
+    size_t n = c ? c->rx_len - c->rx_pos : 0;
+    hal_tcp_unlock();
+    return n;
+}
+
+void sim_tcp_set_window(int id, size_t window) {
+    hal_tcp_lock();
+    struct sim_tcp_client *c = client_get(id);
+    if (c) c->window = window;
+    hal_tcp_unlock();
+}
+
+void sim_tcp_set_acking(int id, bool acking) {
+    hal_tcp_lock();
+    struct sim_tcp_client *c = client_get(id);
+    if (c) c->acking = acking;
+    hal_tcp_unlock();
+}
+
+void sim_tcp_close(int id) {
+    hal_tcp_lock();
+    struct sim_tcp_client *c = client_get(id);
+    if (c) c->fin_out = true;
+    hal_tcp_unlock();
+}
+
+void sim_tcp_reset(int id) {
+    hal_tcp_lock();
+    struct sim_tcp_client *c = client_get(id);
+    if (c) c->rst_out = true;
+    hal_tcp_unlock();
+}
+
+sim_tcp_state sim_tcp_get_state(int id) {
+    hal_tcp_lock();
+    struct sim_tcp_client *c = client_get(id);
+    sim_tcp_state state;
+    if (!c || c->rst_in || c->rst_out) {
+        state = SIM_TCP_RESET;
+    } else if (!c->accepted) {
+        state = SIM_TCP_CONNECTING;
+    } else if (c->fin_in) {
+        state = c->fin_out ? SIM_TCP_CLOSED : SIM_TCP_PEER_CLOSED;
+    } else {
+        state = SIM_TCP_OPEN;
+    }
+    hal_tcp_unlock();
+    return state;
+}
+
+void sim_tcp_release(int id) {
+    hal_tcp_lock();
+    struct sim_tcp_client *c = client_get(id);
+    if (c) {
+        if (c->conn) {
+            // The connection sees the reset on the next run
+            c->rst_out = true;
+            hal_tcp_unlock();
+            sim_network_run(0);
+            hal_tcp_lock();
+        }
+        if (c->conn) {
+            c->conn->client = NULL;
+        }
+        free(c->rx);
+        free(c->tx);
+        memset(c, 0, sizeof(*c));
+    }
+    hal_tcp_unlock();
+}
+
+// ---------------------------------------------------------------------------
+// Running the stack
+// ---------------------------------------------------------------------------
+
+// One pass over everything that can move; true if anything did
+static bool stack_step(void) {
+    bool progress = false;
+    if (s_virtual) {
+        clients_refuse_unheard();
+    }
+    for (uint8_t i = 0; i < s_listener_count; i++) {
+        progress |= listener_input(&s_listeners[i]);
+    }
+    for (hal_tcp_conn *conn = s_conns; conn; conn = conn->next) {
+        if (!conn->freed) {
+            progress |= conn_service(conn);
+        }
+    }
+    conns_reap();
+    return progress;
+}
+
+static void stack_run_ready(void) {
+    for (int i = 0; i < STEPS_PER_WAKE && stack_step(); i++) {
+    }
+}
+
+// Run the TCP timer if a tick is due. Ticks missed while the clock jumped
+// or the thread was held up are not made up for, as a burst of them would
+// time connections out that were never idle that long in ticks.
+static void stack_run_ticks(void) {
+    uint64_t now_us = hal_time_us_64();
+    if (s_next_tick_us <= now_us) {
+        tcp_tick();
+        s_next_tick_us += TICK_MS * 1000ull;
+        if (s_next_tick_us <= now_us) {
+            s_next_tick_us = now_us + TICK_MS * 1000ull;
+        }
+    }
+}
+
+// Wait in poll() for the sockets and the next tick, then run what is ready
+static void *stack_thread(void *arg) {
+    (void)arg;
+    struct pollfd fds[1 + LISTENERS_MAX + CONNS_MAX + FREED_CONNS_KEPT];
+    const size_t fds_max = sizeof(fds) / sizeof(fds[0]);
+    for (;;) {
+        hal_tcp_lock();
+        size_t n = 0;
+        fds[n++] = (struct pollfd){ .fd = s_wake_fd, .events = POLLIN };
+        for (uint8_t i = 0; i < s_listener_count; i++) {
+            fds[n++] = (struct pollfd){ .fd = s_listeners[i].fd, .events = POLLIN };
+        }
+        bool awaiting_ack = false;
+        for (hal_tcp_conn *conn = s_conns; conn && n < fds_max; conn = conn->next) {
+            if (conn->freed || conn->fd < 0) continue;
+            short events = 0;
+            if (!conn->peer_fin && !conn->refused && conn->rcv_wnd > 0) {
+                events |= POLLIN;
+            }
+            if (conn->sent != conn->written) {
+                events |= POLLOUT;
+            }
+            awaiting_ack |= conn->sent != conn->acked || (conn->fin_sent && !conn->fin_acked);
+            fds[n++] = (struct pollfd){ .fd = conn->fd, .events = events };
+        }
+        uint64_t now_us = hal_time_us_64();
+        int timeout_ms = s_next_tick_us <= now_us ? 0 : (int)((s_next_tick_us - now_us + 999) / 1000);
+        if (awaiting_ack && timeout_ms > ACK_POLL_MS) {
+            timeout_ms = ACK_POLL_MS;
+        }
+        hal_tcp_unlock();
+
+        poll(fds, n, timeout_ms);
+        if (fds[0].revents & POLLIN) {
+            uint64_t count;
+            ssize_t got = read(s_wake_fd, &count, sizeof(count));
+            (void)got;
+        }
+
+        hal_tcp_lock();
+        stack_run_ready();
+        stack_run_ticks();
+        stack_run_ready();
+        hal_tcp_unlock();
+    }
+    return NULL;
+}
+
+// Start the timers and, with sockets, the thread; later calls do nothing
+static void stack_start(void) {
+    hal_tcp_lock();
+    if (!s_started) {
+        s_started = true;
+        s_next_tick_us = hal_time_us_64() + TICK_MS * 1000ull;
+        if (!s_virtual) {
+            s_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            pthread_t thread;
+            if (pthread_create(&thread, NULL, stack_thread, NULL) == 0) {
+                pthread_detach(thread);
+            } else {
+                printf("ERROR: can't start the network thread\n");
+            }
+        }
+    }
+    hal_tcp_unlock();
+}
+
+void sim_network_run(uint32_t ms) {
+    hal_tcp_lock();
+    uint64_t end_us = hal_time_us_64() + (uint64_t)ms * 1000u;
+    for (;;) {
+        stack_run_ready();
+        if (!s_started || s_next_tick_us > end_us) break;
+        uint64_t now_us = hal_time_us_64();
+        if (s_next_tick_us > now_us) {
+            hal_advance_us(s_next_tick_us - now_us);
+        }
+        stack_run_ticks();
+    }
+    uint64_t now_us = hal_time_us_64();
+    if (end_us > now_us) {
+        hal_advance_us(end_us - now_us);
+    }
+    stack_run_ready();
+    hal_tcp_unlock();
+}
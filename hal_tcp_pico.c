@@ -0,0 +1,282 @@
+/*
+File: hal_tcp_pico.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Pico backend of the hardware abstraction layer's TCP functions (see
+    hal.h), on lwIP's raw API over the CYW43 radio. Built only with WiFi.
+
+    A hal_tcp_conn is a struct tcp_pcb and a hal_tcp_data a pbuf chain, so
+    most calls go straight through. lwIP has one argument per PCB, so an
+    attached connection's argument and callbacks are kept in a binding,
+    one per PCB lwIP can have, and small trampolines pass lwIP's callbacks
+    on to the owner's.
+
+Responsibilities:
+- Listen on a port and hand new connections to the owner at low priority
+- Pass a connection's receive, sent, poll and error events to its owner
+- Write, output, close and abort through lwIP's raw API
+- Report how full lwIP's heap and segment pool are
+- Hold the lwIP lock of the CYW43 driver
+
+Requires the following modules:
+- hal.h: for interface definitions
+*/
+
+#include "pico/cyw43_arch.h"
+#include "lwip/memp.h"
+#include "lwip/pbuf.h"
+#include "lwip/stats.h"
+#include "lwip/tcp.h"
+
+#include <stdio.h>
+
+#include "hal.h"
+
+#define TCP_LISTENERS_MAX 2   // Ports listened on at once
+
+// hal.h passes lwIP's values through unchanged
+_Static_assert(HAL_TCP_OK == ERR_OK && HAL_TCP_ERR_MEM == ERR_MEM &&
+               HAL_TCP_ERR_CONN == ERR_CONN && HAL_TCP_ABORTED == ERR_ABRT &&
+               HAL_TCP_ERR_RESET == ERR_RST, "HAL_TCP_* results must match lwIP's err_t");
+_Static_assert(HAL_TCP_WRITE_COPY == TCP_WRITE_FLAG_COPY &&
+               HAL_TCP_WRITE_MORE == TCP_WRITE_FLAG_MORE,
+               "HAL_TCP_WRITE_* flags must match lwIP's");
+
+// The owner of an attached connection
+typedef struct {
+    struct tcp_pcb *pcb;                  // NULL when the binding is free
+    void *arg;
+    const hal_tcp_callbacks *callbacks;
+} tcp_binding;
+
+// A listening port
+typedef struct {
+    struct tcp_pcb *pcb;
+    hal_tcp_accept_fn accept;
+} tcp_listener;
+
+static tcp_binding s_bindings[MEMP_NUM_TCP_PCB];
+static tcp_listener s_listeners[TCP_LISTENERS_MAX];
+
+static struct tcp_pcb *tcp_pcb_of(const hal_tcp_conn *conn) {
+    return (struct tcp_pcb *)conn;
+}
+
+static struct pbuf *tcp_pbuf_of(const hal_tcp_data *data) {
+    return (struct pbuf *)data;
+}
+
+// ---- Trampolines ----
+
+static err_t tcp_recv_cb(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+    (void)pcb;
+    tcp_binding *binding = (tcp_binding *)arg;
+    if (err != ERR_OK && p) {
+        // lwIP doesn't do this, but the owner would take it as data
+        pbuf_free(p);
+        p = NULL;
+    }
+    return (err_t)binding->callbacks->recv(binding->arg, (hal_tcp_data *)p);
+}
+
+static err_t tcp_sent_cb(void *arg, struct tcp_pcb *pcb, u16_t len) {
+    (void)pcb;
+    tcp_binding *binding = (tcp_binding *)arg;
+    return (err_t)binding->callbacks->sent(binding->arg, len);
+}
+
+static err_t tcp_poll_cb(void *arg, struct tcp_pcb *pcb) {
+    (void)pcb;
+    tcp_binding *binding = (tcp_binding *)arg;
+    return (err_t)binding->callbacks->poll(binding->arg);
+}
+
+// lwIP has already freed the PCB, so the binding goes before the owner hears of it
+static void tcp_err_cb(void *arg, err_t err) {
+    tcp_binding *binding = (tcp_binding *)arg;
+    void *owner = binding->arg;
+    const hal_tcp_callbacks *callbacks = binding->callbacks;
+    binding->pcb = NULL;
+    callbacks->error(owner, err);
+}
+
+static err_t tcp_accept_cb(void *arg, struct tcp_pcb *new_pcb, err_t err) {
+    tcp_listener *listener = (tcp_listener *)arg;
+    if (err != ERR_OK || new_pcb == NULL) {
+        return ERR_VAL;
+    }
+
+    // New clients may take the PCBs of accepted ones when lwIP runs out
+    tcp_setprio(new_pcb, TCP_PRIO_MIN);
+    int result = listener->accept((hal_tcp_conn *)new_pcb);
+    if (result == HAL_TCP_OK || result == HAL_TCP_ABORTED) {
+        return (err_t)result;
+    }
+    tcp_abort(new_pcb);
+    return ERR_ABRT;
+}
+
+// ---- Connections ----
+
+bool hal_tcp_listen(uint16_t port, uint8_t backlog, hal_tcp_accept_fn accept) {
+    tcp_listener *listener = NULL;
+    for (int i = 0; i < TCP_LISTENERS_MAX && !listener; i++) {
+        if (!s_listeners[i].pcb) {
+            listener = &s_listeners[i];
+        }
+    }
+    if (!listener) {
+        printf("ERROR: no room for a listener on port %u\n", port);
+        return false;
+    }
+
+    // Create new TCP listener
+    struct tcp_pcb *pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+    if (!pcb) {
+        printf("ERROR: tcp_new_ip_type() failed\n");
+        return false;
+    }
+
+    // Bind listener to the given port
+    err_t err = tcp_bind(pcb, IP_ANY_TYPE, port);
+    if (err != ERR_OK) {
+        printf("ERROR: tcp_bind() failed: %d\n", err);
+        tcp_close(pcb);
+        return false;
+    }
+
+    // Convert listener to be ready to accept clients
+    struct tcp_pcb *listen_pcb = tcp_listen_with_backlog(pcb, backlog);
+    if (!listen_pcb) {
+        printf("ERROR: tcp_listen_with_backlog() failed\n");
+        tcp_close(pcb);
+        return false;
+    }
+
+    listener->pcb = listen_pcb;
+    listener->accept = accept;
+    tcp_arg(listen_pcb, listener);
+    tcp_accept(listen_pcb, tcp_accept_cb);
+    return true;
+}
+
+void hal_tcp_attach(hal_tcp_conn *conn, void *arg, const hal_tcp_callbacks *callbacks,
+                    uint8_t poll_interval) {
+    struct tcp_pcb *pcb = tcp_pcb_of(conn);
+    tcp_binding *binding = NULL;
+    for (int i = 0; i < MEMP_NUM_TCP_PCB; i++) {
+        if (s_bindings[i].pcb == pcb) {
+            binding = &s_bindings[i];
+            break;
+        }
+        if (!binding && !s_bindings[i].pcb) {
+            binding = &s_bindings[i];
+        }
+    }
+    if (!binding) {
+        // Every PCB lwIP can have is bound already, so this one can't exist
+        printf("ERROR: no binding free for a TCP connection\n");
+        return;
+    }
+
+    binding->pcb = pcb;
+    binding->arg = arg;
+    binding->callbacks = callbacks;
+    tcp_arg(pcb, binding);
+    tcp_recv(pcb, tcp_recv_cb);
+    tcp_err(pcb, tcp_err_cb);
+    tcp_sent(pcb, tcp_sent_cb);
+    tcp_poll(pcb, tcp_poll_cb, poll_interval);
+}
+
+void hal_tcp_detach(hal_tcp_conn *conn) {
+    struct tcp_pcb *pcb = tcp_pcb_of(conn);
+    for (int i = 0; i < MEMP_NUM_TCP_PCB; i++) {
+        if (s_bindings[i].pcb == pcb) {
+            s_bindings[i].pcb = NULL;
+        }
+    }
+
+    // With no receive callback lwIP acknowledges and drops data itself
+    tcp_arg(pcb, NULL);
+    tcp_recv(pcb, NULL);
+    tcp_sent(pcb, NULL);
+    tcp_err(pcb, NULL);
+    tcp_poll(pcb, NULL, 0);
+}
+
+int hal_tcp_write(hal_tcp_conn *conn, const void *data, uint16_t len, uint8_t flags) {
+    return tcp_write(tcp_pcb_of(conn), data, len, flags);
+}
+
+int hal_tcp_output(hal_tcp_conn *conn) {
+    return tcp_output(tcp_pcb_of(conn));
+}
+
+uint16_t hal_tcp_send_space(const hal_tcp_conn *conn) {
+    return (uint16_t)tcp_sndbuf(tcp_pcb_of(conn));
+}
+
+uint16_t hal_tcp_send_slots(const hal_tcp_conn *conn) {
+    uint16_t queued = (uint16_t)tcp_sndqueuelen(tcp_pcb_of(conn));
+    return (queued < TCP_SND_QUEUELEN) ? (uint16_t)(TCP_SND_QUEUELEN - queued) : 0;
+}
+
+void hal_tcp_recved(hal_tcp_conn *conn, uint16_t len) {
+    tcp_recved(tcp_pcb_of(conn), len);
+}
+
+void hal_tcp_nodelay(hal_tcp_conn *conn) {
+    tcp_nagle_disable(tcp_pcb_of(conn));
+}
+
+int hal_tcp_close(hal_tcp_conn *conn) {
+    return tcp_close(tcp_pcb_of(conn));
+}
+
+void hal_tcp_abort(hal_tcp_conn *conn) {
+    tcp_abort(tcp_pcb_of(conn));
+}
+
+bool hal_tcp_pools_low(uint8_t percent) {
+    const struct stats_mem *seg = lwip_stats.memp[MEMP_TCP_SEG];
+    if (lwip_stats.mem.avail &&
+        lwip_stats.mem.used * 100u >= lwip_stats.mem.avail * (uint32_t)percent) {
+        return true;
+    }
+    return seg && seg->avail && seg->used * 100u >= seg->avail * (uint32_t)percent;
+}
+
+void hal_tcp_lock(void) {
+    cyw43_arch_lwip_begin();
+}
+
+void hal_tcp_unlock(void) {
+    cyw43_arch_lwip_end();
+}
+
+// ---- Received data ----
+
+uint16_t hal_tcp_data_total(const hal_tcp_data *data) {
+    return tcp_pbuf_of(data)->tot_len;
+}
+
+const uint8_t *hal_tcp_data_bytes(const hal_tcp_data *data, uint16_t *len) {
+    const struct pbuf *p = tcp_pbuf_of(data);
+    *len = p->len;
+    return (const uint8_t *)p->payload;
+}
+
+hal_tcp_data *hal_tcp_data_next(const hal_tcp_data *data) {
+    return (hal_tcp_data *)tcp_pbuf_of(data)->next;
+}
+
+void hal_tcp_data_append(hal_tcp_data *head, hal_tcp_data *tail) {
+    pbuf_cat(tcp_pbuf_of(head), tcp_pbuf_of(tail));
+}
+
+void hal_tcp_data_free(hal_tcp_data *data) {
+    pbuf_free(tcp_pbuf_of(data));
+}
@@ -0,0 +1,232 @@
+/*
+File: history.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Provides the in-RAM sample history. Each tier is a ring of fixed-size
+    records addressed by a sequence number that only ever grows, so an
+    export can tell which records were overwritten since it started. The
+    sampling loop is the only writer; exports read the rings from the
+    network stack's context and re-check the sequence number after each
+    copy instead of taking a lock.
+
+Responsibilities:
+- Store raw samples and fold them into 1-minute and 1-hour averages
+- Look up records by sequence number and by time
+- Serialize exports as CSV or packed binary records, a piece at a time
+
+Requires the following modules:
+- history.h: for interface definitions
+- le_pack.h: for little-endian records and tenths
+*/
+
+#include "history.h"
+#include "le_pack.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Longest CSV row: "4294967295,-3276.8,-3276.8\n"
+#define CSV_ROW_MAX 28
+
+static const char CSV_HEADER[] = "time_ms,humidity,temp_c\n";
+
+// One ring of records plus the running average for its next record
+typedef struct {
+    history_record *records;
+    uint32_t capacity;
+    uint32_t period_ms;         // Averaging period, 0 for raw samples
+    volatile uint32_t head;     // Sequence number of the next record written
+    uint32_t bucket;            // Period the running average belongs to
+    uint32_t sum_count;         // Samples in the running average
+    float sum_humidity;
+    float sum_temp;
+} history_tier;
+
+static history_record s_raw[HISTORY_RAW_LEN];
+static history_record s_minute[HISTORY_MINUTE_LEN];
+static history_record s_hour[HISTORY_HOUR_LEN];
+
+static history_tier s_tiers[HISTORY_TIER_COUNT] = {
+    { s_raw,    HISTORY_RAW_LEN,    0,         0, 0, 0, 0, 0 },
+    { s_minute, HISTORY_MINUTE_LEN, 60000,     0, 0, 0, 0, 0 },
+    { s_hour,   HISTORY_HOUR_LEN,   3600000,   0, 0, 0, 0, 0 },
+};
+
+static const char *const TIER_NAMES[HISTORY_TIER_COUNT] = { "raw", "1m", "1h" };
+
+// Order record writes before the head update that publishes them, and the
+// head reads around a copy, so a concurrent export sees consistent records
+#define HISTORY_BARRIER() __sync_synchronize()
+
+static void tier_push(history_tier *tier, uint32_t time_ms, float humidity, float temp) {
+    history_record *rec = &tier->records[tier->head % tier->capacity];
+    rec->time_ms = time_ms;
+    rec->humidity_x10 = to_x10(humidity);
+    rec->temp_x10 = to_x10(temp);
+    HISTORY_BARRIER();
+    tier->head++;
+}
+
+void history_init(void) {
+    for (int i = 0; i < HISTORY_TIER_COUNT; i++) {
+        history_tier *tier = &s_tiers[i];
+        tier->head = 0;
+        tier->sum_count = 0;
+        tier->sum_humidity = 0.0f;
+        tier->sum_temp = 0.0f;
+    }
+}
+
+void history_add(uint32_t time_ms, float humidity, float temp_celsius) {
+    tier_push(&s_tiers[HISTORY_TIER_RAW], time_ms, humidity, temp_celsius);
+
+    for (int i = HISTORY_TIER_RAW + 1; i < HISTORY_TIER_COUNT; i++) {
+        history_tier *tier = &s_tiers[i];
+        uint32_t bucket = time_ms / tier->period_ms;
+
+        // A sample in a new period completes the previous period's average
+        if (tier->sum_count > 0 && bucket != tier->bucket) {
+            tier_push(tier, tier->bucket * tier->period_ms,
+                      tier->sum_humidity / (float)tier->sum_count,
+                      tier->sum_temp / (float)tier->sum_count);
+            tier->sum_count = 0;
+            tier->sum_humidity = 0.0f;
+            tier->sum_temp = 0.0f;
+        }
+        tier->bucket = bucket;
+        tier->sum_count++;
+        tier->sum_humidity += humidity;
+        tier->sum_temp += temp_celsius;
+    }
+}
+
+uint32_t history_count(uint8_t tier) {
+    uint32_t head = s_tiers[tier].head;
+    return (head < s_tiers[tier].capacity) ? head : s_tiers[tier].capacity;
+}
+
+int history_tier_from_name(const char *name) {
+    for (int i = 0; i < HISTORY_TIER_COUNT; i++) {
+        if (strcmp(name, TIER_NAMES[i]) == 0) {
+            return i;
+        }
+    }
+    if (name[0] >= '0' && name[0] < '0' + HISTORY_TIER_COUNT && name[1] == '\0') {
+        return name[0] - '0';
+    }
+    return -1;
+}
+
+// Oldest sequence number still stored, given the current head
+static uint32_t tier_oldest(const history_tier *tier, uint32_t head) {
+    return (head > tier->capacity) ? head - tier->capacity : 0;
+}
+
+// Copy one record. False if it isn't stored (any more). The slot of the oldest
+// record is the one the writer fills next, so that record counts as gone too.
+static bool tier_read(const history_tier *tier, uint32_t seq, history_record *out) {
+    uint32_t head = tier->head;
+    if (seq >= head || seq < tier_oldest(tier, head)) {
+        return false;
+    }
+    HISTORY_BARRIER();
+    *out = tier->records[seq % tier->capacity];
+    HISTORY_BARRIER();
+    head = tier->head;
+    return head - seq < tier->capacity;
+}
+
+// First stored sequence number at or after the given time, by binary search
+static uint32_t tier_lower_bound(const history_tier *tier, uint32_t end, uint32_t time_ms) {
+    uint32_t lo = tier_oldest(tier, tier->head);
+    uint32_t hi = end;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        history_record rec;
+        if (!tier_read(tier, mid, &rec)) {
+            lo = mid + 1;  // Overwritten meanwhile; newer records are later
+        } else if (rec.time_ms < time_ms) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void history_query_init(history_query *query, uint8_t tier, uint8_t format,
+                        uint32_t from_ms, uint32_t to_ms) {
+    query->tier = (tier < HISTORY_TIER_COUNT) ? tier : HISTORY_TIER_RAW;
+    query->format = format;
+    query->from_ms = from_ms;
+    query->to_ms = to_ms;
+    query->end_seq = s_tiers[query->tier].head;
+}
+
+// Format a tenths value such as -12.3 without floating point
+static int format_x10(char *out, size_t size, int16_t v) {
+    int value = v;
+    const char *sign = "";
+    if (value < 0) {
+        sign = "-";
+        value = -value;
+    }
+    return snprintf(out, size, "%s%d.%d", sign, value / 10, value % 10);
+}
+
+size_t history_export(const history_query *query, uint32_t *pos, char *buf, size_t size) {
+    const history_tier *tier = &s_tiers[query->tier];
+    size_t len = 0;
+
+    // pos 0 means the header is still to be written; after that it holds
+    // the sequence number of the next record plus one
+    if (*pos == 0) {
+        if (query->format == HISTORY_FORMAT_BINARY) {
+            if (size < HISTORY_BINARY_HEADER) return 0;
+            memcpy(buf, "HIST", 4);
+            buf[4] = HISTORY_BINARY_VERSION;
+            buf[5] = (char)query->tier;
+            put_le16(buf + 6, HISTORY_RECORD_SIZE);
+            len = HISTORY_BINARY_HEADER;
+        } else {
+            if (size < sizeof(CSV_HEADER) - 1) return 0;
+            memcpy(buf, CSV_HEADER, sizeof(CSV_HEADER) - 1);
+            len = sizeof(CSV_HEADER) - 1;
+        }
+        *pos = tier_lower_bound(tier, query->end_seq, query->from_ms) + 1;
+    }
+
+    size_t row_max = (query->format == HISTORY_FORMAT_BINARY) ? HISTORY_RECORD_SIZE : CSV_ROW_MAX;
+    while (len + row_max <= size && *pos - 1 < query->end_seq) {
+        uint32_t seq = *pos - 1;
+        history_record rec;
+        if (!tier_read(tier, seq, &rec)) {
+            // Overwritten since the export started: jump to the oldest record left
+            uint32_t oldest = tier_oldest(tier, tier->head) + 1;
+            *pos = ((oldest > seq) ? oldest : seq + 1) + 1;
+            continue;
+        }
+        if (rec.time_ms > query->to_ms) {
+            *pos = query->end_seq + 1;  // Records are in time order, so nothing later matches
+            break;
+        }
+
+        if (query->format == HISTORY_FORMAT_BINARY) {
+            put_le32(buf + len, rec.time_ms);
+            put_le16(buf + len + 4, (uint16_t)rec.humidity_x10);
+            put_le16(buf + len + 6, (uint16_t)rec.temp_x10);
+            len += HISTORY_RECORD_SIZE;
+        } else {
+            len += (size_t)snprintf(buf + len, size - len, "%lu,", (unsigned long)rec.time_ms);
+            len += (size_t)format_x10(buf + len, size - len, rec.humidity_x10);
+            buf[len++] = ',';
+            len += (size_t)format_x10(buf + len, size - len, rec.temp_x10);
+            buf[len++] = '\n';
+        }
+        (*pos)++;
+    }
+
+    return len;
+}
@@ -0,0 +1,130 @@
+/*
+File: history.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the in-RAM sample history. Every good
+    sensor reading is kept in a ring of recent raw samples, and is also
+    folded into 1-minute and 1-hour averages kept in their own, longer
+    rings. The history can be exported, a piece at a time, as CSV or as
+    packed little-endian binary records (see tools/history_decode.py).
+
+    This module has no hardware dependencies so it can be unit tested on
+    the host (see test_history.c).
+*/
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Storage tiers
+#define HISTORY_TIER_RAW     0   // Every sample
+#define HISTORY_TIER_MINUTE  1   // 1-minute averages
+#define HISTORY_TIER_HOUR    2   // 1-hour averages
+#define HISTORY_TIER_COUNT   3
+
+// Records kept per tier (8 bytes each)
+#ifndef HISTORY_RAW_LEN
+#define HISTORY_RAW_LEN      512  // About 17 minutes at the default 2 s interval
+#endif
+#ifndef HISTORY_MINUTE_LEN
+#define HISTORY_MINUTE_LEN   720  // 12 hours
+#endif
+#ifndef HISTORY_HOUR_LEN
+#define HISTORY_HOUR_LEN     336  // 14 days
+#endif
+
+// Export formats
+#define HISTORY_FORMAT_CSV     0
+#define HISTORY_FORMAT_BINARY  1
+
+// Binary export layout (little-endian):
+//   header  "HIST", u8 version, u8 tier, u16 record size
+//   records u32 time_ms, i16 humidity x10, i16 temp_c x10
+#define HISTORY_BINARY_VERSION  1
+#define HISTORY_BINARY_HEADER   8
+#define HISTORY_RECORD_SIZE     8
+
+/**
+ * @brief One stored sample or average
+ */
+typedef struct {
+    uint32_t time_ms;      // Sample time, or start of the averaging period (ms since boot)
+    int16_t humidity_x10;  // Relative humidity in tenths of a percent
+    int16_t temp_x10;      // Temperature in tenths of a degree Celsius
+} history_record;
+
+/**
+ * @brief Parameters of one export, fixed when the export starts
+ */
+typedef struct {
+    uint8_t tier;          // HISTORY_TIER_*
+    uint8_t format;        // HISTORY_FORMAT_*
+    uint32_t from_ms;      // Oldest record time included
+    uint32_t to_ms;        // Newest record time included
+    uint32_t end_seq;      // Records added after the export started are left out
+} history_query;
+
+/**
+ * @brief Clear all stored history
+ */
+void history_init(void);
+
+/**
+ * @brief Record one good sample in every tier
+ *
+ * Must only be called from one context (the sampling loop); exports may
+ * run concurrently from the network stack.
+ *
+ * @param time_ms       Sample time in ms since boot
+ * @param humidity      Relative humidity in percent
+ * @param temp_celsius  Temperature in degrees Celsius
+ */
+void history_add(uint32_t time_ms, float humidity, float temp_celsius);
+
+/**
+ * @brief Number of records currently stored in a tier
+ *
+ * @param tier  HISTORY_TIER_*
+ * @return Stored record count
+ */
+uint32_t history_count(uint8_t tier);
+
+/**
+ * @brief Look up a tier by number ("0".."2") or name ("raw", "1m", "1h")
+ *
+ * @param name  Tier parameter from a request
+ * @return HISTORY_TIER_*, or -1 if not recognized
+ */
+int history_tier_from_name(const char *name);
+
+/**
+ * @brief Prepare an export of the records stored so far
+ *
+ * @param query    Receives the export parameters
+ * @param tier     HISTORY_TIER_*
+ * @param format   HISTORY_FORMAT_*
+ * @param from_ms  Oldest record time to include
+ * @param to_ms    Newest record time to include
+ */
+void history_query_init(history_query *query, uint8_t tier, uint8_t format,
+                        uint32_t from_ms, uint32_t to_ms);
+
+/**
+ * @brief Serialize the next part of an export
+ *
+ * Writes the format header and then as many whole records as fit. Records
+ * overwritten while an export is in progress are skipped.
+ *
+ * @param query  Export parameters from history_query_init()
+ * @param pos    Export position; start at 0, advanced past what was written
+ * @param buf    Output buffer
+ * @param size   Size of buf; at least 32 bytes so a CSV row fits
+ * @return Number of bytes written; 0 once the export is complete
+ */
+size_t history_export(const history_query *query, uint32_t *pos, char *buf, size_t size);
+
+#endif // HISTORY_H
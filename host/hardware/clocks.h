@@ -0,0 +1,44 @@
+/*
+File: host/hardware/clocks.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Stand-in for the pico-sdk's hardware/clocks.h in the host
+    build. The clocks only record the frequencies they are set to, so
+    power.c runs unchanged. Implemented by sdk_linux.c.
+*/
+
+#ifndef HOST_HARDWARE_CLOCKS_H
+#define HOST_HARDWARE_CLOCKS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum clock_num {
+    clk_gpout0 = 0,
+    clk_gpout1,
+    clk_gpout2,
+    clk_gpout3,
+    clk_ref,
+    clk_sys,
+    clk_peri,
+    clk_hstx,
+    clk_usb,
+    clk_adc,
+    CLK_COUNT
+} clock_num_t;
+
+typedef clock_num_t clock_handle_t;
+
+#define CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLK_REF               0x0
+#define CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX    0x1
+#define CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB    0x2
+
+#define USB_CLK_HZ 48000000
+
+uint32_t clock_get_hz(clock_handle_t clock);
+bool clock_configure(clock_handle_t clock, uint32_t src, uint32_t auxsrc, uint32_t src_freq,
+                     uint32_t freq);
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+
+#endif // HOST_HARDWARE_CLOCKS_H
@@ -0,0 +1,32 @@
+/*
+File: host/hardware/pll.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Stand-in for the pico-sdk's hardware/pll.h in the host
+    build. Implemented by sdk_linux.c.
+*/
+
+#ifndef HOST_HARDWARE_PLL_H
+#define HOST_HARDWARE_PLL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct host_pll {
+    bool running;
+} pll_hw_t;
+
+typedef pll_hw_t *PLL;
+
+extern pll_hw_t host_pll_sys;
+extern pll_hw_t host_pll_usb;
+
+#define pll_sys (&host_pll_sys)
+#define pll_usb (&host_pll_usb)
+
+void pll_init(PLL pll, unsigned int ref_div, unsigned int vco_freq, unsigned int post_div1,
+              unsigned int post_div2);
+void pll_deinit(PLL pll);
+
+#endif // HOST_HARDWARE_PLL_H
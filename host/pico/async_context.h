@@ -0,0 +1,59 @@
+/*
+File: host/pico/async_context.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Stand-in for the pico-sdk's pico/async_context.h in the host
+    build. Only the poll flavour is provided (async_context_poll.h): each
+    context belongs to the thread standing in for its core, which runs
+    the workers from async_context_poll() and sleeps in
+    async_context_wait_for_work_until(). async_context_set_work_pending()
+    may be called from any thread, as on the Pico. Implemented by
+    sdk_linux.c.
+*/
+
+#ifndef HOST_PICO_ASYNC_CONTEXT_H
+#define HOST_PICO_ASYNC_CONTEXT_H
+
+#include <pthread.h>
+#include "pico/stdlib.h"
+
+typedef struct async_context async_context_t;
+
+typedef struct async_work_on_timeout {
+    struct async_work_on_timeout *next;
+    void (*do_work)(async_context_t *context, struct async_work_on_timeout *timeout);
+    absolute_time_t next_time;
+    void *user_data;
+} async_at_time_worker_t;
+
+typedef struct async_when_pending_worker {
+    struct async_when_pending_worker *next;
+    void (*do_work)(async_context_t *context, struct async_when_pending_worker *worker);
+    volatile bool work_pending;
+    void *user_data;
+} async_when_pending_worker_t;
+
+struct async_context {
+    pthread_mutex_t lock;          // Guards the lists and the pending flags
+    pthread_cond_t wake;           // Signalled when work becomes pending
+    async_at_time_worker_t *at_time_list;
+    async_when_pending_worker_t *when_pending_list;
+    bool woken;                    // Work was set pending since the last wait
+};
+
+bool async_context_add_at_time_worker_at(async_context_t *context, async_at_time_worker_t *worker,
+                                         absolute_time_t at);
+bool async_context_add_at_time_worker_in_ms(async_context_t *context,
+                                            async_at_time_worker_t *worker, uint32_t ms);
+bool async_context_remove_at_time_worker(async_context_t *context, async_at_time_worker_t *worker);
+bool async_context_add_when_pending_worker(async_context_t *context,
+                                           async_when_pending_worker_t *worker);
+bool async_context_remove_when_pending_worker(async_context_t *context,
+                                              async_when_pending_worker_t *worker);
+void async_context_set_work_pending(async_context_t *context, async_when_pending_worker_t *worker);
+void async_context_poll(async_context_t *context);
+void async_context_wait_for_work_until(async_context_t *context, absolute_time_t until);
+void async_context_wait_for_work_ms(async_context_t *context, uint32_t ms);
+
+#endif // HOST_PICO_ASYNC_CONTEXT_H
@@ -0,0 +1,21 @@
+/*
+File: host/pico/async_context_poll.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Stand-in for the pico-sdk's pico/async_context_poll.h in the
+    host build (see host/pico/async_context.h).
+*/
+
+#ifndef HOST_PICO_ASYNC_CONTEXT_POLL_H
+#define HOST_PICO_ASYNC_CONTEXT_POLL_H
+
+#include "pico/async_context.h"
+
+typedef struct async_context_poll {
+    async_context_t core;
+} async_context_poll_t;
+
+bool async_context_poll_init_with_defaults(async_context_poll_t *self);
+
+#endif // HOST_PICO_ASYNC_CONTEXT_POLL_H
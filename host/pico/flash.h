@@ -0,0 +1,19 @@
+/*
+File: host/pico/flash.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Stand-in for the pico-sdk's pico/flash.h in the host build.
+    Only the call main.c makes is here: the WiFi cache that writes flash
+    is in network_wifi.c, which the host build doesn't have. Implemented
+    by sdk_linux.c.
+*/
+
+#ifndef HOST_PICO_FLASH_H
+#define HOST_PICO_FLASH_H
+
+#include <stdbool.h>
+
+bool flash_safe_execute_core_init(void);
+
+#endif // HOST_PICO_FLASH_H
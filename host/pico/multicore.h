@@ -0,0 +1,15 @@
+/*
+File: host/pico/multicore.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Stand-in for the pico-sdk's pico/multicore.h in the host
+    build. Core 1 is a thread. Implemented by sdk_linux.c.
+*/
+
+#ifndef HOST_PICO_MULTICORE_H
+#define HOST_PICO_MULTICORE_H
+
+void multicore_launch_core1(void (*entry)(void));
+
+#endif // HOST_PICO_MULTICORE_H
@@ -0,0 +1,271 @@
+/*
+File: host_main.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Entry point for the Linux host build of the Humidity Sensor
+    project. It boots the firmware itself: main.c's main() (built as
+    firmware_main()) runs on this process with core 1 as a thread, the
+    sensor, LCD and LEDs are the simulated board (sim_devices.c), and
+    network.c serves its web server and WebSocket on loopback through
+    hal_tcp_linux.c (sim_network.h). Nothing here takes part
+    in the pipeline; it only sets the stage, drifts the simulated
+    climate, prints the LCD and checks or drives the running firmware.
+
+    Usage: humidity_host [--port-offset N] [--interval MS] [--duration S]
+                         [--blocking-i2c] [--check] [--run "COMMAND"]
+    The firmware's port 80 is reachable on 127.0.0.1 at 80 + the offset
+    (8080 by default). --check fetches /api/v1/readings, /metrics and the
+    web page once the first sample is in and exits with their result.
+    --run runs a command against the firmware instead, with HOST_HTTP_PORT
+    set in its environment, and exits with its status. Either way ctest
+    can run the application. --blocking-i2c keeps the I2C transfers
+    blocking, to exercise that path.
+
+Responsibilities:
+- Boot the firmware on the simulated board and network
+- Vary the simulated climate so the LCD and LEDs have something to show
+- Print the LCD whenever it changes, and the device statistics on exit
+- Check the running firmware over HTTP, or run a client against it
+
+Assumes the following modules exist:
+- main.c: the firmware, with main() renamed firmware_main()
+- snapshot.c / snapshot.h: for the latest reading the firmware published
+- sim_network.h: for the loopback ports
+- sim_devices.c / sim_devices.h: for the simulated board
+- i2c_bus.c / i2c_bus.h: for the bus statistics
+- hal_linux.c / hal.h: for the time
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include "i2c_bus.h"
+#include "snapshot.h"
+#include "sim_devices.h"
+#include "sim_network.h"
+#include "hal.h"
+
+#define HOST_FIRMWARE_PORT  80        // Port the firmware's web server listens on
+#define HOST_FIRST_SAMPLE_MS 10000    // Longest wait for the first reading
+#define CLIMATE_PERIOD_S    60.0      // Period of the simulated humidity swing
+#define CLIMATE_STEP_MS     100       // How often the climate and the LCD are looked at
+
+// Defined by main.c
+int firmware_main(void);
+extern snapshot_seqlock g_latest;
+extern volatile uint32_t g_sample_interval_ms;
+
+static volatile sig_atomic_t s_stop = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    s_stop = 1;
+}
+
+// Humidity and temperature drift slowly, as they would in a room
+static void simulate_climate(sim_dht20 *dht, uint32_t now_ms) {
+    double phase = 2.0 * 3.14159265358979 * (now_ms / 1000.0) / CLIMATE_PERIOD_S;
+    dht->humidity = (float)(50.0 + 30.0 * sin(phase));
+    dht->temp_c = (float)(21.0 + 3.0 * cos(phase));
+}
+
+// Print the LCD whenever its text changes
+static void print_lcd(const sim_lcd *lcd) {
+    static char shown[SIM_LCD_ROWS][SIM_LCD_COLS + 1];
+    char line[SIM_LCD_ROWS][SIM_LCD_COLS + 1];
+    bool changed = false;
+    for (uint8_t row = 0; row < SIM_LCD_ROWS; row++) {
+        sim_lcd_line(lcd, row, line[row]);
+        changed |= strcmp(line[row], shown[row]) != 0;
+    }
+    if (changed) {
+        memcpy(shown, line, sizeof(shown));
+        printf("LCD |%s|%s|\n", line[0], line[1]);
+    }
+}
+
+// The firmware never returns from main() unless it failed to start
+static void *firmware_thread(void *arg) {
+    (void)arg;
+    int code = firmware_main();
+    printf("ERROR: The firmware stopped (%d)\n", code);
+    fflush(stdout);
+    _exit(1);
+    return NULL;
+}
+
+// GET a path from the firmware and return the status code, or -1 on failure.
+// The body must contain expect.
+static int check_get(uint16_t port, const char *path, const char *expect) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    char request[128];
+    int request_len = snprintf(request, sizeof(request),
+                               "GET %s HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\n\r\n",
+                               path);
+    send(fd, request, (size_t)request_len, 0);
+
+    static char response[65536];
+    size_t len = 0;
+    ssize_t n;
+    while (len < sizeof(response) - 1 &&
+           (n = recv(fd, &response[len], sizeof(response) - 1 - len, 0)) > 0) {
+        len += (size_t)n;
+    }
+    response[len] = '\0';
+    close(fd);
+
+    int status = -1;
+    if (sscanf(response, "HTTP/1.1 %d", &status) != 1 || !strstr(response, expect)) {
+        return -1;
+    }
+    return status;
+}
+
+// Fetch the readings, the metrics and the page the firmware serves
+static int run_check(uint16_t port) {
+    int readings = check_get(port, "/api/v1/readings", "\"humidity\"");
+    int metrics = check_get(port, "/metrics", "i2c_bus_seconds_total");
+    int page = check_get(port, "/", "text/html");
+    printf("Check: /api/v1/readings %d, /metrics %d, / %d\n", readings, metrics, page);
+    return readings == 200 && metrics == 200 && page == 200 ? 0 : 1;
+}
+
+// Run a command against the firmware
+static int run_command(uint16_t port, const char *command) {
+    char value[8];
+    snprintf(value, sizeof(value), "%u", port);
+    setenv("HOST_HTTP_PORT", value, 1);
+    printf("Running: %s\n", command);
+    fflush(stdout);
+    int status = system(command);
+    printf("Command exited with %d\n", WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+    return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : 1;
+}
+
+static uint32_t latest_seq(void) {
+    reading_snapshot latest;
+    snapshot_read(&g_latest, &latest);
+    return latest.seq;
+}
+
+static void print_summary(void) {
+    sim_board *board = sim_board_get();
+    sim_board_lock();
+    printf("Samples: %lu\n", (unsigned long)latest_seq());
+    for (int i = 0; i < I2C_DEV_COUNT; i++) {
+        const i2c_device_stats *bus = i2c_bus_stats((i2c_device)i);
+        printf("I2C %-6s %lu transactions, %lu errors, %.3f s on the bus\n",
+               i2c_device_name((i2c_device)i),
+               (unsigned long)bus->transactions, (unsigned long)bus->errors, bus->bus_us / 1e6);
+    }
+    printf("DHT20: %lu measurements, %lu early reads\n",
+           (unsigned long)board->dht20.triggers, (unsigned long)board->dht20.early_reads);
+    printf("LCD: %lu commands, %lu characters, %lu sent while busy\n",
+           (unsigned long)board->lcd.commands, (unsigned long)board->lcd.chars,
+           (unsigned long)board->lcd.violations);
+    printf("LEDs: %lu frames, %zu of %zu lit\n", (unsigned long)board->leds.frames,
+           sim_ws2812_lit(&board->leds), board->leds.count);
+    sim_board_unlock();
+}
+
+int main(int argc, char **argv) {
+    uint16_t port_offset = SIM_DEFAULT_PORT_OFFSET;
+    uint32_t interval_ms = 0;    // 0 keeps the firmware's own
+    uint32_t duration_s = 0;     // 0 runs until interrupted
+    const char *command = NULL;
+    bool check = false;
+    bool blocking_i2c = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port-offset") == 0 && i + 1 < argc) {
+            port_offset = (uint16_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            interval_ms = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            duration_s = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--run") == 0 && i + 1 < argc) {
+            command = argv[++i];
+        } else if (strcmp(argv[i], "--check") == 0) {
+            check = true;
+        } else if (strcmp(argv[i], "--blocking-i2c") == 0) {
+            blocking_i2c = true;
+        } else {
+            printf("Usage: %s [--port-offset N] [--interval MS] [--duration S]"
+                   " [--blocking-i2c] [--check] [--run \"COMMAND\"]\n", argv[0]);
+            return 2;
+        }
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    sim_network_set_port_offset(port_offset);
+    if (interval_ms) {
+        g_sample_interval_ms = interval_ms;
+    }
+    sim_i2c_set_blocking(blocking_i2c);
+    sim_board *board = sim_board_get();
+    sim_board_lock();
+    simulate_climate(&board->dht20, hal_time_ms());
+    sim_board_unlock();
+
+    pthread_t firmware;
+    if (pthread_create(&firmware, NULL, firmware_thread, NULL) != 0) {
+        printf("ERROR: Failed to start the firmware\n");
+        return 1;
+    }
+    uint16_t http_port = sim_network_host_port(HOST_FIRMWARE_PORT);
+    printf("Host build: the firmware's web server is on http://127.0.0.1:%u/\n", http_port);
+
+    int exit_code = 0;
+    bool probed = false;
+    while (!s_stop) {
+        hal_sleep_ms(CLIMATE_STEP_MS);
+        sim_board_lock();
+        simulate_climate(&board->dht20, hal_time_ms());
+        print_lcd(&board->lcd);
+        sim_board_unlock();
+
+        // The first reading means the firmware is up, on both cores and the network
+        if ((check || command) && !probed) {
+            if (latest_seq() > 0) {
+                probed = true;
+                exit_code = command ? run_command(http_port, command) : run_check(http_port);
+                s_stop = 1;
+            } else if (hal_time_ms() > HOST_FIRST_SAMPLE_MS) {
+                printf("ERROR: No reading from the firmware after %u ms\n", HOST_FIRST_SAMPLE_MS);
+                exit_code = 1;
+                s_stop = 1;
+            }
+        }
+        if (duration_s && hal_time_ms() >= duration_s * 1000u) {
+            s_stop = 1;
+        }
+    }
+
+    // The firmware's threads never return; leave without waiting for them
+    print_summary();
+    fflush(stdout);
+    _exit(exit_code);
+}
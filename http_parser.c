@@ -0,0 +1,567 @@
+/*
+File: http_parser.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Provides an incremental HTTP/1.x request parser. Each byte moves a
+    small state machine forward, so a request head can be split across
+    any number of TCP segments and pbufs without reassembling it first.
+    Only the request line and a handful of known headers are copied into
+    fixed-size fields; every other header is skipped as it streams past.
+    Connection handling lives in network.c.
+
+Responsibilities:
+- Parse the request line into method, path, query and version
+- Extract the Connection, Upgrade, Accept-Encoding, If-None-Match,
+  Content-Length and Sec-WebSocket-* headers
+- Skip request bodies so pipelined requests stay framed
+- Reject malformed or oversized requests with a suitable status code
+- Split and percent-decode query string parameters
+- Compare If-None-Match lists against entity tags
+
+Requires the following modules:
+- http_parser.h: for interface definitions
+*/
+
+#include "http_parser.h"
+
+#include <string.h>
+#include <strings.h>
+
+// Parser states
+#define HP_STATE_START         0   // Before a request, skipping empty lines
+#define HP_STATE_METHOD        1
+#define HP_STATE_PATH          2
+#define HP_STATE_QUERY         3
+#define HP_STATE_VERSION       4
+#define HP_STATE_HEADER_START  5   // Start of a header line or the blank line
+#define HP_STATE_HEADER_NAME   6
+#define HP_STATE_HEADER_VALUE  7
+#define HP_STATE_BODY          8   // Skipping a request body
+#define HP_STATE_ERROR         9
+
+// Headers the parser keeps; everything else is skipped
+#define HP_HDR_OTHER              0
+#define HP_HDR_CONNECTION         1
+#define HP_HDR_UPGRADE            2
+#define HP_HDR_ACCEPT_ENCODING    3
+#define HP_HDR_IF_NONE_MATCH      4
+#define HP_HDR_CONTENT_LENGTH     5
+#define HP_HDR_TRANSFER_ENCODING  6
+#define HP_HDR_WS_KEY             7
+#define HP_HDR_WS_VERSION         8
+
+static const struct {
+    const char *name;
+    uint8_t id;
+} KNOWN_HEADERS[] = {
+    { "Connection",            HP_HDR_CONNECTION },
+    { "Upgrade",               HP_HDR_UPGRADE },
+    { "Accept-Encoding",       HP_HDR_ACCEPT_ENCODING },
+    { "If-None-Match",         HP_HDR_IF_NONE_MATCH },
+    { "Content-Length",        HP_HDR_CONTENT_LENGTH },
+    { "Transfer-Encoding",     HP_HDR_TRANSFER_ENCODING },
+    { "Sec-WebSocket-Key",     HP_HDR_WS_KEY },
+    { "Sec-WebSocket-Version", HP_HDR_WS_VERSION },
+};
+
+#define KNOWN_HEADER_COUNT (sizeof(KNOWN_HEADERS) / sizeof(KNOWN_HEADERS[0]))
+
+// Method names, indexed by bit position of the matching HTTP_METHOD_* flag
+static const char *const METHOD_NAMES[] = {
+    "GET",
+    "HEAD",
+    "POST",
+    "PUT",
+    "DELETE",
+    "OPTIONS",
+};
+
+#define METHOD_COUNT (sizeof(METHOD_NAMES) / sizeof(METHOD_NAMES[0]))
+
+// Characters allowed in methods and header names (RFC 9110 section 5.6.2)
+static bool is_tchar(char c) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+        return true;
+    }
+    return c != '\0' && strchr("!#$%&'*+-.^_`|~", c) != NULL;
+}
+
+// Printable characters allowed in the request target
+static bool is_target_char(char c) {
+    return c > ' ' && c < 0x7F;
+}
+
+void http_parser_init(http_parser *parser) {
+    memset(parser, 0, sizeof(*parser));
+    parser->state = HP_STATE_START;
+}
+
+bool http_parser_idle(const http_parser *parser) {
+    return parser->state == HP_STATE_START && parser->body_left == 0;
+}
+
+// Stop parsing for good; the connection must be answered with status and closed
+static http_parse_result http_fail(http_parser *parser, uint16_t status) {
+    parser->state = HP_STATE_ERROR;
+    parser->error_status = status;
+    return HTTP_PARSE_ERROR;
+}
+
+// Clear the previous request when the first byte of the next one arrives
+static void begin_request(http_parser *parser) {
+    memset(&parser->req, 0, sizeof(parser->req));
+    parser->len = 0;
+    parser->head_len = 0;
+    parser->conn_close = false;
+    parser->conn_keep_alive = false;
+}
+
+// Methods are case-sensitive (RFC 9110 section 9.1)
+static uint8_t lookup_method(const char *method) {
+    for (size_t i = 0; i < METHOD_COUNT; i++) {
+        if (strcmp(METHOD_NAMES[i], method) == 0) {
+            return (uint8_t)(1u << i);
+        }
+    }
+    return HTTP_METHOD_OTHER;
+}
+
+static uint8_t lookup_header(const char *name, size_t len) {
+    for (size_t i = 0; i < KNOWN_HEADER_COUNT; i++) {
+        if (strlen(KNOWN_HEADERS[i].name) == len &&
+            strncasecmp(KNOWN_HEADERS[i].name, name, len) == 0) {
+            return KNOWN_HEADERS[i].id;
+        }
+    }
+    return HP_HDR_OTHER;
+}
+
+// Walk a comma-separated header list. Returns the next element with
+// surrounding whitespace trimmed and advances *list past it, or NULL at the end.
+static const char *next_list_item(const char **list, size_t *item_len) {
+    const char *c = *list;
+    while (*c == ' ' || *c == '\t' || *c == ',') c++;
+    if (*c == '\0') return NULL;
+
+    const char *start = c;
+    while (*c && *c != ',') c++;
+    const char *end = c;
+    while (end > start && (end[-1] == ' ' || end[-1] == '\t')) end--;
+
+    *list = c;
+    *item_len = (size_t)(end - start);
+    return start;
+}
+
+// Check whether a comma-separated list contains a token (case-insensitive)
+static bool list_has_token(const char *list, const char *token) {
+    size_t token_len = strlen(token);
+    size_t len;
+    const char *item;
+    while ((item = next_list_item(&list, &len)) != NULL) {
+        if (len == token_len && strncasecmp(item, token, len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Check whether Accept-Encoding allows gzip and doesn't refuse it with q=0.
+// A q-value is zero when it has no non-zero digit, so no float parsing is needed.
+static bool list_accepts_gzip(const char *list) {
+    size_t len;
+    const char *item;
+    while ((item = next_list_item(&list, &len)) != NULL) {
+        const char *end = item + len;
+        const char *c = item;
+        while (c < end && *c != ';' && *c != ' ') c++;
+        if ((size_t)(c - item) != 4 || strncasecmp(item, "gzip", 4) != 0) {
+            continue;
+        }
+
+        // Look for a quality value such as "gzip;q=0" after the coding
+        while (c < end && (*c == ' ' || *c == ';')) c++;
+        if (end - c < 2 || strncasecmp(c, "q=", 2) != 0) {
+            return true;
+        }
+        for (c += 2; c < end; c++) {
+            if (*c >= '1' && *c <= '9') return true;
+        }
+        return false;
+    }
+    return false;
+}
+
+// Act on a complete header line. Returns 0, or the status to fail with.
+static uint16_t apply_header(http_parser *parser) {
+    http_request *req = &parser->req;
+
+    // Trim trailing whitespace (leading whitespace was never stored)
+    size_t len = parser->len;
+    while (len > 0 && (parser->buf[len - 1] == ' ' || parser->buf[len - 1] == '\t')) len--;
+    parser->buf[len] = '\0';
+    const char *value = parser->buf;
+
+    // A value cut short can't be trusted for anything but the token lists
+    if (parser->overflow) {
+        switch (parser->header) {
+            case HP_HDR_IF_NONE_MATCH:
+                return 0;  // Can't be matched, so treat it as absent
+            case HP_HDR_CONNECTION:
+            case HP_HDR_UPGRADE:
+            case HP_HDR_ACCEPT_ENCODING:
+                break;     // Use the tokens that did fit
+            default:
+                return 400;
+        }
+    }
+
+    switch (parser->header) {
+        case HP_HDR_CONNECTION:
+            parser->conn_close |= list_has_token(value, "close");
+            parser->conn_keep_alive |= list_has_token(value, "keep-alive");
+            req->connection_upgrade |= list_has_token(value, "upgrade");
+            break;
+        case HP_HDR_UPGRADE:
+            req->upgrade_websocket |= list_has_token(value, "websocket");
+            break;
+        case HP_HDR_ACCEPT_ENCODING:
+            req->accept_gzip |= list_accepts_gzip(value);
+            break;
+        case HP_HDR_IF_NONE_MATCH:
+            memcpy(req->if_none_match, value, len + 1);
+            break;
+        case HP_HDR_CONTENT_LENGTH: {
+            // Digits only, and small enough that uint32_t can't overflow
+            if (len == 0 || len > 9) return 400;
+            uint32_t n = 0;
+            for (size_t i = 0; i < len; i++) {
+                if (value[i] < '0' || value[i] > '9') return 400;
+                n = n * 10 + (uint32_t)(value[i] - '0');
+            }
+            req->content_length = n;
+            break;
+        }
+        case HP_HDR_TRANSFER_ENCODING:
+            // Chunked request bodies are never needed, so they can't be framed
+            return 501;
+        case HP_HDR_WS_KEY:
+            if (len >= sizeof(req->ws_key)) return 400;
+            memcpy(req->ws_key, value, len + 1);
+            break;
+        case HP_HDR_WS_VERSION:
+            req->ws_version = (len == 2 && value[0] == '1' && value[1] == '3') ? 13 : 0xFF;
+            break;
+        default:
+            break;
+    }
+    return 0;
+}
+
+// Check the collected "HTTP/1.x" version token. Returns 0, or the status to fail with.
+static uint16_t apply_version(http_parser *parser) {
+    if (parser->len != 8 || strncmp(parser->buf, "HTTP/", 5) != 0 ||
+        parser->buf[6] != '.' || parser->buf[5] < '0' || parser->buf[5] > '9' ||
+        parser->buf[7] < '0' || parser->buf[7] > '9') {
+        return 400;
+    }
+    if (parser->buf[5] != '1' || parser->buf[7] > '1') {
+        return 505;
+    }
+    parser->req.version_minor = (uint8_t)(parser->buf[7] - '0');
+    return 0;
+}
+
+// The blank line ending the head was read; settle what happens next
+static void finish_head(http_parser *parser) {
+    http_request *req = &parser->req;
+
+    // HTTP/1.1 keeps connections open unless asked not to, HTTP/1.0 only on request
+    if (req->version_minor >= 1) {
+        req->keep_alive = !parser->conn_close;
+    } else {
+        req->keep_alive = parser->conn_keep_alive && !parser->conn_close;
+    }
+
+    parser->body_left = req->content_length;
+    parser->state = parser->body_left ? HP_STATE_BODY : HP_STATE_START;
+}
+
+http_parse_result http_parser_feed(http_parser *parser, const char *data, size_t len,
+                                   size_t *consumed) {
+    size_t i = 0;
+    http_parse_result result = HTTP_PARSE_NEED_MORE;
+    http_request *req = &parser->req;
+
+    if (parser->state == HP_STATE_ERROR) {
+        *consumed = 0;
+        return HTTP_PARSE_ERROR;
+    }
+
+    while (i < len && result == HTTP_PARSE_NEED_MORE) {
+        // Discard the previous request's body in bulk
+        if (parser->state == HP_STATE_BODY) {
+            size_t n = (parser->body_left < len - i) ? parser->body_left : len - i;
+            i += n;
+            parser->body_left -= (uint32_t)n;
+            if (parser->body_left == 0) {
+                parser->state = HP_STATE_START;
+            }
+            continue;
+        }
+
+        char c = data[i++];
+        if (parser->state != HP_STATE_START && ++parser->head_len > HTTP_HEAD_MAX) {
+            result = http_fail(parser, 431);
+            break;
+        }
+
+        switch (parser->state) {
+            case HP_STATE_START:
+                // Empty lines before a request are ignored (RFC 9112 section 2.2)
+                if (c == '\r' || c == '\n') break;
+                begin_request(parser);
+                parser->head_len = 1;
+                parser->state = HP_STATE_METHOD;
+                // fall through
+
+            case HP_STATE_METHOD:
+                if (c == ' ' && parser->len > 0) {
+                    req->method_id = lookup_method(req->method);
+                    parser->state = HP_STATE_PATH;
+                    parser->len = 0;
+                } else if (!is_tchar(c)) {
+                    result = http_fail(parser, 400);
+                } else if (parser->len >= HTTP_METHOD_MAX - 1) {
+                    result = http_fail(parser, 501);
+                } else {
+                    req->method[parser->len++] = c;
+                }
+                break;
+
+            case HP_STATE_PATH:
+                // Only origin-form targets ("/path?query") are served
+                if (parser->len == 0 && c != '/') {
+                    result = http_fail(parser, 400);
+                } else if (c == ' ') {
+                    parser->state = HP_STATE_VERSION;
+                    parser->len = 0;
+                } else if (c == '?') {
+                    req->has_query = true;
+                    parser->state = HP_STATE_QUERY;
+                    parser->len = 0;
+                } else if (!is_target_char(c)) {
+                    result = http_fail(parser, 400);
+                } else if (parser->len >= HTTP_PATH_MAX - 1) {
+                    result = http_fail(parser, 414);
+                } else {
+                    req->path[parser->len++] = c;
+                }
+                break;
+
+            case HP_STATE_QUERY:
+                if (c == ' ') {
+                    parser->state = HP_STATE_VERSION;
+                    parser->len = 0;
+                } else if (!is_target_char(c)) {
+                    result = http_fail(parser, 400);
+                } else if (parser->len >= HTTP_QUERY_MAX - 1) {
+                    result = http_fail(parser, 414);
+                } else {
+                    req->query[parser->len++] = c;
+                }
+                break;
+
+            case HP_STATE_VERSION:
+                if (c == '\r') break;
+                if (c == '\n') {
+                    uint16_t status = apply_version(parser);
+                    if (status) {
+                        result = http_fail(parser, status);
+                    } else {
+                        parser->state = HP_STATE_HEADER_START;
+                    }
+                } else if (parser->len >= 8) {
+                    result = http_fail(parser, 400);
+                } else {
+                    parser->buf[parser->len++] = c;
+                }
+                break;
+
+            case HP_STATE_HEADER_START:
+                if (c == '\r') break;
+                if (c == '\n') {
+                    finish_head(parser);
+                    result = HTTP_PARSE_DONE;
+                    break;
+                }
+                // Obsolete line folding is rejected (RFC 9112 section 5.2)
+                if (c == ' ' || c == '\t') {
+                    result = http_fail(parser, 400);
+                    break;
+                }
+                parser->state = HP_STATE_HEADER_NAME;
+                parser->len = 0;
+                // fall through
+
+            case HP_STATE_HEADER_NAME:
+                if (c == ':' && parser->len > 0) {
+                    // Names longer than the buffer can't be a known header
+                    parser->header = (parser->len < sizeof(parser->buf))
+                                         ? lookup_header(parser->buf, parser->len)
+                                         : HP_HDR_OTHER;
+                    parser->state = HP_STATE_HEADER_VALUE;
+                    parser->len = 0;
+                    parser->overflow = false;
+                } else if (!is_tchar(c)) {
+                    result = http_fail(parser, 400);
+                } else {
+                    if (parser->len < sizeof(parser->buf)) {
+                        parser->buf[parser->len] = c;
+                    }
+                    if (parser->len < UINT16_MAX) parser->len++;
+                }
+                break;
+
+            case HP_STATE_HEADER_VALUE:
+                if (c == '\r') break;
+                if (c == '\n') {
+                    uint16_t status = apply_header(parser);
+                    if (status) {
+                        result = http_fail(parser, status);
+                    } else {
+                        parser->state = HP_STATE_HEADER_START;
+                    }
+                    break;
+                }
+                // Unknown headers stream past without being stored
+                if (parser->header == HP_HDR_OTHER) break;
+                if (parser->len == 0 && (c == ' ' || c == '\t')) break;
+                if (parser->len < sizeof(parser->buf) - 1) {
+                    parser->buf[parser->len++] = c;
+                } else {
+                    parser->overflow = true;
+                }
+                break;
+
+            default:
+                result = http_fail(parser, 400);
+                break;
+        }
+    }
+
+    *consumed = i;
+    return result;
+}
+
+const char *http_method_name(uint8_t method_id) {
+    for (size_t i = 0; i < METHOD_COUNT; i++) {
+        if (method_id == (1u << i)) {
+            return METHOD_NAMES[i];
+        }
+    }
+    return NULL;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Percent-decode a null-terminated string in place; false on a bad escape
+static bool url_decode(char *s) {
+    char *out = s;
+    for (char *c = s; *c; c++) {
+        if (*c == '+') {
+            *out++ = ' ';
+        } else if (*c == '%') {
+            int hi = hex_value(c[1]);
+            int lo = (hi < 0) ? -1 : hex_value(c[2]);
+            if (lo < 0) return false;
+            *out++ = (char)(hi * 16 + lo);
+            c += 2;
+        } else {
+            *out++ = *c;
+        }
+    }
+    *out = '\0';
+    return true;
+}
+
+http_query_result http_query_next(char **cursor, char **name, char **value) {
+    char *c = *cursor;
+    while (*c == '&') c++;
+    if (*c == '\0') {
+        *cursor = c;
+        return HTTP_QUERY_END;
+    }
+
+    // Cut the parameter off at the next '&' and split it at the first '='
+    char *param = c;
+    char *amp = strchr(param, '&');
+    if (amp) {
+        *amp = '\0';
+        *cursor = amp + 1;
+    } else {
+        *cursor = param + strlen(param);
+    }
+
+    char *eq = strchr(param, '=');
+    if (eq) {
+        *eq = '\0';
+        *value = eq + 1;
+    } else {
+        *value = param + strlen(param);
+    }
+    *name = param;
+
+    if (!url_decode(*name) || !url_decode(*value)) {
+        return HTTP_QUERY_ERROR;
+    }
+    return HTTP_QUERY_PARAM;
+}
+
+// Optional whitespace and the commas between list members
+static const char *skip_list_separators(const char *c) {
+    while (*c == ' ' || *c == '\t' || *c == ',') c++;
+    return c;
+}
+
+bool http_etag_matches(const char *if_none_match, const char *etag) {
+    if (!if_none_match) return false;
+
+    // Compare the opaque-tags only; W/ doesn't matter for GET
+    if (strncmp(etag, "W/", 2) == 0) etag += 2;
+    size_t etag_len = strlen(etag);
+
+    const char *c = skip_list_separators(if_none_match);
+    while (*c && *c != '\r') {
+        if (*c == '*') {
+            const char *next = skip_list_separators(c + 1);
+            if (next == c + 1 && *next && *next != '\r') {
+                return false;   // "*" must stand alone
+            }
+            return true;
+        }
+        if (strncmp(c, "W/", 2) == 0) c += 2;
+
+        // An opaque-tag is a quoted string without escapes
+        const char *end = (*c == '"') ? strchr(c + 1, '"') : NULL;
+        if (end) {
+            size_t len = (size_t)(end - c) + 1;
+            if (len == etag_len && strncmp(c, etag, len) == 0) {
+                return true;
+            }
+            c = end + 1;
+        }
+
+        // Move on to the next member, skipping anything malformed
+        while (*c && *c != ',' && *c != '\r') c++;
+        c = skip_list_separators(c);
+    }
+    return false;
+}
@@ -0,0 +1,176 @@
+/*
+File: http_parser.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the incremental HTTP/1.x request parser
+    used by network.c. The parser is a byte-at-a-time state machine that
+    reads received data in place, wherever lwIP left it, and keeps only
+    the request fields the server uses. A request may arrive in any number
+    of pieces, and several requests may arrive back to back on one
+    connection; parsing resumes exactly where the previous piece ended.
+
+    This module has no hardware or lwIP dependencies so it can be unit
+    tested and fuzzed on the host (see test_http_parser.c and
+    fuzz_http_parser.c).
+*/
+
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Field sizes, including the null terminator
+#define HTTP_METHOD_MAX      8     // Longest standard method is "OPTIONS"
+#define HTTP_PATH_MAX        64    // Path part of the request target
+#define HTTP_QUERY_MAX       96    // Query part of the request target, without '?'
+#define HTTP_ETAG_LIST_MAX   96    // If-None-Match value
+#define HTTP_WS_KEY_MAX      32    // Sec-WebSocket-Key value (24 base64 characters)
+#define HTTP_VALUE_MAX       96    // Header name or value being collected
+
+// Largest request head (request line and headers) accepted. Nothing is
+// buffered per byte, so this only bounds how long a client can keep the
+// parser busy with one request.
+#define HTTP_HEAD_MAX        4096
+
+// Request methods, as bit flags so a route can allow several
+#define HTTP_METHOD_OTHER    0x00
+#define HTTP_METHOD_GET      0x01
+#define HTTP_METHOD_HEAD     0x02
+#define HTTP_METHOD_POST     0x04
+#define HTTP_METHOD_PUT      0x08
+#define HTTP_METHOD_DELETE   0x10
+#define HTTP_METHOD_OPTIONS  0x20
+
+/**
+ * @brief Outcome of feeding bytes to the request parser
+ */
+typedef enum {
+    HTTP_PARSE_NEED_MORE = 0,  // All input consumed, request head not complete yet
+    HTTP_PARSE_DONE,           // A request head is complete and in parser.req
+    HTTP_PARSE_ERROR,          // Malformed request; answer with error_status and close
+} http_parse_result;
+
+/**
+ * @brief The parts of one request the server acts on
+ *
+ * All strings are null-terminated. Header fields are empty (or false / 0)
+ * when the client didn't send the header.
+ */
+typedef struct {
+    char method[HTTP_METHOD_MAX];           // e.g. "GET"
+    uint8_t method_id;                      // HTTP_METHOD_* flag, or HTTP_METHOD_OTHER
+    char path[HTTP_PATH_MAX];               // Request path, always starts with '/'
+    char query[HTTP_QUERY_MAX];             // Raw query string without the '?'
+    bool has_query;                         // Target contained a '?'
+    uint8_t version_minor;                  // 0 for HTTP/1.0, 1 for HTTP/1.1
+    bool keep_alive;                        // Connection may be reused afterwards
+    bool connection_upgrade;                // Connection header lists "upgrade"
+    bool upgrade_websocket;                 // Upgrade header lists "websocket"
+    bool accept_gzip;                       // Accept-Encoding allows gzip
+    uint32_t content_length;                // Content-Length, 0 when absent
+    uint8_t ws_version;                     // Sec-WebSocket-Version, 0 when absent
+    char ws_key[HTTP_WS_KEY_MAX];           // Sec-WebSocket-Key
+    char if_none_match[HTTP_ETAG_LIST_MAX]; // If-None-Match
+} http_request;
+
+/**
+ * @brief Per-connection parser state
+ *
+ * After http_parser_feed() returns HTTP_PARSE_DONE, req describes the
+ * request until the next call starts reading the following request.
+ */
+typedef struct {
+    uint8_t state;               // Internal parser state
+    uint8_t header;              // Known header whose value is being read
+    uint16_t len;                // Bytes collected for the current field
+    uint16_t head_len;           // Bytes of the current request head so far
+    bool conn_close;             // Connection header lists "close"
+    bool conn_keep_alive;        // Connection header lists "keep-alive"
+    bool overflow;               // Current header value didn't fit in buf
+    uint32_t body_left;          // Body bytes still to skip before the next request
+    uint16_t error_status;       // HTTP status to answer with after HTTP_PARSE_ERROR
+    char buf[HTTP_VALUE_MAX];    // Header name or value being collected
+    http_request req;            // The request being parsed or just completed
+} http_parser;
+
+/**
+ * @brief Outcome of reading one query parameter
+ */
+typedef enum {
+    HTTP_QUERY_END = 0,  // No parameters left
+    HTTP_QUERY_PARAM,    // name and value point at the next parameter
+    HTTP_QUERY_ERROR,    // Malformed %-escape
+} http_query_result;
+
+/**
+ * @brief Reset a parser before the first request of a connection
+ *
+ * @param parser  Parser to reset
+ */
+void http_parser_init(http_parser *parser);
+
+/**
+ * @brief Feed received bytes to the parser
+ *
+ * Parsing stops after each complete request head so the caller can answer
+ * it; call again with the remaining bytes (data + consumed). Any request
+ * body announced by Content-Length is skipped on later calls.
+ *
+ * @param parser    Parser state for the connection
+ * @param data      Received bytes
+ * @param len       Number of bytes in data
+ * @param consumed  Receives how many bytes of data were used
+ * @return Whether a request is ready, more data is needed, or the request is malformed
+ */
+http_parse_result http_parser_feed(http_parser *parser, const char *data, size_t len,
+                                   size_t *consumed);
+
+/**
+ * @brief Whether the parser is between requests
+ *
+ * @param parser  Parser state for the connection
+ * @return true if no part of a request head or body has been read since
+ *         the last completed request
+ */
+bool http_parser_idle(const http_parser *parser);
+
+/**
+ * @brief Name of an HTTP_METHOD_* flag, for Allow headers and logs
+ *
+ * @param method_id  A single HTTP_METHOD_* flag
+ * @return The method name, or NULL for HTTP_METHOD_OTHER
+ */
+const char *http_method_name(uint8_t method_id);
+
+/**
+ * @brief Take the next name=value parameter from a query string
+ *
+ * Parameters are separated by '&'. The name and value are split and
+ * percent-decoded in place ('+' becomes a space), so the query string is
+ * consumed. A parameter without '=' has an empty value; empty parameters
+ * ("a=1&&b=2") are skipped.
+ *
+ * @param cursor  Position in the query; start it at the query string
+ * @param name    Receives the decoded parameter name
+ * @param value   Receives the decoded parameter value
+ * @return Whether a parameter was found, the query ended, or an escape was malformed
+ */
+http_query_result http_query_next(char **cursor, char **name, char **value);
+
+/**
+ * @brief Check an If-None-Match field value against an entity tag
+ *
+ * Uses the weak comparison GET requires (RFC 9110 section 13.1.2): a W/
+ * prefix on either tag is ignored, but the quoted parts must be equal in
+ * full. "*" matches any tag. Malformed list members never match.
+ *
+ * @param if_none_match  Field value, or NULL when the header was absent
+ * @param etag           The current tag, quoted and optionally W/-prefixed
+ * @return true if the client's copy is current
+ */
+bool http_etag_matches(const char *if_none_match, const char *etag);
+
+#endif // HTTP_PARSER_H
@@ -0,0 +1,379 @@
+/*
+File: i2c_bus.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    I2C bus manager (see i2c_bus.h). Every I2C transfer in the firmware
+    goes through here.
+
+    Once attached, a transaction runs in the background. Each write
+    chunk or read is at most one FIFO deep, so the HAL hands it to the
+    controller in one go and the CPU is not needed again until the
+    transfer's completion callback (the STOP interrupt on the Pico). The
+    waits between LCD chunks are HAL timers (alarms on core 1's own
+    alarm pool). The worker on the attached async_context records each
+    finished transaction, calls its completion callback and starts the
+    next one.
+
+    Before attaching (at startup, on core 0), or if the HAL can't run
+    transfers in the background, transactions use the HAL's blocking
+    calls instead.
+
+    Between samples core 1 puts the idle buses to sleep: each controller
+    is held in reset and clk_sys to it is gated off. The next transaction
+    brings it back at whatever clk_sys is by then.
+
+    The same file runs on the Pico and in the host build; the controllers
+    are reached only through hal.h.
+
+Responsibilities:
+- Initialize each bus and its pins once
+- Queue device transactions and run them in priority order
+- Drive transfers from the HAL's completion callbacks and time chunk gaps
+  with its timers
+- Record bus time, CPU time, bytes, errors and queue waits per device
+- Hold idle buses in reset with their clock gated, and wake them on use
+
+Requires the following modules:
+- i2c_bus.h: for interface definitions
+- i2c_queue.h: for the transaction queue and statistics
+- board_pins.h: for the bus pins and speed
+- hal.h: for the I2C controllers and the time
+*/
+
+#include <stdio.h>
+#include "pico/async_context.h"
+
+#include "i2c_bus.h"
+#include "board_pins.h"
+#include "hal.h"
+
+#define I2C_BUS_ERROR (-1)   // PICO_ERROR_GENERIC, as the HAL reports a failed transfer
+
+// Each bus, set up on its first use
+typedef struct {
+    uint8_t index;         // Controller number
+    uint8_t sda_pin;
+    uint8_t scl_pin;
+    uint32_t freq;
+} i2c_bus_config;
+
+static const i2c_bus_config BUSES[] = {
+    { 0, I2C0_SDA_PIN, I2C0_SCL_PIN, I2C0_FREQ },
+};
+
+#define BUS_COUNT (sizeof(BUSES) / sizeof(BUSES[0]))
+
+// Bus each device is wired to (index into BUSES)
+static const uint8_t DEVICE_BUS[I2C_DEV_COUNT] = {
+    [I2C_DEV_DHT20] = 0,
+    [I2C_DEV_LCD]   = 0,
+};
+
+_Static_assert(I2C_TXN_TX_MAX <= HAL_I2C_FIFO_DEPTH, "A write must fit in the TX FIFO");
+_Static_assert(I2C_TXN_RX_MAX <= HAL_I2C_FIFO_DEPTH, "A read must fit in the RX FIFO");
+
+// The transaction on the bus, shared between the worker and the HAL's callbacks
+typedef struct {
+    i2c_txn txn;
+    uint8_t bus;           // Controller it runs on
+    uint8_t pos;           // tx bytes written so far
+    uint8_t len;           // Bytes in the write or read on the bus now
+    bool reading;          // The read is on the bus
+    bool read_done;
+    bool held;             // hold_us has been waited
+    int result;
+    uint32_t start_us;
+    uint32_t end_us;
+    uint32_t cpu_us;       // Time spent starting it and in its callbacks
+} bus_active;
+
+static bool s_initialized = false;
+static bool s_asleep = false;          // Buses held in reset with clk_sys gated off
+static i2c_queue s_queue;
+static i2c_device_stats s_stats[I2C_DEV_COUNT];
+static async_context_t *s_context = NULL;
+
+static bus_active s_active;
+static volatile bool s_busy = false;   // A transaction is on the bus or between chunks
+static volatile bool s_done = false;   // ... and has finished, waiting for the worker
+
+static void bus_work(async_context_t *context, async_when_pending_worker_t *worker);
+static async_when_pending_worker_t s_worker = { .do_work = bus_work };
+
+void i2c_bus_init(void) {
+    if (s_initialized) return;
+    s_initialized = true;
+
+    i2c_queue_init(&s_queue);
+    for (size_t i = 0; i < BUS_COUNT; i++) {
+        const i2c_bus_config *bus = &BUSES[i];
+        hal_i2c_init(bus->index, bus->sda_pin, bus->scl_pin, bus->freq);
+    }
+}
+
+// Bring the buses out of sleep before a transaction, at the current clk_sys
+static void wake(void) {
+    if (!s_asleep) return;
+    s_asleep = false;
+    for (size_t i = 0; i < BUS_COUNT; i++) {
+        hal_i2c_wake(BUSES[i].index, BUSES[i].freq);
+    }
+}
+
+// Run one transaction with the HAL's blocking calls (before attaching)
+static int run_blocking(const i2c_txn *txn) {
+    wake();
+    uint8_t bus = BUSES[DEVICE_BUS[txn->device]].index;
+    uint32_t start_us = hal_time_us();
+    int result = 0;
+
+    // Writes, in chunks if the device needs time between them
+    uint8_t chunk = txn->chunk ? txn->chunk : txn->tx_len;
+    for (uint8_t pos = 0; pos < txn->tx_len && result >= 0; pos += chunk) {
+        uint8_t len = (uint8_t)((txn->tx_len - pos < chunk) ? txn->tx_len - pos : chunk);
+        int n = hal_i2c_write_blocking(bus, txn->addr, &txn->tx[pos], len);
+        result = (n < 0) ? n : result + n;
+        if (txn->gap_us) {
+            hal_sleep_us(txn->gap_us);
+        }
+    }
+    if (txn->rx_len && result >= 0) {
+        int n = hal_i2c_read_blocking(bus, txn->addr, txn->rx, txn->rx_len);
+        result = (n < 0) ? n : result + n;
+    }
+    if (txn->hold_us) {
+        hal_sleep_us(txn->hold_us);
+    }
+
+    // The CPU waited on the bus throughout
+    uint32_t bus_us = hal_time_us() - start_us;
+    i2c_stats_record(&s_stats[txn->device], 0, bus_us, bus_us,
+                     i2c_txn_bytes(txn), result >= 0);
+    if (txn->done) {
+        txn->done(txn, result, txn->ctx);
+    }
+    return result;
+}
+
+// ---- Background transfers (the HAL's callbacks on core 1) ----
+
+static void step(void);
+
+// Hand one write chunk or the whole read to the controller; the HAL calls
+// transfer_done() when the bus is done with it
+static void load(void) {
+    const i2c_txn *txn = &s_active.txn;
+    if (s_active.reading) {
+        hal_i2c_start_read(s_active.bus, txn->addr, txn->rx, s_active.len);
+    } else {
+        hal_i2c_start_write(s_active.bus, txn->addr, &txn->tx[s_active.pos], s_active.len);
+    }
+}
+
+static void wait_done(void) {
+    uint32_t entry_us = hal_time_us();
+    step();
+    s_active.cpu_us += hal_time_us() - entry_us;
+}
+
+// Start the next part of the active transaction, or finish it
+static void step(void) {
+    i2c_txn *txn = &s_active.txn;
+
+    if (s_active.result >= 0 && s_active.pos < txn->tx_len) {
+        uint8_t chunk = txn->chunk ? txn->chunk : txn->tx_len;
+        uint8_t left = txn->tx_len - s_active.pos;
+        s_active.len = left < chunk ? left : chunk;
+        s_active.reading = false;
+        load();
+        return;
+    }
+    if (s_active.result >= 0 && txn->rx_len && !s_active.read_done) {
+        s_active.len = txn->rx_len;
+        s_active.reading = true;
+        load();
+        return;
+    }
+    if (s_active.result >= 0 && txn->hold_us && !s_active.held) {
+        s_active.held = true;
+        hal_i2c_call_after_us(txn->hold_us, wait_done);
+        return;
+    }
+
+    s_active.end_us = hal_time_us();
+    s_done = true;
+    hal_i2c_notify();   // Wake a blocking transfer waiting in finish_active()
+    async_context_set_work_pending(s_context, &s_worker);
+}
+
+// Every write and read ends here, failed if the device didn't answer
+static void transfer_done(int result) {
+    uint32_t entry_us = hal_time_us();
+
+    if (result < 0) {
+        s_active.result = result;
+    }
+    if (s_active.reading) {
+        s_active.read_done = true;
+    } else {
+        s_active.pos += s_active.len;
+    }
+    if (s_active.result >= 0) {
+        s_active.result += s_active.len;
+    }
+
+    if (!s_active.reading && s_active.txn.gap_us && s_active.result >= 0) {
+        hal_i2c_call_after_us(s_active.txn.gap_us, wait_done);
+    } else {
+        step();
+    }
+    s_active.cpu_us += hal_time_us() - entry_us;
+}
+
+// ---- Task context on core 1 ----
+
+// Put a transaction on the bus; it runs from the HAL's callbacks from here on
+static void start(const i2c_txn *txn) {
+    uint32_t entry_us = hal_time_us();
+    wake();
+    s_active = (bus_active){
+        .txn = *txn,
+        .bus = BUSES[DEVICE_BUS[txn->device]].index,
+        .start_us = entry_us,
+    };
+    if (s_active.txn.rx_len > I2C_TXN_RX_MAX) {
+        printf("ERROR: I2C read of %u bytes is longer than the FIFO\n", s_active.txn.rx_len);
+        s_active.result = I2C_BUS_ERROR;
+    }
+    // Keep the completion callback out until the start is accounted for
+    uint32_t saved = hal_i2c_lock();
+    s_done = false;
+    s_busy = true;
+    step();
+    s_active.cpu_us += hal_time_us() - entry_us;
+    hal_i2c_unlock(saved);
+}
+
+// Record the finished transaction and report it
+static int complete(void) {
+    i2c_txn txn = s_active.txn;
+    int result = s_active.result;
+    uint32_t wait_us = txn.queued_us ? s_active.start_us - txn.queued_us : 0;
+    i2c_stats_record(&s_stats[txn.device], wait_us, s_active.end_us - s_active.start_us,
+                     s_active.cpu_us, i2c_txn_bytes(&txn), result >= 0);
+    s_done = false;
+    s_busy = false;
+    if (txn.done) {
+        txn.done(&txn, result, txn.ctx);
+    }
+    return result;
+}
+
+// Sleep until the transaction on the bus finishes, then complete it
+static int finish_active(void) {
+    while (!s_done) {
+        hal_i2c_wait();
+    }
+    return complete();
+}
+
+// Start the next queued transaction at or above a priority
+static bool start_next(i2c_priority max_priority) {
+    i2c_txn txn;
+    if (!i2c_queue_pop(&s_queue, max_priority, &txn)) {
+        return false;
+    }
+    start(&txn);
+    return true;
+}
+
+// Woken when a transaction finishes or is queued: report it and start the next
+static void bus_work(async_context_t *context, async_when_pending_worker_t *worker) {
+    (void)context;
+    (void)worker;
+    if (s_busy && s_done) {
+        complete();
+    }
+    if (!s_busy) {
+        start_next(I2C_PRIORITY_LOW);
+    }
+}
+
+void i2c_bus_attach(async_context_t *context) {
+    if (!hal_i2c_attach(transfer_done)) {
+        return;   // Transfers stay blocking
+    }
+    s_context = context;
+    async_context_add_when_pending_worker(context, &s_worker);
+    if (i2c_queue_count(&s_queue) > 0) {
+        async_context_set_work_pending(context, &s_worker);
+    }
+}
+
+void i2c_bus_submit(const i2c_txn *txn) {
+    if (!s_context) {
+        run_blocking(txn);
+        return;
+    }
+    while (!i2c_queue_push(&s_queue, txn, hal_time_us())) {
+        // Full: make room by finishing what is on the bus and starting the next
+        if (s_busy) {
+            finish_active();
+        }
+        start_next(I2C_PRIORITY_LOW);
+    }
+    async_context_set_work_pending(s_context, &s_worker);
+}
+
+int i2c_bus_transfer(const i2c_txn *txn) {
+    if (!s_context) {
+        return run_blocking(txn);   // Nothing is ever queued before attaching
+    }
+
+    // Let the transaction on the bus finish, then strictly higher priorities;
+    // this one goes ahead of its equals
+    if (s_busy) {
+        finish_active();
+    }
+    while (txn->priority > I2C_PRIORITY_HIGH &&
+           start_next((i2c_priority)(txn->priority - 1))) {
+        finish_active();
+    }
+    i2c_txn now = *txn;
+    now.queued_us = 0;
+    start(&now);
+    int result = finish_active();
+    if (i2c_queue_count(&s_queue) > 0) {
+        async_context_set_work_pending(s_context, &s_worker);
+    }
+    return result;
+}
+
+bool i2c_bus_pending(void) {
+    return s_busy || i2c_queue_count(&s_queue) > 0;
+}
+
+bool i2c_bus_busy(void) {
+    return s_busy;
+}
+
+void i2c_bus_sleep(void) {
+    if (s_asleep || s_busy) return;
+    s_asleep = true;
+    for (size_t i = 0; i < BUS_COUNT; i++) {
+        hal_i2c_sleep(BUSES[i].index);
+    }
+}
+
+void i2c_bus_clock_changed(void) {
+    if (s_asleep) return;   // Set from the new clk_sys on waking
+    for (size_t i = 0; i < BUS_COUNT; i++) {
+        hal_i2c_set_baudrate(BUSES[i].index, BUSES[i].freq);
+    }
+}
+
+const i2c_device_stats *i2c_bus_stats(i2c_device device) {
+    return &s_stats[device];
+}
@@ -0,0 +1,104 @@
+/*
+File: i2c_bus.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the I2C bus manager. It owns every I2C
+    bus, initializes each one once on the pins in board_pins.h, and runs
+    device transactions one at a time through the priority queue in
+    i2c_queue.h, recording the bus time each device uses.
+
+    Drivers queue transactions with i2c_bus_submit() and carry on. Once
+    the bus is attached to an async_context, transactions run in the
+    background from the I2C interrupt, and a worker on that context calls
+    each one's completion callback and starts the next, so time-critical
+    transactions get the bus between two LCD writes. i2c_bus_transfer()
+    runs a transaction right away for drivers that need the result,
+    sleeping until it is done.
+
+    Only the core that attached the bus may use it once it is attached.
+
+    i2c_bus.c implements it for both the Pico and the host build; it
+    reaches the controllers only through the HAL's I2C calls (hal.h).
+*/
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdbool.h>
+#include "i2c_queue.h"
+
+struct async_context;   // pico/async_context.h
+
+/**
+ * @brief Initialize the I2C buses and their pins
+ *
+ * Safe to call from every driver's init; only the first call does anything.
+ */
+void i2c_bus_init(void);
+
+/**
+ * @brief Run queued transactions in the background on this core
+ *
+ * Installs the I2C interrupt handlers and an alarm pool on the calling
+ * core. Until this is called, i2c_bus_submit() runs each transaction
+ * right away with the SDK's blocking calls.
+ * @param context  async_context of the core that owns the buses
+ */
+void i2c_bus_attach(struct async_context *context);
+
+/**
+ * @brief Queue a transaction
+ *
+ * If the queue is full, the next queued transaction is run first to make room.
+ * @param txn  Transaction to copy in
+ */
+void i2c_bus_submit(const i2c_txn *txn);
+
+/**
+ * @brief Run a transaction now and wait for it
+ *
+ * Queued transactions of strictly higher priority run first; the rest wait.
+ * @param txn  Transaction
+ * @return Bytes transferred, or a negative value if the bus failed
+ */
+int i2c_bus_transfer(const i2c_txn *txn);
+
+/**
+ * @brief Check for transactions waiting to run or running
+ *
+ * @return true if any are queued or one is on the bus
+ */
+bool i2c_bus_pending(void);
+
+/**
+ * @brief Check for a transaction running in the background
+ *
+ * The clock must not change while one is, since the bus timing follows it.
+ * @return true if one is on the bus or between two of its chunks
+ */
+bool i2c_bus_busy(void);
+
+/**
+ * @brief Hold the buses in reset with their clock stopped until next used
+ *
+ * For the idle time between samples. The next transaction wakes the
+ * buses first, which takes a few microseconds. No effect while a
+ * transaction is running.
+ */
+void i2c_bus_sleep(void);
+
+/**
+ * @brief Reprogram the baud rates after clk_sys changes
+ */
+void i2c_bus_clock_changed(void);
+
+/**
+ * @brief Bus usage so far of a device
+ *
+ * @param device  Device
+ * @return Statistics; read-only
+ */
+const i2c_device_stats *i2c_bus_stats(i2c_device device);
+
+#endif // I2C_BUS_H
@@ -0,0 +1,92 @@
+/*
+File: i2c_queue.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Provides the prioritized I2C transaction queue and the per-device bus
+    statistics (see i2c_queue.h).
+
+Responsibilities:
+- Hold queued transactions in a fixed pool
+- Hand them out highest priority first, oldest first within a priority
+- Accumulate bus time, byte, error and queue wait statistics per device
+
+Requires the following modules:
+- i2c_queue.h: for interface definitions
+*/
+
+#include <string.h>
+#include "i2c_queue.h"
+
+void i2c_queue_init(i2c_queue *queue) {
+    memset(queue, 0, sizeof(*queue));
+}
+
+bool i2c_queue_push(i2c_queue *queue, const i2c_txn *txn, uint32_t now_us) {
+    for (size_t i = 0; i < I2C_QUEUE_MAX; i++) {
+        if (!queue->used[i]) {
+            queue->slots[i] = *txn;
+            queue->slots[i].queued_us = now_us;
+            queue->slots[i].seq = queue->next_seq++;
+            queue->used[i] = true;
+            queue->count++;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool i2c_queue_pop(i2c_queue *queue, i2c_priority max_priority, i2c_txn *out) {
+    int best = -1;
+    for (size_t i = 0; i < I2C_QUEUE_MAX; i++) {
+        if (!queue->used[i] || queue->slots[i].priority > max_priority) continue;
+        if (best < 0) {
+            best = (int)i;
+            continue;
+        }
+        const i2c_txn *a = &queue->slots[i];
+        const i2c_txn *b = &queue->slots[best];
+        // Sequence numbers may wrap; compare by difference
+        if (a->priority < b->priority ||
+            (a->priority == b->priority && (int32_t)(a->seq - b->seq) < 0)) {
+            best = (int)i;
+        }
+    }
+    if (best < 0) return false;
+
+    *out = queue->slots[best];
+    queue->used[best] = false;
+    queue->count--;
+    return true;
+}
+
+size_t i2c_queue_count(const i2c_queue *queue) {
+    return queue->count;
+}
+
+uint32_t i2c_txn_bytes(const i2c_txn *txn) {
+    return (uint32_t)txn->tx_len + txn->rx_len;
+}
+
+void i2c_stats_record(i2c_device_stats *stats, uint32_t wait_us, uint32_t bus_us,
+                      uint32_t cpu_us, uint32_t bytes, bool ok) {
+    stats->transactions++;
+    if (!ok) {
+        stats->errors++;
+    }
+    stats->bytes += bytes;
+    stats->bus_us += bus_us;
+    stats->cpu_us += cpu_us;
+    if (wait_us > stats->max_wait_us) {
+        stats->max_wait_us = wait_us;
+    }
+}
+
+const char *i2c_device_name(i2c_device device) {
+    switch (device) {
+        case I2C_DEV_DHT20: return "dht20";
+        case I2C_DEV_LCD:   return "lcd";
+        default:            return "unknown";
+    }
+}
@@ -0,0 +1,169 @@
+/*
+File: i2c_queue.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the I2C transaction queue and per-device
+    bus statistics used by the bus manager in i2c_bus.c.
+
+    A transaction is everything one device needs done in a single go:
+    bytes to write, optionally split into chunks with a wait after each
+    (the LCD latches a nibble per write), then bytes to read. Queued
+    transactions run highest priority first and in submission order
+    within a priority, so a sensor read never waits behind more than the
+    LCD transaction already on the bus.
+
+    This module has no hardware dependencies so it can be unit tested on
+    the host (see test_i2c_queue.c).
+*/
+
+#ifndef I2C_QUEUE_H
+#define I2C_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define I2C_QUEUE_MAX   40   // Queued transactions; one LCD frame is 35
+#define I2C_TXN_TX_MAX  6    // Bytes written per transaction
+#define I2C_TXN_RX_MAX  16   // Bytes read per transaction; one controller FIFO
+
+/**
+ * @brief Devices on the I2C buses
+ */
+typedef enum {
+    I2C_DEV_DHT20 = 0,      // Humidity sensor
+    I2C_DEV_LCD,            // LCD1602 behind a PCF8574 backpack
+    I2C_DEV_COUNT
+} i2c_device;
+
+/**
+ * @brief Transaction priority; lower values run first
+ */
+typedef enum {
+    I2C_PRIORITY_HIGH = 0,  // Time-critical (sensor trigger and read)
+    I2C_PRIORITY_LOW,       // Bulk output (LCD refresh)
+    I2C_PRIORITY_COUNT
+} i2c_priority;
+
+typedef struct i2c_txn i2c_txn;
+
+/**
+ * @brief Called when a queued transaction has finished
+ *
+ * @param txn     The transaction (a copy; rx points at the caller's buffer)
+ * @param result  Bytes transferred, or a negative value if the bus failed
+ * @param ctx     The transaction's ctx
+ */
+typedef void (*i2c_txn_done)(const i2c_txn *txn, int result, void *ctx);
+
+/**
+ * @brief One device transaction
+ */
+struct i2c_txn {
+    uint8_t device;                 // i2c_device, for priority and statistics
+    uint8_t priority;               // i2c_priority
+    uint8_t addr;                   // 7-bit device address
+    uint8_t tx_len;                 // Bytes in tx
+    uint8_t tx[I2C_TXN_TX_MAX];     // Bytes to write
+    uint8_t chunk;                  // Bytes per bus write (0 = all in one write)
+    uint8_t rx_len;                 // Bytes to read after the writes, up to I2C_TXN_RX_MAX
+    uint16_t gap_us;                // Wait after each write
+    uint16_t hold_us;               // Extra wait once the transaction is done
+    uint8_t *rx;                    // Where read bytes go
+    i2c_txn_done done;              // Completion callback, or NULL
+    void *ctx;                      // Passed to done
+    uint32_t queued_us;             // Set when queued
+    uint32_t seq;                   // Set when queued; orders transactions of equal priority
+};
+
+/**
+ * @brief Fixed pool of queued transactions
+ */
+typedef struct {
+    i2c_txn slots[I2C_QUEUE_MAX];
+    bool used[I2C_QUEUE_MAX];
+    uint8_t count;
+    uint32_t next_seq;
+} i2c_queue;
+
+/**
+ * @brief Bus usage of one device
+ */
+typedef struct {
+    uint32_t transactions;          // Transactions run
+    uint32_t errors;                // Of those, ones the bus reported as failed
+    uint32_t bytes;                 // Bytes written and read
+    uint64_t bus_us;                // Time holding the bus, including waits
+    uint64_t cpu_us;                // Of that, time the CPU spent driving the bus
+    uint32_t max_wait_us;           // Longest time a transaction waited in the queue
+} i2c_device_stats;
+
+/**
+ * @brief Empty the queue
+ *
+ * @param queue  Queue to set up
+ */
+void i2c_queue_init(i2c_queue *queue);
+
+/**
+ * @brief Queue a copy of a transaction
+ *
+ * @param queue   Queue
+ * @param txn     Transaction to copy in
+ * @param now_us  Current time, recorded as when it was queued
+ * @return false if the queue is full
+ */
+bool i2c_queue_push(i2c_queue *queue, const i2c_txn *txn, uint32_t now_us);
+
+/**
+ * @brief Take the next transaction to run
+ *
+ * Picks the highest priority, and the oldest within it, among the
+ * transactions whose priority is at least max_priority.
+ *
+ * @param queue         Queue
+ * @param max_priority  Lowest priority to consider (I2C_PRIORITY_LOW for any)
+ * @param out           Receives the transaction
+ * @return false if no transaction qualifies
+ */
+bool i2c_queue_pop(i2c_queue *queue, i2c_priority max_priority, i2c_txn *out);
+
+/**
+ * @brief Number of queued transactions
+ *
+ * @param queue  Queue
+ * @return Count
+ */
+size_t i2c_queue_count(const i2c_queue *queue);
+
+/**
+ * @brief Total bytes a transaction moves over the bus
+ *
+ * @param txn  Transaction
+ * @return Bytes written plus bytes read
+ */
+uint32_t i2c_txn_bytes(const i2c_txn *txn);
+
+/**
+ * @brief Add one finished transaction to a device's statistics
+ *
+ * @param stats    Device statistics
+ * @param wait_us  Time it waited in the queue
+ * @param bus_us   Time it held the bus
+ * @param cpu_us   CPU time spent starting it and in its interrupts
+ * @param bytes    Bytes it moved
+ * @param ok       Whether the bus reported success
+ */
+void i2c_stats_record(i2c_device_stats *stats, uint32_t wait_us, uint32_t bus_us,
+                      uint32_t cpu_us, uint32_t bytes, bool ok);
+
+/**
+ * @brief Get a short lowercase name for a device
+ *
+ * @param device  Device
+ * @return Constant string such as "dht20" or "lcd"
+ */
+const char *i2c_device_name(i2c_device device);
+
+#endif // I2C_QUEUE_H
@@ -0,0 +1,59 @@
+/*
+File: le_pack.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Helpers for the packed little-endian records that history.c
+    exports over HTTP, telemetry.c sends over UDP and network.c sends over
+    WebSocket. Readings travel as tenths in an int16_t, so the scaling and
+    clamping lives here too and every format rounds a value the same way.
+
+    Header only, with no hardware dependencies.
+*/
+
+#ifndef LE_PACK_H
+#define LE_PACK_H
+
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * @brief Store a 16-bit value little-endian
+ *
+ * @param out  Destination, two bytes, any alignment
+ * @param v    Value to store
+ */
+static inline void put_le16(void *out, uint16_t v) {
+    uint8_t *p = (uint8_t *)out;
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+/**
+ * @brief Store a 32-bit value little-endian
+ *
+ * @param out  Destination, four bytes, any alignment
+ * @param v    Value to store
+ */
+static inline void put_le32(void *out, uint32_t v) {
+    uint8_t *p = (uint8_t *)out;
+    put_le16(p, (uint16_t)v);
+    put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+/**
+ * @brief Scale a reading to tenths and clamp it to the int16_t range
+ *
+ * NaN, which converting to an integer would leave undefined, packs as
+ * INT16_MAX like any other out-of-range value.
+ * @param value  Reading, e.g. 45.25 for 45.25 %RH
+ * @return The value in tenths, e.g. 453
+ */
+static inline int16_t to_x10(float value) {
+    float scaled = roundf(value * 10.0f);
+    if (!(scaled <= INT16_MAX)) return INT16_MAX;  // Also catches NaN
+    if (scaled < INT16_MIN) return INT16_MIN;
+    return (int16_t)scaled;
+}
+
+#endif // LE_PACK_H
@@ -4,10 +4,12 @@ Language: C
 Author: Andrew Poon
 Date: 10/30/25
 Description: Provides initialization & control functionality for the
-    WS2812 RGB 8 LED Strip connected to the Raspberry Pi Pico.
+    WS2812 RGB 8 LED Strip connected to the Raspberry Pi Pico. Frames go
+    out through hal_leds_show() (hal_pico.c on the Pico, a simulated
+    strip in hal_linux.c on the host build).
 
-    Portions of low-level PIO setup and pixel packing logic were adapted from
-    the official Raspberry Pi Pico SDK "ws2812" pio example and is licensed as
+    Portions of the pixel packing logic were adapted from the official
+    Raspberry Pi Pico SDK "ws2812" pio example and is licensed as
     follows:
     Copyright (c) 2020 Raspberry Pi (Trading) Ltd.
     SPDX-License-Identifier: BSD-3-Clause
@@ -20,6 +22,7 @@ Responsibilities:
 
 Requires the following modules:
 - led_array.h: for interface definitions
+- hal.h: for the strip output and timing
 
 Wiring configuration
 ** WS2812 RGB 8 LED Strip **
@@ -29,18 +32,17 @@ GND  (pin 38)  -> GND on LED strip
 */
 
 #include "led_array.h"
-#include "pico/stdlib.h"
-#include "hardware/pio.h"
-#include "hardware/clocks.h"
-#include "ws2812.pio.h"
+#include "metrics.h"
+#include "hal.h"
 
-#define LED_PIN    2
 #define LED_COUNT  8
 
-static PIO pio = pio0;      // PIO block used to drive LEDs
-static int sm = -1;         // State machine index for LED control
 static uint32_t led_buf[LED_COUNT]; // Buffer holding LED color data
-static bool s_led_enabled = true;   // Private flag tracking LED output
+static volatile bool s_led_enabled = true;   // Private flag tracking LED output
+static volatile uint8_t s_brightness = 255;  // Level used for lit humidity LEDs
+static volatile bool s_redraw = false;       // Settings changed since the strip was drawn
+static void (*volatile s_on_change)(void) = NULL;  // Tells the owning core to redraw
+static uint8_t s_leds_on = 0;       // Number of LEDs lit by the last humidity update
 
 // Pack RGB into GRB order
 static inline uint32_t pack_grb(uint8_t r, uint8_t g, uint8_t b) {
@@ -58,9 +60,10 @@ static void hw_set_pixel(uint8_t i, uint8_t r, uint8_t g, uint8_t b) {
 
 // Send colors from memory buffer to LED strip
 static void hw_show(void) {
-    for (int i = 0; i < LED_COUNT; ++i)
-        pio_sm_put_blocking(pio, sm, led_buf[i] << 8);
-    sleep_us(100);
+    uint32_t start_us = hal_time_us();
+    hal_leds_show(led_buf, LED_COUNT);
+    metrics_count(METRIC_LED_FRAMES);
+    metrics_observe(METRIC_TIME_LED_SHOW, hal_time_us() - start_us);
 }
 
 // Clear all LEDs
@@ -71,18 +74,10 @@ static void hw_clear(void) {
 }
 
 bool led_array_init(void) {
-    // Load PIO program
-    uint offset = pio_add_program(pio, &ws2812_program);
-    if (offset == (uint)-1) {
-        return false;
-    }
-    // Claim unused state machine
-    sm = pio_claim_unused_sm(pio, false);
-    if (sm < 0) {
+    // Claim the strip output (PIO on the Pico)
+    if (!hal_leds_init()) {
         return false;
     }
-    // Initialize WS2812 driver at 800 kHz
-    ws2812_program_init(pio, sm, offset, LED_PIN, 800000, false);
 
     //  Clear all LEDs to start
     hw_clear();
@@ -93,9 +88,10 @@ bool led_array_init(void) {
 static void led_array_set(uint8_t leds_on) {
     if (leds_on > LED_COUNT)
         leds_on = LED_COUNT;
+    s_leds_on = leds_on;
     for (uint8_t i = 0; i < LED_COUNT; i++) {
         if (i < leds_on) {
-            hw_set_pixel(i, 0, 0, 255); // on
+            hw_set_pixel(i, 0, 0, s_brightness); // on
         }
         else {
             hw_set_pixel(i, 0, 0, 0);   // off
@@ -109,15 +105,53 @@ bool led_array_is_enabled(void) {
     return s_led_enabled;
 }
 
-// Enable or disable LED output on WS2812 strip
+// Enable or disable LED output on WS2812 strip. The strip is written by
+// led_array_update() on the core that owns it, not here.
 void led_array_set_enabled(bool enabled) {
     s_led_enabled = enabled;
-    if (!enabled) {
+    s_redraw = true;
+    if (s_on_change) s_on_change();
+}
+
+// Change the level of lit LEDs; the current humidity level is redrawn by led_array_update()
+void led_array_set_brightness(uint8_t brightness) {
+    s_brightness = brightness;
+    s_redraw = true;
+    if (s_on_change) s_on_change();
+}
+
+// Let the last frame finish before clk_sys changes under it
+void led_array_wait_idle(void) {
+    hal_leds_wait_idle();
+}
+
+// Keep the strip's bit timing after clk_sys changes
+void led_array_clock_changed(void) {
+    hal_leds_clock_changed();
+}
+
+// Register the function that schedules led_array_update() on the owning core
+void led_array_set_change_callback(void (*on_change)(void)) {
+    s_on_change = on_change;
+}
+
+// Redraw the strip after a settings change
+void led_array_update(void) {
+    if (!s_redraw) return;
+    s_redraw = false;
+    if (!s_led_enabled) {
         // Turn off LED strip
         hw_clear();
+    } else if (s_leds_on > 0) {
+        led_array_set(s_leds_on);
     }
 }
 
+// Return the level used for lit LEDs
+uint8_t led_array_get_brightness(void) {
+    return s_brightness;
+}
+
 // Convert humidity percentage (0–100) to LEDs (0-8)
 void humidity_to_leds(float humidity) {
     if (!s_led_enabled) {
@@ -156,13 +190,13 @@ void humidity_to_leds(float humidity) {
 // Loading visualization
 void led_array_show_loading(uint32_t ms_total) {
 
-    uint32_t start_time = to_ms_since_boot(get_absolute_time());
+    uint32_t start_time = hal_time_ms();
 
     // Run visualization until total duration elapsed
-    while (to_ms_since_boot(get_absolute_time()) - start_time < ms_total) {
+    while (hal_time_ms() - start_time < ms_total) {
 
         // Compute current position of moving LED
-        uint32_t elapsed = to_ms_since_boot(get_absolute_time()) / 60;
+        uint32_t elapsed = hal_time_ms() / 60;
         int position = elapsed % (LED_COUNT * 2 - 2);
         if (position >= LED_COUNT)
             position = (LED_COUNT * 2 - 2) - position;
@@ -172,16 +206,16 @@ void led_array_show_loading(uint32_t ms_total) {
             hw_set_pixel(i, 0, 0, 0);
         hw_set_pixel(position, 255, 255, 0);
         hw_show();
-        sleep_ms(16);
+        hal_sleep_ms(16);
     }
 }
 
 // Error visualization
 void led_array_show_error(uint8_t code, uint32_t ms_total) {
 
-    uint32_t start_time = to_ms_since_boot(get_absolute_time());
+    uint32_t start_time = hal_time_ms();
 
-    while (to_ms_since_boot(get_absolute_time()) - start_time < ms_total) {
+    while (hal_time_ms() - start_time < ms_total) {
 
         uint8_t leds_to_light = code;
         if (leds_to_light > LED_COUNT)
@@ -197,10 +231,10 @@ void led_array_show_error(uint8_t code, uint32_t ms_total) {
 
         // Show the pattern
         hw_show();
-        sleep_ms(180);
+        hal_sleep_ms(180);
 
         // Turn off pattern
         hw_clear();
-        sleep_ms(180);
+        hal_sleep_ms(180);
     }
 }
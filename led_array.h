@@ -37,7 +37,9 @@ void humidity_to_leds(float humidity);
  * @brief Enable or disable LED array output
  *
  * When disabled, all LEDs are turned off and humidity_to_leds()
- * will not illuminate anything until re-enabled.
+ * will not illuminate anything until re-enabled. May be called from
+ * either core or an interrupt; the strip changes on the next
+ * led_array_update().
  * @param enabled true to enable LED output, false to disable
  */
 void led_array_set_enabled(bool enabled);
@@ -52,6 +54,53 @@ void led_array_set_enabled(bool enabled);
  */
 bool led_array_is_enabled(void);
 
+/**
+ * @brief Set the brightness used for the humidity display
+ *
+ * Takes effect on the next led_array_update() if LEDs are enabled and
+ * showing humidity. May be called from either core or an interrupt.
+ * @param brightness Blue channel level for lit LEDs (0–255)
+ */
+void led_array_set_brightness(uint8_t brightness);
+
+/**
+ * @brief Apply enable and brightness changes to the strip
+ *
+ * Only the core that drives the strip (the one calling humidity_to_leds())
+ * may call this, so the two cores never write the PIO FIFO at once.
+ */
+void led_array_update(void);
+
+/**
+ * @brief Wait until the strip has sent everything queued for it
+ *
+ * Call on the core that drives the strip, before changing clk_sys.
+ */
+void led_array_wait_idle(void);
+
+/**
+ * @brief Keep the strip's bit timing after clk_sys changes
+ *
+ * Call on the core that drives the strip, after every clk_sys change.
+ */
+void led_array_clock_changed(void);
+
+/**
+ * @brief Register a function called after every enable or brightness change
+ *
+ * Called from whichever core or interrupt made the change, so it should
+ * only schedule led_array_update() on the core that drives the strip.
+ * @param on_change Function to call, or NULL for none
+ */
+void led_array_set_change_callback(void (*on_change)(void));
+
+/**
+ * @brief Get the brightness used for the humidity display
+ *
+ * @return Blue channel level for lit LEDs (0–255)
+ */
+uint8_t led_array_get_brightness(void);
+
 /**
  * @brief Display a loading "ping pong" animation pattern
  *
@@ -39,6 +39,9 @@ Description:
 #define MEM_SIZE                    4000
 #endif
 #define MEMP_NUM_TCP_SEG            32
+// One PCB per keep-alive client (HTTP_MAX_CLIENTS), the listener and the MQTT client
+#define MEMP_NUM_TCP_PCB            8
+#define TCP_LISTEN_BACKLOG          1
 #define MEMP_NUM_ARP_QUEUE          10
 #define PBUF_POOL_SIZE              24
 #define LWIP_ARP                    1
@@ -53,13 +56,19 @@ Description:
 #define LWIP_NETIF_LINK_CALLBACK    1
 #define LWIP_NETIF_HOSTNAME         1
 #define LWIP_NETCONN                0
-#define MEM_STATS                   0
+// Heap and pool usage are reported at /metrics, so these stay on in release builds
+#define LWIP_STATS                  1
+#define MEM_STATS                   1
 #define SYS_STATS                   0
-#define MEMP_STATS                  0
+#define MEMP_STATS                  1
 #define LINK_STATS                  0
 // #define ETH_PAD_SIZE                2
 #define LWIP_CHKSUM_ALGORITHM       3
 #define LWIP_DHCP                   1
+// mDNS listens on the 224.0.0.251 multicast group
+#define LWIP_IGMP                   1
+// DHCP client, DNS, the AP's DHCP server, UDP telemetry and mDNS
+#define MEMP_NUM_UDP_PCB            6
 #define LWIP_IPV4                   1
 #define LWIP_TCP                    1
 #define LWIP_UDP                    1
@@ -68,10 +77,15 @@ Description:
 #define LWIP_NETIF_TX_SINGLE_PBUF   1
 #define DHCP_DOES_ARP_CHECK         0
 #define LWIP_DHCP_DOES_ACD_CHECK    0
+// MQTT client: its cyclic timer plus the reconnect timer in network.c;
+// the WiFi station poll timer and the mDNS announcement timer
+#define MEMP_NUM_SYS_TIMEOUT        (LWIP_NUM_SYS_TIMEOUT_INTERNAL + 4)
+#define MQTT_OUTPUT_RINGBUF_SIZE    1024
+// Enough request slots for a full outbox (MQTT_OUTBOX_LEN) plus the subscribe
+#define MQTT_REQ_MAX_IN_FLIGHT      9
 
 #ifndef NDEBUG
 #define LWIP_DEBUG                  1
-#define LWIP_STATS                  1
 #define LWIP_STATS_DISPLAY          1
 #endif
 
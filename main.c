@@ -3,19 +3,26 @@ File: main.c
 Language: C
 Author: Trevor Carlyle
 Date: 10/29/25
-Last Updated: 11/9/25
+Last Updated: 10/18/26
 Description: Entry point for the Humidity Sensor project using Raspberry Pi Pico.
 
 Responsibilities:
 - Initialize hardware and subsystems (sensor, display, LED array)
-- Periodically read humidity from the sensor
-- Update the LED array and display with the current humidity
+- Periodically read humidity from the sensor on drift-free deadlines (core 1)
+- Update the LED array and display with the current humidity (core 1)
+- Hand each sample to core 0, which runs WiFi and the network services
+- Run the work on each core as async_context workers, timing every run
+- Lower the system clock while core 1 is idle or no network client is connected
 - Implements error handling
 
 Assumes the following modules exist:
 - sensor.c / sensor.h: for reading humidity values
 - display.c / display.h: for updating the screen display
 - led_array.c / led_array.h: for controlling the 8-stage LED array
+- sample_ring.c / sample_ring.h: for passing samples from core 1 to core 0
+- snapshot.c / snapshot.h: for sharing the latest reading with network.c
+- power.c / power.h: for lowering the clocks while there is nothing to do
+- i2c_bus.c / i2c_bus.h: for running the LCD's bus writes between other work
 */
 
 // Include standard libraries
@@ -24,31 +31,338 @@ Assumes the following modules exist:
 #include <stdint.h>
 #include <stdbool.h>
 #include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/async_context_poll.h"
 
 // Include project files
 #include "sensor.h"     // Sensor interface (sensor.c/.h)
 #include "display.h"    // Display interface (display.c/.h)
 #include "led_array.h"  // LED array interface (led_array.c/.h)
+#include "metrics.h"    // Performance counters (metrics.c/.h)
+#include "sample_ring.h" // Core 1 to core 0 hand-off (sample_ring.c/.h)
+#include "snapshot.h"   // Latest reading shared with network.c (snapshot.c/.h)
+#include "power.h"      // Clock scaling between samples (power.c/.h)
+#include "i2c_bus.h"    // Shared I2C bus and transaction queue (i2c_bus.c/.h)
 
 // Optional WiFi feature toggle (only use with Pico2W)
 #ifdef ENABLE_WIFI
 #include "network.h"
+#include "history.h"
+#include "pico/flash.h"
 #endif
 
-// Globals shared with network.c
-float g_latest_humidity = 0.0f;
-float g_latest_temp_f   = 0.0f;
+// Latest reading, shared with network.c. Only publish_sample() writes it.
+snapshot_seqlock g_latest;
 
 // Constants
 // Checks every 2 seconds, can be adjusted as needed.
 #define HUMIDITY_CHECK_INTERVAL_MS 2000
-#define SLEEP_MS 5000
+#ifndef SLEEP_MS
+#define SLEEP_MS 5000              // Time to open the serial console before the first output
+#endif
+#define WIFI_SERVICE_MS 100        // How often core 0 runs WiFi housekeeping
+#define POWER_REPORT_MS 60000      // How often non-WiFi builds print the power statistics
+
+// Sampling interval, adjustable at runtime from the web interface (network.c)
+volatile uint32_t g_sample_interval_ms = HUMIDITY_CHECK_INTERVAL_MS;
+
+// Samples travel from core 1 (sensor, LCD, LEDs) to core 0 (network) through this ring
+static sample_ring s_samples;
+
+// Each core runs its work as async_context workers and sleeps in between.
+// Core 1: sample timer -> sensor ready -> display flush and LED frame, with the
+// sensor's I2C transfers finishing in the background in between (i2c_bus.c).
+// Core 0: network events (and the WiFi service timer in WiFi builds).
+static async_context_poll_t s_core0;
+static async_context_poll_t s_core1;
+
+// Core 1 sampling state, kept between samples so a failed read leaves the last good values
+static dht_reading s_reading;
+static uint32_t s_seq = 0;
+static uint32_t s_sample_ms = 0;
+static dht_status s_trigger_status;      // Result of the trigger for the measurement in progress
+static uint32_t s_trigger_us;            // Time the trigger transfer took
+static uint32_t s_trigger_start_us;      // When the trigger was queued
+static uint32_t s_read_start_us;         // When the read was queued
+static absolute_time_t s_next_sample;    // Deadline of the next sample timer run
+static bool s_leds_new_sample;           // LED frame should show a new humidity level
+
+static void sample_timer_work(async_context_t *context, async_at_time_worker_t *worker);
+static void sensor_ready_work(async_context_t *context, async_at_time_worker_t *worker);
+static void display_flush_work(async_context_t *context, async_when_pending_worker_t *worker);
+static void led_frame_work(async_context_t *context, async_when_pending_worker_t *worker);
+static void network_events_work(async_context_t *context, async_when_pending_worker_t *worker);
+
+static async_at_time_worker_t s_sample_timer = { .do_work = sample_timer_work };
+static async_at_time_worker_t s_sensor_ready = { .do_work = sensor_ready_work };
+static async_when_pending_worker_t s_display_flush = { .do_work = display_flush_work };
+static async_when_pending_worker_t s_led_frame = { .do_work = led_frame_work };
+static async_when_pending_worker_t s_network_events = { .do_work = network_events_work };
+
+// Core 1, once the trigger is on the bus: come back when the measurement is ready
+static void trigger_done(dht_status status) {
+    s_trigger_status = status;
+    s_trigger_us = time_us_32() - s_trigger_start_us;
+    async_context_add_at_time_worker_in_ms(&s_core1.core, &s_sensor_ready,
+                                           status == DHT_STATUS_OK ? SLEEP_TIME : 0);
+}
+
+// Core 1, on absolute deadlines: start a measurement and come back when it is ready
+static void sample_timer_work(async_context_t *context, async_at_time_worker_t *worker) {
+    uint32_t start_us = time_us_32();
+
+    // Trigger a measurement on the DHT20 (sensor.c/.h); the trigger goes out in the
+    // background and the core is free while the sensor measures
+    s_trigger_start_us = start_us;
+    dht_start_measurement_async(trigger_done);
+
+    // The next deadline follows from this one, not from when the work finished,
+    // so the interval doesn't drift. After a stall, start again from now.
+    s_next_sample = delayed_by_ms(s_next_sample, g_sample_interval_ms);
+    if (absolute_time_diff_us(get_absolute_time(), s_next_sample) <= 0) {
+        metrics_count(METRIC_SAMPLES_LATE);
+        s_next_sample = make_timeout_time_ms(g_sample_interval_ms);
+    }
+    async_context_add_at_time_worker_at(context, worker, s_next_sample);
+
+    metrics_observe(METRIC_TIME_WORKER_SAMPLE, time_us_32() - start_us);
+}
+
+static void sample_ready(dht_status status);
+
+// Core 1: collect the measurement in the background
+static void sensor_ready_work(async_context_t *context, async_at_time_worker_t *worker) {
+    (void)context;
+    (void)worker;
+
+    // Read humidity and temperature from DHT20 (sensor.c/.h)
+    s_read_start_us = time_us_32();
+    if (s_trigger_status == DHT_STATUS_OK) {
+        dht_read_measurement_async(&s_reading, sample_ready);
+    } else {
+        sample_ready(s_trigger_status);
+    }
+}
+
+// Core 1, once the read is done: hand the sample to core 0, then the LCD and LEDs
+static void sample_ready(dht_status status) {
+    uint32_t start_us = time_us_32();
+    metrics_observe(METRIC_TIME_DHT_READ, s_trigger_us + (start_us - s_read_start_us));
+
+    if (status == DHT_STATUS_OK) {
+        s_sample_ms = to_ms_since_boot(get_absolute_time());
+        if (s_sample_ms == 0) {
+            s_sample_ms = 1;   // Reserve 0 for "no sample yet"
+        }
+    } else {
+        printf("WARNING: Sensor read failed (%s)\n", dht_status_name(status));
+    }
+
+    // Publish before the slow LCD update so core 0 serves the new reading right away
+    ring_sample sample = {
+        .seq = ++s_seq,
+        .sample_ms = s_sample_ms,
+        .humidity = s_reading.humidity,
+        .temp_c = s_reading.temp_celsius,
+        .temp_f = s_reading.temp_fahrenheit,
+        .status = (uint8_t)status,
+        .produced_us = time_us_32(),
+    };
+    if (!sample_ring_push(&s_samples, &sample)) {
+        metrics_count(METRIC_SAMPLES_DROPPED);
+    }
+    async_context_set_work_pending(&s_core0.core, &s_network_events);
+
+    // Print only humidity to output
+    printf("Humidity: %.1f%%\n", s_reading.humidity);
+    s_leds_new_sample = true;
+    async_context_set_work_pending(&s_core1.core, &s_display_flush);
+    async_context_set_work_pending(&s_core1.core, &s_led_frame);
+
+    metrics_observe(METRIC_TIME_WORKER_SENSOR, time_us_32() - start_us);
+}
+
+// Core 1: show the latest reading on the LCD
+static void display_flush_work(async_context_t *context, async_when_pending_worker_t *worker) {
+    (void)context;
+    (void)worker;
+    uint32_t start_us = time_us_32();
+
+    // Update the LCD display (display.c/.h)
+    display_show_reading(s_reading.humidity, s_reading.temp_fahrenheit);
+    metrics_count(METRIC_LCD_FRAMES);
+    metrics_observe(METRIC_TIME_DISPLAY, time_us_32() - start_us);
+
+    metrics_observe(METRIC_TIME_WORKER_DISPLAY, time_us_32() - start_us);
+}
+
+// Core 1: draw a new humidity level or LED settings changed from core 0
+static void led_frame_work(async_context_t *context, async_when_pending_worker_t *worker) {
+    (void)context;
+    (void)worker;
+    uint32_t start_us = time_us_32();
+
+    // Update the LED array (led_array.c/.h)
+    if (s_leds_new_sample) {
+        s_leds_new_sample = false;
+        humidity_to_leds(s_reading.humidity);
+    }
+    led_array_update();
+
+    metrics_observe(METRIC_TIME_WORKER_LEDS, time_us_32() - start_us);
+}
+
+// Called by led_array.c from whichever core changed the LED settings
+static void leds_changed(void) {
+    async_context_set_work_pending(&s_core1.core, &s_led_frame);
+}
+
+// Clock state for core 1's situation (power.c/.h)
+static power_state power_wanted(bool awake) {
+#ifdef ENABLE_WIFI
+    return power_policy_state(true, awake, web_server_client_count() > 0);
+#else
+    return power_policy_state(false, awake, false);
+#endif
+}
+
+#ifdef ENABLE_WIFI
+// Nothing to do here: waking core 1 is enough for its loop to raise the clock
+static void client_connected_work(async_context_t *context, async_when_pending_worker_t *worker) {
+    (void)context;
+    (void)worker;
+}
+
+static async_when_pending_worker_t s_client_connected = { .do_work = client_connected_work };
+
+// Called by network.c on core 0 when an HTTP client connects
+static void client_connected(void) {
+    async_context_set_work_pending(&s_core1.core, &s_client_connected);
+}
+#else
+// Without /metrics, print the time in each power state now and then
+static void power_report_work(async_context_t *context, async_at_time_worker_t *worker) {
+    power_report();
+    async_context_add_at_time_worker_in_ms(context, worker, POWER_REPORT_MS);
+}
+
+static async_at_time_worker_t s_power_report = { .do_work = power_report_work };
+#endif
+
+// Core 1: the acquisition and output path. Its I2C and LCD waits no longer
+// hold up the WiFi and lwIP work on core 0.
+static void core1_main(void) {
+#ifdef ENABLE_WIFI
+    // Let core 0 pause this core while it writes the WiFi cache to flash
+    flash_safe_execute_core_init();
+#endif
+
+    if (!async_context_poll_init_with_defaults(&s_core1)) {
+        printf("ERROR: Failed to create the core 1 async context!\n");
+        return;
+    }
+    async_context_add_when_pending_worker(&s_core1.core, &s_display_flush);
+    async_context_add_when_pending_worker(&s_core1.core, &s_led_frame);
+    i2c_bus_attach(&s_core1.core);   // I2C transfers now run in the background on this core
+    led_array_set_change_callback(leds_changed);
+#ifdef ENABLE_WIFI
+    async_context_add_when_pending_worker(&s_core1.core, &s_client_connected);
+    web_server_set_connect_callback(client_connected);
+#else
+    async_context_add_at_time_worker_in_ms(&s_core1.core, &s_power_report, POWER_REPORT_MS);
+#endif
+
+    // First sample right away; later ones every g_sample_interval_ms from here
+    s_next_sample = get_absolute_time();
+    async_context_add_at_time_worker_at(&s_core1.core, &s_sample_timer, s_next_sample);
+
+    // Run workers as they become due, sleeping in between. Core 1 owns the
+    // I2C buses and the LED strip, so it is the one that changes the clock.
+    power_init();
+    while (true) {
+        async_context_poll(&s_core1.core);
+        // A transfer running in the background would be re-timed mid-byte;
+        // its completion wakes this loop, which switches afterwards
+        if (!i2c_bus_busy()) {
+            power_enter(power_wanted(i2c_bus_pending()));
+        }
+        // Nothing queued until the next sample or display update: stop the
+        // I2C controllers too, not just slow them down
+        if (!i2c_bus_pending()) {
+            i2c_bus_sleep();
+        }
+        async_context_wait_for_work_until(&s_core1.core, at_the_end_of_time);
+        if (!i2c_bus_busy()) {
+            power_enter(power_wanted(true));
+        }
+    }
+}
+
+// Core 0: make a sample from core 1 the latest reading and push it to clients
+static void publish_sample(const ring_sample *sample) {
+    metrics_observe(METRIC_TIME_CORE_HANDOFF, time_us_32() - sample->produced_us);
+
+    // Store latest readings for the web UI. A failed read keeps the last
+    // good values but still publishes its status and sequence number.
+    static reading_snapshot latest = { .status = DHT_STATUS_BUSY };
+    latest.seq    = sample->seq;
+    latest.status = sample->status;
+    if (sample->status == DHT_STATUS_OK) {
+        latest.humidity  = sample->humidity;
+        latest.temp_c    = sample->temp_c;
+        latest.temp_f    = sample->temp_f;
+        latest.sample_ms = sample->sample_ms;
+    }
+    snapshot_publish(&g_latest, &latest);
+
+#ifdef ENABLE_WIFI
+    if (sample->status == DHT_STATUS_OK) {
+        // Keep the sample for the history export (history.c/.h)
+        history_add(sample->sample_ms, sample->humidity, sample->temp_c);
+    }
+
+    // Push the new reading to open web pages (network.c/.h)
+    web_server_publish_reading();
+    udp_telemetry_publish();
+    mqtt_telemetry_publish();
+#endif
+}
+
+// Core 0, woken by core 1: publish every sample waiting in the ring
+static void network_events_work(async_context_t *context, async_when_pending_worker_t *worker) {
+    (void)context;
+    (void)worker;
+    uint32_t start_us = time_us_32();
+
+    ring_sample sample;
+    while (sample_ring_pop(&s_samples, &sample)) {
+        publish_sample(&sample);
+    }
+
+    metrics_observe(METRIC_TIME_WORKER_NETWORK, time_us_32() - start_us);
+}
+
+#ifdef ENABLE_WIFI
+// Core 0: station mode reconnects and other periodic WiFi work (network.c/.h)
+static void wifi_service_work(async_context_t *context, async_at_time_worker_t *worker) {
+    uint32_t start_us = time_us_32();
+    wifi_service();
+    async_context_add_at_time_worker_in_ms(context, worker, WIFI_SERVICE_MS);
+    metrics_observe(METRIC_TIME_WORKER_WIFI, time_us_32() - start_us);
+}
+
+static async_at_time_worker_t s_wifi_service = { .do_work = wifi_service_work };
+#endif
 
 int main() {
     stdio_init_all(); // Initialize stdio
     sleep_ms(SLEEP_MS);
     printf("Raspberry Pi Humidity Sensor: Initializing hardware...\n");
 
+    // Nothing has been sampled yet; readers see this until the first publish
+    const reading_snapshot none = { .status = DHT_STATUS_BUSY };
+    snapshot_init(&g_latest, &none);
+
     // Initialize the DHT20 humidity sensor (sensor.c/.h)
     if (!dht_init()) {
         printf("ERROR: Failed to initialize humidity sensor!\n");
@@ -72,9 +386,31 @@ int main() {
         return 1;
     }
 
+    // Core 0's workers must exist before core 1 can wake them
+    if (!async_context_poll_init_with_defaults(&s_core0)) {
+        printf("ERROR: Failed to create the core 0 async context!\n");
+        return 1;
+    }
+    async_context_add_when_pending_worker(&s_core0.core, &s_network_events);
+
+    // Start sampling on core 1 (sensor, LCD and LEDs); core 0 goes on to the network
+    sample_ring_init(&s_samples);
+    multicore_launch_core1(core1_main);
+
 // Start WiFi access point and web server
 // This block only runs when compile time flag ENABLE_WIFI is used
 #ifdef ENABLE_WIFI
+#ifdef WIFI_SSID
+    // Join an existing network, falling back to the access point (set WIFI_SSID when configuring)
+    if (!wifi_start_sta(WIFI_SSID, WIFI_PASSWORD, "PICO2W-AP", "capstone467")) {
+        printf("ERROR: Failed to start WiFi station mode.\n");
+    } else {
+        if (!web_server_start(80)) {
+            printf("ERROR: Failed to start web server.\n");
+        } else {
+            printf("Joining '%s'. Once connected, open http://%s.local/\n", WIFI_SSID, MDNS_HOSTNAME);
+        }
+#else
     if (!wifi_start_ap("PICO2W-AP", "capstone467")) {
         printf("ERROR: Failed to start WiFi access point.\n");
     } else {
@@ -83,44 +419,37 @@ int main() {
         } else {
             printf("WiFi AP active. Connect to SSID 'PICO2W-AP' and open http://192.168.4.1/\n");
         }
+#endif
+        // Let clients find the device as <MDNS_HOSTNAME>.local (network.c/.h)
+        if (!mdns_start(MDNS_HOSTNAME, 80)) {
+            printf("ERROR: Failed to start mDNS responder.\n");
+        }
+#ifdef UDP_TELEMETRY_ADDR
+        // Optional UDP push of each sample (set UDP_TELEMETRY_ADDR when configuring)
+        if (!udp_telemetry_start(UDP_TELEMETRY_ADDR, UDP_TELEMETRY_PORT, UDP_TELEMETRY_BATCH)) {
+            printf("ERROR: Failed to start UDP telemetry.\n");
+        }
+#endif
+#ifdef MQTT_BROKER
+        // Optional MQTT publishing and control (set MQTT_BROKER when configuring)
+        if (!mqtt_telemetry_start(MQTT_BROKER, MQTT_BROKER_PORT, MQTT_TOPIC_ROOT, MQTT_QOS)) {
+            printf("ERROR: Failed to start MQTT client.\n");
+        }
+#endif
     }
 #endif
 
     printf("Initialization complete. Entering main loop.\n");
 
-    // Main loop
+#ifdef ENABLE_WIFI
+    async_context_add_at_time_worker_in_ms(&s_core0.core, &s_wifi_service, 0);
+#endif
+
+    // Main loop: core 0 publishes what core 1 measures, sleeping until a
+    // sample arrives or a timer is due
     while (true) {
-        // Structure to hold sensor readings (sensor.c/.h)
-        dht_reading reading;
-        // Read humidity and temperature from DHT20 (sensor.c/.h)
-        read_from_dht(&reading);
-
-        // Store latest readings for the web UI
-        g_latest_humidity = reading.humidity;
-        g_latest_temp_f   = reading.temp_fahrenheit;
-
-        // Print only humidity to output
-        printf("Humidity: %.1f%%\n", reading.humidity);
-        // Update the LCD display (display.c/.h)
-        display_clear(); // Clear previous display
-        display_set_cursor(0, 0); // Go to the top line of display
-        char line1[17]; // Declare an array line1
-        // Format a string with the current humidity value and stores it in line1
-        snprintf(line1, sizeof(line1), "Humidity: %.1f%%", reading.humidity);
-        // Use display_print from (display.c/.h)
-        display_print(line1);
-
-        // Display temperature in fahrenheit on LCD
-        display_set_cursor(0, 1);
-        char line2[17];
-        snprintf(line2, sizeof(line2), "Temp: %.1fF", reading.temp_fahrenheit);
-        display_print(line2);
-
-        // Update the LED array (led_array.c/.h)
-        humidity_to_leds(reading.humidity);
-    
-        // Wait before next check
-        sleep_ms(HUMIDITY_CHECK_INTERVAL_MS);
+        async_context_poll(&s_core0.core);
+        async_context_wait_for_work_until(&s_core0.core, at_the_end_of_time);
     }
 
     // Should never reach here
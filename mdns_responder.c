@@ -0,0 +1,481 @@
+/*
+File: mdns_responder.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Provides the multicast DNS responder (RFC 6762) and DNS-SD service
+    records (RFC 6763) used by network.c. The device owns four names:
+
+        <host>.local                    A    its address
+        _http._tcp.local                PTR  -> <host>._http._tcp.local
+        <host>._http._tcp.local         SRV  -> <host>.local:<port>, and TXT
+        _services._dns-sd._udp.local    PTR  -> _http._tcp.local
+
+    The cached packets are written without name compression, so a one-shot
+    reply can be assembled by copying a cached packet behind the echoed
+    question without rewriting any offsets.
+
+Responsibilities:
+- Encode the records into one cached response per kind of question
+- Parse queries and pick the cached response that answers them
+- Limit how often the same response is multicast
+- Build replies to one-shot (legacy unicast) queries
+
+Requires the following modules:
+- mdns_responder.h: for interface definitions
+*/
+
+#include "mdns_responder.h"
+
+#include <string.h>
+
+// DNS message layout
+#define DNS_ID          0
+#define DNS_FLAGS       2
+#define DNS_QDCOUNT     4
+#define DNS_ANCOUNT     6
+#define DNS_NSCOUNT     8
+#define DNS_ARCOUNT     10
+#define DNS_HEADER_LEN  12
+
+#define DNS_FLAG_QR         0x8000  // Message is a response
+#define DNS_FLAG_AA         0x0400  // Authoritative answer
+#define DNS_OPCODE_MASK     0x7800
+
+#define DNS_TYPE_A      1
+#define DNS_TYPE_PTR    12
+#define DNS_TYPE_TXT    16
+#define DNS_TYPE_SRV    33
+#define DNS_TYPE_ANY    255
+
+#define DNS_CLASS_IN        1
+#define DNS_CLASS_ANY       255
+#define DNS_CLASS_MASK      0x7FFF
+#define MDNS_CACHE_FLUSH    0x8000  // In a record's class: replaces cached records of this name
+#define MDNS_UNICAST_REPLY  0x8000  // In a question's class: the asker wants a unicast reply
+
+#define DNS_NAME_MAX    256     // Longest dotted name read from a query
+#define DNS_JUMPS_MAX   16      // Compression pointers followed per name
+
+#define SERVICE_NAME    "_http._tcp.local"
+#define ENUM_NAME       "_services._dns-sd._udp.local"
+
+// Records, as bits so each cached answer can list the ones it carries
+enum {
+    REC_A       = 1 << 0,
+    REC_PTR     = 1 << 1,
+    REC_SRV     = 1 << 2,
+    REC_TXT     = 1 << 3,
+    REC_ENUM    = 1 << 4,
+};
+
+// Answer and additional records of each cached response
+static const struct {
+    uint8_t answers;
+    uint8_t additional;
+} ANSWER_RECORDS[MDNS_ANSWER_COUNT] = {
+    [MDNS_ANSWER_HOST]    = { REC_A, 0 },
+    [MDNS_ANSWER_BROWSE]  = { REC_PTR, REC_SRV | REC_TXT | REC_A },
+    [MDNS_ANSWER_SERVICE] = { REC_SRV | REC_TXT, REC_A },
+    [MDNS_ANSWER_ENUM]    = { REC_ENUM, 0 },
+    [MDNS_ANSWER_ALL]     = { REC_A | REC_PTR | REC_SRV | REC_TXT | REC_ENUM, 0 },
+};
+
+static void put_u16(uint8_t *out, uint16_t v) {
+    out[0] = (uint8_t)(v >> 8);
+    out[1] = (uint8_t)v;
+}
+
+static uint16_t get_u16(const uint8_t *in) {
+    return (uint16_t)((in[0] << 8) | in[1]);
+}
+
+static void put_u32(uint8_t *out, uint32_t v) {
+    put_u16(out, (uint16_t)(v >> 16));
+    put_u16(out + 2, (uint16_t)v);
+}
+
+static uint32_t get_u32(const uint8_t *in) {
+    return ((uint32_t)get_u16(in) << 16) | get_u16(in + 2);
+}
+
+static bool valid_host(const char *host) {
+    size_t len = strlen(host);
+    if (len == 0 || len > MDNS_LABEL_MAX || host[0] == '-') {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        char c = host[i];
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                  (c >= '0' && c <= '9') || c == '-';
+        if (!ok) return false;
+    }
+    return true;
+}
+
+bool mdns_responder_init(mdns_responder *r, const char *host, uint16_t port,
+                         const char *const *txt, size_t txt_count) {
+    memset(r, 0, sizeof(*r));
+    if (!valid_host(host)) {
+        return false;
+    }
+    strcpy(r->host, host);
+    r->port = port;
+
+    // Each TXT string is a length byte followed by the text
+    size_t pos = 0;
+    for (size_t i = 0; i < txt_count; i++) {
+        size_t len = strlen(txt[i]);
+        if (len == 0 || len > 255 || pos + 1 + len > MDNS_TXT_MAX) {
+            return false;
+        }
+        r->txt[pos++] = (uint8_t)len;
+        memcpy(&r->txt[pos], txt[i], len);
+        pos += len;
+    }
+    if (pos == 0) {
+        r->txt[pos++] = 0;  // An empty TXT record still holds one empty string
+    }
+    r->txt_len = (uint8_t)pos;
+    return true;
+}
+
+// Output buffer for building a packet; further writes are dropped once full
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    bool overflow;
+} writer;
+
+static uint8_t *reserve(writer *w, size_t n) {
+    if (w->overflow || w->len + n > MDNS_MSG_MAX) {
+        w->overflow = true;
+        return NULL;
+    }
+    uint8_t *p = &w->buf[w->len];
+    w->len += n;
+    return p;
+}
+
+// Encoded length of a dotted name: one length byte per label plus the root
+static size_t name_len(const char *name) {
+    return strlen(name) + 2;
+}
+
+static void put_name(writer *w, const char *name) {
+    uint8_t *p = reserve(w, name_len(name));
+    if (!p) return;
+    while (*name) {
+        const char *dot = strchr(name, '.');
+        size_t label = dot ? (size_t)(dot - name) : strlen(name);
+        *p++ = (uint8_t)label;
+        memcpy(p, name, label);
+        p += label;
+        name += label + (dot ? 1 : 0);
+    }
+    *p = 0;
+}
+
+static void put_record_head(writer *w, const char *name, uint16_t type, uint16_t cls,
+                            uint32_t ttl, uint16_t rdlen) {
+    put_name(w, name);
+    uint8_t *p = reserve(w, 10);
+    if (!p) return;
+    put_u16(p, type);
+    put_u16(p + 2, cls);
+    put_u32(p + 4, ttl);
+    put_u16(p + 8, rdlen);
+}
+
+static void put_record(writer *w, const mdns_responder *r, uint8_t record) {
+    char host[MDNS_LABEL_MAX + sizeof(".local")];
+    char instance[MDNS_LABEL_MAX + sizeof("." SERVICE_NAME)];
+    strcpy(host, r->host);
+    strcat(host, ".local");
+    strcpy(instance, r->host);
+    strcat(instance, "." SERVICE_NAME);
+
+    uint8_t *p;
+    switch (record) {
+        case REC_A:
+            put_record_head(w, host, DNS_TYPE_A, DNS_CLASS_IN | MDNS_CACHE_FLUSH,
+                            MDNS_HOST_TTL_S, 4);
+            if ((p = reserve(w, 4)) != NULL) {
+                memcpy(p, r->ip, 4);
+            }
+            break;
+
+        case REC_PTR:
+            // Shared record: other devices offer the same service type
+            put_record_head(w, SERVICE_NAME, DNS_TYPE_PTR, DNS_CLASS_IN, MDNS_SERVICE_TTL_S,
+                            (uint16_t)name_len(instance));
+            put_name(w, instance);
+            break;
+
+        case REC_SRV:
+            put_record_head(w, instance, DNS_TYPE_SRV, DNS_CLASS_IN | MDNS_CACHE_FLUSH,
+                            MDNS_HOST_TTL_S, (uint16_t)(6 + name_len(host)));
+            if ((p = reserve(w, 6)) != NULL) {
+                put_u16(p, 0);          // Priority
+                put_u16(p + 2, 0);      // Weight
+                put_u16(p + 4, r->port);
+            }
+            put_name(w, host);
+            break;
+
+        case REC_TXT:
+            put_record_head(w, instance, DNS_TYPE_TXT, DNS_CLASS_IN | MDNS_CACHE_FLUSH,
+                            MDNS_SERVICE_TTL_S, r->txt_len);
+            if ((p = reserve(w, r->txt_len)) != NULL) {
+                memcpy(p, r->txt, r->txt_len);
+            }
+            break;
+
+        case REC_ENUM:
+            put_record_head(w, ENUM_NAME, DNS_TYPE_PTR, DNS_CLASS_IN, MDNS_SERVICE_TTL_S,
+                            (uint16_t)name_len(SERVICE_NAME));
+            put_name(w, SERVICE_NAME);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static unsigned count_bits(uint8_t v) {
+    unsigned n = 0;
+    for (; v; v &= (uint8_t)(v - 1)) n++;
+    return n;
+}
+
+static void build_answer(mdns_responder *r, mdns_answer answer) {
+    mdns_packet *pkt = &r->answers[answer];
+    writer w = { pkt->data, 0, false };
+    uint8_t *head = reserve(&w, DNS_HEADER_LEN);
+    memset(head, 0, DNS_HEADER_LEN);
+    put_u16(&head[DNS_FLAGS], DNS_FLAG_QR | DNS_FLAG_AA);
+    put_u16(&head[DNS_ANCOUNT], (uint16_t)count_bits(ANSWER_RECORDS[answer].answers));
+    put_u16(&head[DNS_ARCOUNT], (uint16_t)count_bits(ANSWER_RECORDS[answer].additional));
+
+    for (uint8_t rec = REC_A; rec <= REC_ENUM; rec <<= 1) {
+        if (ANSWER_RECORDS[answer].answers & rec) put_record(&w, r, rec);
+    }
+    for (uint8_t rec = REC_A; rec <= REC_ENUM; rec <<= 1) {
+        if (ANSWER_RECORDS[answer].additional & rec) put_record(&w, r, rec);
+    }
+    // The limits in mdns_responder.h keep every packet within MDNS_MSG_MAX
+    pkt->len = w.overflow ? 0 : (uint16_t)w.len;
+    pkt->multicast = false;
+}
+
+bool mdns_responder_set_ip(mdns_responder *r, const uint8_t ip[4]) {
+    if (memcmp(r->ip, ip, 4) == 0) {
+        return false;
+    }
+    memcpy(r->ip, ip, 4);
+    for (int i = 0; i < MDNS_ANSWER_COUNT; i++) {
+        build_answer(r, (mdns_answer)i);
+    }
+    return true;
+}
+
+static bool has_ip(const mdns_responder *r) {
+    static const uint8_t zero[4] = { 0 };
+    return memcmp(r->ip, zero, 4) != 0;
+}
+
+// Read a possibly compressed name at *off as a dotted string and move
+// *off past it. Returns false if the name is malformed or too long.
+static bool read_name(const uint8_t *msg, size_t len, size_t *off, char *out) {
+    size_t pos = *off;
+    size_t out_len = 0;
+    int jumps = 0;
+    bool jumped = false;
+
+    while (true) {
+        if (pos >= len) return false;
+        uint8_t label = msg[pos];
+        if (label == 0) {
+            if (!jumped) *off = pos + 1;
+            break;
+        }
+        if ((label & 0xC0) == 0xC0) {
+            if (pos + 1 >= len || ++jumps > DNS_JUMPS_MAX) return false;
+            if (!jumped) *off = pos + 2;
+            jumped = true;
+            pos = ((size_t)(label & 0x3F) << 8) | msg[pos + 1];
+            continue;
+        }
+        if ((label & 0xC0) != 0 || pos + 1 + label > len) return false;
+        if (out_len + label + 1 >= DNS_NAME_MAX) return false;
+        if (out_len > 0) out[out_len++] = '.';
+        memcpy(&out[out_len], &msg[pos + 1], label);
+        out_len += label;
+        pos += 1 + label;
+    }
+    out[out_len] = '\0';
+    return true;
+}
+
+// DNS names compare without regard to ASCII case
+static bool name_equal(const char *a, const char *b) {
+    for (; *a && *b; a++, b++) {
+        char ca = (*a >= 'A' && *a <= 'Z') ? (char)(*a + 32) : *a;
+        char cb = (*b >= 'A' && *b <= 'Z') ? (char)(*b + 32) : *b;
+        if (ca != cb) return false;
+    }
+    return *a == *b;
+}
+
+// Which cached answer (as a bit) a question asks for, or 0 if none
+static unsigned match_question(const mdns_responder *r, const char *name, uint16_t type) {
+    bool any = (type == DNS_TYPE_ANY);
+    char own[MDNS_LABEL_MAX + sizeof("." SERVICE_NAME)];
+    strcpy(own, r->host);
+    strcat(own, ".local");
+    if (name_equal(name, own)) {
+        return (type == DNS_TYPE_A || any) ? 1u << MDNS_ANSWER_HOST : 0;
+    }
+    strcpy(own, r->host);
+    strcat(own, "." SERVICE_NAME);
+    if (name_equal(name, own)) {
+        return (type == DNS_TYPE_SRV || type == DNS_TYPE_TXT || any)
+                   ? 1u << MDNS_ANSWER_SERVICE : 0;
+    }
+    if (name_equal(name, SERVICE_NAME)) {
+        return (type == DNS_TYPE_PTR || any) ? 1u << MDNS_ANSWER_BROWSE : 0;
+    }
+    if (name_equal(name, ENUM_NAME)) {
+        return (type == DNS_TYPE_PTR || any) ? 1u << MDNS_ANSWER_ENUM : 0;
+    }
+    return 0;
+}
+
+// Copy a cached answer behind the question of a one-shot query. Such
+// resolvers don't understand the cache-flush bit, and their TTLs are capped.
+static size_t build_legacy(mdns_responder *r, const mdns_packet *pkt, const uint8_t *msg,
+                           size_t question_len) {
+    uint8_t *out = r->legacy;
+    size_t len = DNS_HEADER_LEN;
+    memcpy(out, pkt->data, DNS_HEADER_LEN);
+    memcpy(&out[DNS_ID], &msg[DNS_ID], 2);
+    put_u16(&out[DNS_QDCOUNT], 0);
+
+    // Echo the first question, unless it uses compression (its offsets
+    // would be wrong here) or doesn't fit
+    bool echo = question_len > 0 && question_len + pkt->len <= MDNS_MSG_MAX;
+    for (size_t i = DNS_HEADER_LEN; echo && msg[i] != 0; i += 1 + msg[i]) {
+        if ((msg[i] & 0xC0) != 0) echo = false;
+    }
+    if (echo) {
+        memcpy(&out[len], &msg[DNS_HEADER_LEN], question_len);
+        len += question_len;
+        put_u16(&out[DNS_QDCOUNT], 1);
+    }
+
+    size_t records_len = pkt->len - DNS_HEADER_LEN;
+    if (len + records_len > MDNS_MSG_MAX) {
+        return 0;
+    }
+    memcpy(&out[len], &pkt->data[DNS_HEADER_LEN], records_len);
+
+    // Walk the (uncompressed) records to patch class and TTL
+    size_t pos = len;
+    len += records_len;
+    unsigned records = get_u16(&out[DNS_ANCOUNT]) + get_u16(&out[DNS_NSCOUNT]) +
+                       get_u16(&out[DNS_ARCOUNT]);
+    for (unsigned i = 0; i < records; i++) {
+        while (out[pos] != 0) {
+            pos += 1 + out[pos];
+        }
+        pos++;
+        uint8_t *fixed = &out[pos];
+        put_u16(fixed + 2, get_u16(fixed + 2) & DNS_CLASS_MASK);
+        if (get_u32(fixed + 4) > MDNS_LEGACY_TTL_S) {
+            put_u32(fixed + 4, MDNS_LEGACY_TTL_S);
+        }
+        pos += 10 + get_u16(fixed + 8);
+    }
+    return len;
+}
+
+size_t mdns_responder_handle(mdns_responder *r, const uint8_t *msg, size_t len,
+                             uint16_t src_port, uint32_t now_ms,
+                             const uint8_t **reply, bool *unicast) {
+    *unicast = false;
+    if (len < DNS_HEADER_LEN || !has_ip(r)) {
+        return 0;
+    }
+    uint16_t flags = get_u16(&msg[DNS_FLAGS]);
+    if ((flags & DNS_FLAG_QR) || (flags & DNS_OPCODE_MASK)) {
+        return 0;   // A response from another host, or not a standard query
+    }
+
+    unsigned wanted = 0;
+    bool unicast_requested = false;
+    size_t first_question_len = 0;
+    size_t off = DNS_HEADER_LEN;
+    uint16_t questions = get_u16(&msg[DNS_QDCOUNT]);
+    for (uint16_t i = 0; i < questions; i++) {
+        char name[DNS_NAME_MAX];
+        if (!read_name(msg, len, &off, name) || off + 4 > len) {
+            break;
+        }
+        uint16_t type = get_u16(&msg[off]);
+        uint16_t cls = get_u16(&msg[off + 2]);
+        off += 4;
+        if (i == 0) {
+            first_question_len = off - DNS_HEADER_LEN;
+        }
+        if ((cls & DNS_CLASS_MASK) != DNS_CLASS_IN && (cls & DNS_CLASS_MASK) != DNS_CLASS_ANY) {
+            continue;
+        }
+        unsigned match = match_question(r, name, type);
+        if (match) {
+            wanted |= match;
+            unicast_requested |= (cls & MDNS_UNICAST_REPLY) != 0;
+        }
+    }
+    if (wanted == 0) {
+        return 0;
+    }
+
+    // A single kind of question has its own cached answer; anything else gets everything
+    mdns_answer answer = MDNS_ANSWER_ALL;
+    for (int i = 0; i < MDNS_ANSWER_COUNT; i++) {
+        if (wanted == (1u << i)) answer = (mdns_answer)i;
+    }
+    mdns_packet *pkt = &r->answers[answer];
+    if (pkt->len == 0) {
+        return 0;
+    }
+
+    if (src_port != MDNS_PORT) {
+        *unicast = true;
+        *reply = r->legacy;
+        return build_legacy(r, pkt, msg, first_question_len);
+    }
+    *reply = pkt->data;
+    if (unicast_requested) {
+        *unicast = true;
+        return pkt->len;
+    }
+    if (pkt->multicast && now_ms - pkt->multicast_ms < MDNS_REPEAT_MS) {
+        return 0;   // Everyone on the link just heard this answer
+    }
+    pkt->multicast = true;
+    pkt->multicast_ms = now_ms;
+    return pkt->len;
+}
+
+size_t mdns_responder_announce(mdns_responder *r, uint32_t now_ms, const uint8_t **reply) {
+    mdns_packet *pkt = &r->answers[MDNS_ANSWER_ALL];
+    if (!has_ip(r) || pkt->len == 0) {
+        return 0;
+    }
+    pkt->multicast = true;
+    pkt->multicast_ms = now_ms;
+    *reply = pkt->data;
+    return pkt->len;
+}
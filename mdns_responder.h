@@ -0,0 +1,126 @@
+/*
+File: mdns_responder.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the multicast DNS responder that lets
+    clients find the device as <hostname>.local and browse it as an
+    _http._tcp service (DNS-SD). This module only turns a query into a
+    reply; network.c receives the queries on UDP port 5353 and sends the
+    replies.
+
+    Every answer the responder can give is encoded once, when the address
+    changes, into a ready-to-send packet. Answering a query is then just
+    matching its questions against a few names.
+
+    This module has no hardware or lwIP dependencies so it can be unit
+    tested on the host (see test_mdns_responder.c).
+*/
+
+#ifndef MDNS_RESPONDER_H
+#define MDNS_RESPONDER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MDNS_PORT           5353
+#define MDNS_GROUP          "224.0.0.251"
+#define MDNS_LABEL_MAX      32      // Longest hostname accepted (DNS allows 63)
+#define MDNS_TXT_MAX        96      // Room for the encoded TXT strings
+#define MDNS_MSG_MAX        512     // Largest packet sent or read
+#define MDNS_HOST_TTL_S     120     // TTL of address and SRV records (RFC 6762 10)
+#define MDNS_SERVICE_TTL_S  4500    // TTL of PTR and TXT records
+#define MDNS_LEGACY_TTL_S   10      // TTL cap in replies to one-shot (legacy unicast) queries
+#define MDNS_REPEAT_MS      1000    // Don't multicast the same answer more often than this
+
+/**
+ * @brief Cached answers, one packet per kind of question
+ */
+typedef enum {
+    MDNS_ANSWER_HOST = 0,   // <host>.local A
+    MDNS_ANSWER_BROWSE,     // _http._tcp.local PTR, with SRV, TXT and A as additional records
+    MDNS_ANSWER_SERVICE,    // <host>._http._tcp.local SRV and TXT, with A
+    MDNS_ANSWER_ENUM,       // _services._dns-sd._udp.local PTR
+    MDNS_ANSWER_ALL,        // Everything; used for announcements and mixed queries
+    MDNS_ANSWER_COUNT
+} mdns_answer;
+
+/**
+ * @brief One ready-to-send response
+ */
+typedef struct {
+    uint8_t data[MDNS_MSG_MAX];
+    uint16_t len;
+    bool multicast;             // Has been multicast at least once
+    uint32_t multicast_ms;      // When it was last multicast
+} mdns_packet;
+
+/**
+ * @brief Responder configuration and cached answers
+ */
+typedef struct {
+    char host[MDNS_LABEL_MAX + 1];
+    uint8_t txt[MDNS_TXT_MAX];  // TXT strings in wire format
+    uint8_t txt_len;
+    uint16_t port;              // HTTP port advertised in the SRV record
+    uint8_t ip[4];              // 0.0.0.0 until an address is set; nothing is answered until then
+    mdns_packet answers[MDNS_ANSWER_COUNT];
+    uint8_t legacy[MDNS_MSG_MAX];   // Reply being built for a one-shot query
+} mdns_responder;
+
+/**
+ * @brief Set up the responder
+ *
+ * @param r          Responder state
+ * @param host       Hostname without ".local"; letters, digits and '-' only
+ * @param port       TCP port of the web server
+ * @param txt        "key=value" strings for the service's TXT record
+ * @param txt_count  Number of strings in txt
+ * @return false if the hostname or TXT strings are invalid or too long
+ */
+bool mdns_responder_init(mdns_responder *r, const char *host, uint16_t port,
+                         const char *const *txt, size_t txt_count);
+
+/**
+ * @brief Change the advertised address, re-encoding the cached answers
+ *
+ * @param r   Responder state
+ * @param ip  Address of the interface the responder is running on
+ * @return true if the address changed (and should be announced)
+ */
+bool mdns_responder_set_ip(mdns_responder *r, const uint8_t ip[4]);
+
+/**
+ * @brief Handle one message received on the mDNS port
+ *
+ * Queries for the hostname, the service type, the service instance or
+ * the DNS-SD service list are answered; responses and other names are
+ * ignored. The same answer is multicast at most once per MDNS_REPEAT_MS.
+ *
+ * @param r         Responder state
+ * @param msg       Received UDP payload
+ * @param len       Length of msg
+ * @param src_port  Source port of the query; any port but 5353 is a one-shot
+ *                  query and gets a unicast reply with the question echoed
+ * @param now_ms    Current time
+ * @param reply     Set to the packet to send; valid until the next call
+ * @param unicast   Set to true if the reply goes back to the sender's
+ *                  address and port instead of to the multicast group
+ * @return Length of the reply, or 0 if there is nothing to send
+ */
+size_t mdns_responder_handle(mdns_responder *r, const uint8_t *msg, size_t len,
+                             uint16_t src_port, uint32_t now_ms,
+                             const uint8_t **reply, bool *unicast);
+
+/**
+ * @brief Unsolicited announcement of every record, to send to the group
+ *
+ * @param r       Responder state
+ * @param now_ms  Current time
+ * @param reply   Set to the packet to send
+ * @return Length of the packet, or 0 if no address is set
+ */
+size_t mdns_responder_announce(mdns_responder *r, uint32_t now_ms, const uint8_t **reply);
+
+#endif // MDNS_RESPONDER_H
@@ -0,0 +1,338 @@
+/*
+File: metrics.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Provides the firmware performance counters and their Prometheus text
+    exposition. The output is described by a table of metric families;
+    an export position names a family and a line within it, so a scrape
+    can be produced in pieces as small as one line.
+
+Responsibilities:
+- Hold event counters, latency histograms, gauges and memory pool usage
+- Sort durations into histogram buckets
+- Serialize everything in the text exposition format on request
+
+Requires the following modules:
+- metrics.h: for interface definitions
+*/
+
+#include "metrics.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+uint32_t g_metric_counters[METRIC_COUNTER_COUNT];
+metrics_histogram g_metric_timers[METRIC_TIMER_COUNT];
+
+static float s_gauges[METRIC_GAUGE_COUNT];
+static metrics_pool s_pools[METRICS_POOL_MAX];
+static size_t s_pool_count = 0;
+
+static const uint32_t BUCKET_BOUNDS_US[METRICS_BUCKET_COUNT] = METRICS_BUCKET_BOUNDS_US;
+
+// The same bounds in seconds, as they appear in le labels
+static const char *const BUCKET_LABELS[METRICS_BUCKET_COUNT] = {
+    "0.0001", "0.00025", "0.0005", "0.001", "0.0025", "0.005", "0.01",
+    "0.025", "0.05", "0.1", "0.25", "0.5", "1", "2.5"
+};
+
+// Where a family's values come from
+typedef enum {
+    SOURCE_COUNTER,
+    SOURCE_GAUGE,
+    SOURCE_GAUGE_US,     // Gauge of seconds, exported to the microsecond
+    SOURCE_TIMER,
+    SOURCE_POOL_USED,
+    SOURCE_POOL_MAX,
+    SOURCE_POOL_AVAIL,
+    SOURCE_POOL_ERRORS,
+} metric_source;
+
+// One metric family: HELP and TYPE lines followed by its series. Series
+// come from consecutive counter, gauge or timer ids starting at first, or
+// from every reported memory pool.
+typedef struct {
+    const char *name;
+    const char *type;                  // "counter", "gauge" or "histogram"
+    const char *help;
+    metric_source source;
+    uint8_t first;                     // First counter, gauge or timer id
+    uint8_t count;                     // Number of series (pool families use the pool count)
+    const char *label;                 // Label distinguishing the series, or NULL
+    const char *const *label_values;   // One value per series
+} metric_family;
+
+static const char *const DHT_ERROR_LABELS[] = { "i2c_error", "busy", "crc_error" };
+static const char *const SUBSYSTEM_LABELS[] = { "dht_read", "display_refresh", "led_show" };
+static const char *const HTTP_CODE_LABELS[] = { "1xx", "2xx", "3xx", "4xx", "5xx" };
+static const char *const HTTP_STATE_LABELS[] = { "reading", "writing", "closing" };
+static const char *const POWER_STATE_LABELS[] = { "full", "reduced", "xosc" };
+static const char *const I2C_DEVICE_LABELS[] = { "dht20", "lcd" };
+static const char *const WORKER_LABELS[] = {
+    "sample_timer", "sensor_ready", "display_flush", "led_frame", "network_events", "wifi_service"
+};
+
+static const metric_family FAMILIES[] = {
+    { "dht_humidity_percent", "gauge", "Latest relative humidity reading.",
+      SOURCE_GAUGE, METRIC_HUMIDITY, 1, NULL, NULL },
+    { "dht_temperature_celsius", "gauge", "Latest temperature reading.",
+      SOURCE_GAUGE, METRIC_TEMP_C, 1, NULL, NULL },
+    { "dht_reads_total", "counter", "Sensor reads attempted.",
+      SOURCE_COUNTER, METRIC_DHT_READS, 1, NULL, NULL },
+    { "dht_read_errors_total", "counter", "Sensor reads that failed, by reason.",
+      SOURCE_COUNTER, METRIC_DHT_I2C_ERRORS, 3, "status", DHT_ERROR_LABELS },
+    { "lcd_frames_total", "counter", "LCD refreshes.",
+      SOURCE_COUNTER, METRIC_LCD_FRAMES, 1, NULL, NULL },
+    { "led_frames_total", "counter", "LED strip updates.",
+      SOURCE_COUNTER, METRIC_LED_FRAMES, 1, NULL, NULL },
+    { "subsystem_duration_seconds", "histogram", "Time spent in sensor, display and LED updates.",
+      SOURCE_TIMER, METRIC_TIME_DHT_READ, 3, "subsystem", SUBSYSTEM_LABELS },
+    { "http_responses_total", "counter", "HTTP responses sent, by status class.",
+      SOURCE_COUNTER, METRIC_HTTP_1XX, 5, "code", HTTP_CODE_LABELS },
+    { "http_received_bytes_total", "counter", "HTTP request bytes received.",
+      SOURCE_COUNTER, METRIC_HTTP_RX_BYTES, 1, NULL, NULL },
+    { "http_sent_bytes_total", "counter", "HTTP response bytes acknowledged by clients.",
+      SOURCE_COUNTER, METRIC_HTTP_TX_BYTES, 1, NULL, NULL },
+    { "http_deferred_writes_total", "counter", "HTTP writes held back until the send buffer had room.",
+      SOURCE_COUNTER, METRIC_HTTP_DEFERRED, 1, NULL, NULL },
+    { "http_rejected_connections_total", "counter", "HTTP connections turned away with 503.",
+      SOURCE_COUNTER, METRIC_HTTP_REJECTED, 1, NULL, NULL },
+    { "http_evicted_connections_total", "counter", "Idle HTTP connections closed to make room.",
+      SOURCE_COUNTER, METRIC_HTTP_EVICTED, 1, NULL, NULL },
+    { "http_connection_errors_total", "counter", "HTTP connections ended by a TCP error.",
+      SOURCE_COUNTER, METRIC_HTTP_CONN_ERRORS, 1, NULL, NULL },
+    { "http_connection_aborts_total", "counter", "HTTP connections aborted after closing failed.",
+      SOURCE_COUNTER, METRIC_HTTP_ABORTED, 1, NULL, NULL },
+    { "http_connections", "gauge", "Open HTTP connections, by state.",
+      SOURCE_GAUGE, METRIC_HTTP_READING, 3, "state", HTTP_STATE_LABELS },
+    { "udp_telemetry_datagrams_total", "counter", "UDP telemetry datagrams sent.",
+      SOURCE_COUNTER, METRIC_UDP_DATAGRAMS, 1, NULL, NULL },
+    { "udp_telemetry_samples_total", "counter", "Samples sent in UDP telemetry datagrams.",
+      SOURCE_COUNTER, METRIC_UDP_SAMPLES, 1, NULL, NULL },
+    { "udp_telemetry_bytes_total", "counter", "UDP telemetry payload bytes sent.",
+      SOURCE_COUNTER, METRIC_UDP_BYTES, 1, NULL, NULL },
+    { "udp_telemetry_errors_total", "counter", "UDP telemetry datagrams that could not be sent.",
+      SOURCE_COUNTER, METRIC_UDP_ERRORS, 1, NULL, NULL },
+    { "mqtt_messages_total", "counter", "MQTT messages sent (QoS 0) or acknowledged (QoS 1).",
+      SOURCE_COUNTER, METRIC_MQTT_MESSAGES, 1, NULL, NULL },
+    { "mqtt_dropped_total", "counter", "MQTT messages dropped because the outbox was full.",
+      SOURCE_COUNTER, METRIC_MQTT_DROPPED, 1, NULL, NULL },
+    { "mqtt_connects_total", "counter", "MQTT connections accepted by the broker.",
+      SOURCE_COUNTER, METRIC_MQTT_CONNECTS, 1, NULL, NULL },
+    { "wifi_connects_total", "counter", "Station mode joins that got an address.",
+      SOURCE_COUNTER, METRIC_WIFI_CONNECTS, 1, NULL, NULL },
+    { "wifi_reconnects_total", "counter", "Station mode joins after a lost connection.",
+      SOURCE_COUNTER, METRIC_WIFI_RECONNECTS, 1, NULL, NULL },
+    { "wifi_join_failures_total", "counter", "Station mode joins that failed or timed out.",
+      SOURCE_COUNTER, METRIC_WIFI_JOIN_FAILURES, 1, NULL, NULL },
+    { "wifi_join_duration_seconds", "gauge", "Time the last station mode join took.",
+      SOURCE_GAUGE, METRIC_WIFI_JOIN_TIME, 1, NULL, NULL },
+    { "mdns_received_total", "counter", "mDNS messages received.",
+      SOURCE_COUNTER, METRIC_MDNS_RECEIVED, 1, NULL, NULL },
+    { "mdns_sent_total", "counter", "mDNS answers and announcements sent.",
+      SOURCE_COUNTER, METRIC_MDNS_SENT, 1, NULL, NULL },
+    { "http_request_duration_seconds", "histogram", "Time from request to fully queued response.",
+      SOURCE_TIMER, METRIC_TIME_HTTP, 1, NULL, NULL },
+    { "core_handoff_duration_seconds", "histogram", "Time from a sample leaving core 1 until core 0 took it.",
+      SOURCE_TIMER, METRIC_TIME_CORE_HANDOFF, 1, NULL, NULL },
+    { "samples_dropped_total", "counter", "Samples dropped because core 0 fell behind.",
+      SOURCE_COUNTER, METRIC_SAMPLES_DROPPED, 1, NULL, NULL },
+    { "sample_deadlines_missed_total", "counter", "Sample deadlines missed by a whole interval.",
+      SOURCE_COUNTER, METRIC_SAMPLES_LATE, 1, NULL, NULL },
+    { "worker_run_duration_seconds", "histogram", "Run time of each main loop worker.",
+      SOURCE_TIMER, METRIC_TIME_WORKER_SAMPLE, 6, "worker", WORKER_LABELS },
+    { "lwip_pool_used", "gauge", "lwIP memory pool entries (heap bytes) in use.",
+      SOURCE_POOL_USED, 0, 0, "pool", NULL },
+    { "lwip_pool_max_used", "gauge", "Highest lwIP memory pool usage since boot.",
+      SOURCE_POOL_MAX, 0, 0, "pool", NULL },
+    { "lwip_pool_size", "gauge", "lwIP memory pool capacity.",
+      SOURCE_POOL_AVAIL, 0, 0, "pool", NULL },
+    { "lwip_pool_errors_total", "counter", "lwIP memory pool allocation failures.",
+      SOURCE_POOL_ERRORS, 0, 0, "pool", NULL },
+    { "dhcp_clients", "gauge", "Access point clients holding a DHCP lease.",
+      SOURCE_GAUGE, METRIC_DHCP_CLIENTS, 1, NULL, NULL },
+    { "dhcp_next_lease_expiry_seconds", "gauge", "Time until the soonest DHCP lease expires.",
+      SOURCE_GAUGE, METRIC_DHCP_NEXT_EXPIRY, 1, NULL, NULL },
+    { "power_state_seconds_total", "counter", "Time clk_sys has spent in each power state.",
+      SOURCE_GAUGE, METRIC_POWER_FULL_S, 3, "state", POWER_STATE_LABELS },
+    { "power_estimated_current_milliamps", "gauge", "Average estimated board current since boot.",
+      SOURCE_GAUGE, METRIC_POWER_CURRENT, 1, NULL, NULL },
+    { "i2c_bus_seconds_total", "counter", "Time each device has held the I2C bus.",
+      SOURCE_GAUGE_US, METRIC_I2C_DHT_S, 2, "device", I2C_DEVICE_LABELS },
+    { "i2c_cpu_seconds_total", "counter", "CPU time spent driving each device's I2C transfers.",
+      SOURCE_GAUGE_US, METRIC_I2C_DHT_CPU_S, 2, "device", I2C_DEVICE_LABELS },
+    { "i2c_transactions_total", "counter", "I2C transactions run, by device.",
+      SOURCE_GAUGE, METRIC_I2C_DHT_TXNS, 2, "device", I2C_DEVICE_LABELS },
+    { "i2c_errors_total", "counter", "I2C transactions that failed, by device.",
+      SOURCE_GAUGE, METRIC_I2C_DHT_ERRORS, 2, "device", I2C_DEVICE_LABELS },
+    { "i2c_queue_wait_max_seconds", "gauge", "Longest time a transaction waited for the I2C bus.",
+      SOURCE_GAUGE_US, METRIC_I2C_DHT_WAIT, 2, "device", I2C_DEVICE_LABELS },
+    { "uptime_seconds", "gauge", "Time since boot.",
+      SOURCE_GAUGE, METRIC_UPTIME, 1, NULL, NULL },
+};
+
+#define FAMILY_COUNT (sizeof(FAMILIES) / sizeof(FAMILIES[0]))
+
+// Lines per histogram series: one per bucket, +Inf, _sum and _count
+#define HISTOGRAM_LINES (METRICS_BUCKET_COUNT + 3)
+
+void metrics_observe(metrics_timer timer, uint32_t duration_us) {
+    metrics_histogram *h = &g_metric_timers[timer];
+    int i = 0;
+    while (i < METRICS_BUCKET_COUNT && duration_us > BUCKET_BOUNDS_US[i]) {
+        i++;
+    }
+    h->buckets[i]++;
+    h->count++;
+    h->sum_us += duration_us;
+}
+
+void metrics_count_http_status(const char *status) {
+    int status_class = status[0] - '0';
+    if (status_class >= 1 && status_class <= 5) {
+        metrics_count((metrics_counter)(METRIC_HTTP_1XX + status_class - 1));
+    }
+}
+
+void metrics_reset(void) {
+    memset(g_metric_counters, 0, sizeof(g_metric_counters));
+    memset(g_metric_timers, 0, sizeof(g_metric_timers));
+    for (int i = 0; i < METRIC_GAUGE_COUNT; i++) {
+        s_gauges[i] = NAN;
+    }
+    s_pool_count = 0;
+}
+
+void metrics_set_gauge(metrics_gauge gauge, float value) {
+    s_gauges[gauge] = value;
+}
+
+void metrics_set_pools(const metrics_pool *pools, size_t count) {
+    if (count > METRICS_POOL_MAX) {
+        count = METRICS_POOL_MAX;
+    }
+    if (count > 0) {
+        memcpy(s_pools, pools, count * sizeof(pools[0]));
+    }
+    s_pool_count = count;
+}
+
+static size_t family_series(const metric_family *f) {
+    return (f->source >= SOURCE_POOL_USED) ? s_pool_count : f->count;
+}
+
+static uint32_t pool_value(const metric_family *f, size_t series) {
+    const metrics_pool *pool = &s_pools[series];
+    switch (f->source) {
+        case SOURCE_POOL_USED:  return pool->used;
+        case SOURCE_POOL_MAX:   return pool->max;
+        case SOURCE_POOL_AVAIL: return pool->avail;
+        default:                return pool->errors;
+    }
+}
+
+// Format the label set of a series, with an optional le label for a bucket
+static void format_labels(const metric_family *f, size_t series, const char *le,
+                          char *out, size_t size) {
+    const char *value = NULL;
+    if (f->label) {
+        value = (f->source >= SOURCE_POOL_USED) ? s_pools[series].name : f->label_values[series];
+    }
+    if (value && le) {
+        snprintf(out, size, "{%s=\"%s\",le=\"%s\"}", f->label, value, le);
+    } else if (value) {
+        snprintf(out, size, "{%s=\"%s\"}", f->label, value);
+    } else if (le) {
+        snprintf(out, size, "{le=\"%s\"}", le);
+    } else {
+        out[0] = '\0';
+    }
+}
+
+// Format one line of a histogram series
+static int format_histogram_line(const metric_family *f, size_t series, size_t part,
+                                 char *out, size_t size) {
+    const metrics_histogram *h = &g_metric_timers[f->first + series];
+    char labels[64];
+
+    if (part <= METRICS_BUCKET_COUNT) {
+        // Exported buckets are cumulative
+        uint32_t total = 0;
+        for (size_t i = 0; i <= part; i++) {
+            total += h->buckets[i];
+        }
+        format_labels(f, series, (part < METRICS_BUCKET_COUNT) ? BUCKET_LABELS[part] : "+Inf",
+                      labels, sizeof(labels));
+        return snprintf(out, size, "%s_bucket%s %lu\n", f->name, labels, (unsigned long)total);
+    }
+
+    format_labels(f, series, NULL, labels, sizeof(labels));
+    if (part == METRICS_BUCKET_COUNT + 1) {
+        uint64_t sum_us = h->sum_us;
+        return snprintf(out, size, "%s_sum%s %lu.%06lu\n", f->name, labels,
+                        (unsigned long)(sum_us / 1000000u), (unsigned long)(sum_us % 1000000u));
+    }
+    return snprintf(out, size, "%s_count%s %lu\n", f->name, labels, (unsigned long)h->count);
+}
+
+// Format line number `line` of a family; returns 0 past its last line
+static int format_family_line(const metric_family *f, size_t line, char *out, size_t size) {
+    if (line == 0) {
+        return snprintf(out, size, "# HELP %s %s\n", f->name, f->help);
+    }
+    if (line == 1) {
+        return snprintf(out, size, "# TYPE %s %s\n", f->name, f->type);
+    }
+
+    size_t index = line - 2;
+    size_t series_lines = (f->source == SOURCE_TIMER) ? HISTOGRAM_LINES : 1;
+    size_t series = index / series_lines;
+    if (series >= family_series(f)) {
+        return 0;
+    }
+    if (f->source == SOURCE_TIMER) {
+        return format_histogram_line(f, series, index % series_lines, out, size);
+    }
+
+    char labels[64];
+    format_labels(f, series, NULL, labels, sizeof(labels));
+    if (f->source == SOURCE_GAUGE || f->source == SOURCE_GAUGE_US) {
+        float value = s_gauges[f->first + series];
+        if (isnan(value)) {
+            return snprintf(out, size, "%s%s NaN\n", f->name, labels);
+        }
+        return snprintf(out, size, "%s%s %.*f\n", f->name, labels,
+                        (f->source == SOURCE_GAUGE_US) ? 6 : 2, (double)value);
+    }
+    uint32_t value = (f->source == SOURCE_COUNTER) ? g_metric_counters[f->first + series]
+                                                   : pool_value(f, series);
+    return snprintf(out, size, "%s%s %lu\n", f->name, labels, (unsigned long)value);
+}
+
+size_t metrics_export(uint32_t *pos, char *buf, size_t size) {
+    // pos holds the family index in the high 16 bits and the line within it below
+    size_t len = 0;
+    while ((*pos >> 16) < FAMILY_COUNT) {
+        const metric_family *f = &FAMILIES[*pos >> 16];
+        char line[METRICS_LINE_MAX];
+        int n = format_family_line(f, *pos & 0xFFFF, line, sizeof(line));
+        if (n <= 0) {
+            *pos = ((*pos >> 16) + 1) << 16;  // Family done, on to the next
+            continue;
+        }
+        if ((size_t)n >= sizeof(line)) {
+            n = sizeof(line) - 1;  // Truncated; keep the line ending
+            line[n - 1] = '\n';
+        }
+        if (len + (size_t)n > size) {
+            break;
+        }
+        memcpy(buf + len, line, (size_t)n);
+        len += (size_t)n;
+        (*pos)++;
+    }
+    return len;
+}
@@ -0,0 +1,214 @@
+/*
+File: metrics.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the firmware performance counters served
+    at /metrics. Hot paths only bump a counter or drop a duration into a
+    histogram bucket; nothing is formatted until a scrape asks for the
+    Prometheus text exposition, which is produced a few lines at a time
+    so it can stream straight into the TCP send buffer.
+
+    Counters and histograms are plain increments, not atomic. Each one is
+    updated from a single context except led_frames (the main loop and
+    /set both redraw the LEDs), which may rarely lose a count.
+
+    This module has no hardware dependencies so it can be unit tested on
+    the host (see test_metrics.c).
+*/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Event counters
+ */
+typedef enum {
+    METRIC_DHT_READS = 0,      // Measurements started
+    METRIC_DHT_I2C_ERRORS,     // Reads failed on the I2C bus
+    METRIC_DHT_BUSY,           // Reads that found the sensor still measuring
+    METRIC_DHT_CRC_ERRORS,     // Reads whose CRC check failed
+    METRIC_LCD_FRAMES,         // LCD refreshes
+    METRIC_LED_FRAMES,         // LED strip updates (hw_show)
+    METRIC_HTTP_1XX,           // HTTP responses by status class, 1xx..5xx
+    METRIC_HTTP_2XX,
+    METRIC_HTTP_3XX,
+    METRIC_HTTP_4XX,
+    METRIC_HTTP_5XX,
+    METRIC_HTTP_RX_BYTES,      // HTTP request bytes received
+    METRIC_HTTP_TX_BYTES,      // HTTP response bytes acknowledged by clients
+    METRIC_HTTP_DEFERRED,      // HTTP writes held back until the send buffer had room
+    METRIC_HTTP_REJECTED,      // HTTP connections turned away with 503
+    METRIC_HTTP_EVICTED,       // Idle HTTP connections closed to make room
+    METRIC_HTTP_CONN_ERRORS,   // HTTP connections ended by a TCP error
+    METRIC_HTTP_ABORTED,       // HTTP connections aborted after tcp_close() kept failing
+    METRIC_SAMPLES_DROPPED,    // Samples core 1 dropped because core 0 hadn't taken the previous ones
+    METRIC_SAMPLES_LATE,       // Sample deadlines missed by a whole interval and rescheduled
+    METRIC_UDP_DATAGRAMS,      // UDP telemetry datagrams sent
+    METRIC_UDP_SAMPLES,        // Samples carried in those datagrams
+    METRIC_UDP_BYTES,          // UDP telemetry payload bytes sent
+    METRIC_UDP_ERRORS,         // Datagrams that could not be sent
+    METRIC_MQTT_MESSAGES,      // MQTT messages sent (QoS 0) or acknowledged (QoS 1)
+    METRIC_MQTT_DROPPED,       // MQTT messages dropped from a full outbox
+    METRIC_MQTT_CONNECTS,      // MQTT connections accepted by the broker
+    METRIC_WIFI_CONNECTS,      // Station mode joins that got an address
+    METRIC_WIFI_RECONNECTS,    // Of those, joins after a lost connection
+    METRIC_WIFI_JOIN_FAILURES, // Station mode joins that failed or timed out
+    METRIC_MDNS_RECEIVED,      // mDNS messages received (queries and other hosts' answers)
+    METRIC_MDNS_SENT,          // mDNS answers and announcements sent
+    METRIC_COUNTER_COUNT
+} metrics_counter;
+
+/**
+ * @brief Timed operations, each with its own latency histogram
+ */
+typedef enum {
+    METRIC_TIME_DHT_READ = 0,  // DHT20 trigger and read transfers
+    METRIC_TIME_DISPLAY,       // LCD refresh
+    METRIC_TIME_LED_SHOW,      // hw_show() in led_array.c
+    METRIC_TIME_HTTP,          // Request received until its response is fully queued
+    METRIC_TIME_CORE_HANDOFF,  // Sample pushed on core 1 until core 0 took it
+    METRIC_TIME_WORKER_SAMPLE,   // One run of each async_context worker in main.c:
+    METRIC_TIME_WORKER_SENSOR,   //   sample timer, sensor ready, display flush,
+    METRIC_TIME_WORKER_DISPLAY,  //   LED frame, network events and WiFi service
+    METRIC_TIME_WORKER_LEDS,
+    METRIC_TIME_WORKER_NETWORK,
+    METRIC_TIME_WORKER_WIFI,
+    METRIC_TIMER_COUNT
+} metrics_timer;
+
+/**
+ * @brief Values sampled when a scrape starts
+ */
+typedef enum {
+    METRIC_HUMIDITY = 0,       // Latest relative humidity in percent
+    METRIC_TEMP_C,             // Latest temperature in degrees Celsius
+    METRIC_UPTIME,             // Seconds since boot
+    METRIC_DHCP_CLIENTS,       // AP clients holding a DHCP lease
+    METRIC_DHCP_NEXT_EXPIRY,   // Seconds until the soonest DHCP lease expires (NaN if none)
+    METRIC_WIFI_JOIN_TIME,     // Seconds the last station mode join took (NaN before the first)
+    METRIC_HTTP_READING,       // HTTP connections by state: waiting for a request,
+    METRIC_HTTP_WRITING,       //   sending a response,
+    METRIC_HTTP_CLOSING,       //   and closing
+    METRIC_POWER_FULL_S,       // Seconds clk_sys has spent at full speed,
+    METRIC_POWER_REDUCED_S,    //   lowered,
+    METRIC_POWER_XOSC_S,       //   and running from the crystal
+    METRIC_POWER_CURRENT,      // Average estimated board current since boot, mA
+    METRIC_I2C_DHT_S,          // Seconds each I2C device has held the bus: DHT20, LCD
+    METRIC_I2C_LCD_S,
+    METRIC_I2C_DHT_CPU_S,      // Of that, seconds the CPU spent driving the bus, by device
+    METRIC_I2C_LCD_CPU_S,
+    METRIC_I2C_DHT_TXNS,       // I2C transactions run, by device
+    METRIC_I2C_LCD_TXNS,
+    METRIC_I2C_DHT_ERRORS,     // I2C transactions that failed, by device
+    METRIC_I2C_LCD_ERRORS,
+    METRIC_I2C_DHT_WAIT,       // Longest a transaction waited in the I2C queue, seconds
+    METRIC_I2C_LCD_WAIT,
+    METRIC_GAUGE_COUNT
+} metrics_gauge;
+
+// Histogram bucket upper bounds in microseconds (a final +Inf bucket is implied)
+#define METRICS_BUCKET_BOUNDS_US \
+    { 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000 }
+#define METRICS_BUCKET_COUNT 14
+
+#define METRICS_POOL_MAX  20    // Memory pools reported per scrape
+#define METRICS_LINE_MAX  128   // Longest line of exposition text (including the newline)
+
+/**
+ * @brief Latency histogram; buckets are not cumulative until exported
+ */
+typedef struct {
+    uint32_t buckets[METRICS_BUCKET_COUNT + 1];  // Last entry counts values above every bound
+    uint32_t count;
+    uint64_t sum_us;
+} metrics_histogram;
+
+/**
+ * @brief Usage of one memory pool at the time of a scrape
+ */
+typedef struct {
+    const char *name;   // Must stay valid until the scrape is complete
+    uint32_t used;
+    uint32_t max;
+    uint32_t avail;
+    uint32_t errors;
+} metrics_pool;
+
+// Storage behind the inline update functions; use those rather than these
+extern uint32_t g_metric_counters[METRIC_COUNTER_COUNT];
+extern metrics_histogram g_metric_timers[METRIC_TIMER_COUNT];
+
+/**
+ * @brief Count one event
+ *
+ * @param counter  Counter to increment
+ */
+static inline void metrics_count(metrics_counter counter) {
+    g_metric_counters[counter]++;
+}
+
+/**
+ * @brief Add an amount, such as a byte count, to a counter
+ *
+ * @param counter  Counter to increase
+ * @param amount   Amount to add
+ */
+static inline void metrics_add(metrics_counter counter, uint32_t amount) {
+    g_metric_counters[counter] += amount;
+}
+
+/**
+ * @brief Record how long one timed operation took
+ *
+ * @param timer        Histogram to update
+ * @param duration_us  Duration in microseconds
+ */
+void metrics_observe(metrics_timer timer, uint32_t duration_us);
+
+/**
+ * @brief Count an HTTP response by the status class of its status line
+ *
+ * @param status  Status line text such as "200 OK"
+ */
+void metrics_count_http_status(const char *status);
+
+/**
+ * @brief Reset every counter, histogram, gauge and pool
+ */
+void metrics_reset(void);
+
+/**
+ * @brief Set a gauge; NaN is exported as NaN (e.g. no sample yet)
+ *
+ * @param gauge  Gauge to set
+ * @param value  Current value
+ */
+void metrics_set_gauge(metrics_gauge gauge, float value);
+
+/**
+ * @brief Replace the memory pool usage reported by the next export
+ *
+ * @param pools  Pool usage; copied, but the names are referenced
+ * @param count  Number of pools (at most METRICS_POOL_MAX are kept)
+ */
+void metrics_set_pools(const metrics_pool *pools, size_t count);
+
+/**
+ * @brief Serialize the next part of the exposition text
+ *
+ * Writes whole lines only. Counters keep moving between calls, so values
+ * are read as each line is written.
+ *
+ * @param pos   Export position; start at 0, advanced past what was written
+ * @param buf   Output buffer
+ * @param size  Size of buf; at least METRICS_LINE_MAX
+ * @return Number of bytes written; 0 once the export is complete
+ */
+size_t metrics_export(uint32_t *pos, char *buf, size_t size);
+
+#endif // METRICS_H
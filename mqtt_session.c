@@ -0,0 +1,127 @@
+/*
+File: mqtt_session.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Provides the MQTT outbox used by the MQTT client in network.c.
+    The outbox is a small fixed array; messages are ordered by an id that
+    only grows, which also tags each publish so its acknowledgement can be
+    matched up after other messages were dropped or replaced.
+
+Responsibilities:
+- Queue outgoing messages, replacing stale unsent values per topic
+- Track which messages are in flight and requeue them after failures
+
+Requires the following modules:
+- mqtt_session.h: for interface definitions
+*/
+
+#include "mqtt_session.h"
+
+#include <string.h>
+
+void mqtt_outbox_init(mqtt_outbox *box) {
+    memset(box, 0, sizeof(*box));
+    box->next_id = 1;
+}
+
+static mqtt_message *find_id(mqtt_outbox *box, uint32_t id) {
+    for (int i = 0; i < MQTT_OUTBOX_LEN; i++) {
+        if (id != 0 && box->msgs[i].id == id) {
+            return &box->msgs[i];
+        }
+    }
+    return NULL;
+}
+
+// Slot for a new message: a free one, or else the oldest message, which is dropped
+static mqtt_message *take_slot(mqtt_outbox *box) {
+    mqtt_message *oldest = &box->msgs[0];
+    for (int i = 0; i < MQTT_OUTBOX_LEN; i++) {
+        mqtt_message *m = &box->msgs[i];
+        if (m->id == 0) {
+            return m;
+        }
+        if (m->id < oldest->id) {
+            oldest = m;
+        }
+    }
+    box->dropped++;
+    return oldest;
+}
+
+bool mqtt_outbox_put(mqtt_outbox *box, const char *topic, const void *payload, size_t len,
+                     uint8_t qos, bool retain) {
+    if (len > MQTT_PAYLOAD_MAX) {
+        return false;
+    }
+
+    // A value still waiting to go out is superseded by the new one
+    mqtt_message *m = NULL;
+    for (int i = 0; i < MQTT_OUTBOX_LEN; i++) {
+        mqtt_message *q = &box->msgs[i];
+        if (q->id != 0 && !q->in_flight && strncmp(q->topic, topic, MQTT_TOPIC_MAX - 1) == 0) {
+            m = q;
+            break;
+        }
+    }
+    if (!m) {
+        m = take_slot(box);
+    }
+
+    m->id = box->next_id++;
+    if (box->next_id == 0) {
+        box->next_id = 1;  // 0 marks a free slot
+    }
+    m->in_flight = false;
+    m->retain = retain;
+    m->qos = qos;
+    m->len = (uint16_t)len;
+    strncpy(m->topic, topic, MQTT_TOPIC_MAX - 1);
+    m->topic[MQTT_TOPIC_MAX - 1] = '\0';
+    memcpy(m->payload, payload, len);
+    return true;
+}
+
+mqtt_message *mqtt_outbox_next(mqtt_outbox *box) {
+    mqtt_message *next = NULL;
+    for (int i = 0; i < MQTT_OUTBOX_LEN; i++) {
+        mqtt_message *m = &box->msgs[i];
+        if (m->id != 0 && !m->in_flight && (!next || m->id < next->id)) {
+            next = m;
+        }
+    }
+    return next;
+}
+
+void mqtt_outbox_done(mqtt_outbox *box, uint32_t id) {
+    mqtt_message *m = find_id(box, id);
+    if (m) {
+        m->id = 0;
+        m->in_flight = false;
+    }
+}
+
+void mqtt_outbox_retry(mqtt_outbox *box, uint32_t id) {
+    mqtt_message *m = find_id(box, id);
+    if (m) {
+        m->in_flight = false;
+    }
+}
+
+void mqtt_outbox_retry_all(mqtt_outbox *box) {
+    for (int i = 0; i < MQTT_OUTBOX_LEN; i++) {
+        box->msgs[i].in_flight = false;
+    }
+}
+
+size_t mqtt_outbox_count(const mqtt_outbox *box) {
+    size_t count = 0;
+    for (int i = 0; i < MQTT_OUTBOX_LEN; i++) {
+        if (box->msgs[i].id != 0) {
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,105 @@
+/*
+File: mqtt_session.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the MQTT outbox: the bounded queue of
+    messages waiting to be published or acknowledged, which outlives any
+    one broker connection. The MQTT client in network.c drives it from
+    lwIP callbacks.
+
+    This module has no hardware or lwIP dependencies so it can be unit
+    tested on the host (see test_mqtt_session.c).
+*/
+
+#ifndef MQTT_SESSION_H
+#define MQTT_SESSION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MQTT_OUTBOX_LEN    8     // Messages waiting to be sent or acknowledged
+#define MQTT_TOPIC_MAX     64    // Longest topic, including the null terminator
+#define MQTT_PAYLOAD_MAX   192   // Longest payload
+
+/**
+ * @brief One message in the outbox
+ */
+typedef struct {
+    uint32_t id;                      // Outbox order and publish callback tag; 0 when the slot is free
+    bool in_flight;                   // Handed to the MQTT stack and not yet acknowledged
+    bool retain;
+    uint8_t qos;
+    uint16_t len;
+    char topic[MQTT_TOPIC_MAX];
+    uint8_t payload[MQTT_PAYLOAD_MAX];
+} mqtt_message;
+
+/**
+ * @brief Bounded queue of outgoing messages
+ *
+ * A message stays here from mqtt_outbox_put() until the broker acknowledges
+ * it (QoS 1) or it has been sent (QoS 0), so it can be published again after
+ * a reconnect. A newer message for a topic replaces one that hasn't been
+ * sent yet, and when the outbox is full the oldest message is dropped.
+ */
+typedef struct {
+    mqtt_message msgs[MQTT_OUTBOX_LEN];
+    uint32_t next_id;
+    uint32_t dropped;                 // Messages discarded because the outbox was full
+} mqtt_outbox;
+
+/**
+ * @brief Empty the outbox
+ */
+void mqtt_outbox_init(mqtt_outbox *box);
+
+/**
+ * @brief Queue a message to publish
+ *
+ * @param box      Outbox
+ * @param topic    Topic name (truncated to MQTT_TOPIC_MAX - 1 characters)
+ * @param payload  Payload bytes
+ * @param len      Payload length; must not exceed MQTT_PAYLOAD_MAX
+ * @param qos      0 or 1
+ * @param retain   Ask the broker to keep the message for new subscribers
+ * @return false if the payload is too long; the message is not queued
+ */
+bool mqtt_outbox_put(mqtt_outbox *box, const char *topic, const void *payload, size_t len,
+                     uint8_t qos, bool retain);
+
+/**
+ * @brief Oldest message not yet handed to the MQTT stack
+ *
+ * @return Message to publish next, or NULL if none is waiting
+ */
+mqtt_message *mqtt_outbox_next(mqtt_outbox *box);
+
+/**
+ * @brief The broker acknowledged a message, or a QoS 0 message went out
+ *
+ * @param box  Outbox
+ * @param id   Message id; unknown ids (e.g. dropped messages) are ignored
+ */
+void mqtt_outbox_done(mqtt_outbox *box, uint32_t id);
+
+/**
+ * @brief A publish failed or timed out; send the message again later
+ *
+ * @param box  Outbox
+ * @param id   Message id; unknown ids are ignored
+ */
+void mqtt_outbox_retry(mqtt_outbox *box, uint32_t id);
+
+/**
+ * @brief The connection was lost; every in-flight message goes out again
+ */
+void mqtt_outbox_retry_all(mqtt_outbox *box);
+
+/**
+ * @brief Number of messages in the outbox
+ */
+size_t mqtt_outbox_count(const mqtt_outbox *box);
+
+#endif // MQTT_SESSION_H
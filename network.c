@@ -4,10 +4,9 @@ Language: C
 Author: Andrew Poon
 Date: 11/22/25
 Description:
-    Provides initialization and control functionality for the CYW43 WiFi
-    chip on the Raspberry Pi Pico2W and also a HTTP server. This module is
-    responsible for bringing up the device in WiFi access point (AP) mode so
-    that other devices (laptops, phones, etc) can connect to the Pico’s network.
+    The HTTP server of the Raspberry Pi Pico2W. Once network_wifi.c has
+    brought up the CYW43 WiFi chip, this module answers the devices
+    (laptops, phones, etc) that connect to the Pico's network.
 
     Portions of WiFi initialization and lwIP/TCP logic were adapted from the
     official Raspberry Pi Pico SDK WiFi examples and is licensed as follows:
@@ -16,317 +15,1532 @@ Description:
     Source: https://github.com/raspberrypi/pico-examples/blob/master/pico_w/
 
 Responsibilities:
-- Initialize CYW43 WiFi
-- Start WiFi AP with given SSID and password
 - Create TCP listener on configured HTTP port
-- Accept incoming HTTP connection and return HTML page
+- Accept incoming HTTP connections and keep them open for further requests
+- Close connections reliably, retrying a failed close and aborting as a last resort
+- Serve the static page assets from flash, gzip-compressed when accepted
+- Serve the latest reading as JSON on /api/v1/readings
+- Push each new reading to Server-Sent Events subscribers on /events
+- Accept WebSocket clients on /ws for telemetry and LED/sampling control
+
+The WiFi radio, DHCP and mDNS servers, UDP telemetry and MQTT are in
+network_wifi.c. TCP goes through the hal_tcp_* functions of hal.h, so the
+same server runs on lwIP on the Pico and on loopback in the host build.
 
 Requires the following modules:
 - network.h: for interface definitions
+- network_wifi.h: for the WiFi side's metrics and the shared settings
+- hal.h: for TCP connections
+- conn_pool.h: for the state of each HTTP connection slot
+- http_parser.h: for incremental parsing of requests as they arrive
+- web_api.h: for JSON serialization of readings
+- web_assets.h: for the static page assets embedded at build time
+- websocket.h: for the WebSocket handshake and framing
+- snapshot.h: for reading the latest sample published by main.c
+- power.h: for the power state statistics served at /metrics
+- i2c_bus.h: for the I2C bus statistics served at /metrics
+- le_pack.h: for the little-endian WebSocket telemetry frame
 */
 
 #include "network.h"
+#include "network_wifi.h"
+#include "conn_pool.h"
+#include "hal.h"
+#include "history.h"
+#include "http_parser.h"
+#include "i2c_bus.h"
+#include "le_pack.h"
 #include "led_array.h"
-#include "web_ui.h"
+#include "metrics.h"
+#include "power.h"
+#include "sensor.h"
+#include "snapshot.h"
+#include "web_api.h"
+#include "web_assets.h"
+#include "websocket.h"
 
-#include "pico/cyw43_arch.h"
-#include "lwip/tcp.h"
+#include "pico/stdlib.h"
 
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-extern float g_latest_humidity;
-extern float g_latest_temp_f;
+extern snapshot_seqlock g_latest;
+extern volatile uint32_t g_sample_interval_ms;
 
 #define HTTP_PORT_DEFAULT 80
-#define HTTP_BODY_MAX     4096
-#define HTTP_RESP_MAX     (HTTP_BODY_MAX + 512)
 
-// TCP listener for the HTTP server
-static struct tcp_pcb *http_listener_pcb = NULL;
+#define HTTP_POLL_INTERVAL  2     // Poll interval in HAL_TCP_POLL_MS ticks
+#define HTTP_IDLE_TIMEOUT_S 15    // Close keep-alive connections idle this long
+#define HTTP_KEEPALIVE_MAX  100   // Requests served per connection before closing
+#define HTTP_PENDING_MAX    512   // Response bytes held per connection while the TCP send buffer is full
+#define HTTP_POOL_LOW_PCT   75    // Heap or segment pool use at which idle connections are evicted
+#define HTTP_STRINGIFY_(x)  #x
+#define HTTP_STRINGIFY(x)   HTTP_STRINGIFY_(x)
+
+#define HTTP_STREAM_CHUNK   1024  // Largest piece of a streamed body produced at once
+#define HTTP_CHUNK_HEAD     6     // Room for a chunk-size line ("3ff\r\n" fits easily)
+#define HTTP_STREAM_MIN     128   // Smallest piece offered to a producer (fits a /metrics line)
+#define HTTP_LENGTH_UNKNOWN SIZE_MAX  // Content length of a body produced as it streams
+
+#define SSE_EVENT_MAX       256   // Largest serialized Server-Sent Event
+
+#define WS_TELEMETRY_LEN    20    // Payload size of a binary telemetry frame
+#define SAMPLE_INTERVAL_MIN_MS  500
+#define SAMPLE_INTERVAL_MAX_MS  60000
+
+#define SET_PARAMS_MAX      4     // Settings accepted in one /set request or WebSocket message
+
+#define API_HISTORY_PATH  "/api/v1/history"
+#define API_READINGS_PATH "/api/v1/readings"
+#define METRICS_PATH      "/metrics"
+#define SSE_EVENTS_PATH   "/events"
+#define SET_PATH          "/set"
+#define WS_PATH           "/ws"
+
+static bool s_started = false;   // Listening for HTTP connections
+
+// Lightweight HTTP server implementation
+
+typedef struct http_conn http_conn;
+
+// Produces the next part of a streamed response body into buf, at most size
+// bytes, and advances conn->body_pos past it. Returns the number of bytes
+// written; 0 ends the body. Producing again from the same body_pos must give
+// the same bytes, since a piece the stack had no memory for is produced again later.
+typedef size_t (*http_body_fn)(http_conn *conn, char *buf, size_t size);
+
+// Per-connection state, handed to every TCP callback through hal_tcp_attach()
+struct http_conn {
+    hal_tcp_conn *tcp;         // TCP connection, NULL when the slot is free
+    union {
+        http_parser http_rx;     // Request parser, resumes where the last segment ended
+        ws_parser ws_rx;         // Frame parser once upgraded to a WebSocket
+    };
+    hal_tcp_data *rx_held;     // Received data waiting for a streamed response to finish
+    uint16_t rx_held_offset;   // Bytes at the start of rx_held already parsed
+    http_body_fn body_fn;      // Producer of the body being streamed, or NULL
+    const uint8_t *body_data;  // Constant body still being sent by reference, or NULL
+    uint32_t body_left;        // Bytes of body_data not yet queued
+    uint32_t body_pos;         // Producer's position within its data
+    history_query history;     // Export being streamed by history_body()
+    bool chunked;              // Streamed body uses chunked transfer coding
+    bool http11;               // Current request was HTTP/1.1 (may use chunked coding)
+    uint32_t unacked;          // Response bytes queued but not yet acknowledged
+    uint16_t pending_len;      // Bytes in pending not yet handed to the stack
+    uint8_t pending[HTTP_PENDING_MAX];  // Response bytes written while the send buffer was full
+    uint32_t request_us;       // When the current request arrived, for the latency histogram
+    uint8_t idle_polls;        // Poll intervals since the last activity
+    uint8_t requests;          // Requests served on this connection
+    bool keep_alive;           // Leave the connection open after the current response
+    bool sse;                  // Connection is subscribed to the /events stream
+    bool ws;                   // Connection was upgraded to a WebSocket
+};
+
+// Fixed pool of connections, one slot per concurrent client. s_conn_pool
+// keeps the state of each slot: reading, writing, closing or closed (free).
+static http_conn s_conns[HTTP_MAX_CLIENTS];
+static conn_pool s_conn_pool;
+static void (*volatile s_on_connect)(void) = NULL;   // Wakes the power manager for a new client
+
+// Latest reading serialized once as an SSE event and shared by every subscriber
+static char   s_sse_event[SSE_EVENT_MAX];
+static size_t s_sse_event_len = 0;
+
+// Latest reading as one binary WebSocket frame, shared the same way
+static uint8_t s_ws_frame[2 + WS_TELEMETRY_LEN];
+static size_t  s_ws_frame_len = 0;
+
+// Scratch space for streamed bodies, shared by every connection since the
+// stack copies each piece out before the next is produced. Laid out as a
+// chunk-size line, up to HTTP_STREAM_CHUNK bytes of body and the chunk's
+// closing CRLF.
+static char s_stream_buf[HTTP_CHUNK_HEAD + HTTP_STREAM_CHUNK + 2];
+
+_Static_assert(HTTP_MAX_CLIENTS <= CONN_POOL_MAX, "HTTP_MAX_CLIENTS exceeds CONN_POOL_MAX");
 
-// WiFi / Access Point (AP) setup
-bool wifi_start_ap(const char *ssid, const char *password) {
-    // Initialize the CYW43 Wi-Fi chip + lwIP networking stack
-    if (cyw43_arch_init()) {
-        printf("ERROR: cyw43_arch_init() failed\n");
+// Forward declarations of callbacks
+static int  http_accept(hal_tcp_conn *tcp);
+static int  http_recv(void *arg, hal_tcp_data *data);
+static void http_err(void *arg, int err);
+static int  http_sent(void *arg, uint16_t len);
+static int  http_poll(void *arg);
+static void http_check_tables(void);
+static void http_receive(http_conn *conn, hal_tcp_data *data, uint16_t offset);
+
+static const hal_tcp_callbacks HTTP_CALLBACKS = {
+    .recv = http_recv,
+    .sent = http_sent,
+    .poll = http_poll,
+    .error = http_err,
+};
+
+// Setting handlers validate a value and, when apply is true, also apply it.
+// They return false if the value is not recognized.
+typedef bool (*setting_handler)(const char *value, bool apply);
+
+static bool set_led(const char *value, bool apply) {
+    bool on;
+    if (strcmp(value, "on") == 0) {
+        on = true;
+    } else if (strcmp(value, "off") == 0) {
+        on = false;
+    } else {
         return false;
     }
+    if (apply) {
+        led_array_set_enabled(on);
+        printf("HTTP: LED %s via web UI\n", on ? "enabled" : "disabled");
+    }
+    return true;
+}
 
-    // Enable AP mode with given SSID/password
-    cyw43_arch_enable_ap_mode(ssid, password, CYW43_AUTH_WPA2_AES_PSK);
-    printf("WiFi AP started with SSID '%s'\n", ssid);
+static bool set_brightness(const char *value, bool apply) {
+    char *end;
+    long level = strtol(value, &end, 10);
+    if (end == value || *end != '\0' || level < 0 || level > 255) {
+        return false;
+    }
+    if (apply) {
+        led_array_set_brightness((uint8_t)level);
+        printf("HTTP: LED brightness set to %ld\n", level);
+    }
+    return true;
+}
 
+static bool set_interval(const char *value, bool apply) {
+    char *end;
+    long interval = strtol(value, &end, 10);
+    if (end == value || *end != '\0' ||
+        interval < SAMPLE_INTERVAL_MIN_MS || interval > SAMPLE_INTERVAL_MAX_MS) {
+        return false;
+    }
+    if (apply) {
+        g_sample_interval_ms = (uint32_t)interval;
+        printf("HTTP: sample interval set to %ld ms\n", interval);
+    }
     return true;
 }
 
-// Lightweight HTTP server implementation
+typedef struct {
+    const char *name;          // Parameter name, e.g. "led"
+    setting_handler handler;
+} setting;
 
-// Forward declarations of callbacks
-static err_t http_accept(void *arg, struct tcp_pcb *new_pcb, err_t err);
-static err_t http_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);
-static void  http_err(void *arg, err_t err);
-static err_t http_sent(void *arg, struct tcp_pcb *tpcb, u16_t len);
-
-static void handle_set_request(const char *param_name, const char *param_value) {
-    if (strcmp(param_name, "led") == 0) {
-        if (strcmp(param_value, "on") == 0) {
-            led_array_set_enabled(true);
-            printf("HTTP: LED enabled via web UI\n");
-        } else if (strcmp(param_value, "off") == 0) {
-            led_array_set_enabled(false);
-            printf("HTTP: LED disabled via web UI\n");
+// Settings accepted by /set and WebSocket control messages, sorted by name
+// (strcmp order) for bsearch
+static const setting SETTINGS[] = {
+    { "brightness", set_brightness },
+    { "interval",   set_interval },
+    { "led",        set_led },
+};
+
+#define SETTING_COUNT (sizeof(SETTINGS) / sizeof(SETTINGS[0]))
+
+// bsearch comparator for tables whose first member is a name or path string
+static int compare_name(const void *key, const void *entry) {
+    return strcmp((const char *)key, *(const char *const *)entry);
+}
+
+// Apply the name=value settings in a query-style string such as
+// "led=on&brightness=64", decoding it in place. Every setting is checked
+// before any is applied, so a bad one leaves the device unchanged.
+// Returns false if any setting or value is not recognized.
+bool web_server_apply_settings(char *query) {
+    setting_handler handlers[SET_PARAMS_MAX];
+    const char *values[SET_PARAMS_MAX];
+    size_t count = 0;
+
+    char *cursor = query;
+    char *name, *value;
+    http_query_result result;
+    while ((result = http_query_next(&cursor, &name, &value)) == HTTP_QUERY_PARAM) {
+        const setting *found = bsearch(name, SETTINGS, SETTING_COUNT, sizeof(SETTINGS[0]),
+                                       compare_name);
+        if (!found || count == SET_PARAMS_MAX || !found->handler(value, false)) {
+            return false;
         }
+        handlers[count] = found->handler;
+        values[count] = value;
+        count++;
     }
+    if (result == HTTP_QUERY_ERROR || count == 0) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        handlers[i](values[i], true);
+    }
+
+    // Let other open pages, WebSocket clients and MQTT subscribers see the new state right away
+    web_server_publish_reading();
+    mqtt_telemetry_publish();
+    return true;
 }
 
-// Helper that closes a TCP connection
-static void http_connection_close(struct tcp_pcb *tpcb) {
-    if (!tpcb) return;
+// Index of a connection's slot in s_conns and s_conn_pool
+static int http_conn_slot(const http_conn *conn) {
+    return (int)(conn - s_conns);
+}
 
-    cyw43_arch_lwip_begin();
+// True once a close has been requested; no further requests are answered
+static bool http_conn_closing(const http_conn *conn) {
+    return conn_pool_state(&s_conn_pool, http_conn_slot(conn)) == CONN_CLOSING;
+}
+
+// Close the connection once everything queued has been acknowledged
+static void http_conn_close_when_sent(http_conn *conn) {
+    conn_pool_set_state(&s_conn_pool, http_conn_slot(conn), CONN_CLOSING);
+}
+
+// Take a free connection slot, or NULL if every client slot is in use
+static http_conn *http_conn_alloc(hal_tcp_conn *tcp) {
+    int slot = conn_pool_alloc(&s_conn_pool);
+    if (slot < 0) return NULL;
+    if (s_on_connect) s_on_connect();
+
+    http_conn *conn = &s_conns[slot];
+    memset(conn, 0, sizeof(*conn));
+    conn->tcp = tcp;
+    http_parser_init(&conn->http_rx);
+    return conn;
+}
+
+// Install the connection's TCP callbacks
+static void http_conn_attach(http_conn *conn, hal_tcp_conn *tcp) {
+    hal_tcp_attach(tcp, conn, &HTTP_CALLBACKS, HTTP_POLL_INTERVAL);
+}
+
+// Helper that closes a TCP connection and releases its slot. hal_tcp_close()
+// fails when the stack has no memory for the FIN; the connection then stays in
+// CONN_CLOSING with its callbacks in place and http_poll() tries again. After
+// CONN_CLOSE_RETRIES more failures it is aborted, so a connection is never
+// leaked. Returns HAL_TCP_ABORTED if it was aborted, which a TCP callback for
+// this connection must return.
+static int http_connection_close(http_conn *conn) {
+    if (!conn || !conn->tcp) return HAL_TCP_OK;
+
+    hal_tcp_conn *tcp = conn->tcp;
+    int result = HAL_TCP_OK;
+
+    hal_tcp_lock();
+
+    // Drop any request data that was waiting behind a streamed response,
+    // and output that never made it to the stack
+    if (conn->rx_held) {
+        hal_tcp_data_free(conn->rx_held);
+        conn->rx_held = NULL;
+    }
+    conn->pending_len = 0;
+    conn->body_fn = NULL;
+    conn->body_data = NULL;
 
-    // Remove callbacks from connection
-    tcp_arg(tpcb, NULL);
-    tcp_recv(tpcb, NULL);
-    tcp_sent(tpcb, NULL);
-    tcp_err(tpcb, NULL);
+    // Remove callbacks from connection; a successful close may free it
+    hal_tcp_detach(tcp);
 
     // Closes connection
-    tcp_close(tpcb);
+    int err = hal_tcp_close(tcp);
+    switch (conn_pool_close_result(&s_conn_pool, http_conn_slot(conn), err == HAL_TCP_OK)) {
+        case CONN_CLOSE_DONE:
+            conn->tcp = NULL;
+            break;
+        case CONN_CLOSE_RETRY:
+            printf("HTTP: hal_tcp_close() failed: %d, retrying\n", err);
+            http_conn_attach(conn, tcp);
+            break;
+        case CONN_CLOSE_ABORT:
+            printf("ERROR: hal_tcp_close() failed %d times, aborting connection\n",
+                   CONN_CLOSE_RETRIES + 1);
+            conn->tcp = NULL;
+            metrics_count(METRIC_HTTP_ABORTED);
+            hal_tcp_abort(tcp);
+            result = HAL_TCP_ABORTED;
+            break;
+    }
+
+    hal_tcp_unlock();
+    return result;
+}
+
+// True if the stack can take len more bytes on the connection right now
+static bool http_conn_can_write(const http_conn *conn, size_t len) {
+    return hal_tcp_send_slots(conn->tcp) >= 2 && hal_tcp_send_space(conn->tcp) >= len;
+}
+
+// Hand as much of the pending output to the stack as it will take. Returns true
+// once nothing is left pending.
+static bool http_conn_flush(http_conn *conn) {
+    while (conn->pending_len > 0) {
+        if (hal_tcp_send_slots(conn->tcp) < 2) return false;
+        uint16_t n = hal_tcp_send_space(conn->tcp);
+        if (n > conn->pending_len) n = conn->pending_len;
+        if (n == 0) return false;
+        if (hal_tcp_write(conn->tcp, conn->pending, n, HAL_TCP_WRITE_COPY | HAL_TCP_WRITE_MORE) != HAL_TCP_OK) {
+            return false;
+        }
+        conn->unacked += n;
+        conn->pending_len -= n;
+        memmove(conn->pending, conn->pending + n, conn->pending_len);
+    }
+    return true;
+}
+
+// Queue bytes on the connection. The stack copies them into its send buffer when
+// it has room; otherwise they wait in the connection's pending buffer and go
+// out from http_sent() or http_poll() as the client acknowledges data.
+// Returns false only if the pending buffer is full too.
+static bool http_conn_write(http_conn *conn, const void *data, uint16_t len) {
+    if (conn->pending_len == 0 && http_conn_can_write(conn, len)) {
+        int err = hal_tcp_write(conn->tcp, data, len, HAL_TCP_WRITE_COPY | HAL_TCP_WRITE_MORE);
+        if (err == HAL_TCP_OK) {
+            conn->unacked += len;
+            return true;
+        }
+        if (err != HAL_TCP_ERR_MEM) {
+            printf("ERROR: hal_tcp_write() failed: %d\n", err);
+            return false;
+        }
+    }
+
+    // Keep the bytes in order behind whatever is already waiting
+    if (len > HTTP_PENDING_MAX - conn->pending_len) {
+        printf("ERROR: HTTP send buffer full, dropping %u bytes\n", len);
+        return false;
+    }
+    memcpy(conn->pending + conn->pending_len, data, len);
+    conn->pending_len += len;
+    metrics_count(METRIC_HTTP_DEFERRED);
+    return true;
+}
+
+// True once every queued byte has been sent and acknowledged
+static bool http_conn_drained(const http_conn *conn) {
+    return conn->unacked == 0 && conn->pending_len == 0;
+}
+
+// Push queued data out and decide whether the connection stays open
+static void http_conn_finish_response(http_conn *conn) {
+    int err = hal_tcp_output(conn->tcp);
+    if (err != HAL_TCP_OK) {
+        printf("ERROR: hal_tcp_output() failed: %d\n", err);
+    }
+    metrics_observe(METRIC_TIME_HTTP, time_us_32() - conn->request_us);
+    conn->requests++;
+    if (!conn->keep_alive) {
+        http_conn_close_when_sent(conn);
+    }
+}
+
+// True while a response body is still being streamed out
+static bool http_conn_streaming(const http_conn *conn) {
+    return conn->body_fn != NULL || conn->body_data != NULL;
+}
+
+// True while earlier output still has to reach the stack; later requests wait
+static bool http_conn_busy(const http_conn *conn) {
+    return http_conn_streaming(conn) || conn->pending_len > 0;
+}
+
+// Track whether the connection is sending a response or waiting for the next request
+static void http_conn_update_state(const http_conn *conn) {
+    bool writing = http_conn_busy(conn) || conn->unacked > 0;
+    conn_pool_set_state(&s_conn_pool, http_conn_slot(conn), writing ? CONN_WRITING : CONN_READING);
+}
+
+// True for a keep-alive connection waiting for its next request, the only
+// kind that can be closed early without cutting a response short
+static bool http_conn_idle(const http_conn *conn) {
+    return conn->tcp && conn->requests > 0 && !http_conn_busy(conn) && !http_conn_closing(conn) &&
+           !conn->sse && !conn->ws && conn->unacked == 0 && !conn->rx_held &&
+           http_parser_idle(&conn->http_rx);
+}
+
+// True once the stack's heap or TCP segment pool is HTTP_POOL_LOW_PCT full
+static bool http_pools_low(void) {
+    return hal_tcp_pools_low(HTTP_POOL_LOW_PCT);
+}
+
+// Close the idle connection that has waited longest. Returns false if none is idle.
+static bool http_evict_idle(void) {
+    http_conn *oldest = NULL;
+    for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+        http_conn *conn = &s_conns[i];
+        if (http_conn_idle(conn) && (!oldest || conn->idle_polls > oldest->idle_polls)) {
+            oldest = conn;
+        }
+    }
+    if (!oldest) return false;
+    printf("HTTP: evicting idle connection\n");
+    metrics_count(METRIC_HTTP_EVICTED);
+    http_connection_close(oldest);
+    return true;
+}
+
+// A streamed body has been fully queued
+static void http_stream_finish(http_conn *conn) {
+    conn->body_fn = NULL;
+    conn->body_data = NULL;
+    conn->body_left = 0;
+    http_conn_finish_response(conn);
+}
+
+// Queue as much of a streamed body as the stack will take right now. Called
+// when the response starts and again as the client acknowledges data, so a
+// body of any size goes out through a fixed amount of RAM. Running out of send
+// buffer or stack memory just pauses the stream until the next call.
+// Deferred output from http_conn_write() goes first, keeping bytes in order.
+static void http_stream_pump(http_conn *conn) {
+    if (conn->tcp && !http_conn_flush(conn)) {
+        hal_tcp_output(conn->tcp);
+        return;
+    }
+    while (conn->tcp && http_conn_streaming(conn)) {
+        // Leave a few queue entries for the size line, data and CRLF of a chunk
+        if (hal_tcp_send_slots(conn->tcp) < 4) break;
+        size_t space = hal_tcp_send_space(conn->tcp);
+
+        if (conn->body_data) {
+            // Constant data in flash is queued by reference, no copy
+            uint16_t n = (uint16_t)((conn->body_left < space) ? conn->body_left : space);
+            if (n == 0) break;
+            if (hal_tcp_write(conn->tcp, conn->body_data, n, HAL_TCP_WRITE_MORE) != HAL_TCP_OK) break;
+            conn->unacked += n;
+            conn->body_data += n;
+            conn->body_left -= n;
+            if (conn->body_left == 0) {
+                http_stream_finish(conn);
+            }
+            continue;
+        }
+
+        // Produced data: wait until a worthwhile piece fits
+        size_t overhead = conn->chunked ? HTTP_CHUNK_HEAD + 2 : 0;
+        if (space < overhead + HTTP_STREAM_MIN) break;
+        size_t room = space - overhead;
+        if (room > HTTP_STREAM_CHUNK) room = HTTP_STREAM_CHUNK;
+
+        uint32_t start_pos = conn->body_pos;
+        char *data = s_stream_buf + HTTP_CHUNK_HEAD;
+        size_t n = conn->body_fn(conn, data, room);
+
+        if (n == 0) {
+            // End of body; a chunked body ends with a zero-size chunk
+            static const char last_chunk[] = "0\r\n\r\n";
+            if (conn->chunked) {
+                if (hal_tcp_write(conn->tcp, last_chunk, sizeof(last_chunk) - 1, 0) != HAL_TCP_OK) break;
+                conn->unacked += sizeof(last_chunk) - 1;
+            }
+            http_stream_finish(conn);
+            break;
+        }
+
+        // Frame the piece as one chunk so it goes to the stack in a single write
+        char *start = data;
+        size_t len = n;
+        if (conn->chunked) {
+            char size_line[HTTP_CHUNK_HEAD + 1];
+            int head_len = snprintf(size_line, sizeof(size_line), "%x\r\n", (unsigned)n);
+            start -= head_len;
+            memcpy(start, size_line, (size_t)head_len);
+            memcpy(data + n, "\r\n", 2);
+            len += (size_t)head_len + 2;
+        }
+        if (hal_tcp_write(conn->tcp, start, (uint16_t)len,
+                          HAL_TCP_WRITE_COPY | HAL_TCP_WRITE_MORE) != HAL_TCP_OK) {
+            conn->body_pos = start_pos;  // Produce the same piece again next time
+            break;
+        }
+        conn->unacked += len;
+    }
+
+    if (conn->tcp) {
+        hal_tcp_output(conn->tcp);
+    }
+}
+
+// Keep a streamed response moving, then go back to any requests that
+// arrived while it was being sent
+static void http_conn_continue(http_conn *conn) {
+    if (!conn->tcp) return;
+
+    hal_tcp_lock();
+    http_stream_pump(conn);
+    hal_tcp_unlock();
+
+    if (conn->tcp && !http_conn_busy(conn) && conn->rx_held) {
+        hal_tcp_data *data = conn->rx_held;
+        conn->rx_held = NULL;
+        http_receive(conn, data, conn->rx_held_offset);
+    }
+}
+
+// Format the Connection (and Keep-Alive) headers for the current response
+static void format_connection_headers(const http_conn *conn, char *buf, size_t size) {
+    if (conn->keep_alive) {
+        snprintf(buf, size,
+                 "Connection: keep-alive\r\n"
+                 "Keep-Alive: timeout=%d, max=%d\r\n",
+                 HTTP_IDLE_TIMEOUT_S, HTTP_KEEPALIVE_MAX - conn->requests);
+    } else {
+        snprintf(buf, size, "Connection: close\r\n");
+    }
+}
+
+// Format the status line and headers shared by every response. A content_len
+// of HTTP_LENGTH_UNKNOWN announces a chunked body (conn->chunked must be set).
+static int format_http_header(const http_conn *conn, char *buf, size_t size,
+                              const char *status, const char *content_type,
+                              const char *extra, size_t content_len) {
+    metrics_count_http_status(status);
+
+    char connection[64];
+    format_connection_headers(conn, connection, sizeof(connection));
+
+    char length[40];
+    if (content_len == HTTP_LENGTH_UNKNOWN) {
+        snprintf(length, sizeof(length), "%s",
+                 conn->chunked ? "Transfer-Encoding: chunked\r\n" : "");
+    } else {
+        snprintf(length, sizeof(length), "Content-Length: %zu\r\n", content_len);
+    }
+
+    return snprintf(buf, size,
+                    "HTTP/1.1 %s\r\n"
+                    "Content-Type: %s\r\n"
+                    "%s"
+                    "%s"
+                    "%s"
+                    "\r\n",
+                    status, content_type, extra ? extra : "", connection, length);
+}
+
+// Start a response whose body is produced piece by piece by body_fn. When
+// content_len is HTTP_LENGTH_UNKNOWN the body is sent with chunked transfer
+// coding, or for an HTTP/1.0 client ended by closing the connection.
+static void http_start_stream(http_conn *conn, const char *status, const char *content_type,
+                              const char *extra, size_t content_len, http_body_fn body_fn) {
+    if (content_len == HTTP_LENGTH_UNKNOWN) {
+        conn->chunked = conn->http11;
+        if (!conn->chunked) {
+            conn->keep_alive = false;
+        }
+    } else {
+        conn->chunked = false;
+    }
+
+    char header[384];
+    int header_len = format_http_header(conn, header, sizeof(header), status, content_type,
+                                        extra, content_len);
+
+    hal_tcp_lock();
+    if (http_conn_write(conn, header, (uint16_t)header_len)) {
+        conn->body_fn = body_fn;
+        conn->body_pos = 0;
+        http_stream_pump(conn);
+    } else {
+        conn->keep_alive = false;
+        http_conn_finish_response(conn);
+    }
+    hal_tcp_unlock();
+}
+
+// Answer a conditional GET whose cached copy is still current; 304 has no body.
+// extra carries the validator and caching headers of the unchanged resource.
+static void send_not_modified(http_conn *conn, const char *extra) {
+    metrics_count(METRIC_HTTP_3XX);
+
+    char connection[64];
+    format_connection_headers(conn, connection, sizeof(connection));
+
+    char header[256];
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.1 304 Not Modified\r\n"
+                              "%s"
+                              "%s"
+                              "\r\n",
+                              extra, connection);
+
+    hal_tcp_lock();
+    http_conn_write(conn, header, (uint16_t)header_len);
+    http_conn_finish_response(conn);
+    hal_tcp_unlock();
+}
+
+// Status line for a request the parser rejected
+static const char *http_error_status(uint16_t code) {
+    switch (code) {
+        case 414: return "414 URI Too Long";
+        case 431: return "431 Request Header Fields Too Large";
+        case 501: return "501 Not Implemented";
+        case 505: return "505 HTTP Version Not Supported";
+        default:  return "400 Bad Request";
+    }
+}
+
+// Send a short plain-text status response; extra holds additional headers or NULL.
+// The connection stays open if the request allowed it.
+static void send_http_status(http_conn *conn, const char *status, const char *extra) {
+    char body[48];
+    int body_len = snprintf(body, sizeof(body), "%s\n", status);
+
+    char header[224];
+    int header_len = format_http_header(conn, header, sizeof(header), status,
+                                        "text/plain", extra, (size_t)body_len);
+
+    hal_tcp_lock();
+    if (http_conn_write(conn, header, (uint16_t)header_len)) {
+        http_conn_write(conn, body, (uint16_t)body_len);
+    }
+    http_conn_finish_response(conn);
+    hal_tcp_unlock();
+}
 
-    cyw43_arch_lwip_end();
+// Send a short plain-text error response and close the connection afterwards
+static void send_http_error(http_conn *conn, const char *status) {
+    conn->keep_alive = false;
+    send_http_status(conn, status, NULL);
 }
 
 // Start the web server and listen for HTTP connections
+uint32_t web_server_client_count(void) {
+    return (uint32_t)(conn_pool_count(&s_conn_pool, CONN_READING) +
+                      conn_pool_count(&s_conn_pool, CONN_WRITING));
+}
+
+void web_server_set_connect_callback(void (*on_connect)(void)) {
+    s_on_connect = on_connect;
+}
+
 bool web_server_start(uint16_t port) {
     if (port == 0) {
         port = HTTP_PORT_DEFAULT;
     }
 
-    cyw43_arch_lwip_begin();
+    http_check_tables();
+    conn_pool_init(&s_conn_pool, HTTP_MAX_CLIENTS);
 
-    // Create new TCP listener
-    http_listener_pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
-    if (!http_listener_pcb) {
-        cyw43_arch_lwip_end();
-        printf("ERROR: tcp_new_ip_type() failed\n");
+    hal_tcp_lock();
+    s_started = hal_tcp_listen(port, HTTP_MAX_CLIENTS, http_accept);
+    hal_tcp_unlock();
+    if (!s_started) {
         return false;
     }
 
-    // Bind listener to the given port
-    err_t err = tcp_bind(http_listener_pcb, IP_ANY_TYPE, port);
-    if (err != ERR_OK) {
-        printf("ERROR: tcp_bind() failed: %d\n", err);
-        tcp_close(http_listener_pcb);
-        http_listener_pcb = NULL;
-        cyw43_arch_lwip_end();
-        return false;
+    printf("HTTP server listening on port %u (max %d clients)\n", port, HTTP_MAX_CLIENTS);
+    return true;
+}
+
+// Turn away a client when every slot is busy. The fixed response is queued
+// by reference and the connection closed right behind it, so the client
+// learns when to retry without the server keeping any state for it.
+static int http_reject(hal_tcp_conn *tcp) {
+    static const char response[] =
+        "HTTP/1.1 503 Service Unavailable\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: 20\r\n"
+        "Retry-After: " HTTP_STRINGIFY(HTTP_RETRY_AFTER_S) "\r\n"
+        "Connection: close\r\n"
+        "\r\n"
+        "Service Unavailable\n";
+
+    metrics_count(METRIC_HTTP_REJECTED);
+    metrics_count(METRIC_HTTP_5XX);
+    if (hal_tcp_write(tcp, response, sizeof(response) - 1, 0) == HAL_TCP_OK) {
+        hal_tcp_output(tcp);
+    }
+    if (hal_tcp_close(tcp) != HAL_TCP_OK) {
+        hal_tcp_abort(tcp);
+        return HAL_TCP_ABORTED;
     }
+    return HAL_TCP_OK;
+}
 
-    // Convert listener to be ready to accept clients
-    struct tcp_pcb *listen_pcb = tcp_listen_with_backlog(http_listener_pcb, 1);
-    if (!listen_pcb) {
-        printf("ERROR: tcp_listen_with_backlog() failed\n");
-        tcp_close(http_listener_pcb);
-        http_listener_pcb = NULL;
-        cyw43_arch_lwip_end();
-        return false;
+// Called when a new client opens a TCP connection
+static int http_accept(hal_tcp_conn *tcp) {
+    // Make room by closing idle keep-alive connections first
+    if (http_pools_low()) {
+        http_evict_idle();
+    }
+    http_conn *conn = http_conn_alloc(tcp);
+    if (!conn && http_evict_idle()) {
+        conn = http_conn_alloc(tcp);
+    }
+    if (!conn) {
+        printf("HTTP: all %d client slots busy, rejecting connection\n", HTTP_MAX_CLIENTS);
+        return http_reject(tcp);
     }
 
-    http_listener_pcb = listen_pcb;
+    printf("HTTP: client connected\n");
 
-    // Set the callback that triggers when a new client connects
-    tcp_arg(http_listener_pcb, NULL);
-    tcp_accept(http_listener_pcb, http_accept);
+    http_conn_attach(conn, tcp);
 
-    cyw43_arch_lwip_end();
+    return HAL_TCP_OK;
+}
 
-    printf("HTTP server listening on port %u\n", port);
-    return true;
+// Find the embedded static asset served at a path, or NULL. The path has no
+// query string (cache-busting versions such as ?v=1a2b are parsed off), and
+// the generated table is sorted by path.
+static const web_asset *find_web_asset(const char *path) {
+    return bsearch(path, WEB_ASSETS, WEB_ASSET_COUNT, sizeof(WEB_ASSETS[0]), compare_name);
 }
 
-// Called when a new client opens a TCP connection
-static err_t http_accept(void *arg, struct tcp_pcb *new_pcb, err_t err) {
-    (void)arg;
-    (void)err;
+// Send a static asset straight from flash, gzip-compressed if the client accepts it.
+// Each encoding has its own strong ETag, so a matching If-None-Match gets a 304.
+static void send_web_asset(http_conn *conn, const web_asset *asset, bool gzip_ok,
+                           const char *if_none_match) {
+    const uint8_t *body = gzip_ok ? asset->gzip_data : asset->data;
+    size_t body_len = gzip_ok ? asset->gzip_len : asset->len;
+    const char *etag = gzip_ok ? asset->gzip_etag : asset->etag;
+
+    char extra[192];
+    snprintf(extra, sizeof(extra),
+             "%s"
+             "Vary: Accept-Encoding\r\n"
+             "ETag: %s\r\n"
+             "Cache-Control: %s\r\n",
+             gzip_ok ? "Content-Encoding: gzip\r\n" : "", etag, asset->cache_control);
+
+    if (http_etag_matches(if_none_match, etag)) {
+        printf("HTTP: %s not modified\n", asset->path);
+        send_not_modified(conn, extra);
+        return;
+    }
 
-    printf("HTTP: client connected\n");
+    char header[384];
+    int header_len = format_http_header(conn, header, sizeof(header), "200 OK",
+                                        asset->content_type, extra, body_len);
+
+    printf("HTTP: %s sent %s, %u bytes (identity %lu, gzip %lu)\n", asset->path,
+           gzip_ok ? "gzip" : "identity", (unsigned)body_len,
+           (unsigned long)asset->len, (unsigned long)asset->gzip_len);
+
+    // The header is copied; the body is referenced in flash without a copy and
+    // streamed as the send buffer allows, so assets may be any size
+    hal_tcp_lock();
+    if (http_conn_write(conn, header, (uint16_t)header_len) && body_len > 0) {
+        conn->body_data = body;
+        conn->body_left = (uint32_t)body_len;
+        http_stream_pump(conn);
+    } else {
+        http_conn_finish_response(conn);
+    }
+    hal_tcp_unlock();
+}
+
+// api_sink callback that appends serialized output to the TCP send buffer
+static bool tcp_sink_write(void *ctx, const char *data, uint16_t len) {
+    return http_conn_write((http_conn *)ctx, data, len);
+}
+
+// Gather the values reported by the readings API from one snapshot of the
+// latest reading, which is also returned in latest
+void web_server_fill_reading(api_reading *r, reading_snapshot *latest) {
+    snapshot_read(&g_latest, latest);
+    r->humidity        = latest->humidity;
+    r->temp_celsius    = latest->temp_c;
+    r->temp_fahrenheit = latest->temp_f;
+    r->led_enabled     = led_array_is_enabled();
+    r->has_sample      = (latest->sample_ms != 0);
+    r->sample_ms       = latest->sample_ms;
+    r->now_ms          = to_ms_since_boot(get_absolute_time());
+    r->status          = dht_status_name((dht_status)latest->status);
+}
 
-    tcp_setprio(new_pcb, TCP_PRIO_MIN);
-    tcp_recv(new_pcb, http_recv);
-    tcp_err(new_pcb, http_err);
-    tcp_sent(new_pcb, http_sent);
+// Send the latest reading as JSON, serialized directly into the TCP send buffer.
+// The ETag follows the sample sequence number, the LED state and the selected
+// fields, so pollers get a bodiless 304 until a new sample is published. It is
+// weak because age_ms in the body changes on every request while the reading
+// it describes doesn't.
+static void send_json_readings(http_conn *conn, uint32_t fields, const char *if_none_match) {
+    api_reading r;
+    reading_snapshot latest;
+    web_server_fill_reading(&r, &latest);
+
+    char etag[32];
+    snprintf(etag, sizeof(etag), "W/\"r%lu-%d-%lx\"", (unsigned long)latest.seq,
+             r.led_enabled ? 1 : 0, (unsigned long)fields);
+
+    // no-cache lets clients keep the body but makes them revalidate every time
+    char extra[96];
+    snprintf(extra, sizeof(extra), "ETag: %s\r\nCache-Control: no-cache\r\n", etag);
+
+    if (http_etag_matches(if_none_match, etag)) {
+        send_not_modified(conn, extra);
+        return;
+    }
+
+    // First pass only measures the body so Content-Length is known up front
+    api_sink sink;
+    api_sink_init(&sink, NULL, NULL);
+    size_t body_len = api_write_readings_json(&sink, fields, &r);
 
-    return ERR_OK;
+    char header[256];
+    int header_len = format_http_header(conn, header, sizeof(header), "200 OK",
+                                        "application/json", extra, body_len);
+
+    // Second pass writes the same snapshot straight into TCP segments. If
+    // any of it is dropped the body falls short of Content-Length and the
+    // client can't tell where the next response starts, so the connection
+    // is closed once what was queued has gone out.
+    hal_tcp_lock();
+    api_sink_init(&sink, tcp_sink_write, conn);
+    if (http_conn_write(conn, header, (uint16_t)header_len)) {
+        api_write_readings_json(&sink, fields, &r);
+    } else {
+        sink.ok = false;
+    }
+    if (!sink.ok) {
+        conn->keep_alive = false;
+    }
+    http_conn_finish_response(conn);
+    hal_tcp_unlock();
 }
 
-// Send a HTML page to client
-static void send_http_response(struct tcp_pcb *tpcb) {
+// Serialize the latest reading into the shared SSE event buffer
+static void sse_build_event(void) {
+    api_reading r;
+    reading_snapshot latest;
+    web_server_fill_reading(&r, &latest);
+
+    api_buffer buf = { s_sse_event, sizeof(s_sse_event), 0 };
+    api_sink sink;
+    api_sink_init(&sink, api_buffer_write, &buf);
 
-    // Buffer for the formatted HTML page
-    char body[HTTP_BODY_MAX];
-    
-    // Check current LED state
-    bool enabled = led_array_is_enabled();
+    char prefix[32];
+    int prefix_len = snprintf(prefix, sizeof(prefix), "id: %lu\ndata: ",
+                              (unsigned long)latest.seq);
+    api_buffer_write(&buf, prefix, (uint16_t)prefix_len);
+    api_write_readings_json(&sink, API_FIELDS_ALL, &r);
+    api_buffer_write(&buf, "\n\n", 2);
 
-    // Values inserted into the HTML template at runtime
-    const char *status_text  = enabled ? "On"  : "Off";
-    const char *toggle_href  = enabled ? "/set?led=off" : "/set?led=on";
-    const char *toggle_label = enabled ? "Turn LEDs Off" : "Turn LEDs On";
+    s_sse_event_len = sink.ok ? buf.len : 0;
+}
 
-    // Format HTML page using template and values
-    int body_len_int = snprintf(body, sizeof(body),
-                                PAGE_INDEX_HTML,
-                                g_latest_humidity,
-                                g_latest_temp_f,
-                                status_text,
-                                toggle_href,
-                                toggle_label);
-    printf("HTTP: body_len_int=%d (max=%d)\n", body_len_int, HTTP_BODY_MAX);
-    if (body_len_int < 0) {
-        body[0] = '\0';
+// Store a little-endian 32-bit value
+static void put_le_float(uint8_t *out, float f) {
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    put_le32(out, v);
+}
+
+// Serialize the latest reading into the shared binary WebSocket frame.
+// Payload layout (little-endian, 20 bytes):
+//   0  u8   format version (1)
+//   1  u8   sensor status (dht_status)
+//   2  u8   flags: bit 0 LEDs enabled, bit 1 sample valid
+//   3  u8   LED brightness
+//   4  u32  sample timestamp, ms since boot
+//   8  f32  relative humidity, %
+//   12 f32  temperature, Celsius
+//   16 u32  sample interval, ms
+static void ws_build_telemetry(void) {
+    uint8_t *payload = s_ws_frame + ws_frame_header(s_ws_frame, WS_OP_BINARY, WS_TELEMETRY_LEN);
+    reading_snapshot latest;
+    snapshot_read(&g_latest, &latest);
+
+    payload[0] = 1;
+    payload[1] = latest.status;
+    payload[2] = (led_array_is_enabled() ? 0x01 : 0) | (latest.sample_ms ? 0x02 : 0);
+    payload[3] = led_array_get_brightness();
+    put_le32(&payload[4], latest.sample_ms);
+    put_le_float(&payload[8], latest.humidity);
+    put_le_float(&payload[12], latest.temp_c);
+    put_le32(&payload[16], g_sample_interval_ms);
+
+    s_ws_frame_len = (size_t)(payload - s_ws_frame) + WS_TELEMETRY_LEN;
+}
+
+// Queue a buffer shared by all subscribers if this connection's send buffer
+// has room. A subscriber that can't keep up skips this update and gets the next.
+static void send_shared(http_conn *conn, const void *data, size_t len) {
+    if (len == 0) return;
+    if (conn->pending_len > 0 || hal_tcp_send_space(conn->tcp) < len) {
+        printf("HTTP: subscriber busy, skipping update\n");
+        return;
+    }
+    if (http_conn_write(conn, data, (uint16_t)len)) {
+        hal_tcp_output(conn->tcp);
+    }
+}
+
+static void sse_send_event(http_conn *conn) {
+    send_shared(conn, s_sse_event, s_sse_event_len);
+}
+
+// Start an event stream; the connection stays open until the client leaves
+static void send_sse_stream(http_conn *conn) {
+    static const char header[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n"
+        "retry: 3000\n\n";
+
+    metrics_count(METRIC_HTTP_2XX);
+
+    hal_tcp_lock();
+    conn->sse = true;
+    conn->keep_alive = true;
+    if (http_conn_write(conn, header, sizeof(header) - 1)) {
+        // Give the new subscriber the current reading immediately
+        if (s_sse_event_len == 0) {
+            sse_build_event();
+        }
+        sse_send_event(conn);
     }
+    conn->requests++;
+    hal_tcp_unlock();
+}
 
-    // Clamp buffer size to avoid overflow issues
-    size_t body_len = (size_t)body_len_int;
-    if (body_len >= sizeof(body)) {
-        body_len = sizeof(body) - 1;
-        body[body_len] = '\0';
+// Publish the latest reading to every /events subscriber
+void web_server_publish_reading(void) {
+    if (!s_started) return;  // Server never started
+
+    hal_tcp_lock();
+
+    // Serialize once per format, then fan the same bytes out to each subscriber
+    sse_build_event();
+    ws_build_telemetry();
+    for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+        http_conn *conn = &s_conns[i];
+        if (!conn->tcp || http_conn_closing(conn)) continue;
+        if (conn->sse) {
+            sse_send_event(conn);
+        } else if (conn->ws) {
+            send_shared(conn, s_ws_frame, s_ws_frame_len);
+        }
     }
 
-    // Standard HTTP header
-    char header[256];
-    int header_len = snprintf(header, sizeof(header),
-                              "HTTP/1.1 200 OK\r\n"
-                              "Content-Type: text/html; charset=UTF-8\r\n"
-                              "Connection: close\r\n"
-                              "Content-Length: %zu\r\n"
-                              "\r\n",
-                              body_len);
+    hal_tcp_unlock();
+}
 
-    // Allocate a temporary buffer for full HTTP response (header + body)
-    char response[HTTP_RESP_MAX];
-    size_t total_len = (size_t)header_len + body_len;
-    if (total_len > sizeof(response)) {
-        total_len = sizeof(response);
+// Send one unfragmented frame to a WebSocket client
+static void ws_send_frame(http_conn *conn, uint8_t opcode, const void *payload, size_t len) {
+    uint8_t header[WS_FRAME_HEADER_MAX];
+    size_t header_len = ws_frame_header(header, opcode, len);
+
+    hal_tcp_lock();
+    if (http_conn_write(conn, header, (uint16_t)header_len) && len > 0) {
+        http_conn_write(conn, payload, (uint16_t)len);
     }
+    hal_tcp_output(conn->tcp);
+    hal_tcp_unlock();
+}
 
-    // Copy header and then body after it
-    memcpy(response, header, (size_t)header_len);
-    memcpy(response + header_len, body, total_len - (size_t)header_len);
+// Start the closing handshake; the connection closes once the frame is acknowledged
+static void ws_close(http_conn *conn, uint16_t code) {
+    uint8_t payload[2] = { (uint8_t)(code >> 8), (uint8_t)code };
+    ws_send_frame(conn, WS_OP_CLOSE, payload, sizeof(payload));
+    http_conn_close_when_sent(conn);
+}
 
-    // Send the full HTTP response over TCP using lwIP
-    cyw43_arch_lwip_begin();
-    err_t err = tcp_write(tpcb, response, (u16_t)total_len, TCP_WRITE_FLAG_COPY);
-    if (err != ERR_OK) {
-        printf("ERROR: tcp_write() failed: %d\n", err);
+// Handle one complete message from a WebSocket client
+static void ws_handle_message(http_conn *conn) {
+    ws_parser *ws = &conn->ws_rx;
+
+    switch (ws->opcode) {
+        case WS_OP_TEXT: {
+            // Control messages use the same query form as /set,
+            // e.g. "led=on", "brightness=64&interval=1000"
+            char cmd[WS_MAX_PAYLOAD + 1];
+            memcpy(cmd, ws->message, ws->message_len);
+            cmd[ws->message_len] = '\0';
+
+            // On success the new state was already pushed to every client
+            if (!web_server_apply_settings(cmd)) {
+                static const char reply[] = "error: unknown command";
+                ws_send_frame(conn, WS_OP_TEXT, reply, sizeof(reply) - 1);
+            }
+            break;
+        }
+        case WS_OP_PING:
+            ws_send_frame(conn, WS_OP_PONG, ws->message, ws->message_len);
+            break;
+        case WS_OP_CLOSE:
+            ws_close(conn, WS_CLOSE_NORMAL);
+            break;
+        default:
+            // Binary messages and pongs are ignored
+            break;
+    }
+}
+
+// Feed received WebSocket bytes to the connection's frame parser
+static void ws_receive(http_conn *conn, const uint8_t *data, size_t len) {
+    while (len > 0 && conn->tcp && !http_conn_closing(conn)) {
+        size_t used = 0;
+        ws_parse_result result = ws_parser_feed(&conn->ws_rx, data, len, &used);
+        data += used;
+        len -= used;
+
+        if (result == WS_PARSE_MESSAGE) {
+            ws_handle_message(conn);
+        } else if (result == WS_PARSE_ERROR) {
+            printf("HTTP: WebSocket protocol error, closing (%u)\n", conn->ws_rx.close_code);
+            ws_close(conn, conn->ws_rx.close_code);
+        }
+    }
+}
+
+// Answer a WebSocket opening handshake and switch the connection to frames
+static void handle_ws_upgrade(http_conn *conn, const http_request *req) {
+    if (!req->upgrade_websocket || !req->connection_upgrade || req->ws_version != 13 ||
+        req->ws_key[0] == '\0') {
+        send_http_error(conn, "400 Bad Request");
+        return;
+    }
+
+    char accept[WS_ACCEPT_KEY_LEN];
+    ws_accept_key(req->ws_key, strlen(req->ws_key), accept);
+
+    metrics_count(METRIC_HTTP_1XX);
+
+    char response[160];
+    int response_len = snprintf(response, sizeof(response),
+                                "HTTP/1.1 101 Switching Protocols\r\n"
+                                "Upgrade: websocket\r\n"
+                                "Connection: Upgrade\r\n"
+                                "Sec-WebSocket-Accept: %s\r\n"
+                                "\r\n",
+                                accept);
+
+    hal_tcp_lock();
+    if (http_conn_write(conn, response, (uint16_t)response_len)) {
+        // Control round trips are tiny, so don't let Nagle hold them back
+        hal_tcp_nodelay(conn->tcp);
+
+        // The request parser's memory is reused by the frame parser from here on
+        conn->ws = true;
+        conn->keep_alive = true;
+        conn->requests++;
+        ws_parser_init(&conn->ws_rx);
+
+        // Send the current state right away
+        ws_build_telemetry();
+        send_shared(conn, s_ws_frame, s_ws_frame_len);
     } else {
-        err = tcp_output(tpcb);
-        if (err != ERR_OK) {
-            printf("ERROR: tcp_output() failed: %d\n", err);
+        http_conn_close_when_sent(conn);
+    }
+    hal_tcp_unlock();
+}
+
+// Route handlers; the router has already checked the method
+typedef void (*http_route_handler)(http_conn *conn, http_request *req);
+
+typedef struct {
+    const char *path;          // Exact request path, without the query
+    uint8_t methods;           // Allowed HTTP_METHOD_* flags
+    http_route_handler handler;
+} http_route;
+
+// JSON readings API; ?fields= selects which members are returned
+static void route_readings(http_conn *conn, http_request *req) {
+    uint32_t fields = API_FIELDS_ALL;
+    char *cursor = req->query;
+    char *name, *value;
+    http_query_result result;
+    while ((result = http_query_next(&cursor, &name, &value)) == HTTP_QUERY_PARAM) {
+        if (strcmp(name, "fields") == 0) {
+            fields = api_parse_fields(value);
+        }
+    }
+    if (result == HTTP_QUERY_ERROR || fields == 0) {
+        send_http_status(conn, "400 Bad Request", NULL);
+        return;
+    }
+    send_json_readings(conn, fields, req->if_none_match[0] ? req->if_none_match : NULL);
+}
+
+// Producer for a history export: records go from the history rings straight
+// into the stream buffer, a piece at a time, as the client acknowledges data
+static size_t history_body(http_conn *conn, char *buf, size_t size) {
+    return history_export(&conn->history, &conn->body_pos, buf, size);
+}
+
+// Parse a time bound in ms since boot
+static bool parse_time_ms(const char *value, uint32_t *out) {
+    char *end;
+    unsigned long v = strtoul(value, &end, 10);
+    if (value[0] < '0' || value[0] > '9' || *end != '\0' || v > UINT32_MAX) {
+        return false;
+    }
+    *out = (uint32_t)v;
+    return true;
+}
+
+// Stored history, e.g. /api/v1/history?tier=1m&from=60000&format=bin.
+// tier is raw, 1m or 1h; format is csv (default) or bin, decoded by
+// tools/history_decode.py. The body's length isn't known up front, so it
+// goes out chunked.
+static void route_history(http_conn *conn, http_request *req) {
+    int tier = HISTORY_TIER_RAW;
+    uint8_t format = HISTORY_FORMAT_CSV;
+    uint32_t from_ms = 0;
+    uint32_t to_ms = UINT32_MAX;
+
+    bool ok = true;
+    char *cursor = req->query;
+    char *name, *value;
+    http_query_result result;
+    while ((result = http_query_next(&cursor, &name, &value)) == HTTP_QUERY_PARAM) {
+        if (strcmp(name, "tier") == 0) {
+            tier = history_tier_from_name(value);
+            ok = ok && tier >= 0;
+        } else if (strcmp(name, "from") == 0) {
+            ok = ok && parse_time_ms(value, &from_ms);
+        } else if (strcmp(name, "to") == 0) {
+            ok = ok && parse_time_ms(value, &to_ms);
+        } else if (strcmp(name, "format") == 0) {
+            if (strcmp(value, "csv") == 0) {
+                format = HISTORY_FORMAT_CSV;
+            } else if (strcmp(value, "bin") == 0) {
+                format = HISTORY_FORMAT_BINARY;
+            } else {
+                ok = false;
+            }
         }
     }
-    cyw43_arch_lwip_end();
+    if (result == HTTP_QUERY_ERROR || !ok || from_ms > to_ms) {
+        send_http_status(conn, "400 Bad Request", NULL);
+        return;
+    }
+
+    history_query_init(&conn->history, (uint8_t)tier, format, from_ms, to_ms);
+    http_start_stream(conn, "200 OK",
+                      (format == HISTORY_FORMAT_BINARY) ? "application/octet-stream" : "text/csv",
+                      "Cache-Control: no-store\r\n", HTTP_LENGTH_UNKNOWN, history_body);
 }
 
+// Producer for the /metrics exposition text
+static size_t metrics_body(http_conn *conn, char *buf, size_t size) {
+    return metrics_export(&conn->body_pos, buf, size);
+}
 
-// Callback for incoming HTTP request data
-static err_t http_recv(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err) {
-    (void)arg;
+// Prometheus scrape target. Counters are bumped in place as things happen;
+// gauges are sampled here, once per scrape, along with the WiFi side's
+// DHCP and lwIP pool figures (network_wifi_metrics()).
+static void route_metrics(http_conn *conn, http_request *req) {
+    (void)req;
+    reading_snapshot latest;
+    snapshot_read(&g_latest, &latest);
+    bool has_sample = (latest.sample_ms != 0);
+    metrics_set_gauge(METRIC_HUMIDITY, has_sample ? latest.humidity : NAN);
+    metrics_set_gauge(METRIC_TEMP_C, has_sample ? latest.temp_c : NAN);
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    metrics_set_gauge(METRIC_UPTIME, (float)now_ms / 1000.0f);
+    for (int i = 0; i < POWER_STATE_COUNT; i++) {
+        metrics_set_gauge((metrics_gauge)(METRIC_POWER_FULL_S + i), power_state_seconds((power_state)i));
+    }
+    metrics_set_gauge(METRIC_POWER_CURRENT, power_average_ma());
+    for (int i = 0; i < I2C_DEV_COUNT; i++) {
+        // Written by core 1; a scrape may catch a field mid-update, which the next one corrects
+        const i2c_device_stats *bus = i2c_bus_stats((i2c_device)i);
+        metrics_set_gauge((metrics_gauge)(METRIC_I2C_DHT_S + i), (float)bus->bus_us / 1e6f);
+        metrics_set_gauge((metrics_gauge)(METRIC_I2C_DHT_CPU_S + i), (float)bus->cpu_us / 1e6f);
+        metrics_set_gauge((metrics_gauge)(METRIC_I2C_DHT_TXNS + i), (float)bus->transactions);
+        metrics_set_gauge((metrics_gauge)(METRIC_I2C_DHT_ERRORS + i), (float)bus->errors);
+        metrics_set_gauge((metrics_gauge)(METRIC_I2C_DHT_WAIT + i), (float)bus->max_wait_us / 1e6f);
+    }
+    metrics_set_gauge(METRIC_HTTP_READING, (float)conn_pool_count(&s_conn_pool, CONN_READING));
+    metrics_set_gauge(METRIC_HTTP_WRITING, (float)conn_pool_count(&s_conn_pool, CONN_WRITING));
+    metrics_set_gauge(METRIC_HTTP_CLOSING, (float)conn_pool_count(&s_conn_pool, CONN_CLOSING));
+    network_wifi_metrics(now_ms);
+
+    http_start_stream(conn, "200 OK", "text/plain; version=0.0.4",
+                      "Cache-Control: no-store\r\n", HTTP_LENGTH_UNKNOWN, metrics_body);
+}
+
+// Live readings stream for the web page
+static void route_events(http_conn *conn, http_request *req) {
+    (void)req;
+    send_sse_stream(conn);
+}
 
-    printf("HTTP: received data, err=%d, p=%p\n", err, (void*)p);
+// Control endpoint, e.g. /set?led=off or /set?brightness=64&interval=2000
+static void route_set(http_conn *conn, http_request *req) {
+    if (!req->has_query || !web_server_apply_settings(req->query)) {
+        send_http_status(conn, "400 Bad Request", NULL);
+        return;
+    }
+    // Answer with the updated state so the page can refresh without a reload
+    send_json_readings(conn, API_FIELDS_ALL, NULL);
+}
+
+// WebSocket telemetry and control
+static void route_ws(http_conn *conn, http_request *req) {
+    handle_ws_upgrade(conn, req);
+}
+
+// Static page assets, served from flash
+static void route_static(http_conn *conn, http_request *req) {
+    send_web_asset(conn, find_web_asset(req->path), req->accept_gzip,
+                   req->if_none_match[0] ? req->if_none_match : NULL);
+}
 
-    // If request is invalid or connection closes, free buffer and close
-    if ((err != ERR_OK) || (p == NULL)) {
-        if (p) {
-            cyw43_arch_lwip_begin();
-            pbuf_free(p);
-            cyw43_arch_lwip_end();
+// Dynamic routes, sorted by path (strcmp order) for bsearch. Paths not
+// listed here are looked up in the static asset table.
+static const http_route ROUTES[] = {
+    { API_HISTORY_PATH,  HTTP_METHOD_GET, route_history },
+    { API_READINGS_PATH, HTTP_METHOD_GET, route_readings },
+    { SSE_EVENTS_PATH,   HTTP_METHOD_GET, route_events },
+    { METRICS_PATH,      HTTP_METHOD_GET, route_metrics },
+    { SET_PATH,          HTTP_METHOD_GET, route_set },
+    { WS_PATH,           HTTP_METHOD_GET, route_ws },
+};
+
+#define ROUTE_COUNT (sizeof(ROUTES) / sizeof(ROUTES[0]))
+
+// The lookup tables are searched with bsearch, so report any that were
+// edited out of order (the asset table is sorted by embed_assets.py)
+static void http_check_tables(void) {
+    for (size_t i = 1; i < ROUTE_COUNT; i++) {
+        if (strcmp(ROUTES[i - 1].path, ROUTES[i].path) >= 0) {
+            printf("ERROR: ROUTES not sorted at %s\n", ROUTES[i].path);
         }
-        http_connection_close(tpcb);
-        return ERR_OK;
     }
+    for (size_t i = 1; i < SETTING_COUNT; i++) {
+        if (strcmp(SETTINGS[i - 1].name, SETTINGS[i].name) >= 0) {
+            printf("ERROR: SETTINGS not sorted at %s\n", SETTINGS[i].name);
+        }
+    }
+    for (size_t i = 1; i < WEB_ASSET_COUNT; i++) {
+        if (strcmp(WEB_ASSETS[i - 1].path, WEB_ASSETS[i].path) >= 0) {
+            printf("ERROR: WEB_ASSETS not sorted at %s\n", WEB_ASSETS[i].path);
+        }
+    }
+}
 
-    // Copy the entire incoming HTTP request into a local buffer
-    char req[512];
-    size_t copied = pbuf_copy_partial(p, req, sizeof(req) - 1, 0);
-    req[copied] = '\0';
+// Answer a request whose method the resource doesn't support
+static void send_method_not_allowed(http_conn *conn, uint8_t methods) {
+    char allow[64];
+    size_t len = (size_t)snprintf(allow, sizeof(allow), "Allow: ");
+    for (uint8_t bit = 1; bit != 0 && len < sizeof(allow); bit <<= 1) {
+        const char *name = (methods & bit) ? http_method_name(bit) : NULL;
+        if (name) {
+            len += (size_t)snprintf(allow + len, sizeof(allow) - len, "%s%s",
+                                    len > 7 ? ", " : "", name);
+        }
+    }
+    if (len < sizeof(allow)) {
+        snprintf(allow + len, sizeof(allow) - len, "\r\n");
+    }
+    send_http_status(conn, "405 Method Not Allowed", allow);
+}
 
-    // Free the lwIP packet buffer now that its data was copied
-    cyw43_arch_lwip_begin();
-    pbuf_free(p);
-    cyw43_arch_lwip_end();
+// Handle one complete request head as extracted by the parser
+static void http_handle_request(http_conn *conn, http_request *req) {
+    printf("HTTP: %s %s%s%s\n", req->method, req->path, req->has_query ? "?" : "", req->query);
 
-    printf("HTTP: raw request:\n%s\n", req);
+    conn->request_us = time_us_32();
+    conn->keep_alive = req->keep_alive;
+    conn->http11 = (req->version_minor >= 1);
 
-    // Extract only the first line ("GET /path HTTP/1.1")
-    char *first_line = req;
-    char *line_end = strstr(first_line, "\r\n");
-    if (line_end) {
-        *line_end = '\0';  // terminate first line
+    // Bound the number of requests served before the client must reconnect
+    if (conn->requests + 1 >= HTTP_KEEPALIVE_MAX) {
+        conn->keep_alive = false;
     }
 
-    printf("HTTP: first line: '%s'\n", first_line);
+    uint8_t methods;
+    http_route_handler handler;
+    const http_route *route = bsearch(req->path, ROUTES, ROUTE_COUNT, sizeof(ROUTES[0]),
+                                      compare_name);
+    if (route) {
+        methods = route->methods;
+        handler = route->handler;
+    } else if (find_web_asset(req->path)) {
+        methods = HTTP_METHOD_GET;
+        handler = route_static;
+    } else {
+        send_http_status(conn, "404 Not Found", NULL);
+        return;
+    }
 
-    // Parse method, path, and version
-    char method[8]  = {0};
-    char path[128]  = {0};
-    char version[16]= {0};
+    if (!(req->method_id & methods)) {
+        send_method_not_allowed(conn, methods);
+        return;
+    }
+    handler(conn, req);
+}
 
-    if (sscanf(first_line, "%7s %127s %15s", method, path, version) == 3) {
-        printf("HTTP: parsed method=%s path=%s version=%s\n", method, path, version);
+// Callback for incoming HTTP request data
+static int http_recv(void *arg, hal_tcp_data *data) {
+    http_conn *conn = (http_conn *)arg;
 
-        // Check if this request is for control endpoint
-        if (strncmp(path, "/set?", 5) == 0) {
-            const char *query = path + 5;  // points to "led=off"
+    printf("HTTP: received data, data=%p\n", (void*)data);
 
-            char name[32]  = {0};
-            char value[32] = {0};
+    // The client closed its side; close ours too
+    if (data == NULL) {
+        return http_connection_close(conn);
+    }
+
+    conn->idle_polls = 0;
+    metrics_add(METRIC_HTTP_RX_BYTES, hal_tcp_data_total(data));
 
-            // Split "name=value" into separate strings
-            const char *eq = strchr(query, '=');
-            if (eq) {
-                size_t name_len = (size_t)(eq - query);
-                if (name_len >= sizeof(name)) name_len = sizeof(name) - 1;
-                memcpy(name, query, name_len);
-                name[name_len] = '\0';
+    // Requests pipelined behind a streamed response wait their turn; holding
+    // them back without reopening the window slows the client down meanwhile
+    if (conn->rx_held) {
+        hal_tcp_lock();
+        hal_tcp_data_append(conn->rx_held, data);
+        hal_tcp_unlock();
+        return HAL_TCP_OK;
+    }
 
-                const char *val_start = eq + 1;
-                size_t val_len = strlen(val_start);
-                if (val_len >= sizeof(value)) val_len = sizeof(value) - 1;
-                memcpy(value, val_start, val_len);
-                value[val_len] = '\0';
+    http_receive(conn, data, 0);
+    return HAL_TCP_OK;
+}
 
-                printf("HTTP: /set param: %s = %s\n", name, value);
+// Parse received data from byte offset on, walking the chain in place.
+// The parser keeps its own state between segments, so requests may be split
+// anywhere or pipelined back to back. Returns the offset parsing stopped at:
+// the chain's total length once everything was used, or less if a streamed
+// response has to finish before the next request can be answered.
+static uint16_t http_consume(http_conn *conn, hal_tcp_data *chain, uint16_t offset) {
+    uint16_t total = hal_tcp_data_total(chain);
+    uint16_t pos = 0;  // Offset of piece within the chain
+    uint16_t piece_len;
+    for (hal_tcp_data *piece = chain; piece != NULL;
+         pos += piece_len, piece = hal_tcp_data_next(piece)) {
+        const uint8_t *bytes = hal_tcp_data_bytes(piece, &piece_len);
+        if (offset >= pos + piece_len) continue;
+        size_t skip = (offset > pos) ? (size_t)(offset - pos) : 0;
+        const char *data = (const char *)bytes + skip;
+        size_t len = piece_len - skip;
+
+        while (len > 0) {
+            // Closed connections and event streams take no more requests
+            if (!conn->tcp || http_conn_closing(conn) || conn->sse) {
+                return total;
+            }
+            // Upgraded connections carry WebSocket frames instead of requests;
+            // frames sent right behind the handshake land here too
+            if (conn->ws) {
+                ws_receive(conn, (const uint8_t *)data, len);
+                break;
+            }
+            if (http_conn_busy(conn)) {
+                return (uint16_t)(pos + piece_len - len);
+            }
 
-                // Apply the setting (LED on/off)
-                handle_set_request(name, value);
+            size_t used = 0;
+            http_parse_result result = http_parser_feed(&conn->http_rx, data, len, &used);
+            data += used;
+            len -= used;
+
+            if (result == HTTP_PARSE_DONE) {
+                http_handle_request(conn, &conn->http_rx.req);
+                http_conn_update_state(conn);
+            } else if (result == HTTP_PARSE_ERROR) {
+                printf("HTTP: malformed request (%u), closing connection\n",
+                       conn->http_rx.error_status);
+                conn->request_us = time_us_32();
+                send_http_error(conn, http_error_status(conn->http_rx.error_status));
             }
         }
-    } else {
-        printf("HTTP: could not parse request line\n");
     }
+    return total;
+}
 
-    // Send the HTML page for any request
-    send_http_response(tpcb);
+// Parse received data, then release it or hold on to the unparsed rest
+static void http_receive(http_conn *conn, hal_tcp_data *data, uint16_t offset) {
+    uint16_t used = http_consume(conn, data, offset);
 
-    return ERR_OK;
+    hal_tcp_lock();
+    // Nothing was copied out, so the window reopens only for what was parsed
+    if (conn->tcp) {
+        hal_tcp_recved(conn->tcp, (uint16_t)(used - offset));
+    }
+    if (conn->tcp && used < hal_tcp_data_total(data)) {
+        conn->rx_held = data;
+        conn->rx_held_offset = used;
+    } else {
+        hal_tcp_data_free(data);
+    }
+    hal_tcp_unlock();
 }
 
-// Called if a TCP error happens on the connection
-static void http_err(void *arg, err_t err) {
-    (void)arg;
-    (void)err;
+// Called if a TCP error happens on the connection; the stack has already freed it
+static void http_err(void *arg, int err) {
+    http_conn *conn = (http_conn *)arg;
+    printf("HTTP: connection error %d\n", err);
+    metrics_count(METRIC_HTTP_CONN_ERRORS);
+    if (conn) {
+        conn->tcp = NULL;
+        if (conn->rx_held) {
+            hal_tcp_data_free(conn->rx_held);
+            conn->rx_held = NULL;
+        }
+        conn_pool_release(&s_conn_pool, http_conn_slot(conn));
+    }
 }
 
-// Called after HTTP response is successful and acknowledged
-static err_t http_sent(void *arg, struct tcp_pcb *tpcb, u16_t len) {
-    (void)arg;
-    (void)len;
+// Called after response data is acknowledged by the client
+static int http_sent(void *arg, uint16_t len) {
+    http_conn *conn = (http_conn *)arg;
+
+    conn->unacked = (len > conn->unacked) ? 0 : conn->unacked - len;
+    conn->idle_polls = 0;
+    metrics_add(METRIC_HTTP_TX_BYTES, len);
+
+    // Acknowledged data made room for more of a streamed response
+    http_conn_continue(conn);
+    if (!conn->tcp) return HAL_TCP_OK;
+
+    // Close only once the whole response has been acknowledged
+    if (http_conn_closing(conn) && http_conn_drained(conn)) {
+        printf("HTTP: data acknowledged, closing connection\n");
+        return http_connection_close(conn);
+    }
 
-    printf("HTTP: data acknowledged, closing connection\n");
-    http_connection_close(tpcb);
+    http_conn_update_state(conn);
+    return HAL_TCP_OK;
+}
+
+// Called every HTTP_POLL_INTERVAL; closes connections that have gone idle
+static int http_poll(void *arg) {
+    http_conn *conn = (http_conn *)arg;
+
+    // Retry a close that was waiting on data the client never acknowledged,
+    // or that the stack couldn't do last time
+    if (http_conn_closing(conn) &&
+        (http_conn_drained(conn) || conn_pool_close_failures(&s_conn_pool, http_conn_slot(conn)))) {
+        return http_connection_close(conn);
+    }
+
+    if (conn->idle_polls < UINT8_MAX) {
+        conn->idle_polls++;
+    }
+
+    // Output that paused with nothing in flight gets no http_sent() to resume it
+    if (http_conn_busy(conn) && conn->unacked == 0) {
+        http_conn_continue(conn);
+        if (!conn->tcp) return HAL_TCP_OK;
+    }
+    http_conn_update_state(conn);
+
+    // Give memory back to new clients when the stack is running short
+    if (http_conn_idle(conn) && http_pools_low()) {
+        printf("HTTP: memory low, closing idle connection\n");
+        metrics_count(METRIC_HTTP_EVICTED);
+        return http_connection_close(conn);
+    }
+
+    // Each poll interval is HTTP_POLL_INTERVAL * HAL_TCP_POLL_MS
+    if (conn->idle_polls * HTTP_POLL_INTERVAL >= HTTP_IDLE_TIMEOUT_S * (1000 / HAL_TCP_POLL_MS) && conn->sse) {
+        // Event streams stay open; a comment line keeps proxies from timing out
+        static const char keepalive[] = ":\n\n";
+        http_conn_write(conn, keepalive, sizeof(keepalive) - 1);
+        hal_tcp_output(conn->tcp);
+        conn->idle_polls = 0;
+    } else if (conn->idle_polls * HTTP_POLL_INTERVAL >= HTTP_IDLE_TIMEOUT_S * (1000 / HAL_TCP_POLL_MS) && conn->ws) {
+        // Same for WebSockets, using a ping the browser answers automatically
+        ws_send_frame(conn, WS_OP_PING, NULL, 0);
+        conn->idle_polls = 0;
+    } else if (conn->idle_polls * HTTP_POLL_INTERVAL >= HTTP_IDLE_TIMEOUT_S * (1000 / HAL_TCP_POLL_MS)) {
+        printf("HTTP: closing idle connection\n");
+        return http_connection_close(conn);
+    }
 
-    return ERR_OK;
+    return HAL_TCP_OK;
 }
@@ -5,7 +5,13 @@ Author: Andrew Poon
 Date: 11/22/25
 Description: Public interface for the network module. This header
     provides the functions that allow main.c to start the Pico2W
-    in WiFi access point (AP) mode and launch the built-in server.
+    in WiFi access point (AP) or station mode and launch the built-in server.
+
+    network.c implements the web server over hal_tcp (hal.h), so it runs
+    unchanged in the host build (HOST_BUILD). network_wifi.c implements
+    the WiFi, mDNS, UDP and MQTT functions with lwIP on the Pico;
+    network_wifi_linux.c stands in for them on the host, where there is
+    no radio.
 */
 #ifndef NETWORK_H
 #define NETWORK_H
@@ -13,6 +19,50 @@ Description: Public interface for the network module. This header
 #include <stdbool.h>
 #include <stdint.h>
 
+// Maximum number of concurrent HTTP clients (each keeps one connection slot)
+#ifndef HTTP_MAX_CLIENTS
+#define HTTP_MAX_CLIENTS 4
+#endif
+
+// Seconds a client turned away with 503 because every slot is busy is asked to wait
+#ifndef HTTP_RETRY_AFTER_S
+#define HTTP_RETRY_AFTER_S 5
+#endif
+
+// UDP telemetry defaults, used when the build sets UDP_TELEMETRY_ADDR
+#ifndef UDP_TELEMETRY_PORT
+#define UDP_TELEMETRY_PORT 5005
+#endif
+#ifndef UDP_TELEMETRY_BATCH
+#define UDP_TELEMETRY_BATCH 1
+#endif
+
+// MQTT defaults, used when the build sets MQTT_BROKER
+#ifndef MQTT_BROKER_PORT
+#define MQTT_BROKER_PORT 1883
+#endif
+#ifndef MQTT_TOPIC_ROOT
+#define MQTT_TOPIC_ROOT "pico2w"
+#endif
+#ifndef MQTT_QOS
+#define MQTT_QOS 1
+#endif
+
+// Version advertised over mDNS
+#ifndef FIRMWARE_VERSION
+#define FIRMWARE_VERSION "1.0.0"
+#endif
+
+// Name the device answers to as <MDNS_HOSTNAME>.local
+#ifndef MDNS_HOSTNAME
+#define MDNS_HOSTNAME "pico2w"
+#endif
+
+// Station mode default, used when the build sets WIFI_SSID
+#ifndef WIFI_FALLBACK_FAILURES
+#define WIFI_FALLBACK_FAILURES 5
+#endif
+
 /**
  * @brief Initialize the CYW43 WiFi chip and start AP mode
  *
@@ -25,15 +75,130 @@ Description: Public interface for the network module. This header
  */
 bool wifi_start_ap(const char *ssid, const char *password);
 
+/**
+ * @brief Initialize the CYW43 WiFi chip and join a network as a station
+ *
+ * Joining continues in the background. The access point's BSSID and
+ * channel and the DHCP lease are saved in flash, so after a reboot or a
+ * lost connection the join skips the scan and asks for the same address
+ * again. Failed joins are retried with backoff; after
+ * WIFI_FALLBACK_FAILURES in a row the device runs as an access point
+ * instead, as wifi_start_ap() would.
+ *
+ * @param ssid         Network to join
+ * @param password     WPA2 password, or "" for an open network
+ * @param ap_ssid      SSID for the fallback access point
+ * @param ap_password  WPA2 password for the fallback access point
+ * @return true if joining has started, false otherwise
+ */
+bool wifi_start_sta(const char *ssid, const char *password,
+                    const char *ap_ssid, const char *ap_password);
+
+/**
+ * @brief Save newly learned station mode parameters to flash
+ *
+ * Call regularly from the main loop; does nothing unless a connection
+ * changed the saved access point or lease.
+ */
+void wifi_service(void);
+
 /**
  * @brief Start a minimal HTTP server on the given port
  *
  * Listens for HTTP connections on the specified port
- * and responds with a webpage
+ * and responds with a webpage. Connections are kept alive
+ * between requests, up to HTTP_MAX_CLIENTS at a time.
  *
  * @param port  TCP port to listen on (use 80 for HTTP)
  * @return true on success, false otherwise
  */
 bool web_server_start(uint16_t port);
 
+/**
+ * @brief Count the HTTP connections that are reading or writing
+ *
+ * @return Open connections, not counting ones being closed
+ */
+uint32_t web_server_client_count(void);
+
+/**
+ * @brief Register a function called whenever an HTTP connection is accepted
+ *
+ * Called from TCP callback context on core 0, before the first request is
+ * read, so it should only schedule work (such as raising the clock)
+ * elsewhere.
+ *
+ * @param on_connect  Function to call, or NULL for none
+ */
+void web_server_set_connect_callback(void (*on_connect)(void));
+
+/**
+ * @brief Start answering mDNS queries for the device and its web server
+ *
+ * The device answers to <hostname>.local and is advertised as an
+ * _http._tcp service (DNS-SD) with TXT fields path, fw (FIRMWARE_VERSION)
+ * and sensors. It follows whichever interface is up, announcing itself
+ * again whenever station mode (re)connects or AP mode starts.
+ *
+ * @param hostname   Name without ".local"; letters, digits and '-'
+ * @param http_port  Port of the web server
+ * @return true on success, false otherwise
+ */
+bool mdns_start(const char *hostname, uint16_t http_port);
+
+/**
+ * @brief Push the latest reading to every live /events subscriber
+ *
+ * Call after each new sample. The reading is serialized once into a
+ * shared Server-Sent Event and sent to all subscribers from that buffer.
+ */
+void web_server_publish_reading(void);
+
+/**
+ * @brief Start publishing samples as UDP datagrams
+ *
+ * Datagrams use the layout in telemetry.h and are sent to a unicast or
+ * broadcast address (e.g. 192.168.4.255 for every AP client).
+ *
+ * @param addr        Destination IPv4 address in dotted form
+ * @param port        Destination UDP port
+ * @param batch_size  Samples packed into each datagram (1 sends every sample at once)
+ * @return true on success, false otherwise
+ */
+bool udp_telemetry_start(const char *addr, uint16_t port, uint8_t batch_size);
+
+/**
+ * @brief Add the latest reading to the UDP telemetry batch
+ *
+ * Call after each new sample. Sends a datagram once the batch is full;
+ * does nothing if udp_telemetry_start() was not called.
+ */
+void udp_telemetry_publish(void);
+
+/**
+ * @brief Connect to an MQTT broker and start publishing readings
+ *
+ * Readings are published retained on <topic_root>/readings (JSON, as served
+ * by /api/v1/readings), <topic_root>/humidity and <topic_root>/temperature.
+ * <topic_root>/online is "1" while connected and "0" (the will) otherwise.
+ * Commands published to <topic_root>/set use the /set query form, e.g.
+ * "led=off&interval=5000". Lost connections are retried with backoff.
+ *
+ * @param broker      Broker IPv4 address in dotted form
+ * @param port        Broker TCP port (1883 for plain MQTT)
+ * @param topic_root  Topic prefix, without a trailing '/'
+ * @param qos         0 or 1 for the readings
+ * @return true on success, false otherwise
+ */
+bool mqtt_telemetry_start(const char *broker, uint16_t port, const char *topic_root, uint8_t qos);
+
+/**
+ * @brief Queue the latest reading for the MQTT broker
+ *
+ * Call after each new sample. While the broker is unreachable only the
+ * newest value per topic is kept; does nothing if mqtt_telemetry_start()
+ * was not called.
+ */
+void mqtt_telemetry_publish(void);
+
 #endif // NETWORK_H
\ No newline at end of file
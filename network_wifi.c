@@ -0,0 +1,862 @@
+/*
+File: network_wifi.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Provides initialization and control functionality for the CYW43 WiFi
+    chip on the Raspberry Pi Pico2W. This module is responsible for
+    bringing up the device in WiFi access point (AP) mode so that other
+    devices (laptops, phones, etc) can connect to the Pico's network, or
+    joining an existing network as a station, and for the UDP and MQTT
+    services that run beside the web server in network.c.
+
+    Portions of WiFi initialization and lwIP logic were adapted from the
+    official Raspberry Pi Pico SDK WiFi examples and is licensed as follows:
+    Copyright (c) 2020 Raspberry Pi (Trading) Ltd.
+    SPDX-License-Identifier: BSD-3-Clause
+    Source: https://github.com/raspberrypi/pico-examples/blob/master/pico_w/
+
+Responsibilities:
+- Initialize CYW43 WiFi
+- Start WiFi AP with given SSID and password
+- Or join a network as a station, reconnecting quickly from cached
+  parameters and falling back to AP mode if it can't be joined
+- Assign addresses to AP clients over DHCP
+- Answer mDNS queries for <hostname>.local and the _http._tcp service
+- Publish readings as UDP datagrams
+- Publish readings to an MQTT broker and accept control commands from it
+- Report DHCP leases and lwIP pool usage at /metrics
+
+Requires the following modules:
+- network.h: for interface definitions
+- network_wifi.h: for the settings and readings shared with the web server
+- dhcp_server.h: for the lease table and replies of the AP's DHCP server
+- mdns_responder.h: for the cached mDNS answers
+- backoff.h: for reconnect delays
+- wifi_sta.h: for the station mode state machine and cached parameters
+- mqtt_session.h: for the MQTT outbox
+- telemetry.h: for the UDP datagram layout
+- snapshot.h: for reading the latest sample published by main.c
+*/
+
+#include "network.h"
+#include "network_wifi.h"
+#include "backoff.h"
+#include "dhcp_server.h"
+#include "http_parser.h"
+#include "led_array.h"
+#include "mdns_responder.h"
+#include "metrics.h"
+#include "mqtt_session.h"
+#include "sensor.h"
+#include "snapshot.h"
+#include "telemetry.h"
+#include "web_api.h"
+#include "wifi_sta.h"
+
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "pico/flash.h"
+#include "pico/rand.h"
+#include "pico/unique_id.h"
+#include "hardware/flash.h"
+#include "lwip/apps/mqtt.h"
+#include "lwip/dhcp.h"
+#include "lwip/igmp.h"
+#include "lwip/memp.h"
+#include "lwip/stats.h"
+#include "lwip/timeouts.h"
+#include "lwip/udp.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern snapshot_seqlock g_latest;
+extern volatile uint32_t g_sample_interval_ms;
+
+#define MQTT_KEEPALIVE_S      30     // Broker drops us after 1.5x this without traffic
+#define MQTT_BACKOFF_MIN_MS   1000   // First reconnect delay
+#define MQTT_BACKOFF_MAX_MS   60000  // Reconnect delay cap
+#define MQTT_ROOT_MAX         40     // Longest topic root; leaves room for "/temperature"
+#define MQTT_CMD_MAX          HTTP_QUERY_MAX  // Longest command accepted on <root>/set
+
+#define MDNS_ANNOUNCE_COUNT       2      // Unsolicited announcements per new address (RFC 6762 8.3)
+#define MDNS_ANNOUNCE_INTERVAL_MS 1000
+
+#define WIFI_POLL_MS            250    // Station link state check interval
+#define WIFI_FLASH_TIMEOUT_MS   100    // Wait for the other core to pause before writing flash
+// Station mode network parameters live in the last flash sector
+#define WIFI_CACHE_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+
+// DHCP server for AP clients. Requests are answered straight from the
+// lwIP receive callback, so a client has its address as soon as the
+// exchange crosses the air.
+static struct udp_pcb *s_dhcp_pcb = NULL;
+static dhcp_server s_dhcp;
+static uint8_t s_dhcp_request[DHCP_REQUEST_MAX];
+static uint8_t s_dhcp_reply[DHCP_MSG_MAX];
+
+static void dhcp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                      const ip_addr_t *addr, u16_t port) {
+    (void)arg;
+    (void)addr;
+    (void)port;
+    uint16_t len = pbuf_copy_partial(p, s_dhcp_request, sizeof(s_dhcp_request), 0);
+    pbuf_free(p);
+
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    size_t clients = dhcp_server_client_count(&s_dhcp, now_ms);
+    bool unicast;
+    size_t reply_len = dhcp_server_handle(&s_dhcp, s_dhcp_request, len, now_ms,
+                                          s_dhcp_reply, &unicast);
+    if (dhcp_server_client_count(&s_dhcp, now_ms) != clients) {
+        printf("DHCP: %u client(s)\n", (unsigned)dhcp_server_client_count(&s_dhcp, now_ms));
+    }
+    if (reply_len == 0) return;
+
+    // Clients without an address yet can only be reached by broadcast
+    ip_addr_t dest;
+    if (unicast) {
+        IP_ADDR4(&dest, s_dhcp_reply[12], s_dhcp_reply[13], s_dhcp_reply[14], s_dhcp_reply[15]);
+    } else {
+        dest = *IP_ADDR_BROADCAST;
+    }
+
+    struct pbuf *out = pbuf_alloc(PBUF_TRANSPORT, (u16_t)reply_len, PBUF_RAM);
+    if (!out) {
+        printf("ERROR: no memory for DHCP reply\n");
+        return;
+    }
+    memcpy(out->payload, s_dhcp_reply, reply_len);
+    err_t err = udp_sendto_if(pcb, out, &dest, DHCP_CLIENT_PORT, &cyw43_state.netif[CYW43_ITF_AP]);
+    pbuf_free(out);
+    if (err != ERR_OK) {
+        printf("ERROR: DHCP reply failed: %d\n", err);
+    }
+}
+
+static bool dhcp_server_start(void) {
+    struct netif *netif = &cyw43_state.netif[CYW43_ITF_AP];
+    const ip4_addr_t *ip = netif_ip4_addr(netif);
+    const ip4_addr_t *mask = netif_ip4_netmask(netif);
+    const uint8_t server_ip[4] = { ip4_addr1(ip), ip4_addr2(ip), ip4_addr3(ip), ip4_addr4(ip) };
+    const uint8_t netmask[4] = { ip4_addr1(mask), ip4_addr2(mask), ip4_addr3(mask), ip4_addr4(mask) };
+    dhcp_server_init(&s_dhcp, server_ip, netmask, DHCP_LEASE_TIME_S);
+
+    cyw43_arch_lwip_begin();
+    s_dhcp_pcb = udp_new_ip_type(IPADDR_TYPE_ANY);
+    if (s_dhcp_pcb) {
+        ip_set_option(s_dhcp_pcb, SOF_BROADCAST);
+        udp_bind_netif(s_dhcp_pcb, netif);
+        if (udp_bind(s_dhcp_pcb, IP_ANY_TYPE, DHCP_SERVER_PORT) == ERR_OK) {
+            udp_recv(s_dhcp_pcb, dhcp_recv, NULL);
+        } else {
+            udp_remove(s_dhcp_pcb);
+            s_dhcp_pcb = NULL;
+        }
+    }
+    cyw43_arch_lwip_end();
+
+    if (!s_dhcp_pcb) {
+        printf("ERROR: failed to start DHCP server\n");
+        return false;
+    }
+    printf("DHCP server leasing %u.%u.%u.%u-%u\n", server_ip[0], server_ip[1], server_ip[2],
+           DHCP_FIRST_HOST, DHCP_FIRST_HOST + DHCP_LEASE_MAX - 1);
+    return true;
+}
+
+// mDNS responder. Replies are sent straight from the cached packets in
+// mdns_responder.c (wrapped in a PBUF_REF), so answering a query only costs
+// the name comparisons.
+static struct udp_pcb *s_mdns_pcb = NULL;
+static mdns_responder s_mdns;
+static uint8_t s_mdns_query[MDNS_MSG_MAX];
+static ip_addr_t s_mdns_group;
+static uint8_t s_mdns_announcements = 0;   // Announcements still to send
+static struct netif *s_mdns_announce_netif = NULL;
+
+static void mdns_send(const uint8_t *data, size_t len, const ip_addr_t *dest, u16_t port,
+                      struct netif *netif) {
+    struct pbuf *p = pbuf_alloc_reference((void *)data, (u16_t)len, PBUF_REF);
+    if (!p) {
+        printf("ERROR: no memory for mDNS reply\n");
+        return;
+    }
+    err_t err = udp_sendto_if(s_mdns_pcb, p, dest, port, netif);
+    pbuf_free(p);
+    if (err != ERR_OK) {
+        printf("ERROR: mDNS reply failed: %d\n", err);
+        return;
+    }
+    metrics_count(METRIC_MDNS_SENT);
+}
+
+// Advertise the address of the interface the responder is answering on
+static void mdns_use_netif(const struct netif *netif) {
+    const ip4_addr_t *ip = netif_ip4_addr(netif);
+    const uint8_t addr[4] = { ip4_addr1(ip), ip4_addr2(ip), ip4_addr3(ip), ip4_addr4(ip) };
+    mdns_responder_set_ip(&s_mdns, addr);
+}
+
+static void mdns_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                      const ip_addr_t *addr, u16_t port) {
+    (void)arg;
+    (void)pcb;
+    uint16_t len = pbuf_copy_partial(p, s_mdns_query, sizeof(s_mdns_query), 0);
+    pbuf_free(p);
+    metrics_count(METRIC_MDNS_RECEIVED);
+
+    struct netif *netif = ip_current_input_netif();
+    mdns_use_netif(netif);
+    const uint8_t *reply;
+    bool unicast;
+    size_t reply_len = mdns_responder_handle(&s_mdns, s_mdns_query, len, port,
+                                             to_ms_since_boot(get_absolute_time()),
+                                             &reply, &unicast);
+    if (reply_len == 0) return;
+    if (unicast) {
+        mdns_send(reply, reply_len, addr, port, netif);
+    } else {
+        mdns_send(reply, reply_len, &s_mdns_group, MDNS_PORT, netif);
+    }
+}
+
+static void mdns_announce_timeout(void *arg) {
+    struct netif *netif = arg;
+    mdns_use_netif(netif);
+    const uint8_t *packet;
+    size_t len = mdns_responder_announce(&s_mdns, to_ms_since_boot(get_absolute_time()), &packet);
+    if (len > 0) {
+        mdns_send(packet, len, &s_mdns_group, MDNS_PORT, netif);
+    }
+    if (--s_mdns_announcements > 0) {
+        sys_timeout(MDNS_ANNOUNCE_INTERVAL_MS, mdns_announce_timeout, netif);
+    }
+}
+
+// Start answering on an interface that just got its address, and tell
+// the link so caches holding an old address are updated
+static void mdns_netif_up(struct netif *netif) {
+    if (!s_mdns_pcb) return;  // Responder not started (yet)
+
+    igmp_joingroup_netif(netif, ip_2_ip4(&s_mdns_group));
+    if (s_mdns_announcements > 0) {
+        sys_untimeout(mdns_announce_timeout, s_mdns_announce_netif);
+    }
+    s_mdns_announcements = MDNS_ANNOUNCE_COUNT;
+    s_mdns_announce_netif = netif;
+    mdns_announce_timeout(netif);
+    printf("mDNS: %s.local at %s\n", s_mdns.host, ip4addr_ntoa(netif_ip4_addr(netif)));
+}
+
+static bool ap_enable(const char *ssid, const char *password) {
+    // Enable AP mode with given SSID/password
+    cyw43_arch_enable_ap_mode(ssid, password, CYW43_AUTH_WPA2_AES_PSK);
+    printf("WiFi AP started with SSID '%s'\n", ssid);
+
+    // Clients configure themselves from our DHCP replies
+    if (!dhcp_server_start()) {
+        return false;
+    }
+    mdns_netif_up(&cyw43_state.netif[CYW43_ITF_AP]);
+    return true;
+}
+
+// WiFi / Access Point (AP) setup
+bool wifi_start_ap(const char *ssid, const char *password) {
+    // Initialize the CYW43 Wi-Fi chip + lwIP networking stack
+    if (cyw43_arch_init()) {
+        printf("ERROR: cyw43_arch_init() failed\n");
+        return false;
+    }
+    return ap_enable(ssid, password);
+}
+
+// WiFi station mode. The connection state machine (wifi_sta.c) is stepped
+// from an lwIP timer; the network parameters it learns are written to the
+// last flash sector from wifi_service() in the main loop, since flash
+// can't be erased from the timer's interrupt context.
+static wifi_sta s_sta;
+static wifi_cache s_sta_cache;
+static bool s_sta_cache_valid = false;
+static volatile bool s_sta_cache_dirty = false;
+static const char *s_sta_ssid;
+static const char *s_sta_password;
+static const char *s_fallback_ssid;
+static const char *s_fallback_password;
+
+static wifi_link sta_link_state(void) {
+    switch (cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA)) {
+        case CYW43_LINK_UP:
+            return WIFI_LINK_UP;
+        case CYW43_LINK_JOIN:
+        case CYW43_LINK_NOIP:
+            return WIFI_LINK_JOINING;
+        case CYW43_LINK_FAIL:
+        case CYW43_LINK_NONET:
+        case CYW43_LINK_BADAUTH:
+            return WIFI_LINK_FAILED;
+        default:
+            return WIFI_LINK_DOWN;
+    }
+}
+
+// Fast reconnect: put the cached lease on the interface as soon as the
+// link is up, so the station is reachable without waiting for DHCP, then
+// restart the DHCP client to renew it. If the network hands out another
+// address now, lwIP replaces the cached one when the client binds. Only
+// lwIP's public API is used, so this doesn't depend on the lwIP version.
+static void sta_apply_cached_lease(void *arg) {
+    (void)arg;
+    struct netif *netif = &cyw43_state.netif[CYW43_ITF_STA];
+    if (!s_sta_cache_valid || !netif_is_link_up(netif) || dhcp_supplied_address(netif)) {
+        return;  // A lease lwIP already holds is renewed by lwIP itself
+    }
+    const uint8_t *ip = s_sta_cache.ip;
+    const uint8_t *mask = s_sta_cache.netmask;
+    const uint8_t *gw = s_sta_cache.gateway;
+    ip4_addr_t addr, netmask, gateway;
+    IP4_ADDR(&addr, ip[0], ip[1], ip[2], ip[3]);
+    IP4_ADDR(&netmask, mask[0], mask[1], mask[2], mask[3]);
+    IP4_ADDR(&gateway, gw[0], gw[1], gw[2], gw[3]);
+    netif_set_addr(netif, &addr, &netmask, &gateway);
+
+    err_t err = dhcp_start(netif);
+    if (err != ERR_OK) {
+        printf("ERROR: dhcp_start() failed: %d\n", err);
+    }
+}
+
+// The link callback runs inside netif_set_link_up(), before lwIP and the
+// CYW43 driver have (re)started their DHCP client for the new link, so the
+// cached lease is applied from a timer once they have
+static void sta_link_changed(struct netif *netif) {
+    if (netif_is_link_up(netif) && s_sta_cache_valid) {
+        sys_timeout(0, sta_apply_cached_lease, NULL);
+    }
+}
+
+static void sta_join(void) {
+    size_t pw_len = strlen(s_sta_password);
+    uint32_t auth = pw_len ? CYW43_AUTH_WPA2_AES_PSK : CYW43_AUTH_OPEN;
+    const uint8_t *bssid = NULL;
+    uint32_t channel = CYW43_CHANNEL_NONE;
+    if (s_sta.use_cache && s_sta_cache_valid) {
+        // Skip the scan and go straight to the access point used last time
+        bssid = s_sta_cache.bssid;
+        channel = s_sta_cache.channel;
+    }
+
+    int err = cyw43_wifi_join(&cyw43_state, strlen(s_sta_ssid), (const uint8_t *)s_sta_ssid,
+                              pw_len, (const uint8_t *)s_sta_password, auth, bssid, channel);
+    if (err != 0) {
+        printf("ERROR: WiFi join failed to start: %d\n", err);
+    } else if (bssid) {
+        printf("WiFi: joining '%s' on channel %u\n", s_sta_ssid, s_sta_cache.channel);
+    } else {
+        printf("WiFi: joining '%s'\n", s_sta_ssid);
+    }
+}
+
+// Remember the access point and lease of the connection just made
+static void sta_update_cache(void) {
+    wifi_cache c = { 0 };
+    strncpy(c.ssid, s_sta_ssid, WIFI_SSID_MAX);
+    cyw43_wifi_get_bssid(&cyw43_state, c.bssid);
+    uint8_t chan_info[12] = { 0 };  // First word is the channel in use
+    if (cyw43_ioctl(&cyw43_state, CYW43_IOCTL_GET_CHANNEL, sizeof(chan_info), chan_info,
+                    CYW43_ITF_STA) == 0) {
+        c.channel = chan_info[0];
+    }
+
+    const struct netif *netif = &cyw43_state.netif[CYW43_ITF_STA];
+    const ip4_addr_t *addrs[3] = { netif_ip4_addr(netif), netif_ip4_netmask(netif),
+                                   netif_ip4_gw(netif) };
+    uint8_t *out[3] = { c.ip, c.netmask, c.gateway };
+    for (int i = 0; i < 3; i++) {
+        out[i][0] = ip4_addr1(addrs[i]);
+        out[i][1] = ip4_addr2(addrs[i]);
+        out[i][2] = ip4_addr3(addrs[i]);
+        out[i][3] = ip4_addr4(addrs[i]);
+    }
+
+    if (c.channel == 0) return;  // Nothing trustworthy to remember
+    if (!s_sta_cache_valid || memcmp(&c, &s_sta_cache, sizeof(c)) != 0) {
+        s_sta_cache = c;
+        s_sta_cache_valid = true;
+        s_sta_cache_dirty = true;
+    }
+}
+
+static void sta_poll(void *arg);
+
+static void sta_handle(wifi_action action) {
+    switch (action) {
+        case WIFI_ACTION_JOIN:
+            sta_join();
+            break;
+
+        case WIFI_ACTION_ABORT:
+            cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+            metrics_count(METRIC_WIFI_JOIN_FAILURES);
+            printf("ERROR: WiFi join failed (%u in a row), retrying in %lu ms\n", s_sta.failures,
+                   (unsigned long)(s_sta.retry_at_ms - s_sta.state_ms));
+            break;
+
+        case WIFI_ACTION_CONNECTED: {
+            const ip4_addr_t *ip = netif_ip4_addr(&cyw43_state.netif[CYW43_ITF_STA]);
+            printf("WiFi: connected to '%s' as %u.%u.%u.%u in %lu ms (offline %lu ms, %lu reconnects)\n",
+                   s_sta_ssid, ip4_addr1(ip), ip4_addr2(ip), ip4_addr3(ip), ip4_addr4(ip),
+                   (unsigned long)s_sta.last_join_ms, (unsigned long)s_sta.outage_ms,
+                   (unsigned long)s_sta.reconnects);
+            metrics_count(METRIC_WIFI_CONNECTS);
+            if (s_sta.reconnects > 0) {
+                metrics_count(METRIC_WIFI_RECONNECTS);
+            }
+            metrics_set_gauge(METRIC_WIFI_JOIN_TIME, (float)s_sta.last_join_ms / 1000.0f);
+            sta_update_cache();
+            mdns_netif_up(&cyw43_state.netif[CYW43_ITF_STA]);
+            break;
+        }
+
+        case WIFI_ACTION_DISCONNECTED:
+            // Drop any half-open association before the next join
+            cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+            printf("ERROR: WiFi connection lost, rejoining in %lu ms\n",
+                   (unsigned long)(s_sta.retry_at_ms - s_sta.state_ms));
+            break;
+
+        case WIFI_ACTION_FALLBACK:
+            cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+            metrics_count(METRIC_WIFI_JOIN_FAILURES);
+            printf("ERROR: could not join '%s' after %u attempts, falling back to AP mode\n",
+                   s_sta_ssid, s_sta.failures);
+            cyw43_arch_disable_sta_mode();
+            ap_enable(s_fallback_ssid, s_fallback_password);
+            break;
+
+        case WIFI_ACTION_NONE:
+        default:
+            break;
+    }
+}
+
+static void sta_poll(void *arg) {
+    (void)arg;
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    sta_handle(wifi_sta_step(&s_sta, sta_link_state(), now_ms, get_rand_32()));
+    if (s_sta.state != WIFI_STA_FALLBACK) {
+        sys_timeout(WIFI_POLL_MS, sta_poll, NULL);
+    }
+}
+
+bool wifi_start_sta(const char *ssid, const char *password,
+                    const char *ap_ssid, const char *ap_password) {
+    if (strlen(ssid) == 0 || strlen(ssid) > WIFI_SSID_MAX) {
+        printf("ERROR: invalid WiFi SSID '%s'\n", ssid);
+        return false;
+    }
+    if (cyw43_arch_init()) {
+        printf("ERROR: cyw43_arch_init() failed\n");
+        return false;
+    }
+    cyw43_arch_enable_sta_mode();
+
+    s_sta_ssid = ssid;
+    s_sta_password = password;
+    s_fallback_ssid = ap_ssid;
+    s_fallback_password = ap_password;
+    s_sta_cache_valid = wifi_cache_decode((const uint8_t *)(XIP_BASE + WIFI_CACHE_FLASH_OFFSET),
+                                          ssid, &s_sta_cache);
+    if (s_sta_cache_valid) {
+        printf("WiFi: cached access point on channel %u, address %u.%u.%u.%u\n",
+               s_sta_cache.channel, s_sta_cache.ip[0], s_sta_cache.ip[1],
+               s_sta_cache.ip[2], s_sta_cache.ip[3]);
+    }
+
+    cyw43_arch_lwip_begin();
+    netif_set_link_callback(&cyw43_state.netif[CYW43_ITF_STA], sta_link_changed);
+    wifi_sta_init(&s_sta, WIFI_FALLBACK_FAILURES, s_sta_cache_valid,
+                  to_ms_since_boot(get_absolute_time()));
+    sta_poll(NULL);
+    cyw43_arch_lwip_end();
+    return true;
+}
+
+static void sta_write_cache(void *arg) {
+    const uint8_t *page = arg;
+    flash_range_erase(WIFI_CACHE_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    flash_range_program(WIFI_CACHE_FLASH_OFFSET, page, FLASH_PAGE_SIZE);
+}
+
+void wifi_service(void) {
+    if (!s_sta_cache_dirty) return;
+
+    uint8_t page[FLASH_PAGE_SIZE];
+    memset(page, 0xFF, sizeof(page));
+    cyw43_arch_lwip_begin();
+    wifi_cache_encode(&s_sta_cache, page);
+    s_sta_cache_dirty = false;
+    cyw43_arch_lwip_end();
+
+    int rc = flash_safe_execute(sta_write_cache, page, WIFI_FLASH_TIMEOUT_MS);
+    if (rc != PICO_OK) {
+        printf("ERROR: failed to save WiFi parameters: %d\n", rc);
+    }
+}
+
+bool mdns_start(const char *hostname, uint16_t http_port) {
+    static const char *const txt[] = { "path=/", "fw=" FIRMWARE_VERSION, "sensors=1" };
+    if (!mdns_responder_init(&s_mdns, hostname, http_port, txt, sizeof(txt) / sizeof(txt[0]))) {
+        printf("ERROR: invalid mDNS hostname '%s'\n", hostname);
+        return false;
+    }
+    ipaddr_aton(MDNS_GROUP, &s_mdns_group);
+
+    cyw43_arch_lwip_begin();
+    s_mdns_pcb = udp_new_ip_type(IPADDR_TYPE_ANY);
+    if (s_mdns_pcb) {
+        udp_set_multicast_ttl(s_mdns_pcb, 255);   // RFC 6762 11: receivers check for 255
+        if (udp_bind(s_mdns_pcb, IP_ANY_TYPE, MDNS_PORT) == ERR_OK) {
+            udp_recv(s_mdns_pcb, mdns_recv, NULL);
+        } else {
+            udp_remove(s_mdns_pcb);
+            s_mdns_pcb = NULL;
+        }
+    }
+    if (s_mdns_pcb) {
+        // Announce on whichever interface already has an address; a
+        // station that connects later announces itself then
+        for (int itf = CYW43_ITF_STA; itf <= CYW43_ITF_AP; itf++) {
+            struct netif *netif = &cyw43_state.netif[itf];
+            if (netif_is_up(netif) && !ip4_addr_isany_val(*netif_ip4_addr(netif))) {
+                mdns_netif_up(netif);
+                break;
+            }
+        }
+    }
+    cyw43_arch_lwip_end();
+
+    if (!s_mdns_pcb) {
+        printf("ERROR: failed to start mDNS responder\n");
+        return false;
+    }
+    return true;
+}
+
+// UDP telemetry publisher: each sample is packed into the current batch,
+// and the batch goes out as one datagram once it is full
+static struct udp_pcb *s_udp_pcb = NULL;
+static ip_addr_t s_udp_target;
+static uint16_t s_udp_port = 0;
+static telemetry_batch s_udp_batch;
+
+bool udp_telemetry_start(const char *addr, uint16_t port, uint8_t batch_size) {
+    if (!ipaddr_aton(addr, &s_udp_target)) {
+        printf("ERROR: invalid UDP telemetry address '%s'\n", addr);
+        return false;
+    }
+
+    cyw43_arch_lwip_begin();
+    s_udp_pcb = udp_new_ip_type(IPADDR_TYPE_ANY);
+    if (s_udp_pcb) {
+        // Needed when the target is a broadcast address such as 192.168.4.255
+        ip_set_option(s_udp_pcb, SOF_BROADCAST);
+    }
+    cyw43_arch_lwip_end();
+
+    if (!s_udp_pcb) {
+        printf("ERROR: udp_new_ip_type() failed\n");
+        return false;
+    }
+
+    s_udp_port = port;
+    telemetry_batch_init(&s_udp_batch, batch_size);
+    printf("UDP telemetry to %s:%u, %u sample(s) per datagram\n", addr, port,
+           s_udp_batch.batch_size);
+    return true;
+}
+
+void udp_telemetry_publish(void) {
+    if (!s_udp_pcb) return;  // Publisher never started
+
+    reading_snapshot latest;
+    snapshot_read(&g_latest, &latest);
+    telemetry_sample sample = {
+        .time_ms = latest.sample_ms,
+        .humidity = latest.humidity,
+        .temp_celsius = latest.temp_c,
+        .status = latest.status,
+        .flags = (led_array_is_enabled() ? TELEMETRY_FLAG_LED : 0) |
+                 (latest.sample_ms ? TELEMETRY_FLAG_VALID : 0),
+    };
+    if (!telemetry_batch_add(&s_udp_batch, &sample)) {
+        return;  // Batch not full yet
+    }
+    size_t len = telemetry_batch_finish(&s_udp_batch);
+
+    cyw43_arch_lwip_begin();
+    err_t err = ERR_MEM;
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, (u16_t)len, PBUF_RAM);
+    if (p) {
+        memcpy(p->payload, s_udp_batch.data, len);
+        err = udp_sendto(s_udp_pcb, p, &s_udp_target, s_udp_port);
+        pbuf_free(p);
+    }
+    cyw43_arch_lwip_end();
+
+    if (err != ERR_OK) {
+        // The samples are lost; receivers see the gap in the sequence numbers
+        printf("ERROR: UDP telemetry send failed: %d\n", err);
+        metrics_count(METRIC_UDP_ERRORS);
+        return;
+    }
+    metrics_count(METRIC_UDP_DATAGRAMS);
+    metrics_add(METRIC_UDP_SAMPLES, s_udp_batch.data[3]);
+    metrics_add(METRIC_UDP_BYTES, (uint32_t)len);
+}
+
+// MQTT client: readings are published as retained messages under a topic
+// root, and <root>/set accepts the same query-form commands as /set.
+// Messages wait in s_mqtt_outbox until sent (QoS 0) or acknowledged (QoS 1),
+// so a dropped connection only delays them. Everything here runs with the
+// lwIP lock held: lwIP callbacks already hold it, and the entry points take it.
+static mqtt_client_t *s_mqtt = NULL;
+static ip_addr_t s_mqtt_broker;
+static uint16_t s_mqtt_port = 0;
+static uint8_t s_mqtt_qos = 0;
+static char s_mqtt_root[MQTT_ROOT_MAX];
+static char s_mqtt_client_id[24];             // MQTT 3.1.1 guarantees 23 characters
+static char s_mqtt_online_topic[MQTT_TOPIC_MAX];
+static char s_mqtt_set_topic[MQTT_TOPIC_MAX];
+static mqtt_outbox s_mqtt_outbox;
+static backoff s_mqtt_backoff;
+
+// Command arriving on the set topic, which may come in several pieces
+static char s_mqtt_cmd[MQTT_CMD_MAX + 1];
+static size_t s_mqtt_cmd_len = 0;
+static bool s_mqtt_cmd_wanted = false;
+
+static void mqtt_connect_broker(void);
+
+// Publish callback; arg is the outbox id of the message
+static void mqtt_publish_done(void *arg, err_t err) {
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+    if (err == ERR_OK) {
+        mqtt_outbox_done(&s_mqtt_outbox, id);
+        metrics_count(METRIC_MQTT_MESSAGES);
+    } else {
+        // Timed out waiting for PUBACK; it goes out again with the next sample
+        mqtt_outbox_retry(&s_mqtt_outbox, id);
+    }
+}
+
+// Hand waiting messages to the MQTT stack until it runs out of room.
+// Not called from mqtt_publish_done(): lwIP completes QoS 0 requests while
+// walking its request list, so new requests must not be added from there.
+static void mqtt_pump(void) {
+    if (!s_mqtt || !mqtt_client_is_connected(s_mqtt)) return;
+
+    mqtt_message *m;
+    while ((m = mqtt_outbox_next(&s_mqtt_outbox)) != NULL) {
+        err_t err = mqtt_publish(s_mqtt, m->topic, m->payload, m->len, m->qos, m->retain,
+                                 mqtt_publish_done, (void *)(uintptr_t)m->id);
+        if (err != ERR_OK) {
+            break;  // Request slots or output buffer full; try again later
+        }
+        m->in_flight = true;
+    }
+}
+
+// Queue a message on <root>/<name>; every message is retained so new
+// subscribers get the current state right away
+static void mqtt_queue(const char *name, const char *payload, size_t len, uint8_t qos) {
+    char topic[MQTT_TOPIC_MAX];
+    snprintf(topic, sizeof(topic), "%s/%s", s_mqtt_root, name);
+
+    uint32_t dropped = s_mqtt_outbox.dropped;
+    if (!mqtt_outbox_put(&s_mqtt_outbox, topic, payload, len, qos, true)) {
+        printf("ERROR: MQTT payload for '%s' too long (%u bytes)\n", topic, (unsigned)len);
+    }
+    metrics_add(METRIC_MQTT_DROPPED, s_mqtt_outbox.dropped - dropped);
+}
+
+static void mqtt_reconnect_timeout(void *arg) {
+    (void)arg;
+    mqtt_connect_broker();
+}
+
+static void mqtt_schedule_reconnect(void) {
+    uint32_t delay_ms = backoff_next(&s_mqtt_backoff, get_rand_32());
+    printf("MQTT: reconnecting in %lu ms\n", (unsigned long)delay_ms);
+    sys_timeout(delay_ms, mqtt_reconnect_timeout, NULL);
+}
+
+static void mqtt_incoming_publish(void *arg, const char *topic, u32_t tot_len) {
+    (void)arg;
+    s_mqtt_cmd_len = 0;
+    s_mqtt_cmd_wanted = (strcmp(topic, s_mqtt_set_topic) == 0 && tot_len <= MQTT_CMD_MAX);
+    if (!s_mqtt_cmd_wanted) {
+        printf("ERROR: ignoring MQTT message on '%s' (%lu bytes)\n", topic, (unsigned long)tot_len);
+    }
+}
+
+static void mqtt_incoming_data(void *arg, const u8_t *data, u16_t len, u8_t flags) {
+    (void)arg;
+    if (!s_mqtt_cmd_wanted) return;
+    if (s_mqtt_cmd_len + len > MQTT_CMD_MAX) {
+        s_mqtt_cmd_wanted = false;
+        return;
+    }
+    memcpy(s_mqtt_cmd + s_mqtt_cmd_len, data, len);
+    s_mqtt_cmd_len += len;
+
+    if (flags & MQTT_DATA_FLAG_LAST) {
+        s_mqtt_cmd[s_mqtt_cmd_len] = '\0';
+        s_mqtt_cmd_wanted = false;
+        if (!web_server_apply_settings(s_mqtt_cmd)) {
+            printf("ERROR: unrecognized MQTT command\n");
+        }
+    }
+}
+
+static void mqtt_subscribe_done(void *arg, err_t err) {
+    (void)arg;
+    if (err != ERR_OK) {
+        printf("ERROR: MQTT subscribe to '%s' failed: %d\n", s_mqtt_set_topic, err);
+    }
+}
+
+static void mqtt_connection_changed(mqtt_client_t *client, void *arg,
+                                    mqtt_connection_status_t status) {
+    (void)arg;
+    if (status == MQTT_CONNECT_ACCEPTED) {
+        printf("MQTT: connected as %s\n", s_mqtt_client_id);
+        metrics_count(METRIC_MQTT_CONNECTS);
+        backoff_reset(&s_mqtt_backoff);
+        mqtt_set_inpub_callback(client, mqtt_incoming_publish, mqtt_incoming_data, NULL);
+        mqtt_subscribe(client, s_mqtt_set_topic, 1, mqtt_subscribe_done, NULL);
+        mqtt_queue("online", "1", 1, 1);  // Replaces the "0" will from the last disconnect
+        mqtt_pump();
+        return;
+    }
+
+    printf("ERROR: MQTT connection lost (status %d)\n", status);
+    mqtt_outbox_retry_all(&s_mqtt_outbox);
+    mqtt_schedule_reconnect();
+}
+
+static void mqtt_connect_broker(void) {
+    // The CONNECT packet is built before mqtt_client_connect() returns,
+    // so the info struct only needs to live until then
+    struct mqtt_connect_client_info_t info = {
+        .client_id = s_mqtt_client_id,
+        .keep_alive = MQTT_KEEPALIVE_S,
+        .will_topic = s_mqtt_online_topic,
+        .will_msg = "0",
+        .will_qos = 1,
+        .will_retain = 1,
+    };
+    err_t err = mqtt_client_connect(s_mqtt, &s_mqtt_broker, s_mqtt_port,
+                                    mqtt_connection_changed, NULL, &info);
+    if (err != ERR_OK) {
+        printf("ERROR: MQTT connect failed: %d\n", err);
+        mqtt_schedule_reconnect();
+    }
+}
+
+bool mqtt_telemetry_start(const char *broker, uint16_t port, const char *topic_root, uint8_t qos) {
+    if (!ipaddr_aton(broker, &s_mqtt_broker)) {
+        printf("ERROR: invalid MQTT broker address '%s'\n", broker);
+        return false;
+    }
+    if (strlen(topic_root) >= MQTT_ROOT_MAX) {
+        printf("ERROR: MQTT topic root '%s' too long\n", topic_root);
+        return false;
+    }
+
+    strcpy(s_mqtt_root, topic_root);
+    snprintf(s_mqtt_online_topic, sizeof(s_mqtt_online_topic), "%s/online", topic_root);
+    snprintf(s_mqtt_set_topic, sizeof(s_mqtt_set_topic), "%s/set", topic_root);
+    char board_id[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+    pico_get_unique_board_id_string(board_id, sizeof(board_id));
+    snprintf(s_mqtt_client_id, sizeof(s_mqtt_client_id), "pico2w-%s", board_id);
+
+    s_mqtt_port = port;
+    s_mqtt_qos = (qos > 0) ? 1 : 0;
+    mqtt_outbox_init(&s_mqtt_outbox);
+    backoff_init(&s_mqtt_backoff, MQTT_BACKOFF_MIN_MS, MQTT_BACKOFF_MAX_MS);
+
+    cyw43_arch_lwip_begin();
+    s_mqtt = mqtt_client_new();
+    if (s_mqtt) {
+        mqtt_connect_broker();
+    }
+    cyw43_arch_lwip_end();
+
+    if (!s_mqtt) {
+        printf("ERROR: mqtt_client_new() failed\n");
+        return false;
+    }
+    printf("MQTT broker %s:%u, topics under %s/, QoS %u\n", broker, port, topic_root, s_mqtt_qos);
+    return true;
+}
+
+void mqtt_telemetry_publish(void) {
+    if (!s_mqtt) return;  // Client never started
+
+    api_reading r;
+    reading_snapshot latest;
+    web_server_fill_reading(&r, &latest);
+
+    char json[MQTT_PAYLOAD_MAX];
+    api_buffer buf = { json, sizeof(json), 0 };
+    api_sink sink;
+    api_sink_init(&sink, api_buffer_write, &buf);
+    api_write_readings_json(&sink, API_FIELDS_ALL, &r);
+
+    cyw43_arch_lwip_begin();
+    mqtt_queue("readings", json, buf.len, s_mqtt_qos);
+    if (r.has_sample) {
+        char value[16];
+        int len = snprintf(value, sizeof(value), "%.1f", r.humidity);
+        mqtt_queue("humidity", value, (size_t)len, s_mqtt_qos);
+        len = snprintf(value, sizeof(value), "%.1f", r.temp_celsius);
+        mqtt_queue("temperature", value, (size_t)len, s_mqtt_qos);
+    }
+    mqtt_pump();
+    cyw43_arch_lwip_end();
+}
+
+// Names of the lwIP memory pools, in memp_t order
+static const char *const MEMP_NAMES[MEMP_MAX] = {
+#define LWIP_MEMPOOL(name, num, size, desc) #name,
+#include "lwip/priv/memp_std.h"
+};
+
+// Every open HTTP connection needs a PCB, plus one for the listener
+_Static_assert(HTTP_MAX_CLIENTS < MEMP_NUM_TCP_PCB,
+               "MEMP_NUM_TCP_PCB in lwipopts.h must exceed HTTP_MAX_CLIENTS");
+
+void network_wifi_metrics(uint32_t now_ms) {
+    uint32_t expiry_ms;
+    metrics_set_gauge(METRIC_DHCP_CLIENTS, (float)dhcp_server_client_count(&s_dhcp, now_ms));
+    metrics_set_gauge(METRIC_DHCP_NEXT_EXPIRY, dhcp_server_next_expiry(&s_dhcp, now_ms, &expiry_ms)
+                                                   ? (float)expiry_ms / 1000.0f : NAN);
+
+    metrics_pool pools[MEMP_MAX + 1];
+    size_t count = 0;
+    pools[count++] = (metrics_pool){ "HEAP", lwip_stats.mem.used, lwip_stats.mem.max,
+                                     lwip_stats.mem.avail, lwip_stats.mem.err };
+    for (int i = 0; i < MEMP_MAX; i++) {
+        const struct stats_mem *m = lwip_stats.memp[i];
+        if (m) {
+            pools[count++] = (metrics_pool){ MEMP_NAMES[i], m->used, m->max, m->avail, m->err };
+        }
+    }
+    metrics_set_pools(pools, count);
+}
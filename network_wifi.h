@@ -0,0 +1,55 @@
+/*
+File: network_wifi.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: What the web server in network.c and the WiFi side in
+    network_wifi.c (network_wifi_linux.c in the host build) share. MQTT
+    commands use the same settings as /set, MQTT readings are gathered the
+    same way as /api/v1/readings, and /metrics includes the WiFi side's
+    DHCP and lwIP pool figures.
+
+    Not for use outside those files; main.c uses network.h.
+*/
+
+#ifndef NETWORK_WIFI_H
+#define NETWORK_WIFI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "snapshot.h"
+#include "web_api.h"
+
+/**
+ * @brief Apply the name=value settings in a query-style string
+ *
+ * Takes the same form as /set, e.g. "led=off&interval=5000". Nothing is
+ * applied unless every setting is valid; on success the new state is
+ * pushed to every subscriber. Implemented in network.c.
+ *
+ * @param query  Settings; modified in place while parsing
+ * @return true if every setting was recognized and applied
+ */
+bool web_server_apply_settings(char *query);
+
+/**
+ * @brief Gather the values reported by the readings API
+ *
+ * Implemented in network.c.
+ *
+ * @param r       Receives the values
+ * @param latest  Receives the snapshot they were taken from
+ */
+void web_server_fill_reading(api_reading *r, reading_snapshot *latest);
+
+/**
+ * @brief Set the WiFi side's /metrics gauges and pool usage
+ *
+ * Called once per scrape, from TCP callback context.
+ *
+ * @param now_ms  Milliseconds since boot
+ */
+void network_wifi_metrics(uint32_t now_ms);
+
+#endif // NETWORK_WIFI_H
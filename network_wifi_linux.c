@@ -0,0 +1,79 @@
+/*
+File: network_wifi_linux.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    The WiFi side of the network module (network.h) for the host build,
+    where there is no radio. The web server in network.c runs on loopback
+    through hal_tcp_linux.c; the access point, station, mDNS, UDP and MQTT
+    functions only report that they have nothing to do, so main.c starts
+    the same way it does on the Pico.
+
+Responsibilities:
+- Accept the AP and station start calls and say there is no radio
+- Turn down UDP telemetry and MQTT, which need lwIP
+- Report no DHCP clients and no lwIP pools at /metrics
+
+Requires the following modules:
+- network.h: for interface definitions
+- network_wifi.h: for the /metrics hook
+- metrics.h: for the DHCP gauges
+*/
+
+#include "network.h"
+#include "network_wifi.h"
+#include "metrics.h"
+
+#include <math.h>
+#include <stdio.h>
+
+bool wifi_start_ap(const char *ssid, const char *password) {
+    (void)password;
+    printf("WiFi: no radio in the host build, not starting AP %s\n", ssid);
+    return true;
+}
+
+bool wifi_start_sta(const char *ssid, const char *password,
+                    const char *ap_ssid, const char *ap_password) {
+    (void)password;
+    (void)ap_ssid;
+    (void)ap_password;
+    printf("WiFi: no radio in the host build, not joining %s\n", ssid);
+    return true;
+}
+
+void wifi_service(void) {
+}
+
+bool mdns_start(const char *hostname, uint16_t http_port) {
+    (void)http_port;
+    printf("mDNS: not in the host build, %s.local is not answered\n", hostname);
+    return true;
+}
+
+bool udp_telemetry_start(const char *addr, uint16_t port, uint8_t batch_size) {
+    (void)batch_size;
+    printf("ERROR: UDP telemetry to %s:%u is not in the host build\n", addr, port);
+    return false;
+}
+
+void udp_telemetry_publish(void) {
+}
+
+bool mqtt_telemetry_start(const char *broker, uint16_t port, const char *topic_root, uint8_t qos) {
+    (void)topic_root;
+    (void)qos;
+    printf("ERROR: MQTT to %s:%u is not in the host build\n", broker, port);
+    return false;
+}
+
+void mqtt_telemetry_publish(void) {
+}
+
+void network_wifi_metrics(uint32_t now_ms) {
+    (void)now_ms;
+    metrics_set_gauge(METRIC_DHCP_CLIENTS, 0.0f);
+    metrics_set_gauge(METRIC_DHCP_NEXT_EXPIRY, NAN);
+    metrics_set_pools(NULL, 0);
+}
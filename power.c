@@ -0,0 +1,135 @@
+/*
+File: power.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Power manager (see power.h). Lowers clk_sys when full speed isn't
+    needed and restores it when it is. The I2C and PIO dividers are
+    computed from clk_sys, so they are reset after every switch.
+
+    USB stdio runs from the USB PLL and the timer from the crystal, so
+    neither is affected by a switch, and the sample timer keeps waking
+    the core on time in every state. clk_peri is kept on the USB PLL too:
+    set_sys_clock_khz() moves it onto clk_sys, and after the switch to the
+    crystal it would otherwise run at 12 MHz while clock_get_hz() still
+    reported the old speed.
+
+Responsibilities:
+- Switch clk_sys between full speed, a lowered PLL speed and the crystal
+- Turn the system PLL off while running from the crystal
+- Let the LED strip finish its frame before a switch, and reset the I2C
+  baud rates and the strip's PIO divider after it
+- Hold clk_peri at 48 MHz from the USB PLL in every state
+- Track the time in each state and estimate the average board current
+
+Requires the following modules:
+- power.h: for interface definitions
+- power_budget.h: for the state policy and accounting
+- i2c_bus.h: for re-timing the I2C buses
+- led_array.h: for draining and re-timing the LED strip
+- hal.h: for the TCP lock that holds off the radio in WiFi builds
+*/
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/pll.h"
+
+#include "power.h"
+#include "i2c_bus.h"
+#include "led_array.h"
+
+#ifdef ENABLE_WIFI
+#include "hal.h"
+#endif
+
+#define XOSC_HZ_DEFAULT 12000000   // Crystal frequency on the Pico boards
+
+static power_budget s_budget;
+static uint32_t s_full_khz;         // clk_sys at boot, restored by POWER_FULL
+
+// Estimated board current in each state; the radio adds a constant in WiFi builds
+static const float CURRENT_MA[POWER_STATE_COUNT] = {
+#ifdef ENABLE_WIFI
+    POWER_FULL_MA + POWER_WIFI_MA, POWER_REDUCED_MA + POWER_WIFI_MA, POWER_XOSC_MA + POWER_WIFI_MA,
+#else
+    POWER_FULL_MA, POWER_REDUCED_MA, POWER_XOSC_MA,
+#endif
+};
+
+// Run clk_peri from the USB PLL, which no power state stops or changes
+static void hold_clk_peri(void) {
+    clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB,
+                    USB_CLK_HZ, USB_CLK_HZ);
+}
+
+void power_init(void) {
+    s_full_khz = clock_get_hz(clk_sys) / 1000;
+    hold_clk_peri();
+    power_budget_init(&s_budget, POWER_FULL, time_us_64());
+}
+
+// Reset the dividers that were computed from the old clk_sys
+static void retime_peripherals(void) {
+    i2c_bus_clock_changed();
+    led_array_clock_changed();
+}
+
+void power_enter(power_state state) {
+    if (state == s_budget.state) return;
+
+#ifdef ENABLE_WIFI
+    // Keep the CYW43 driver, which runs under the TCP lock, from clocking
+    // the radio's SPI bus mid-switch
+    hal_tcp_lock();
+#endif
+    // A frame still shifting out of the PIO would be sent at the wrong bit rate
+    led_array_wait_idle();
+    switch (state) {
+        case POWER_FULL:
+            set_sys_clock_khz(s_full_khz, true);
+            break;
+        case POWER_REDUCED:
+            set_sys_clock_khz(POWER_REDUCED_KHZ, true);
+            break;
+        case POWER_XOSC:
+            // clk_ref already runs from the crystal; move clk_sys onto it and stop the PLL
+            clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLK_REF, 0,
+                            XOSC_HZ_DEFAULT, XOSC_HZ_DEFAULT);
+            pll_deinit(pll_sys);
+            break;
+        default:
+            break;
+    }
+    hold_clk_peri();
+    retime_peripherals();
+#ifdef ENABLE_WIFI
+    hal_tcp_unlock();
+#endif
+
+    power_budget_enter(&s_budget, state, time_us_64());
+}
+
+power_state power_get_state(void) {
+    return s_budget.state;
+}
+
+float power_state_seconds(power_state state) {
+    return (float)power_budget_time_us(&s_budget, state, time_us_64()) / 1e6f;
+}
+
+float power_average_ma(void) {
+    return power_budget_average_ma(&s_budget, CURRENT_MA, time_us_64());
+}
+
+void power_report(void) {
+    uint64_t now_us = time_us_64();
+    printf("Power: %s now, ~%.1f mA average;", power_state_name(s_budget.state),
+           (double)power_budget_average_ma(&s_budget, CURRENT_MA, now_us));
+    for (int i = 0; i < POWER_STATE_COUNT; i++) {
+        printf(" %s %.1f s", power_state_name((power_state)i),
+               (double)power_budget_time_us(&s_budget, (power_state)i, now_us) / 1e6);
+    }
+    printf(", %lu switches\n", (unsigned long)s_budget.transitions);
+}
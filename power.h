@@ -0,0 +1,68 @@
+/*
+File: power.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the power manager. It switches clk_sys
+    between the states in power_budget.h. After each switch it resets
+    the I2C and PIO dividers, which are computed from clk_sys. It also
+    tracks the time spent in each state.
+
+    Only the core that owns the I2C buses and the LED strip (core 1) may
+    change the clock state. Any core may read the statistics.
+*/
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "power_budget.h"
+
+// Lowered clk_sys used while no network client is connected (kHz)
+#ifndef POWER_REDUCED_KHZ
+#define POWER_REDUCED_KHZ 48000
+#endif
+
+/**
+ * @brief Start accounting with clk_sys at its full boot-time speed
+ */
+void power_init(void);
+
+/**
+ * @brief Switch clk_sys to the given state and re-time the peripherals
+ *
+ * No effect if already in that state. Call only from the core that owns
+ * the I2C buses and the LED strip, between transfers.
+ * @param state State to enter
+ */
+void power_enter(power_state state);
+
+/**
+ * @brief Get the current clock state
+ *
+ * @return Current state
+ */
+power_state power_get_state(void);
+
+/**
+ * @brief Time spent in a state since power_init()
+ *
+ * @param state State to report
+ * @return Time in seconds
+ */
+float power_state_seconds(power_state state);
+
+/**
+ * @brief Average estimated board current since power_init()
+ *
+ * @return Current in mA
+ */
+float power_average_ma(void);
+
+/**
+ * @brief Print the time in each state and the average current estimate
+ */
+void power_report(void);
+
+#endif // POWER_H
@@ -0,0 +1,76 @@
+/*
+File: power_budget.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Provides the clock state policy and time-in-state accounting for the
+    power manager (see power_budget.h).
+
+Responsibilities:
+- Choose the clock state from the build type, core activity and clients
+- Accumulate the time spent in each state
+- Estimate the average supply current from the time in each state
+
+Requires the following modules:
+- power_budget.h: for interface definitions
+*/
+
+#include "power_budget.h"
+
+power_state power_policy_state(bool wifi, bool awake, bool clients) {
+    if (wifi) {
+        // The radio needs the PLL; only the CPU speed can come down
+        return clients ? POWER_FULL : POWER_REDUCED;
+    }
+    return awake ? POWER_FULL : POWER_XOSC;
+}
+
+void power_budget_init(power_budget *budget, power_state initial, uint64_t now_us) {
+    budget->state = initial;
+    budget->since_us = now_us;
+    for (int i = 0; i < POWER_STATE_COUNT; i++) {
+        budget->time_us[i] = 0;
+    }
+    budget->transitions = 0;
+}
+
+void power_budget_enter(power_budget *budget, power_state state, uint64_t now_us) {
+    if (state == budget->state) return;
+    budget->time_us[budget->state] += now_us - budget->since_us;
+    budget->state = state;
+    budget->since_us = now_us;
+    budget->transitions++;
+}
+
+uint64_t power_budget_time_us(const power_budget *budget, power_state state, uint64_t now_us) {
+    uint64_t time_us = budget->time_us[state];
+    if (state == budget->state) {
+        time_us += now_us - budget->since_us;
+    }
+    return time_us;
+}
+
+float power_budget_average_ma(const power_budget *budget,
+                              const float current_ma[POWER_STATE_COUNT], uint64_t now_us) {
+    double charge = 0.0;   // mA x us
+    uint64_t total_us = 0;
+    for (int i = 0; i < POWER_STATE_COUNT; i++) {
+        uint64_t time_us = power_budget_time_us(budget, (power_state)i, now_us);
+        charge += (double)current_ma[i] * (double)time_us;
+        total_us += time_us;
+    }
+    if (total_us == 0) {
+        return current_ma[budget->state];
+    }
+    return (float)(charge / (double)total_us);
+}
+
+const char *power_state_name(power_state state) {
+    switch (state) {
+        case POWER_FULL:    return "full";
+        case POWER_REDUCED: return "reduced";
+        case POWER_XOSC:    return "xosc";
+        default:            return "unknown";
+    }
+}
@@ -0,0 +1,120 @@
+/*
+File: power_budget.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the power state bookkeeping used by the
+    power manager in power.c: which clock state to be in, how long has
+    been spent in each, and the average supply current that works out to.
+
+    The currents are estimates for the whole board (from the RP2040 and
+    RP2350 datasheets and the CYW43439 power-save figures), not
+    measurements. Override them when configuring once a unit has been
+    measured.
+
+    This module has no hardware dependencies so it can be unit tested on
+    the host (see test_power_budget.c).
+*/
+
+#ifndef POWER_BUDGET_H
+#define POWER_BUDGET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Estimated board supply current in each state, in mA
+#ifndef POWER_FULL_MA
+#define POWER_FULL_MA     25.0f   // clk_sys at full speed
+#endif
+#ifndef POWER_REDUCED_MA
+#define POWER_REDUCED_MA  12.0f   // clk_sys lowered, PLL still running
+#endif
+#ifndef POWER_XOSC_MA
+#define POWER_XOSC_MA     5.0f    // clk_sys from the 12 MHz crystal, system PLL off
+#endif
+#ifndef POWER_WIFI_MA
+#define POWER_WIFI_MA     30.0f   // Added by the CYW43 radio in WiFi builds
+#endif
+
+/**
+ * @brief Clock states of the power manager, fastest first
+ */
+typedef enum {
+    POWER_FULL = 0,     // Full-speed clk_sys
+    POWER_REDUCED,      // Lowered clk_sys (WiFi builds with no network client)
+    POWER_XOSC,         // clk_sys straight from the crystal (non-WiFi builds between samples)
+    POWER_STATE_COUNT
+} power_state;
+
+/**
+ * @brief Time spent in each state
+ */
+typedef struct {
+    power_state state;                      // Current state
+    uint64_t since_us;                      // When the current state was entered
+    uint64_t time_us[POWER_STATE_COUNT];    // Completed time in each state
+    uint32_t transitions;                   // State changes since init
+} power_budget;
+
+/**
+ * @brief Pick the clock state for the current situation
+ *
+ * WiFi builds keep the PLL running for the radio and only lower clk_sys
+ * while no client is connected. Other builds run from the crystal
+ * whenever the sampling core is idle.
+ *
+ * @param wifi     Whether this is a WiFi build
+ * @param awake    Whether the sampling core has work to do
+ * @param clients  Whether a network client is connected
+ * @return State to be in
+ */
+power_state power_policy_state(bool wifi, bool awake, bool clients);
+
+/**
+ * @brief Start accounting in the given state
+ *
+ * @param budget   Budget to set up
+ * @param initial  Current state
+ * @param now_us   Current time in microseconds
+ */
+void power_budget_init(power_budget *budget, power_state initial, uint64_t now_us);
+
+/**
+ * @brief Record a change of state (no effect if already in it)
+ *
+ * @param budget  Budget
+ * @param state   State being entered
+ * @param now_us  Current time in microseconds
+ */
+void power_budget_enter(power_budget *budget, power_state state, uint64_t now_us);
+
+/**
+ * @brief Total time spent in a state, including the current stay
+ *
+ * @param budget  Budget
+ * @param state   State to report
+ * @param now_us  Current time in microseconds
+ * @return Time in microseconds
+ */
+uint64_t power_budget_time_us(const power_budget *budget, power_state state, uint64_t now_us);
+
+/**
+ * @brief Average estimated supply current since init
+ *
+ * @param budget      Budget
+ * @param current_ma  Estimated current in each state, in mA
+ * @param now_us      Current time in microseconds
+ * @return Time-weighted average in mA (the current state's value if no time has passed)
+ */
+float power_budget_average_ma(const power_budget *budget,
+                              const float current_ma[POWER_STATE_COUNT], uint64_t now_us);
+
+/**
+ * @brief Get a short lowercase name for a state
+ *
+ * @param state  State
+ * @return Constant string such as "full" or "xosc"
+ */
+const char *power_state_name(power_state state);
+
+#endif // POWER_BUDGET_H
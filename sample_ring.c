@@ -0,0 +1,56 @@
+/*
+File: sample_ring.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Lock-free single-producer, single-consumer ring that hands sensor
+    samples from core 1 to core 0 (see sample_ring.h).
+
+Responsibilities:
+- Copy samples in on the producer core and out on the consumer core
+- Order the slot copy and the index update so neither core sees a half-written slot
+- Drop and count samples when the consumer falls behind
+
+Requires the following modules:
+- sample_ring.h: for interface definitions
+*/
+
+#include <string.h>
+#include "sample_ring.h"
+
+_Static_assert((SAMPLE_RING_SIZE & (SAMPLE_RING_SIZE - 1)) == 0,
+               "SAMPLE_RING_SIZE must be a power of two");
+
+void sample_ring_init(sample_ring *ring) {
+    memset(ring->slots, 0, sizeof(ring->slots));
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->dropped = 0;
+}
+
+bool sample_ring_push(sample_ring *ring, const ring_sample *sample) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t next = (head + 1) & (SAMPLE_RING_SIZE - 1);
+
+    // Acquire pairs with the consumer's release: the slot is free to reuse
+    if (next == atomic_load_explicit(&ring->tail, memory_order_acquire)) {
+        ring->dropped++;
+        return false;
+    }
+    ring->slots[head] = *sample;
+    atomic_store_explicit(&ring->head, next, memory_order_release);
+    return true;
+}
+
+bool sample_ring_pop(sample_ring *ring, ring_sample *sample) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    // Acquire pairs with the producer's release: the slot has been written
+    if (tail == atomic_load_explicit(&ring->head, memory_order_acquire)) {
+        return false;
+    }
+    *sample = ring->slots[tail];
+    atomic_store_explicit(&ring->tail, (tail + 1) & (SAMPLE_RING_SIZE - 1), memory_order_release);
+    return true;
+}
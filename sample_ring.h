@@ -0,0 +1,77 @@
+/*
+File: sample_ring.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the ring buffer that carries sensor
+    samples from core 1, which reads the sensor and drives the LCD and
+    LEDs, to core 0, which runs WiFi and the network services (main.c).
+
+    There is exactly one producer and one consumer, so no lock is needed:
+    each side only writes its own index, and the release/acquire ordering
+    on the indices makes a slot's contents visible before the index that
+    publishes it. A full ring drops the new sample rather than blocking
+    core 1.
+
+    This module has no hardware dependencies so it can be unit tested on
+    the host (see test_sample_ring.c).
+*/
+
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SAMPLE_RING_SIZE 8   // Slots; a power of two. One is kept empty to tell full from empty.
+
+/**
+ * @brief One sensor sample as handed from core 1 to core 0
+ */
+typedef struct {
+    uint32_t seq;           // Incremented for every sample taken
+    uint32_t sample_ms;     // Time of the last good reading (0 = none yet)
+    uint32_t produced_us;   // When the sample was pushed, for the hand-off latency
+    float humidity;         // Last good readings; unchanged by a failed read
+    float temp_c;
+    float temp_f;
+    uint8_t status;         // dht_status of this read
+} ring_sample;
+
+/**
+ * @brief Single-producer, single-consumer ring of samples
+ */
+typedef struct {
+    ring_sample slots[SAMPLE_RING_SIZE];
+    _Atomic uint32_t head;  // Next slot to write; written only by the producer
+    _Atomic uint32_t tail;  // Next slot to read; written only by the consumer
+    uint32_t dropped;       // Samples dropped because the ring was full (producer only)
+} sample_ring;
+
+/**
+ * @brief Empty the ring; call before either core uses it
+ *
+ * @param ring  Ring to reset
+ */
+void sample_ring_init(sample_ring *ring);
+
+/**
+ * @brief Add a sample (producer side)
+ *
+ * @param ring    Ring buffer
+ * @param sample  Sample to copy in
+ * @return false if the ring was full and the sample was dropped
+ */
+bool sample_ring_push(sample_ring *ring, const ring_sample *sample);
+
+/**
+ * @brief Take the oldest sample (consumer side)
+ *
+ * @param ring    Ring buffer
+ * @param sample  Receives the sample
+ * @return false if the ring was empty
+ */
+bool sample_ring_pop(sample_ring *ring, ring_sample *sample);
+
+#endif // SAMPLE_RING_H
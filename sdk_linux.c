@@ -0,0 +1,313 @@
+/*
+File: sdk_linux.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    The pico-sdk calls made by main.c, network.c and power.c, for the
+    host build (the headers in host/). With these, the firmware's own
+    main() runs on Linux: each core is a thread with its async_context
+    and time is the hardware abstraction layer's (hal.h).
+
+    Each async_context is a poll context owned by one thread. Its
+    workers run from async_context_poll() on that thread without the
+    context's lock held, as on the Pico, and
+    async_context_wait_for_work_until() sleeps on a condition variable
+    that async_context_set_work_pending() signals from any thread.
+
+Responsibilities:
+- Time and sleeping on top of hal.h
+- Core 1 as a thread
+- async_context poll contexts with at-time and when-pending workers
+- Clocks and PLLs that record what power.c sets them to
+
+Requires the following modules:
+- hal.h: for the time
+*/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pico/stdlib.h"
+#include "pico/async_context_poll.h"
+#include "pico/multicore.h"
+#include "pico/flash.h"
+#include "hardware/clocks.h"
+#include "hardware/pll.h"
+
+#include "hal.h"
+
+#define HOST_SYS_HZ   150000000u   // clk_sys at boot on the RP2350
+#define HOST_XOSC_HZ  12000000u
+#define HOST_USB_HZ   48000000u
+
+const absolute_time_t at_the_end_of_time = UINT64_MAX;
+
+// ---- Time ----
+
+uint64_t time_us_64(void) {
+    return hal_time_us_64();
+}
+
+uint32_t time_us_32(void) {
+    return hal_time_us();
+}
+
+void sleep_us(uint64_t us) {
+    while (us > 0) {
+        uint32_t step = us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+        hal_sleep_us(step);
+        us -= step;
+    }
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000u);
+}
+
+bool stdio_init_all(void) {
+    // Line at a time, so the cores' output interleaves as it would on USB
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    return true;
+}
+
+// ---- Core 1 ----
+
+static void *core1_thread(void *arg) {
+    void (*entry)(void) = (void (*)(void))arg;
+    entry();
+    return NULL;
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, core1_thread, (void *)entry) != 0) {
+        printf("ERROR: Failed to start the core 1 thread\n");
+        return;
+    }
+    pthread_detach(thread);
+}
+
+// ---- async_context ----
+
+bool async_context_poll_init_with_defaults(async_context_poll_t *self) {
+    async_context_t *context = &self->core;
+    memset(context, 0, sizeof(*context));
+    pthread_mutexattr_t mutex_attr;
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_settype(&mutex_attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&context->lock, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&context->wake, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+    return true;
+}
+
+// Wake the context's thread. Called with the lock held.
+static void wake(async_context_t *context) {
+    context->woken = true;
+    pthread_cond_broadcast(&context->wake);
+}
+
+// Unlink an at-time worker. Called with the lock held.
+static bool unlink_at_time(async_context_t *context, async_at_time_worker_t *worker) {
+    for (async_at_time_worker_t **p = &context->at_time_list; *p; p = &(*p)->next) {
+        if (*p == worker) {
+            *p = worker->next;
+            worker->next = NULL;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool async_context_add_at_time_worker_at(async_context_t *context, async_at_time_worker_t *worker,
+                                         absolute_time_t at) {
+    pthread_mutex_lock(&context->lock);
+    unlink_at_time(context, worker);
+    worker->next_time = at;
+    // Keep the list in deadline order; equal deadlines run in the order added
+    async_at_time_worker_t **p = &context->at_time_list;
+    while (*p && (*p)->next_time <= at) {
+        p = &(*p)->next;
+    }
+    worker->next = *p;
+    *p = worker;
+    wake(context);
+    pthread_mutex_unlock(&context->lock);
+    return true;
+}
+
+bool async_context_add_at_time_worker_in_ms(async_context_t *context,
+                                            async_at_time_worker_t *worker, uint32_t ms) {
+    return async_context_add_at_time_worker_at(context, worker, make_timeout_time_ms(ms));
+}
+
+bool async_context_remove_at_time_worker(async_context_t *context, async_at_time_worker_t *worker) {
+    pthread_mutex_lock(&context->lock);
+    bool removed = unlink_at_time(context, worker);
+    pthread_mutex_unlock(&context->lock);
+    return removed;
+}
+
+bool async_context_add_when_pending_worker(async_context_t *context,
+                                           async_when_pending_worker_t *worker) {
+    pthread_mutex_lock(&context->lock);
+    for (async_when_pending_worker_t *w = context->when_pending_list; w; w = w->next) {
+        if (w == worker) {
+            pthread_mutex_unlock(&context->lock);
+            return false;
+        }
+    }
+    worker->next = context->when_pending_list;
+    context->when_pending_list = worker;
+    if (worker->work_pending) {
+        wake(context);
+    }
+    pthread_mutex_unlock(&context->lock);
+    return true;
+}
+
+bool async_context_remove_when_pending_worker(async_context_t *context,
+                                              async_when_pending_worker_t *worker) {
+    pthread_mutex_lock(&context->lock);
+    bool removed = false;
+    for (async_when_pending_worker_t **p = &context->when_pending_list; *p; p = &(*p)->next) {
+        if (*p == worker) {
+            *p = worker->next;
+            worker->next = NULL;
+            removed = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&context->lock);
+    return removed;
+}
+
+void async_context_set_work_pending(async_context_t *context, async_when_pending_worker_t *worker) {
+    pthread_mutex_lock(&context->lock);
+    worker->work_pending = true;
+    wake(context);
+    pthread_mutex_unlock(&context->lock);
+}
+
+void async_context_poll(async_context_t *context) {
+    pthread_mutex_lock(&context->lock);
+    bool ran = true;
+    while (ran) {
+        ran = false;
+        for (async_when_pending_worker_t *w = context->when_pending_list; w; w = w->next) {
+            if (w->work_pending) {
+                w->work_pending = false;
+                pthread_mutex_unlock(&context->lock);
+                w->do_work(context, w);
+                pthread_mutex_lock(&context->lock);
+                ran = true;
+                break;   // The list may have changed
+            }
+        }
+        async_at_time_worker_t *due = context->at_time_list;
+        if (!ran && due && time_reached(due->next_time)) {
+            context->at_time_list = due->next;
+            due->next = NULL;
+            pthread_mutex_unlock(&context->lock);
+            due->do_work(context, due);
+            pthread_mutex_lock(&context->lock);
+            ran = true;
+        }
+    }
+    pthread_mutex_unlock(&context->lock);
+}
+
+void async_context_wait_for_work_until(async_context_t *context, absolute_time_t until) {
+    pthread_mutex_lock(&context->lock);
+    if (context->at_time_list && context->at_time_list->next_time < until) {
+        until = context->at_time_list->next_time;
+    }
+    while (!context->woken && !time_reached(until)) {
+        // Sleep on the monotonic clock for the time left on the HAL's clock
+        uint64_t left_us = until - time_us_64();
+        if (left_us > 3600u * 1000000u) {
+            left_us = 3600u * 1000000u;   // Recompute now and then; nothing waits that long
+        }
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        uint64_t ns = (uint64_t)deadline.tv_nsec + left_us * 1000u;
+        deadline.tv_sec += (time_t)(ns / 1000000000u);
+        deadline.tv_nsec = (long)(ns % 1000000000u);
+        pthread_cond_timedwait(&context->wake, &context->lock, &deadline);
+    }
+    context->woken = false;
+    pthread_mutex_unlock(&context->lock);
+}
+
+void async_context_wait_for_work_ms(async_context_t *context, uint32_t ms) {
+    async_context_wait_for_work_until(context, make_timeout_time_ms(ms));
+}
+
+// ---- Flash ----
+
+// Core 1 never needs pausing, since nothing on the host writes flash
+bool flash_safe_execute_core_init(void) {
+    return true;
+}
+
+// ---- Clocks ----
+
+static uint32_t s_clock_hz[CLK_COUNT] = {
+    [clk_ref] = HOST_XOSC_HZ,
+    [clk_sys] = HOST_SYS_HZ,
+    [clk_peri] = HOST_SYS_HZ,
+    [clk_hstx] = HOST_SYS_HZ,
+    [clk_usb] = HOST_USB_HZ,
+    [clk_adc] = HOST_USB_HZ,
+};
+
+pll_hw_t host_pll_sys = { .running = true };
+pll_hw_t host_pll_usb = { .running = true };
+
+uint32_t clock_get_hz(clock_handle_t clock) {
+    return s_clock_hz[clock];
+}
+
+bool clock_configure(clock_handle_t clock, uint32_t src, uint32_t auxsrc, uint32_t src_freq,
+                     uint32_t freq) {
+    (void)src;
+    (void)auxsrc;
+    if (freq > src_freq) {
+        return false;
+    }
+    s_clock_hz[clock] = freq;
+    return true;
+}
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required) {
+    (void)required;
+    host_pll_sys.running = true;
+    s_clock_hz[clk_sys] = freq_khz * 1000u;
+    s_clock_hz[clk_peri] = freq_khz * 1000u;   // The pico-sdk moves clk_peri onto clk_sys
+    return true;
+}
+
+void pll_init(PLL pll, unsigned int ref_div, unsigned int vco_freq, unsigned int post_div1,
+              unsigned int post_div2) {
+    (void)ref_div;
+    (void)vco_freq;
+    (void)post_div1;
+    (void)post_div2;
+    pll->running = true;
+}
+
+void pll_deinit(PLL pll) {
+    pll->running = false;
+}
+
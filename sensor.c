@@ -21,13 +21,16 @@ Description: Provides initialization & reading functionality between the
 Responsibilities:
 - Initialize sensor and default Pico LED
 - Periodically read humidity from the sensor
+- Reject measurements that fail the sensor's CRC check
 
 Requires the following modules:
 - sensor.h: for reading humidity values
+- i2c_bus.h: for access to the shared I2C bus
+- hal.h: for waiting out a measurement in read_from_dht()
 
 Wiring configuration
 ** DHT20 Sensor **
-I2C0 bus
+I2C0 bus, shared with the LCD (see board_pins.h)
 GPIO 4 (pin 6) -> SDA on DHT20
 GPIO 5 (pin 7) -> SCL on DHT20
 3.3v (pin 36) -> VCC on DHT20
@@ -38,25 +41,23 @@ GND (pin 38) -> GND on DHT20
 #include <stdio.h>
 #include <stdbool.h>
 #include <math.h>
-#include "pico/stdlib.h"
-#include "hardware/i2c.h"
-#include "hardware/gpio.h"
 
 // Import project files
 #include "sensor.h"     // Sensor interface
+#include "metrics.h"    // Error counters for /metrics
+#include "i2c_bus.h"    // Shared I2C bus manager
+#include "hal.h"        // Waiting out a measurement
 
 // Initialize DHT20 sensor
 bool dht_init(void) {
     printf("Initializing the DHT20 sensor.\n");
-    i2c_init(I2C_PORT, I2C_FREQ);
-    gpio_set_function(I2C_SDA_PIN, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL_PIN, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA_PIN);
-    gpio_pull_up(I2C_SCL_PIN);
+    i2c_bus_init();
 
     // Verify connection
     uint8_t i2c_init_signal[1] = {0x00};
-    int result = i2c_read_blocking(I2C_PORT, DHT20_I2C_ADDR, i2c_init_signal, 1, false);
+    i2c_txn probe = { .device = I2C_DEV_DHT20, .priority = I2C_PRIORITY_HIGH, .addr = DHT20_I2C_ADDR,
+                      .rx = i2c_init_signal, .rx_len = 1 };
+    int result = i2c_bus_transfer(&probe);
     if (result < 0) {
         printf("DHT20 not responding at address 0x%02X\n", DHT20_I2C_ADDR);
         return false;
@@ -70,29 +71,76 @@ float celsius_to_fahrenheit(float temp_celsius) {
     return (temp_celsius * 9.0 / 5.0) + 32.0;
 }
 
-// Get a reading from the DHT20 sensor (Adapted from DHT example code)
-void read_from_dht(dht_reading *result) {
-    // Send command trigger to sensor
-    printf("Sending the command trigger.\n");
-    uint8_t i2c_init_signal[3] = {DHT20_CMD_TRIGGER, DHT20_CMD_BYTE_1, DHT20_CMD_BYTE_2};
-    int send_command = i2c_write_blocking(I2C_PORT, DHT20_I2C_ADDR, i2c_init_signal, 3, false);
+// CRC-8 as computed by the DHT20 over the bytes it sends before the CRC byte
+static uint8_t dht_crc8(const uint8_t *data, int len) {
+    uint8_t crc = DHT20_CRC_INIT;
+    for (int i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ DHT20_CRC_POLY) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Trigger command for a DHT20 measurement (Adapted from DHT example code)
+static i2c_txn dht_trigger_txn(void) {
+    i2c_txn trigger = { .device = I2C_DEV_DHT20, .priority = I2C_PRIORITY_HIGH, .addr = DHT20_I2C_ADDR,
+                        .tx = {DHT20_CMD_TRIGGER, DHT20_CMD_BYTE_1, DHT20_CMD_BYTE_2}, .tx_len = 3 };
+    return trigger;
+}
+
+// Check the trigger transfer's result
+static dht_status dht_trigger_status(int send_command) {
     if (send_command < 0) {
         printf("Failed: send_command = %d\n", send_command);
+        metrics_count(METRIC_DHT_I2C_ERRORS);
+        return DHT_STATUS_I2C_ERROR;
     }
-    sleep_ms(SLEEP_TIME);
+    return DHT_STATUS_OK;
+}
 
-    // Read data back from the sensor
-    printf("Receiving data from the sensor.\n");
-    uint8_t received_data[7];
-    int receive_data = i2c_read_blocking(I2C_PORT, DHT20_I2C_ADDR, received_data, 7, false);
+// Start a DHT20 measurement (Adapted from DHT example code)
+dht_status dht_start_measurement(void) {
+    metrics_count(METRIC_DHT_READS);
+
+    // Send command trigger to sensor
+    printf("Sending the command trigger.\n");
+    i2c_txn trigger = dht_trigger_txn();
+    return dht_trigger_status(i2c_bus_transfer(&trigger));
+}
+
+// Get a reading from the DHT20 sensor, waiting for the measurement to finish
+dht_status read_from_dht(dht_reading *result) {
+    dht_status status = dht_start_measurement();
+    if (status != DHT_STATUS_OK) {
+        return status;
+    }
+    hal_sleep_ms(SLEEP_TIME);
+    return dht_read_measurement(result);
+}
+
+// Check and convert the 7 bytes read back from the sensor (Adapted from DHT example code)
+static dht_status dht_decode(const uint8_t received_data[7], int receive_data, dht_reading *result) {
     if (receive_data < 0) {
         printf("Failed: receive_data = %d\n", receive_data);
+        metrics_count(METRIC_DHT_I2C_ERRORS);
+        return DHT_STATUS_I2C_ERROR;
     }
 
     // Check if sensor was done measuring: Status byte (0) bit 7 == 0 when ready
     if (received_data[0] & 0x80) {
         printf("Sensor is busy.\n");
-        return;
+        metrics_count(METRIC_DHT_BUSY);
+        return DHT_STATUS_BUSY;
+    }
+
+    // Byte 6 is a CRC of bytes 0-5; a mismatch means the data was corrupted
+    uint8_t crc = dht_crc8(received_data, 6);
+    if (crc != received_data[6]) {
+        printf("CRC mismatch: computed 0x%02X, received 0x%02X\n", crc, received_data[6]);
+        metrics_count(METRIC_DHT_CRC_ERRORS);
+        return DHT_STATUS_CRC_ERROR;
     }
 
     // Collect raw humidity data from received_data bytes: 20 bits total
@@ -115,6 +163,63 @@ void read_from_dht(dht_reading *result) {
 
     // Convert temp in Celsius to Fahrenheit
     result->temp_fahrenheit = celsius_to_fahrenheit(result->temp_celsius);
+
+    return DHT_STATUS_OK;
+}
+
+// Collect a measurement started SLEEP_TIME ms earlier (Adapted from DHT example code)
+dht_status dht_read_measurement(dht_reading *result) {
+    // Read data back from the sensor
+    printf("Receiving data from the sensor.\n");
+    uint8_t received_data[7];
+    i2c_txn read = { .device = I2C_DEV_DHT20, .priority = I2C_PRIORITY_HIGH, .addr = DHT20_I2C_ADDR,
+                     .rx = received_data, .rx_len = 7 };
+    return dht_decode(received_data, i2c_bus_transfer(&read), result);
+}
+
+// Background measurement state; one trigger or read is in flight at a time
+static dht_callback s_on_trigger;
+static dht_callback s_on_read;
+static dht_reading *s_read_result;
+static uint8_t s_read_data[7];
+
+static void dht_trigger_done(const i2c_txn *txn, int result, void *ctx) {
+    (void)txn;
+    (void)ctx;
+    s_on_trigger(dht_trigger_status(result));
+}
+
+static void dht_read_done(const i2c_txn *txn, int result, void *ctx) {
+    (void)txn;
+    (void)ctx;
+    s_on_read(dht_decode(s_read_data, result, s_read_result));
+}
+
+void dht_start_measurement_async(dht_callback done) {
+    metrics_count(METRIC_DHT_READS);
+    s_on_trigger = done;
+    i2c_txn trigger = dht_trigger_txn();
+    trigger.done = dht_trigger_done;
+    i2c_bus_submit(&trigger);
+}
+
+void dht_read_measurement_async(dht_reading *result, dht_callback done) {
+    s_on_read = done;
+    s_read_result = result;
+    i2c_txn read = { .device = I2C_DEV_DHT20, .priority = I2C_PRIORITY_HIGH, .addr = DHT20_I2C_ADDR,
+                     .rx = s_read_data, .rx_len = 7, .done = dht_read_done };
+    i2c_bus_submit(&read);
+}
+
+// Map a measurement status to the name used in logs and the web API
+const char *dht_status_name(dht_status status) {
+    switch (status) {
+        case DHT_STATUS_OK:        return "ok";
+        case DHT_STATUS_I2C_ERROR: return "i2c_error";
+        case DHT_STATUS_BUSY:      return "busy";
+        case DHT_STATUS_CRC_ERROR: return "crc_error";
+    }
+    return "unknown";
 }
 
 float get_humidity(dht_reading *result) {
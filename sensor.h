@@ -22,6 +22,10 @@ Description: Provides interface for structures, functions, and constants for
 #ifndef SENSOR_H
 #define SENSOR_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
+// Time the DHT20 needs to measure after a trigger (ms).
 // User can update the sleep value if adjustments are needed.
 #define SLEEP_TIME 100
 
@@ -34,6 +38,16 @@ typedef struct {
     float temp_fahrenheit;
 } dht_reading;
 
+/**
+ * @brief Result of a DHT20 measurement, reported alongside each reading
+ */
+typedef enum {
+    DHT_STATUS_OK = 0,      // Measurement completed and values were updated
+    DHT_STATUS_I2C_ERROR,   // Trigger or read transfer failed on the I2C bus
+    DHT_STATUS_BUSY,        // Sensor had not finished measuring; values unchanged
+    DHT_STATUS_CRC_ERROR,   // Data was corrupted on the bus (CRC mismatch); values unchanged
+} dht_status;
+
 
 // Function prototypes
 /**
@@ -47,9 +61,65 @@ bool dht_init(void);
 /**
  * @brief Initiate, read, and process DHT20 sensor measurement data
  * 
+ * The values in result are only updated when DHT_STATUS_OK is returned.
  * @param *result A pointer to the dht_reading structure storing measurement values
+ * 
+ * @return DHT_STATUS_OK on success, otherwise the reason the measurement failed
  */
-void read_from_dht(dht_reading *result);
+dht_status read_from_dht(dht_reading *result);
+
+/**
+ * @brief Trigger a DHT20 measurement without waiting for it
+ * 
+ * Collect the result with dht_read_measurement() SLEEP_TIME ms later.
+ * 
+ * @return DHT_STATUS_OK if the sensor accepted the trigger, otherwise DHT_STATUS_I2C_ERROR
+ */
+dht_status dht_start_measurement(void);
+
+/**
+ * @brief Read and process the measurement started by dht_start_measurement()
+ * 
+ * The values in result are only updated when DHT_STATUS_OK is returned.
+ * @param *result A pointer to the dht_reading structure storing measurement values
+ * 
+ * @return DHT_STATUS_OK on success, otherwise the reason the measurement failed
+ */
+dht_status dht_read_measurement(dht_reading *result);
+
+/**
+ * @brief Called when a measurement step run in the background finishes
+ *
+ * @param status Result of the step, as the blocking version would return it
+ */
+typedef void (*dht_callback)(dht_status status);
+
+/**
+ * @brief Queue the trigger of dht_start_measurement() and return
+ * 
+ * done is called once the trigger has gone out on the bus.
+ * @param done Completion callback
+ */
+void dht_start_measurement_async(dht_callback done);
+
+/**
+ * @brief Queue the read of dht_read_measurement() and return
+ * 
+ * done is called once the data has been read and checked; result is
+ * only updated when the status is DHT_STATUS_OK.
+ * @param *result A pointer to the dht_reading structure to update; must stay valid until done
+ * @param done Completion callback
+ */
+void dht_read_measurement_async(dht_reading *result, dht_callback done);
+
+/**
+ * @brief Get a short lowercase name for a measurement status
+ * 
+ * @param status Status returned by read_from_dht()
+ * 
+ * @return Constant string such as "ok" or "i2c_error"
+ */
+const char *dht_status_name(dht_status status);
 
 /**
  * @brief Convert a given float value from Celsius to Fahrenheit
@@ -92,12 +162,8 @@ float get_temp_fahrenheit(dht_reading *result);
 #define DHT20_CMD_TRIGGER 0xAC
 #define DHT20_CMD_BYTE_1 0x33
 #define DHT20_CMD_BYTE_2 0x00
-
-// Configure I2C for DHT20 sensor
-#define I2C_PORT i2c0
-#define I2C_SDA_PIN 4
-#define I2C_SCL_PIN 5
-#define I2C_FREQ 100000         // Baud rate
+#define DHT20_CRC_POLY 0x31     // CRC-8 over the status and data bytes: x^8 + x^5 + x^4 + 1
+#define DHT20_CRC_INIT 0xFF
 
 // Define humidity conversion macros
 #define BIN_TO_DEC 1048576.0f   // 2^20 = 1048576
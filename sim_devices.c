@@ -0,0 +1,210 @@
+/*
+File: sim_devices.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Simulated peripherals for the Linux build (see sim_devices.h).
+
+Responsibilities:
+- Answer DHT20 triggers and reads with encoded, CRC-checked measurements
+- Decode PCF8574 port writes into HD44780 instructions and characters
+- Keep the last WS2812 frame
+- Count the timing mistakes a real device would punish
+
+Requires the following modules:
+- sim_devices.h: for interface definitions
+*/
+
+#include <string.h>
+#include "sim_devices.h"
+
+// DHT20 (Aosong datasheet)
+#define DHT20_STATUS_CALIBRATED 0x18
+#define DHT20_STATUS_BUSY       0x80
+#define DHT20_CRC_POLY          0x31
+#define DHT20_CRC_INIT          0xFF
+#define DHT20_FULL_SCALE        1048576.0f   // 2^20
+
+// PCF8574 backpack wiring
+#define PCF_RS  0x01
+#define PCF_E   0x04
+
+// ---- DHT20 ----
+
+static uint8_t dht20_crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = DHT20_CRC_INIT;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ DHT20_CRC_POLY) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Scale a value onto the sensor's 20-bit range
+static uint32_t dht20_raw(float fraction) {
+    if (fraction < 0.0f) fraction = 0.0f;
+    float raw = fraction * DHT20_FULL_SCALE;
+    return raw >= DHT20_FULL_SCALE - 1.0f ? 0xFFFFF : (uint32_t)raw;
+}
+
+// Latch the measurement that will be read back once it is ready
+static void dht20_measure(sim_dht20 *dht) {
+    uint32_t hum = dht20_raw(dht->humidity / 100.0f);
+    uint32_t temp = dht20_raw((dht->temp_c + 50.0f) / 200.0f);
+    dht->data[1] = (uint8_t)(hum >> 12);
+    dht->data[2] = (uint8_t)(hum >> 4);
+    dht->data[3] = (uint8_t)(((hum & 0x0F) << 4) | (temp >> 16));
+    dht->data[4] = (uint8_t)(temp >> 8);
+    dht->data[5] = (uint8_t)temp;
+}
+
+static int dht20_write(sim_dht20 *dht, const uint8_t *src, size_t len, uint32_t now_us) {
+    if (len == 3 && src[0] == 0xAC && src[1] == 0x33 && src[2] == 0x00) {
+        dht20_measure(dht);
+        dht->measuring = true;
+        dht->ready_us = now_us + SIM_DHT20_MEASURE_US;
+        dht->triggers++;
+    }
+    return (int)len;
+}
+
+static int dht20_read(sim_dht20 *dht, uint8_t *dst, size_t len, uint32_t now_us) {
+    uint8_t frame[7];
+    bool busy = dht->measuring && (int32_t)(now_us - dht->ready_us) < 0;
+    if (busy) {
+        dht->early_reads++;
+    } else {
+        dht->measuring = false;
+    }
+    memcpy(frame, dht->data, 6);
+    frame[0] = DHT20_STATUS_CALIBRATED | (busy ? DHT20_STATUS_BUSY : 0);
+    frame[6] = dht20_crc8(frame, 6);
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = i < sizeof(frame) ? frame[i] : 0xFF;
+    }
+    return (int)len;
+}
+
+// ---- HD44780 behind a PCF8574 ----
+
+static void lcd_execute(sim_lcd *lcd, uint8_t value, bool data, uint32_t now_us) {
+    if ((int32_t)(now_us - lcd->busy_until_us) < 0) {
+        lcd->violations++;
+    }
+    uint32_t exec_us = SIM_LCD_CMD_US;
+
+    if (data) {
+        uint8_t row = (lcd->addr & 0x40) ? 1 : 0;
+        uint8_t col = lcd->addr & 0x3F;
+        if (col < SIM_LCD_LINE_MAX) {
+            lcd->ddram[row][col] = (char)value;
+        }
+        lcd->addr = (uint8_t)((lcd->addr & 0x40) | ((col + 1) % SIM_LCD_LINE_MAX));
+        lcd->chars++;
+    } else {
+        if (value & 0x80) {             // Set DDRAM address
+            lcd->addr = value & 0x7F;
+        } else if (value & 0x40) {      // Set CGRAM address; custom characters aren't modelled
+        } else if (value & 0x20) {      // Function set
+            lcd->four_bit = !(value & 0x10);
+            lcd->have_high = false;
+        } else if (value & 0x08) {      // Display on/off control
+            lcd->display_on = (value & 0x04) != 0;
+        } else if (value & 0x04) {      // Entry mode set; only left-to-right is used
+        } else if (value & 0x02) {      // Return home
+            lcd->addr = 0;
+            exec_us = SIM_LCD_CLEAR_US;
+        } else if (value & 0x01) {      // Clear display
+            memset(lcd->ddram, ' ', sizeof(lcd->ddram));
+            lcd->addr = 0;
+            exec_us = SIM_LCD_CLEAR_US;
+        }
+        lcd->commands++;
+    }
+    lcd->busy_until_us = now_us + exec_us;
+}
+
+// The HD44780 latches D4-D7 and RS when E falls
+static void lcd_port(sim_lcd *lcd, uint8_t port, uint32_t now_us) {
+    bool falling = (lcd->port & PCF_E) && !(port & PCF_E);
+    lcd->port = port;
+    if (!falling) return;
+
+    uint8_t nibble = port >> 4;
+    bool data = (port & PCF_RS) != 0;
+    if (!lcd->four_bit) {
+        // 8-bit mode: D0-D3 aren't wired, so each pulse is a whole instruction
+        lcd_execute(lcd, (uint8_t)(nibble << 4), data, now_us);
+    } else if (!lcd->have_high) {
+        lcd->high = nibble;
+        lcd->have_high = true;
+    } else {
+        lcd->have_high = false;
+        lcd_execute(lcd, (uint8_t)((lcd->high << 4) | nibble), data, now_us);
+    }
+}
+
+void sim_lcd_line(const sim_lcd *lcd, uint8_t row, char out[SIM_LCD_COLS + 1]) {
+    memcpy(out, lcd->ddram[row < SIM_LCD_ROWS ? row : SIM_LCD_ROWS - 1], SIM_LCD_COLS);
+    out[SIM_LCD_COLS] = '\0';
+}
+
+// ---- WS2812 ----
+
+void sim_ws2812_show(sim_ws2812 *leds, const uint32_t *grb, size_t count) {
+    if (count > SIM_WS2812_MAX) count = SIM_WS2812_MAX;
+    memcpy(leds->grb, grb, count * sizeof(grb[0]));
+    leds->count = count;
+    leds->frames++;
+}
+
+size_t sim_ws2812_lit(const sim_ws2812 *leds) {
+    size_t lit = 0;
+    for (size_t i = 0; i < leds->count; i++) {
+        lit += (leds->grb[i] & 0xFFFFFF) != 0;
+    }
+    return lit;
+}
+
+// ---- Board ----
+
+void sim_board_init(sim_board *board, float humidity, float temp_c) {
+    memset(board, 0, sizeof(*board));
+    board->dht20.humidity = humidity;
+    board->dht20.temp_c = temp_c;
+    memset(board->lcd.ddram, ' ', sizeof(board->lcd.ddram));
+}
+
+int sim_board_i2c_write(sim_board *board, uint8_t addr, const uint8_t *src, size_t len,
+                        uint32_t now_us) {
+    switch (addr) {
+        case SIM_DHT20_ADDR:
+            return dht20_write(&board->dht20, src, len, now_us);
+        case SIM_LCD_ADDR:
+            for (size_t i = 0; i < len; i++) {
+                lcd_port(&board->lcd, src[i], now_us);
+            }
+            return (int)len;
+        default:
+            return -1;
+    }
+}
+
+int sim_board_i2c_read(sim_board *board, uint8_t addr, uint8_t *dst, size_t len,
+                       uint32_t now_us) {
+    switch (addr) {
+        case SIM_DHT20_ADDR:
+            return dht20_read(&board->dht20, dst, len, now_us);
+        case SIM_LCD_ADDR:
+            // Reading the PCF8574 returns its port
+            for (size_t i = 0; i < len; i++) {
+                dst[i] = board->lcd.port;
+            }
+            return (int)len;
+        default:
+            return -1;
+    }
+}
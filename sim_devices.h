@@ -0,0 +1,177 @@
+/*
+File: sim_devices.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Models of the board's peripherals for the Linux build
+    (hal_linux.c): a DHT20 humidity sensor, an LCD1602
+    (HD44780) behind a PCF8574 I2C backpack, and a WS2812 strip that
+    keeps the last frame it was sent.
+
+    The models see the same bytes the real devices would, so the drivers
+    in sensor.c, display.c and led_array.c run unchanged against them.
+    They follow the datasheets closely enough to catch the mistakes that
+    matter to the drivers: reading the DHT20 before its measurement is
+    done, and sending the HD44780 a command while it is still busy.
+
+    This module has no hardware dependencies and takes the time as an
+    argument, so it can be unit tested on the host (see
+    test_sim_devices.c).
+*/
+
+#ifndef SIM_DEVICES_H
+#define SIM_DEVICES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIM_DHT20_ADDR        0x38
+#define SIM_DHT20_MEASURE_US  80000   // Measurement time from the datasheet
+
+#define SIM_LCD_ADDR          0x27
+#define SIM_LCD_COLS          16      // Visible columns
+#define SIM_LCD_ROWS          2
+#define SIM_LCD_LINE_MAX      40      // DDRAM bytes per line
+#define SIM_LCD_CMD_US        37      // Execution time of most instructions
+#define SIM_LCD_CLEAR_US      1520    // ... and of clear and return home
+
+#define SIM_WS2812_MAX        16      // Longest strip kept
+
+/**
+ * @brief DHT20 humidity and temperature sensor
+ */
+typedef struct {
+    float humidity;          // Relative humidity the next measurement reports, percent
+    float temp_c;            // Temperature the next measurement reports, Celsius
+    bool measuring;          // A trigger was received and not yet read back
+    uint32_t ready_us;       // When the measurement in progress completes
+    uint8_t data[6];         // Status and data bytes of the last measurement
+    uint32_t triggers;       // Measurements started
+    uint32_t early_reads;    // Reads made before the measurement was done
+} sim_dht20;
+
+/**
+ * @brief LCD1602 behind a PCF8574 backpack
+ *
+ * PCF8574 bits: P0 = RS, P1 = RW, P2 = E, P3 = backlight, P4-P7 = D4-D7.
+ */
+typedef struct {
+    uint8_t port;                               // Last byte written to the PCF8574
+    bool four_bit;                              // Interface switched to 4-bit mode
+    bool have_high;                             // First nibble of a byte received
+    uint8_t high;                               // ... and its value
+    uint8_t addr;                               // DDRAM address (0x00-0x27, 0x40-0x67)
+    bool display_on;
+    char ddram[SIM_LCD_ROWS][SIM_LCD_LINE_MAX];
+    uint32_t busy_until_us;                     // End of the instruction being executed
+    uint32_t commands;                          // Instructions executed
+    uint32_t chars;                             // Characters written
+    uint32_t violations;                        // Instructions sent while busy
+} sim_lcd;
+
+/**
+ * @brief WS2812 strip
+ */
+typedef struct {
+    uint32_t grb[SIM_WS2812_MAX];   // Last frame, 0x00GGRRBB per LED
+    size_t count;                   // LEDs in the last frame
+    uint32_t frames;                // Frames received
+} sim_ws2812;
+
+/**
+ * @brief Every simulated device on the board
+ */
+typedef struct {
+    sim_dht20 dht20;
+    sim_lcd lcd;
+    sim_ws2812 leds;
+} sim_board;
+
+/**
+ * @brief The devices used by the Linux backend (defined in hal_linux.c)
+ *
+ * @return The board; never NULL
+ */
+sim_board *sim_board_get(void);
+
+/**
+ * @brief Take and release the board (defined in hal_linux.c)
+ *
+ * The I2C bus, the LED output and the host program's climate run on
+ * different threads; each holds the board while it touches a device.
+ */
+void sim_board_lock(void);
+void sim_board_unlock(void);
+
+/**
+ * @brief Keep I2C transfers blocking after i2c_bus_attach() (hal_linux.c)
+ *
+ * Runs the firmware's transfers as they were before they moved to the
+ * background, to compare the two. Call before the firmware starts.
+ * @param blocking  true to block
+ */
+void sim_i2c_set_blocking(bool blocking);
+
+/**
+ * @brief Power up a board: sensor idle and calibrated, LCD in 8-bit mode, strip dark
+ *
+ * @param board     Board to set up
+ * @param humidity  Initial relative humidity, percent
+ * @param temp_c    Initial temperature, Celsius
+ */
+void sim_board_init(sim_board *board, float humidity, float temp_c);
+
+/**
+ * @brief Write bytes to the device at an I2C address
+ *
+ * @param board   Board
+ * @param addr    7-bit address
+ * @param src     Bytes to write
+ * @param len     Number of bytes
+ * @param now_us  Current time
+ * @return len, or -1 if no device answers at addr
+ */
+int sim_board_i2c_write(sim_board *board, uint8_t addr, const uint8_t *src, size_t len,
+                        uint32_t now_us);
+
+/**
+ * @brief Read bytes from the device at an I2C address
+ *
+ * @param board   Board
+ * @param addr    7-bit address
+ * @param dst     Receives the bytes
+ * @param len     Number of bytes
+ * @param now_us  Current time
+ * @return len, or -1 if no device answers at addr
+ */
+int sim_board_i2c_read(sim_board *board, uint8_t addr, uint8_t *dst, size_t len,
+                       uint32_t now_us);
+
+/**
+ * @brief Copy the visible part of an LCD line
+ *
+ * @param lcd  LCD
+ * @param row  Line (0 or 1)
+ * @param out  Receives SIM_LCD_COLS characters and a null terminator
+ */
+void sim_lcd_line(const sim_lcd *lcd, uint8_t row, char out[SIM_LCD_COLS + 1]);
+
+/**
+ * @brief Receive one frame on the strip
+ *
+ * @param leds   Strip
+ * @param grb    Colors, 0x00GGRRBB per LED
+ * @param count  Number of LEDs; extra ones past SIM_WS2812_MAX are dropped
+ */
+void sim_ws2812_show(sim_ws2812 *leds, const uint32_t *grb, size_t count);
+
+/**
+ * @brief Number of LEDs lit in the last frame
+ *
+ * @param leds  Strip
+ * @return LEDs with any color channel on
+ */
+size_t sim_ws2812_lit(const sim_ws2812 *leds);
+
+#endif // SIM_DEVICES_H
@@ -0,0 +1,208 @@
+/*
+File: sim_network.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Controls of the simulated network in the host build
+    (HOST_BUILD). network.c's web server runs on the host through the
+    hal_tcp_* functions of hal.h, which hal_tcp_linux.c implements; this
+    header is how the host program and the tests reach what is behind
+    them.
+
+    Two ways to run it
+    ** Sockets (humidity_host) **
+    Each port the firmware listens on below SIM_PORT_MAP_SPAN is opened
+    on 127.0.0.1 at port + the port offset (80 -> 8080 by default), so
+    browsers, curl and tools/ws_client.py connect to the firmware's own
+    web server. A background thread carries the traffic and runs the TCP
+    timers with the TCP lock held.
+    ** Virtual (tests) **
+    No sockets and no thread. Clients are created with sim_tcp_connect()
+    and driven from the test, and time only moves in sim_network_run(),
+    so connection tests are repeatable and fast.
+
+    Either way each connection's send buffer, segment queue and receive
+    window have the Pico's sizes (lwipopts.h), and network.c's callbacks
+    run in the situations lwIP runs them.
+*/
+
+#ifndef SIM_NETWORK_H
+#define SIM_NETWORK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Ports below this are moved up by the port offset on loopback
+#define SIM_PORT_MAP_SPAN       10000
+#ifndef SIM_DEFAULT_PORT_OFFSET
+#define SIM_DEFAULT_PORT_OFFSET 8000
+#endif
+
+// Virtual clients that can exist at once
+#define SIM_TCP_CLIENTS_MAX     64
+// Bytes a virtual client accepts before it reads, unless changed
+#define SIM_TCP_DEFAULT_WINDOW  65535
+
+/**
+ * @brief Use virtual clients and virtual time instead of sockets and a thread
+ *
+ * Call before anything listens.
+ */
+void sim_network_use_virtual(void);
+
+/**
+ * @brief Set the offset added to ports below SIM_PORT_MAP_SPAN on loopback
+ *
+ * Call before anything listens.
+ * @param offset  Offset; 0 uses the firmware's ports unchanged
+ */
+void sim_network_set_port_offset(uint16_t offset);
+
+/**
+ * @brief Loopback port a firmware port is reachable on
+ *
+ * @param port  Port the firmware uses
+ * @return Port on 127.0.0.1
+ */
+uint16_t sim_network_host_port(uint16_t port);
+
+/**
+ * @brief Run the virtual network for a while
+ *
+ * Carries data between the stack and the virtual clients until nothing
+ * moves, then advances virtual time to each TCP timer tick in turn and
+ * runs it. Virtual mode only.
+ * @param ms  Time to advance; 0 only carries what is ready
+ */
+void sim_network_run(uint32_t ms);
+
+/**
+ * @brief Calls made on a TCP connection after the stack freed it
+ *
+ * On the Pico these touch a freed pcb; the host counts and ignores them.
+ * @return Count since start
+ */
+uint32_t sim_network_stale_calls(void);
+
+/**
+ * @brief TCP connections the stack still holds, in any state
+ *
+ * @return Open and closing connections, not counting listeners
+ */
+uint32_t sim_network_tcp_conns(void);
+
+/**
+ * @brief Buffers the stack still holds for connections
+ *
+ * @return Queued segments plus pieces of received data not yet freed
+ */
+uint32_t sim_network_tcp_buffers(void);
+
+// ----------------------------------------------------------------------
+// Virtual TCP clients
+// ----------------------------------------------------------------------
+
+typedef enum {
+    SIM_TCP_CONNECTING = 0,  // Waiting for the stack to accept
+    SIM_TCP_OPEN,            // Established
+    SIM_TCP_PEER_CLOSED,     // The device sent FIN; the client may still send
+    SIM_TCP_CLOSED,          // Both sides sent FIN
+    SIM_TCP_RESET            // Refused, or reset by either side
+} sim_tcp_state;
+
+/**
+ * @brief Open a connection to a port the firmware listens on
+ *
+ * The stack accepts it on the next sim_network_run(), or refuses it.
+ * @param port  Firmware port
+ * @return Client id, or -1 if every client slot is taken
+ */
+int sim_tcp_connect(uint16_t port);
+
+/**
+ * @brief Queue bytes from the client to the device
+ *
+ * @param id    Client
+ * @param data  Bytes
+ * @param len   Number of bytes
+ * @return len, or 0 if the client can't send any more
+ */
+size_t sim_tcp_send(int id, const void *data, size_t len);
+
+/**
+ * @brief Take bytes the device sent
+ *
+ * Reading opens the client's window again.
+ * @param id    Client
+ * @param buf   Receives the bytes; NULL discards them
+ * @param size  Most bytes to take
+ * @return Bytes taken
+ */
+size_t sim_tcp_read(int id, void *buf, size_t size);
+
+/**
+ * @brief Bytes the device sent that the client hasn't read
+ *
+ * @param id  Client
+ * @return Bytes waiting
+ */
+size_t sim_tcp_unread(int id);
+
+/**
+ * @brief Set how many unread bytes the client accepts
+ *
+ * @param id      Client
+ * @param window  Bytes; 0 stops the device sending
+ */
+void sim_tcp_set_window(int id, size_t window);
+
+/**
+ * @brief Stop or resume acknowledging what the client receives
+ *
+ * A client that stops acknowledging looks like one that dropped off
+ * the network: data stays queued on the device.
+ * @param id      Client
+ * @param acking  true to acknowledge (the default)
+ */
+void sim_tcp_set_acking(int id, bool acking);
+
+/**
+ * @brief Send FIN from the client
+ *
+ * @param id  Client
+ */
+void sim_tcp_close(int id);
+
+/**
+ * @brief Send RST from the client
+ *
+ * @param id  Client
+ */
+void sim_tcp_reset(int id);
+
+/**
+ * @brief State of a client's connection
+ *
+ * @param id  Client
+ * @return State
+ */
+sim_tcp_state sim_tcp_get_state(int id);
+
+/**
+ * @brief Forget a client and free its slot
+ *
+ * A connection still open is reset first.
+ * @param id  Client
+ */
+void sim_tcp_release(int id);
+
+/**
+ * @brief Make the next hal_tcp_close() calls fail with HAL_TCP_ERR_MEM
+ *
+ * As lwIP does when it can't queue the FIN, so the caller has to retry.
+ * @param count  Calls to fail
+ */
+void sim_tcp_fail_closes(uint32_t count);
+
+#endif // SIM_NETWORK_H
@@ -0,0 +1,74 @@
+/*
+File: snapshot.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Lock-free publication of the latest reading (see snapshot.h).
+
+Responsibilities:
+- Write each new snapshot into both copies, switching readers between them
+- Let readers copy out a consistent snapshot without taking a lock
+- Order the version and data accesses so no reader sees a torn snapshot
+
+Requires the following modules:
+- snapshot.h: for interface definitions
+*/
+
+#include <string.h>
+#include "snapshot.h"
+
+// Write one copy with relaxed stores; ordering comes from the version updates
+static void store_copy(_Atomic uint32_t *copy, const uint32_t *words) {
+    for (size_t i = 0; i < SNAPSHOT_WORDS; i++) {
+        atomic_store_explicit(&copy[i], words[i], memory_order_relaxed);
+    }
+}
+
+void snapshot_init(snapshot_seqlock *lock, const reading_snapshot *initial) {
+    uint32_t words[SNAPSHOT_WORDS] = {0};
+    memcpy(words, initial, sizeof(*initial));
+    atomic_init(&lock->version, 0);
+    for (size_t i = 0; i < SNAPSHOT_WORDS; i++) {
+        atomic_init(&lock->copies[0][i], words[i]);
+        atomic_init(&lock->copies[1][i], words[i]);
+    }
+}
+
+void snapshot_publish(snapshot_seqlock *lock, const reading_snapshot *snapshot) {
+    uint32_t words[SNAPSHOT_WORDS] = {0};
+    memcpy(words, snapshot, sizeof(*snapshot));
+
+    uint32_t version = atomic_load_explicit(&lock->version, memory_order_relaxed);
+    for (uint32_t copy = 0; copy < 2; copy++) {
+        // Steer readers to the other copy. The release store publishes the
+        // copy written in the previous step; the fence keeps this copy's
+        // stores from becoming visible before readers have been steered away.
+        atomic_store_explicit(&lock->version, version + 1 + copy, memory_order_release);
+        atomic_thread_fence(memory_order_release);
+        store_copy(lock->copies[copy], words);
+    }
+}
+
+uint32_t snapshot_read(snapshot_seqlock *lock, reading_snapshot *snapshot) {
+    uint32_t words[SNAPSHOT_WORDS];
+    uint32_t retries = 0;
+
+    for (;;) {
+        uint32_t version = atomic_load_explicit(&lock->version, memory_order_acquire);
+        const _Atomic uint32_t *copy = lock->copies[version & 1];
+        for (size_t i = 0; i < SNAPSHOT_WORDS; i++) {
+            words[i] = atomic_load_explicit(&copy[i], memory_order_relaxed);
+        }
+        // Pairs with the writer's fence: if any word came from a newer write,
+        // the version has changed too
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&lock->version, memory_order_relaxed) == version) {
+            break;
+        }
+        retries++;
+    }
+
+    memcpy(snapshot, words, sizeof(*snapshot));
+    return retries;
+}
@@ -0,0 +1,79 @@
+/*
+File: snapshot.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the latest-reading snapshot shared by
+    main.c, which publishes each sample, and network.c, which reads it from
+    lwIP callbacks and the other core.
+
+    All fields of a reading are published together under one version
+    number, so a reader never mixes the humidity of one sample with the
+    temperature of the next. The storage is a seqlock with two copies (a
+    "latch"): while one copy is being rewritten, readers use the other.
+    Readers take no lock and never wait for the writer, so reading from an
+    interrupt that preempted the writer on the same core is safe. There
+    must be only one writer.
+
+    This module has no hardware dependencies so it can be unit tested on
+    the host (see test_snapshot.c).
+*/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/**
+ * @brief One published reading
+ */
+typedef struct {
+    uint32_t seq;           // Incremented for every published sample (0 = none yet)
+    uint32_t sample_ms;     // Time of the last good reading (0 = none yet)
+    float humidity;         // Last good readings; unchanged by a failed read
+    float temp_c;
+    float temp_f;
+    uint8_t status;         // dht_status of the most recent read
+} reading_snapshot;
+
+#define SNAPSHOT_WORDS ((sizeof(reading_snapshot) + sizeof(uint32_t) - 1) / sizeof(uint32_t))
+
+/**
+ * @brief Seqlock holding the latest reading_snapshot
+ */
+typedef struct {
+    _Atomic uint32_t version;                       // Odd: copy 0 may be being written, read copy 1;
+                                                    // even: the other way round
+    _Atomic uint32_t copies[2][SNAPSHOT_WORDS];     // Two copies of the snapshot, word by word
+} snapshot_seqlock;
+
+/**
+ * @brief Set up the seqlock holding initial
+ *
+ * @param lock     Seqlock to set up
+ * @param initial  Snapshot readers see until the first publish
+ */
+void snapshot_init(snapshot_seqlock *lock, const reading_snapshot *initial);
+
+/**
+ * @brief Publish a new snapshot (single writer only)
+ *
+ * @param lock      Seqlock
+ * @param snapshot  Snapshot to copy in
+ */
+void snapshot_publish(snapshot_seqlock *lock, const reading_snapshot *snapshot);
+
+/**
+ * @brief Copy out the latest complete snapshot
+ *
+ * Safe from any core or interrupt. A read starts over only if the writer,
+ * running on the other core, moved on to the next copy meanwhile.
+ *
+ * @param lock      Seqlock
+ * @param snapshot  Receives the snapshot
+ * @return Number of times the copy had to start over
+ */
+uint32_t snapshot_read(snapshot_seqlock *lock, reading_snapshot *snapshot);
+
+#endif // SNAPSHOT_H
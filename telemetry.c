@@ -0,0 +1,64 @@
+/*
+File: telemetry.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Provides the packing of samples into UDP telemetry datagrams for
+    network.c. Records are written in place as samples arrive, so sending
+    a batch only needs its header filled in.
+
+Responsibilities:
+- Number samples with a sequence that receivers use to detect loss
+- Pack samples into fixed-size little-endian records
+- Complete each datagram once its batch is full
+
+Requires the following modules:
+- telemetry.h: for interface definitions
+- le_pack.h: for little-endian records and tenths
+*/
+
+#include "telemetry.h"
+#include "le_pack.h"
+
+void telemetry_batch_init(telemetry_batch *batch, uint8_t batch_size) {
+    if (batch_size < 1) batch_size = 1;
+    if (batch_size > TELEMETRY_BATCH_MAX) batch_size = TELEMETRY_BATCH_MAX;
+    batch->batch_size = batch_size;
+    batch->count = 0;
+    batch->next_seq = 0;
+}
+
+bool telemetry_batch_add(telemetry_batch *batch, const telemetry_sample *sample) {
+    if (batch->count >= batch->batch_size) {
+        batch->count = 0;  // Previous batch was never finished; drop it
+    }
+
+    uint8_t *rec = batch->data + TELEMETRY_HEADER_LEN + batch->count * TELEMETRY_RECORD_LEN;
+    put_le32(rec, sample->time_ms);
+    put_le16(rec + 4, (uint16_t)to_x10(sample->humidity));
+    put_le16(rec + 6, (uint16_t)to_x10(sample->temp_celsius));
+    rec[8] = sample->status;
+    rec[9] = sample->flags;
+
+    batch->count++;
+    batch->next_seq++;
+    return batch->count >= batch->batch_size;
+}
+
+size_t telemetry_batch_finish(telemetry_batch *batch) {
+    if (batch->count == 0) {
+        return 0;
+    }
+
+    uint8_t *header = batch->data;
+    header[0] = 'H';
+    header[1] = 'T';
+    header[2] = TELEMETRY_VERSION;
+    header[3] = batch->count;
+    put_le32(header + 4, batch->next_seq - batch->count);
+
+    size_t len = TELEMETRY_HEADER_LEN + (size_t)batch->count * TELEMETRY_RECORD_LEN;
+    batch->count = 0;
+    return len;
+}
@@ -0,0 +1,87 @@
+/*
+File: telemetry.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the UDP telemetry datagram format sent by
+    network.c. Samples are packed into fixed-size little-endian records,
+    one or more per datagram, behind a header carrying the sequence
+    number of the first record so receivers can detect lost samples
+    (see tools/udp_receiver.py).
+
+    Datagram layout (little-endian):
+      header  'H','T', u8 version, u8 record count, u32 sequence of the first record
+      records u32 time_ms, i16 humidity x10, i16 temp_c x10, u8 status, u8 flags
+
+    This module has no hardware or lwIP dependencies so it can be unit
+    tested on the host (see test_telemetry.c).
+*/
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TELEMETRY_VERSION     1
+#define TELEMETRY_HEADER_LEN  8
+#define TELEMETRY_RECORD_LEN  10
+
+// Most samples packed into one datagram; keeps it well inside one 802.11 frame
+#define TELEMETRY_BATCH_MAX   64
+
+// Record flags
+#define TELEMETRY_FLAG_LED    0x01   // LED array enabled
+#define TELEMETRY_FLAG_VALID  0x02   // Values come from a good sample (not yet one otherwise)
+
+/**
+ * @brief One sample as published over UDP
+ */
+typedef struct {
+    uint32_t time_ms;       // Time of the last good sample (ms since boot)
+    float humidity;         // Relative humidity in percent
+    float temp_celsius;     // Temperature in degrees Celsius
+    uint8_t status;         // dht_status of the read that produced this sample
+    uint8_t flags;          // TELEMETRY_FLAG_*
+} telemetry_sample;
+
+/**
+ * @brief Datagram being filled with samples
+ */
+typedef struct {
+    uint8_t data[TELEMETRY_HEADER_LEN + TELEMETRY_BATCH_MAX * TELEMETRY_RECORD_LEN];
+    uint8_t batch_size;     // Records per datagram
+    uint8_t count;          // Records packed so far
+    uint32_t next_seq;      // Sequence number of the next sample added
+} telemetry_batch;
+
+/**
+ * @brief Start an empty batch
+ *
+ * @param batch       Batch to initialize
+ * @param batch_size  Samples per datagram, 1..TELEMETRY_BATCH_MAX (clamped)
+ */
+void telemetry_batch_init(telemetry_batch *batch, uint8_t batch_size);
+
+/**
+ * @brief Pack one sample, numbering it with the next sequence number
+ *
+ * @param batch   Batch being filled
+ * @param sample  Sample to add
+ * @return true once the batch holds batch_size samples and should be sent
+ */
+bool telemetry_batch_add(telemetry_batch *batch, const telemetry_sample *sample);
+
+/**
+ * @brief Complete the datagram and start the next one
+ *
+ * Fills in the header. The datagram stays in batch->data until the next
+ * telemetry_batch_add(), so send it before adding more samples.
+ *
+ * @param batch  Batch holding at least one sample
+ * @return Datagram length in bytes, or 0 if the batch is empty
+ */
+size_t telemetry_batch_finish(telemetry_batch *batch);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,84 @@
+/*
+File: test_backoff.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the reconnect delay in backoff.c.
+Responsibilities:
+- Test that the delay doubles, is capped and starts over after a reset
+- Test that jitter stays within its bounds
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "backoff.h"
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+// Test 1: Growth, cap and reset
+void test_growth() {
+    printf("\nTest: Growth, Cap and Reset\n");
+    backoff b;
+    backoff_init(&b, 1000, 60000);
+
+    TEST_ASSERT(backoff_next(&b, 0) == 1000, "First delay is the minimum");
+    TEST_ASSERT(backoff_next(&b, 0) == 2000, "Delay doubles");
+    TEST_ASSERT(backoff_next(&b, 0) == 4000, "Delay doubles again");
+
+    backoff_init(&b, 1000, 60000);
+    uint32_t last = 0;
+    for (int i = 0; i < 20; i++) {
+        last = backoff_next(&b, 0);
+    }
+    TEST_ASSERT(last == 60000, "Delay is capped");
+
+    backoff_reset(&b);
+    TEST_ASSERT(backoff_next(&b, 0) == 1000, "Reset returns to the minimum");
+}
+
+// Test 2: Jitter
+void test_jitter() {
+    printf("\nTest: Jitter\n");
+    backoff b;
+    bool in_range = true;
+    for (uint32_t r = 0; r < 5000; r += 7) {
+        backoff_init(&b, 1000, 60000);
+        backoff_next(&b, 0);
+        uint32_t d = backoff_next(&b, r * 2654435761u);
+        in_range = in_range && d >= 1500 && d <= 2000;
+    }
+    TEST_ASSERT(in_range, "Jitter stays within 25% below the delay");
+
+    backoff_init(&b, 2, 100);
+    TEST_ASSERT(backoff_next(&b, 12345) == 2, "Delays too short for jitter are exact");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Backoff Host Test Suite\n");
+    printf("========================================\n");
+
+    test_growth();
+    test_jitter();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,242 @@
+/*
+File: test_conn_pool.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the connection slot bookkeeping in conn_pool.c.
+Responsibilities:
+- Test that slots are handed out and given back exactly once
+- Test state changes, including that a closing connection stays closing
+- Test the close retry limit and the abort fallback
+- Model soak test: run many simulated connections through random closes,
+  close failures and TCP errors and check that the pool's bookkeeping never
+  loses a slot. test_network.c runs the same kind of soak against network.c's
+  real lwIP callbacks.
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+The soak test runs SOAK_STEPS steps; pass a larger number as the first
+argument for a longer run, e.g. ./test_conn_pool 100000000
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "conn_pool.h"
+
+#define SOAK_STEPS  2000000
+#define SOAK_SLOTS  4
+#define SOAK_PCBS   6    // Like MEMP_NUM_TCP_PCB: a little more than the slots
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+// Test 1: Slots are handed out until the pool is full and can be reused
+void test_alloc() {
+    printf("\nTest: Allocation\n");
+    conn_pool pool;
+    conn_pool_init(&pool, 3);
+
+    int a = conn_pool_alloc(&pool);
+    int b = conn_pool_alloc(&pool);
+    int c = conn_pool_alloc(&pool);
+    TEST_ASSERT(a == 0 && b == 1 && c == 2, "Slots handed out in order");
+    TEST_ASSERT(conn_pool_state(&pool, b) == CONN_READING, "New connection is reading");
+    TEST_ASSERT(conn_pool_alloc(&pool) == -1, "Full pool refuses another connection");
+
+    TEST_ASSERT(conn_pool_close_result(&pool, b, true) == CONN_CLOSE_DONE &&
+                conn_pool_state(&pool, b) == CONN_CLOSED, "Closed slot is free");
+    TEST_ASSERT(conn_pool_alloc(&pool) == b, "Freed slot is reused");
+
+    conn_pool_release(&pool, a);
+    conn_pool_release(&pool, a);
+    TEST_ASSERT(pool.errored == 1, "Releasing a free slot again is ignored");
+    TEST_ASSERT(conn_pool_count(&pool, CONN_CLOSED) == 1 && conn_pool_balanced(&pool),
+                "Counters balance");
+
+    conn_pool big;
+    conn_pool_init(&big, 100);
+    TEST_ASSERT(big.size == CONN_POOL_MAX, "Size capped at CONN_POOL_MAX");
+}
+
+// Test 2: State changes
+void test_states() {
+    printf("\nTest: States\n");
+    conn_pool pool;
+    conn_pool_init(&pool, 2);
+    int s = conn_pool_alloc(&pool);
+
+    conn_pool_set_state(&pool, s, CONN_WRITING);
+    TEST_ASSERT(conn_pool_state(&pool, s) == CONN_WRITING, "Reading to writing");
+    conn_pool_set_state(&pool, s, CONN_READING);
+    TEST_ASSERT(conn_pool_state(&pool, s) == CONN_READING, "Writing back to reading");
+    conn_pool_set_state(&pool, s, CONN_CLOSED);
+    TEST_ASSERT(conn_pool_state(&pool, s) == CONN_READING, "Slots are only freed by closing");
+
+    conn_pool_set_state(&pool, s, CONN_CLOSING);
+    conn_pool_set_state(&pool, s, CONN_WRITING);
+    TEST_ASSERT(conn_pool_state(&pool, s) == CONN_CLOSING, "Closing connection stays closing");
+
+    conn_pool_set_state(&pool, 1, CONN_WRITING);
+    conn_pool_set_state(&pool, 7, CONN_WRITING);
+    TEST_ASSERT(conn_pool_state(&pool, 1) == CONN_CLOSED && conn_pool_state(&pool, 7) == CONN_CLOSED,
+                "Free and out of range slots are left alone");
+    TEST_ASSERT(conn_pool_count(&pool, CONN_CLOSING) == 1 && conn_pool_count(&pool, CONN_CLOSED) == 1,
+                "Slots counted by state");
+}
+
+// Test 3: A failing close is retried, then aborted
+void test_close_retry() {
+    printf("\nTest: Close Retry and Abort\n");
+    conn_pool pool;
+    conn_pool_init(&pool, 2);
+    int s = conn_pool_alloc(&pool);
+
+    bool retried = true;
+    for (int i = 0; i < CONN_CLOSE_RETRIES; i++) {
+        retried &= conn_pool_close_result(&pool, s, false) == CONN_CLOSE_RETRY;
+    }
+    TEST_ASSERT(retried && conn_pool_state(&pool, s) == CONN_CLOSING &&
+                conn_pool_close_failures(&pool, s) == CONN_CLOSE_RETRIES,
+                "Failed closes leave the connection closing");
+    TEST_ASSERT(conn_pool_close_result(&pool, s, false) == CONN_CLOSE_ABORT &&
+                conn_pool_state(&pool, s) == CONN_CLOSED && pool.aborted == 1,
+                "Connection aborted after the last retry");
+
+    s = conn_pool_alloc(&pool);
+    TEST_ASSERT(conn_pool_close_failures(&pool, s) == 0, "New connection starts with no failures");
+    conn_pool_close_result(&pool, s, false);
+    TEST_ASSERT(conn_pool_close_result(&pool, s, true) == CONN_CLOSE_DONE && pool.closed == 1,
+                "A retry can still close cleanly");
+    TEST_ASSERT(conn_pool_close_result(&pool, s, true) == CONN_CLOSE_DONE && pool.closed == 1,
+                "Closing a free slot again changes nothing");
+    TEST_ASSERT(conn_pool_balanced(&pool), "Counters balance");
+}
+
+// Small deterministic generator so a failing soak run can be repeated
+static uint32_t s_rng = 12345;
+static uint32_t next_random(void) {
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return s_rng >> 8;
+}
+
+// Test 4: Model soak test. Each step is one lwIP event on a random connection,
+// driven the way network.c drives the pool, with a simulated PCB pool that
+// runs dry if any connection is never closed, aborted or released.
+// test_network.c soaks network.c itself.
+void test_soak(long steps) {
+    printf("\nTest: Soak (%ld steps)\n", steps);
+    conn_pool pool;
+    conn_pool_init(&pool, SOAK_SLOTS);
+    bool has_pcb[SOAK_SLOTS] = {false};
+    int pcbs_used = 0;
+    long refused = 0;
+    bool consistent = true;
+
+    for (long step = 0; step < steps; step++) {
+        uint32_t r = next_random();
+        int slot = (int)(r % SOAK_SLOTS);
+        conn_state state = conn_pool_state(&pool, slot);
+
+        switch ((r >> 4) % 8) {
+            case 0:
+            case 1: {
+                // Accept: a PCB exists before the server has a slot for it
+                if (pcbs_used == SOAK_PCBS) {
+                    refused++;
+                    break;
+                }
+                int s = conn_pool_alloc(&pool);
+                if (s < 0) {
+                    refused++;      // Answered with 503 and closed by the listener
+                    break;
+                }
+                consistent &= !has_pcb[s];
+                has_pcb[s] = true;
+                pcbs_used++;
+                break;
+            }
+            case 2:
+                // Request received or data acknowledged
+                conn_pool_set_state(&pool, slot, (r & 0x1000) ? CONN_WRITING : CONN_READING);
+                break;
+            case 3:
+            case 4: {
+                // Close attempt (or poll retry), failing now and then for lack of memory
+                if (state == CONN_CLOSED) break;
+                bool ok = (r & 0x3000) != 0;
+                conn_close_action action = conn_pool_close_result(&pool, slot, ok);
+                if (action != CONN_CLOSE_RETRY) {
+                    has_pcb[slot] = false;   // Closed or aborted: lwIP frees the PCB
+                    pcbs_used--;
+                }
+                break;
+            }
+            case 5:
+                // TCP error: lwIP has already freed the PCB
+                if (state == CONN_CLOSED) break;
+                conn_pool_release(&pool, slot);
+                has_pcb[slot] = false;
+                pcbs_used--;
+                break;
+            default:
+                // Poll with nothing to do
+                break;
+        }
+
+        consistent &= (conn_pool_state(&pool, slot) != CONN_CLOSED) == has_pcb[slot];
+        consistent &= pcbs_used == (int)(SOAK_SLOTS - conn_pool_count(&pool, CONN_CLOSED));
+    }
+
+    // Drain: every open connection is closed, aborting those whose close keeps failing
+    for (int s = 0; s < SOAK_SLOTS; s++) {
+        while (conn_pool_state(&pool, s) != CONN_CLOSED) {
+            if (conn_pool_close_result(&pool, s, false) != CONN_CLOSE_RETRY) {
+                has_pcb[s] = false;
+                pcbs_used--;
+            }
+        }
+    }
+
+    printf("    opened %lu, closed %lu, aborted %lu, errored %lu, refused %ld\n",
+           (unsigned long)pool.opened, (unsigned long)pool.closed,
+           (unsigned long)pool.aborted, (unsigned long)pool.errored, refused);
+    TEST_ASSERT(consistent, "Slot states always match the PCBs in use");
+    TEST_ASSERT(pool.aborted > 0 && pool.errored > 0 && refused > 0,
+                "Soak covered aborts, errors and refusals");
+    TEST_ASSERT(pcbs_used == 0 && conn_pool_count(&pool, CONN_CLOSED) == SOAK_SLOTS,
+                "No PCB or slot leaked");
+    TEST_ASSERT(conn_pool_balanced(&pool) &&
+                pool.opened == pool.closed + pool.aborted + pool.errored,
+                "Every connection ended exactly once");
+}
+
+int main(int argc, char **argv) {
+    printf("========================================\n");
+    printf("Connection Pool Host Test Suite\n");
+    printf("========================================\n");
+
+    long steps = (argc > 1) ? strtol(argv[1], NULL, 10) : SOAK_STEPS;
+
+    test_alloc();
+    test_states();
+    test_close_retry();
+    test_soak(steps > 0 ? steps : SOAK_STEPS);
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
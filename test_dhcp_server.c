@@ -0,0 +1,254 @@
+/*
+File: test_dhcp_server.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the access point DHCP server in dhcp_server.c.
+Responsibilities:
+- Test the DISCOVER/OFFER/REQUEST/ACK exchange and the reply options
+- Test that clients keep their address and conflicting requests are refused
+- Test lease expiry, release, decline and a full lease table
+- Test that malformed messages are ignored
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "dhcp_server.h"
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+static const uint8_t SERVER_IP[4] = { 192, 168, 4, 1 };
+static const uint8_t NETMASK[4] = { 255, 255, 255, 0 };
+
+static uint8_t s_msg[DHCP_MSG_MAX];
+static uint8_t s_reply[DHCP_MSG_MAX];
+static bool s_unicast;
+
+// Build a client message. requested_host and server_host add the requested
+// address and server identifier options when nonzero; ciaddr_host sets ciaddr.
+static size_t make_msg(uint8_t type, uint8_t mac_last, uint8_t requested_host,
+                       uint8_t server_host, uint8_t ciaddr_host) {
+    memset(s_msg, 0, sizeof(s_msg));
+    s_msg[0] = 1;
+    s_msg[1] = 1;
+    s_msg[2] = 6;
+    s_msg[4] = 0xDE; s_msg[5] = 0xAD; s_msg[6] = 0xBE; s_msg[7] = mac_last;
+    if (ciaddr_host) {
+        memcpy(&s_msg[12], SERVER_IP, 3);
+        s_msg[15] = ciaddr_host;
+    }
+    const uint8_t mac[6] = { 0x02, 0x11, 0x22, 0x33, 0x44, mac_last };
+    memcpy(&s_msg[28], mac, 6);
+    s_msg[236] = 99; s_msg[237] = 130; s_msg[238] = 83; s_msg[239] = 99;
+
+    uint8_t *p = &s_msg[240];
+    *p++ = 53; *p++ = 1; *p++ = type;
+    if (requested_host) {
+        *p++ = 50; *p++ = 4; memcpy(p, SERVER_IP, 3); p[3] = requested_host; p += 4;
+    }
+    if (server_host) {
+        *p++ = 54; *p++ = 4; memcpy(p, SERVER_IP, 3); p[3] = server_host; p += 4;
+    }
+    *p++ = 0;  // Padding is allowed before the end option
+    *p++ = 255;
+    return (size_t)(p - s_msg);
+}
+
+static size_t send_msg(dhcp_server *s, size_t len, uint32_t now_ms) {
+    return dhcp_server_handle(s, s_msg, len, now_ms, s_reply, &s_unicast);
+}
+
+// Find an option in the reply; returns its data or NULL
+static const uint8_t *reply_option(uint8_t code, size_t reply_len) {
+    size_t i = 240;
+    while (i + 1 < reply_len && s_reply[i] != 255) {
+        if (s_reply[i] == 0) {
+            i++;
+            continue;
+        }
+        if (s_reply[i] == code) return &s_reply[i + 2];
+        i += 2 + s_reply[i + 1];
+    }
+    return NULL;
+}
+
+static int reply_type(size_t reply_len) {
+    const uint8_t *t = reply_option(53, reply_len);
+    return t ? t[0] : -1;
+}
+
+// Full exchange for one client; returns the host part of the address it got, or 0
+static uint8_t join(dhcp_server *s, uint8_t mac_last, uint32_t now_ms) {
+    size_t len = send_msg(s, make_msg(DHCP_DISCOVER, mac_last, 0, 0, 0), now_ms);
+    if (reply_type(len) != DHCP_OFFER) return 0;
+    uint8_t offered = s_reply[19];
+    len = send_msg(s, make_msg(DHCP_REQUEST, mac_last, offered, 1, 0), now_ms);
+    return reply_type(len) == DHCP_ACK ? s_reply[19] : 0;
+}
+
+// Test 1: DISCOVER/OFFER/REQUEST/ACK
+void test_exchange() {
+    printf("\nTest: DISCOVER/OFFER/REQUEST/ACK\n");
+    dhcp_server s;
+    dhcp_server_init(&s, SERVER_IP, NETMASK, 3600);
+
+    size_t len = send_msg(&s, make_msg(DHCP_DISCOVER, 1, 0, 0, 0), 1000);
+    TEST_ASSERT(len >= 300 && reply_type(len) == DHCP_OFFER, "DISCOVER answered with OFFER");
+    TEST_ASSERT(s_reply[0] == 2 && memcmp(&s_reply[4], &s_msg[4], 4) == 0 &&
+                memcmp(&s_reply[28], &s_msg[28], 6) == 0, "Reply echoes xid and client MAC");
+    TEST_ASSERT(memcmp(&s_reply[16], SERVER_IP, 3) == 0 && s_reply[19] == DHCP_FIRST_HOST,
+                "First client offered the first address");
+    TEST_ASSERT(!s_unicast, "OFFER is broadcast");
+
+    const uint8_t *opt = reply_option(54, len);
+    TEST_ASSERT(opt && memcmp(opt, SERVER_IP, 4) == 0, "Server identifier option");
+    opt = reply_option(1, len);
+    TEST_ASSERT(opt && memcmp(opt, NETMASK, 4) == 0, "Subnet mask option");
+    opt = reply_option(3, len);
+    TEST_ASSERT(opt && memcmp(opt, SERVER_IP, 4) == 0, "Router option");
+    opt = reply_option(51, len);
+    TEST_ASSERT(opt && opt[0] == 0 && opt[1] == 0 && opt[2] == 0x0E && opt[3] == 0x10,
+                "Lease time option (3600 s)");
+    TEST_ASSERT(dhcp_server_client_count(&s, 1000) == 0, "An offer isn't a client yet");
+
+    len = send_msg(&s, make_msg(DHCP_REQUEST, 1, DHCP_FIRST_HOST, 1, 0), 1050);
+    TEST_ASSERT(reply_type(len) == DHCP_ACK && s_reply[19] == DHCP_FIRST_HOST, "REQUEST acknowledged");
+    TEST_ASSERT(dhcp_server_client_count(&s, 1050) == 1, "Client counted once bound");
+
+    uint32_t expiry = 0;
+    TEST_ASSERT(dhcp_server_next_expiry(&s, 2050, &expiry) && expiry == 3600u * 1000 - 1000,
+                "Lease expiry reported");
+
+    TEST_ASSERT(join(&s, 2, 3000) == DHCP_FIRST_HOST + 1, "Second client gets the next address");
+    TEST_ASSERT(dhcp_server_client_count(&s, 3000) == 2, "Two clients");
+}
+
+// Test 2: Returning clients and conflicting requests
+void test_conflicts() {
+    printf("\nTest: Returning Clients and Conflicts\n");
+    dhcp_server s;
+    dhcp_server_init(&s, SERVER_IP, NETMASK, 3600);
+    join(&s, 1, 0);
+    join(&s, 2, 0);
+
+    size_t len = send_msg(&s, make_msg(DHCP_DISCOVER, 1, 0, 0, 0), 5000);
+    TEST_ASSERT(reply_type(len) == DHCP_OFFER && s_reply[19] == DHCP_FIRST_HOST,
+                "Bound client is offered its own address again");
+
+    len = send_msg(&s, make_msg(DHCP_REQUEST, 3, DHCP_FIRST_HOST, 0, 0), 5000);
+    TEST_ASSERT(reply_type(len) == DHCP_NAK, "Request for another client's address refused");
+    TEST_ASSERT(!s_unicast && memcmp(&s_reply[16], "\0\0\0\0", 4) == 0, "NAK is broadcast, no address");
+
+    len = send_msg(&s, make_msg(DHCP_REQUEST, 3, 200, 0, 0), 5000);
+    TEST_ASSERT(reply_type(len) == DHCP_NAK, "Request for an address outside the pool refused");
+
+    // Renewal: the client already has its address and names it in ciaddr
+    len = send_msg(&s, make_msg(DHCP_REQUEST, 2, 0, 0, DHCP_FIRST_HOST + 1), 600000);
+    TEST_ASSERT(reply_type(len) == DHCP_ACK && s_unicast, "Renewal acknowledged by unicast");
+    uint32_t expiry = 0;
+    dhcp_server_next_expiry(&s, 600000, &expiry);
+    TEST_ASSERT(expiry == 3600u * 1000 - 600000, "Soonest expiry is the lease that wasn't renewed");
+
+    // A client that picked another server's offer frees ours
+    send_msg(&s, make_msg(DHCP_DISCOVER, 4, 0, 0, 0), 700000);
+    uint8_t offered = s_reply[19];
+    len = send_msg(&s, make_msg(DHCP_REQUEST, 4, offered, 99, 0), 700000);
+    TEST_ASSERT(len == 0, "Request to another server ignored");
+    TEST_ASSERT(s.leases[offered - DHCP_FIRST_HOST].state == DHCP_LEASE_FREE, "Our offer released");
+}
+
+// Test 3: Expiry, release, decline and a full table
+void test_lease_lifecycle() {
+    printf("\nTest: Lease Lifecycle\n");
+    dhcp_server s;
+    dhcp_server_init(&s, SERVER_IP, NETMASK, 60);
+
+    bool all_joined = true;
+    for (uint8_t i = 0; i < DHCP_LEASE_MAX; i++) {
+        all_joined = all_joined && join(&s, i, 0) == DHCP_FIRST_HOST + i;
+    }
+    TEST_ASSERT(all_joined && dhcp_server_client_count(&s, 0) == DHCP_LEASE_MAX, "Table filled");
+    TEST_ASSERT(send_msg(&s, make_msg(DHCP_DISCOVER, 100, 0, 0, 0), 1000) == 0,
+                "No offer when every address is leased");
+
+    TEST_ASSERT(dhcp_server_client_count(&s, 60000) == 0, "Leases expire");
+    TEST_ASSERT(join(&s, 100, 61000) != 0, "Expired address reused");
+    TEST_ASSERT(join(&s, 3, 62000) == DHCP_FIRST_HOST + 3, "Expired client keeps its address if unused");
+
+    dhcp_server_init(&s, SERVER_IP, NETMASK, 60);
+    join(&s, 1, 0);
+    send_msg(&s, make_msg(DHCP_RELEASE, 1, 0, 1, DHCP_FIRST_HOST), 100);
+    TEST_ASSERT(dhcp_server_client_count(&s, 100) == 0, "RELEASE frees the lease");
+    TEST_ASSERT(join(&s, 1, 200) == DHCP_FIRST_HOST, "Released client gets the same address back");
+
+    send_msg(&s, make_msg(DHCP_DECLINE, 1, DHCP_FIRST_HOST, 1, 0), 300);
+    TEST_ASSERT(dhcp_server_client_count(&s, 300) == 0, "DECLINE drops the lease");
+    TEST_ASSERT(join(&s, 1, 400) == DHCP_FIRST_HOST + 1, "Declined address kept out of use");
+    size_t len = send_msg(&s, make_msg(DHCP_REQUEST, 2, DHCP_FIRST_HOST, 0, 0), 500);
+    TEST_ASSERT(reply_type(len) == DHCP_NAK, "Declined address refused until it expires");
+
+    // A client remembering its address from before a restart keeps it
+    dhcp_server_init(&s, SERVER_IP, NETMASK, 60);
+    len = send_msg(&s, make_msg(DHCP_DISCOVER, 9, DHCP_FIRST_HOST + 5, 0, 0), 0);
+    TEST_ASSERT(reply_type(len) == DHCP_OFFER && s_reply[19] == DHCP_FIRST_HOST + 5,
+                "Requested address offered when free");
+}
+
+// Test 4: Malformed messages
+void test_malformed() {
+    printf("\nTest: Malformed Messages\n");
+    dhcp_server s;
+    dhcp_server_init(&s, SERVER_IP, NETMASK, 60);
+
+    size_t len = make_msg(DHCP_DISCOVER, 1, 0, 0, 0);
+    TEST_ASSERT(send_msg(&s, 200, 0) == 0, "Short message ignored");
+    s_msg[236] = 0;
+    TEST_ASSERT(send_msg(&s, len, 0) == 0, "Missing magic cookie ignored");
+
+    len = make_msg(DHCP_DISCOVER, 1, 0, 0, 0);
+    s_msg[0] = 2;
+    TEST_ASSERT(send_msg(&s, len, 0) == 0, "BOOTREPLY ignored");
+
+    len = make_msg(DHCP_DISCOVER, 1, 0, 0, 0);
+    s_msg[241] = 40;  // Message type option claims to run past the end
+    TEST_ASSERT(send_msg(&s, len, 0) == 0, "Truncated option ignored");
+
+    len = make_msg(DHCP_DISCOVER, 1, 0, 0, 0);
+    s_msg[240] = 0;  // No message type option left
+    s_msg[241] = 0;
+    s_msg[242] = 0;
+    TEST_ASSERT(send_msg(&s, len, 0) == 0, "Message without a type ignored");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("DHCP Server Host Test Suite\n");
+    printf("========================================\n");
+
+    test_exchange();
+    test_conflicts();
+    test_lease_lifecycle();
+    test_malformed();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,282 @@
+/*
+File: test_history.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the sample history and its export in history.c.
+Responsibilities:
+- Test CSV and binary export formats
+- Test time range selection and exports split across small buffers
+- Test ring wrap-around and records overwritten during an export
+- Test 1-minute and 1-hour averaging and tier names
+- Test that values outside the int16_t tenths range, and NaN, are clamped
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "history.h"
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+static char s_out[16384];
+
+// Run a whole export through a buffer of the given size; returns its length
+static size_t export_all(uint8_t tier, uint8_t format, uint32_t from_ms, uint32_t to_ms,
+                         size_t piece) {
+    history_query query;
+    history_query_init(&query, tier, format, from_ms, to_ms);
+    uint32_t pos = 0;
+    size_t len = 0;
+    size_t n;
+    while (len + piece <= sizeof(s_out) &&
+           (n = history_export(&query, &pos, s_out + len, piece)) > 0) {
+        len += n;
+    }
+    s_out[len < sizeof(s_out) ? len : sizeof(s_out) - 1] = '\0';
+    return len;
+}
+
+static uint32_t get_le32(const char *p) {
+    const uint8_t *b = (const uint8_t *)p;
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+static int16_t get_le16(const char *p) {
+    const uint8_t *b = (const uint8_t *)p;
+    return (int16_t)(b[0] | (b[1] << 8));
+}
+
+// Test 1: CSV export, including an empty history
+void test_csv_export() {
+    printf("\nTest: CSV Export\n");
+    history_init();
+    export_all(HISTORY_TIER_RAW, HISTORY_FORMAT_CSV, 0, UINT32_MAX, 256);
+    TEST_ASSERT(strcmp(s_out, "time_ms,humidity,temp_c\n") == 0, "Empty history is just the header");
+
+    history_add(2000, 45.25f, 21.04f);
+    history_add(4000, 0.0f, -3.46f);
+    export_all(HISTORY_TIER_RAW, HISTORY_FORMAT_CSV, 0, UINT32_MAX, 256);
+    TEST_ASSERT(strcmp(s_out,
+                       "time_ms,humidity,temp_c\n"
+                       "2000,45.3,21.0\n"
+                       "4000,0.0,-3.5\n") == 0,
+                "Rows are rounded to tenths, negatives keep their sign");
+}
+
+// Test 2: Binary export layout
+void test_binary_export() {
+    printf("\nTest: Binary Export\n");
+    history_init();
+    history_add(70000, 55.5f, -12.3f);
+    history_add(72000, 56.0f, 22.0f);
+    size_t len = export_all(HISTORY_TIER_RAW, HISTORY_FORMAT_BINARY, 0, UINT32_MAX, 256);
+
+    TEST_ASSERT(len == HISTORY_BINARY_HEADER + 2 * HISTORY_RECORD_SIZE, "Header plus two records");
+    TEST_ASSERT(memcmp(s_out, "HIST", 4) == 0, "Magic");
+    TEST_ASSERT(s_out[4] == HISTORY_BINARY_VERSION && s_out[5] == HISTORY_TIER_RAW,
+                "Version and tier");
+    TEST_ASSERT(get_le16(s_out + 6) == HISTORY_RECORD_SIZE, "Record size");
+
+    const char *rec = s_out + HISTORY_BINARY_HEADER;
+    TEST_ASSERT(get_le32(rec) == 70000, "First record time");
+    TEST_ASSERT(get_le16(rec + 4) == 555 && get_le16(rec + 6) == -123, "First record values");
+    TEST_ASSERT(get_le32(rec + HISTORY_RECORD_SIZE) == 72000, "Second record time");
+}
+
+// Test 3: from/to select an inclusive time range
+void test_time_range() {
+    printf("\nTest: Time Range\n");
+    history_init();
+    for (uint32_t t = 1000; t <= 10000; t += 1000) {
+        history_add(t, 50.0f, 20.0f);
+    }
+
+    size_t len = export_all(HISTORY_TIER_RAW, HISTORY_FORMAT_BINARY, 3000, 6000, 256);
+    TEST_ASSERT(len == HISTORY_BINARY_HEADER + 4 * HISTORY_RECORD_SIZE, "Four records in range");
+    TEST_ASSERT(get_le32(s_out + HISTORY_BINARY_HEADER) == 3000, "Range starts at from");
+
+    len = export_all(HISTORY_TIER_RAW, HISTORY_FORMAT_BINARY, 3500, 3900, 256);
+    TEST_ASSERT(len == HISTORY_BINARY_HEADER, "Range between samples is empty");
+
+    len = export_all(HISTORY_TIER_RAW, HISTORY_FORMAT_BINARY, 20000, UINT32_MAX, 256);
+    TEST_ASSERT(len == HISTORY_BINARY_HEADER, "Range after the newest sample is empty");
+}
+
+// Test 4: A small buffer gives the same export, a few rows at a time
+void test_small_pieces() {
+    printf("\nTest: Small Pieces\n");
+    history_init();
+    for (uint32_t i = 0; i < 300; i++) {
+        history_add(1000 + i * 2000, 40.0f + (float)(i % 50), 15.0f + (float)(i % 17) / 10.0f);
+    }
+
+    static char whole[16384];
+    size_t whole_len = export_all(HISTORY_TIER_RAW, HISTORY_FORMAT_CSV, 0, UINT32_MAX, 8192);
+    memcpy(whole, s_out, whole_len);
+    size_t piece_len = export_all(HISTORY_TIER_RAW, HISTORY_FORMAT_CSV, 0, UINT32_MAX, 32);
+    TEST_ASSERT(piece_len == whole_len && memcmp(whole, s_out, whole_len) == 0,
+                "32-byte pieces match a single export");
+
+    // Producing again from the same position gives the same bytes
+    history_query query;
+    history_query_init(&query, HISTORY_TIER_RAW, HISTORY_FORMAT_CSV, 0, UINT32_MAX);
+    uint32_t pos = 0;
+    history_export(&query, &pos, s_out, 64);
+    uint32_t saved = pos;
+    char first[64];
+    size_t n1 = history_export(&query, &pos, first, sizeof(first));
+    pos = saved;
+    size_t n2 = history_export(&query, &pos, s_out, sizeof(first));
+    TEST_ASSERT(n1 == n2 && memcmp(first, s_out, n1) == 0, "Repeat from a saved position");
+}
+
+// Test 5: The ring keeps only the newest records
+void test_wrap_around() {
+    printf("\nTest: Wrap Around\n");
+    history_init();
+    uint32_t total = HISTORY_RAW_LEN + 100;
+    for (uint32_t i = 0; i < total; i++) {
+        history_add(i * 10, 50.0f, 20.0f);
+    }
+    TEST_ASSERT(history_count(HISTORY_TIER_RAW) == HISTORY_RAW_LEN, "Count is capped");
+
+    size_t len = export_all(HISTORY_TIER_RAW, HISTORY_FORMAT_BINARY, 0, UINT32_MAX, 4096);
+    size_t records = (len - HISTORY_BINARY_HEADER) / HISTORY_RECORD_SIZE;
+    // The oldest slot is the next one written, so it isn't exported
+    TEST_ASSERT(records == HISTORY_RAW_LEN - 1, "All readable records exported");
+    TEST_ASSERT(get_le32(s_out + HISTORY_BINARY_HEADER) == (total - HISTORY_RAW_LEN + 1) * 10,
+                "Export starts at the oldest readable record");
+    TEST_ASSERT(get_le32(s_out + len - HISTORY_RECORD_SIZE) == (total - 1) * 10,
+                "Export ends at the newest record");
+}
+
+// Test 6: Samples added during an export
+void test_concurrent_add() {
+    printf("\nTest: Concurrent Add\n");
+    history_init();
+    for (uint32_t i = 0; i < 100; i++) {
+        history_add(i * 10, 50.0f, 20.0f);
+    }
+
+    history_query query;
+    history_query_init(&query, HISTORY_TIER_RAW, HISTORY_FORMAT_BINARY, 0, UINT32_MAX);
+    uint32_t pos = 0;
+    char buf[HISTORY_BINARY_HEADER + 10 * HISTORY_RECORD_SIZE];
+    size_t n = history_export(&query, &pos, buf, sizeof(buf));
+    TEST_ASSERT(n == sizeof(buf), "First piece is full");
+
+    // Overwrite records 10..38, which haven't been exported yet
+    for (uint32_t i = 100; i < 100 + HISTORY_RAW_LEN - 62; i++) {
+        history_add(i * 10, 50.0f, 20.0f);
+    }
+
+    uint32_t last = get_le32(buf + n - HISTORY_RECORD_SIZE);
+    size_t records = 0;
+    bool ordered = true;
+    while ((n = history_export(&query, &pos, buf, HISTORY_RECORD_SIZE * 4)) > 0) {
+        for (size_t i = 0; i < n; i += HISTORY_RECORD_SIZE) {
+            uint32_t t = get_le32(buf + i);
+            ordered = ordered && t > last && t < 1000;
+            last = t;
+            records++;
+        }
+    }
+    TEST_ASSERT(ordered, "Only newer records from before the export started follow");
+    TEST_ASSERT(records == 61, "Overwritten records are skipped");
+}
+
+// Test 7: Minute and hour averages
+void test_averages() {
+    printf("\nTest: Averages\n");
+    history_init();
+    // Two minutes of samples every 20 s, then one sample that closes minute 1
+    history_add(0, 40.0f, 10.0f);
+    history_add(20000, 50.0f, 20.0f);
+    history_add(40000, 60.0f, 30.0f);
+    history_add(60000, 10.0f, 0.0f);
+    history_add(80000, 30.0f, 2.0f);
+    TEST_ASSERT(history_count(HISTORY_TIER_MINUTE) == 1, "Open minute isn't stored yet");
+    history_add(120000, 0.0f, 0.0f);
+    TEST_ASSERT(history_count(HISTORY_TIER_MINUTE) == 2, "Next minute closes the previous one");
+
+    export_all(HISTORY_TIER_MINUTE, HISTORY_FORMAT_CSV, 0, UINT32_MAX, 256);
+    TEST_ASSERT(strcmp(s_out,
+                       "time_ms,humidity,temp_c\n"
+                       "0,50.0,20.0\n"
+                       "60000,20.0,1.0\n") == 0,
+                "Averages are stamped with the start of their minute");
+    TEST_ASSERT(history_count(HISTORY_TIER_HOUR) == 0, "Hour is still open");
+
+    history_add(3600000, 0.0f, 0.0f);
+    export_all(HISTORY_TIER_HOUR, HISTORY_FORMAT_CSV, 0, UINT32_MAX, 256);
+    TEST_ASSERT(strcmp(s_out, "time_ms,humidity,temp_c\n0,31.7,10.3\n") == 0,
+                "Hour averages every sample in it");
+}
+
+// Test 8: Tier names accepted by the API
+void test_tier_names() {
+    printf("\nTest: Tier Names\n");
+    TEST_ASSERT(history_tier_from_name("raw") == HISTORY_TIER_RAW, "raw");
+    TEST_ASSERT(history_tier_from_name("1m") == HISTORY_TIER_MINUTE, "1m");
+    TEST_ASSERT(history_tier_from_name("1h") == HISTORY_TIER_HOUR, "1h");
+    TEST_ASSERT(history_tier_from_name("2") == HISTORY_TIER_HOUR, "Tier by number");
+    TEST_ASSERT(history_tier_from_name("3") == -1, "Out of range number");
+    TEST_ASSERT(history_tier_from_name("") == -1, "Empty name");
+    TEST_ASSERT(history_tier_from_name("1d") == -1, "Unknown name");
+}
+
+// Test 9: Out-of-range values and NaN are clamped, not converted
+void test_clamping() {
+    printf("\nTest: Clamping\n");
+    history_init();
+    history_add(1000, 5000.0f, -5000.0f);
+    history_add(2000, NAN, 20.0f);
+    size_t len = export_all(HISTORY_TIER_RAW, HISTORY_FORMAT_BINARY, 0, UINT32_MAX, 256);
+
+    TEST_ASSERT(len == HISTORY_BINARY_HEADER + 2 * HISTORY_RECORD_SIZE, "Header plus two records");
+    const char *rec = s_out + HISTORY_BINARY_HEADER;
+    TEST_ASSERT(get_le16(rec + 4) == INT16_MAX && get_le16(rec + 6) == INT16_MIN,
+                "Values past the int16_t range are clamped");
+    rec += HISTORY_RECORD_SIZE;
+    TEST_ASSERT(get_le16(rec + 4) == INT16_MAX && get_le16(rec + 6) == 200,
+                "NaN packs as INT16_MAX");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("History Host Test Suite\n");
+    printf("========================================\n");
+
+    test_csv_export();
+    test_binary_export();
+    test_time_range();
+    test_small_pieces();
+    test_wrap_around();
+    test_concurrent_add();
+    test_averages();
+    test_tier_names();
+    test_clamping();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
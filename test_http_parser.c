@@ -0,0 +1,362 @@
+/*
+File: test_http_parser.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the incremental HTTP request parser in http_parser.c.
+Responsibilities:
+- Test request line and header extraction
+- Test requests split at every byte boundary and pipelined back to back
+- Test keep-alive rules, body skipping and header edge cases
+- Test that malformed and oversized requests fail with the right status
+- Test query string splitting and percent-decoding
+- Test If-None-Match comparison against strong and weak entity tags
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "http_parser.h"
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+static const char BROWSER_REQUEST[] =
+    "GET /api/v1/readings?fields=humidity,led HTTP/1.1\r\n"
+    "Host: 192.168.4.1\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64)\r\n"
+    "Accept-Encoding: deflate, GZIP, br\r\n"
+    "if-none-match: \"r12-1-9\"\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n";
+
+// Feed a whole buffer in one call and return the result
+static http_parse_result parse_all(http_parser *parser, const char *data, size_t *consumed) {
+    http_parser_init(parser);
+    return http_parser_feed(parser, data, strlen(data), consumed);
+}
+
+// Test 1: Request line and the headers the server uses
+void test_basic_request() {
+    printf("\nTest: Basic Request\n");
+    http_parser parser;
+    size_t used = 0;
+    http_parse_result r = parse_all(&parser, BROWSER_REQUEST, &used);
+    const http_request *req = &parser.req;
+
+    TEST_ASSERT(r == HTTP_PARSE_DONE && used == strlen(BROWSER_REQUEST), "Whole head consumed");
+    TEST_ASSERT(strcmp(req->method, "GET") == 0 && req->method_id == HTTP_METHOD_GET, "Method");
+    TEST_ASSERT(strcmp(req->path, "/api/v1/readings") == 0, "Path without query");
+    TEST_ASSERT(req->has_query && strcmp(req->query, "fields=humidity,led") == 0, "Query");
+    TEST_ASSERT(req->version_minor == 1 && req->keep_alive, "HTTP/1.1 keep-alive");
+    TEST_ASSERT(req->accept_gzip, "Case-insensitive gzip in a list");
+    TEST_ASSERT(strcmp(req->if_none_match, "\"r12-1-9\"") == 0, "Lowercase header name");
+    TEST_ASSERT(req->content_length == 0 && !req->upgrade_websocket, "Absent headers are empty");
+}
+
+// Test 2: The same request split into two pieces at every possible point
+void test_split_everywhere() {
+    printf("\nTest: Split at Every Byte Boundary\n");
+    size_t len = strlen(BROWSER_REQUEST);
+    bool all_ok = true;
+
+    for (size_t split = 1; split < len; split++) {
+        http_parser parser;
+        http_parser_init(&parser);
+        size_t used = 0;
+        http_parse_result r = http_parser_feed(&parser, BROWSER_REQUEST, split, &used);
+        if (r != HTTP_PARSE_NEED_MORE || used != split) {
+            all_ok = false;
+            break;
+        }
+        r = http_parser_feed(&parser, BROWSER_REQUEST + split, len - split, &used);
+        if (r != HTTP_PARSE_DONE || used != len - split ||
+            strcmp(parser.req.path, "/api/v1/readings") != 0 ||
+            strcmp(parser.req.if_none_match, "\"r12-1-9\"") != 0 || !parser.req.accept_gzip) {
+            all_ok = false;
+            break;
+        }
+    }
+    TEST_ASSERT(all_ok, "Every two-piece split parses identically");
+
+    http_parser parser;
+    http_parser_init(&parser);
+    http_parse_result r = HTTP_PARSE_NEED_MORE;
+    size_t i = 0;
+    while (i < len && r == HTTP_PARSE_NEED_MORE) {
+        size_t used = 0;
+        r = http_parser_feed(&parser, BROWSER_REQUEST + i, 1, &used);
+        i += used;
+    }
+    TEST_ASSERT(r == HTTP_PARSE_DONE && i == len, "Byte-by-byte delivery completes on last byte");
+    TEST_ASSERT(strcmp(parser.req.query, "fields=humidity,led") == 0, "Byte-by-byte query intact");
+}
+
+// Test 3: Several requests in one segment are returned one at a time
+void test_pipelined() {
+    printf("\nTest: Pipelined Requests\n");
+    const char buf[] =
+        "GET /style.css HTTP/1.1\r\nHost: a\r\n\r\n"
+        "GET /app.js HTTP/1.1\r\nHost: a\r\n\r\n"
+        "GET /events HTTP/1.1\r\nHo";
+
+    http_parser parser;
+    http_parser_init(&parser);
+    size_t pos = 0, used = 0;
+
+    http_parse_result r = http_parser_feed(&parser, buf + pos, sizeof(buf) - 1 - pos, &used);
+    pos += used;
+    TEST_ASSERT(r == HTTP_PARSE_DONE && strcmp(parser.req.path, "/style.css") == 0,
+                "First request returned alone");
+
+    r = http_parser_feed(&parser, buf + pos, sizeof(buf) - 1 - pos, &used);
+    pos += used;
+    TEST_ASSERT(r == HTTP_PARSE_DONE && strcmp(parser.req.path, "/app.js") == 0,
+                "Second request follows");
+
+    r = http_parser_feed(&parser, buf + pos, sizeof(buf) - 1 - pos, &used);
+    pos += used;
+    TEST_ASSERT(r == HTTP_PARSE_NEED_MORE && pos == sizeof(buf) - 1, "Partial third request kept");
+
+    const char rest[] = "st: a\r\n\r\n";
+    r = http_parser_feed(&parser, rest, sizeof(rest) - 1, &used);
+    TEST_ASSERT(r == HTTP_PARSE_DONE && strcmp(parser.req.path, "/events") == 0 &&
+                !parser.req.has_query, "Third request completed by the next segment");
+}
+
+// Test 4: Connection reuse rules for HTTP/1.0 and HTTP/1.1
+void test_keep_alive() {
+    printf("\nTest: Keep-Alive Rules\n");
+    http_parser parser;
+    size_t used = 0;
+
+    parse_all(&parser, "GET / HTTP/1.0\r\n\r\n", &used);
+    TEST_ASSERT(!parser.req.keep_alive, "HTTP/1.0 closes by default");
+
+    parse_all(&parser, "GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n", &used);
+    TEST_ASSERT(parser.req.keep_alive, "HTTP/1.0 with Connection: keep-alive");
+
+    parse_all(&parser, "GET / HTTP/1.1\r\nConnection: close\r\n\r\n", &used);
+    TEST_ASSERT(!parser.req.keep_alive, "HTTP/1.1 with Connection: close");
+
+    parse_all(&parser, "GET / HTTP/1.1\nHost: a\n\n", &used);
+    TEST_ASSERT(parser.req.keep_alive && used == 24, "Bare LF line endings accepted");
+}
+
+// Test 5: A request body is skipped so the next request is framed correctly
+void test_body_skipped() {
+    printf("\nTest: Request Body Skipped\n");
+    const char buf[] =
+        "POST /set HTTP/1.1\r\nContent-Length: 11\r\n\r\n"
+        "led=on&x=GE"
+        "GET /ws HTTP/1.1\r\n\r\n";
+
+    http_parser parser;
+    http_parser_init(&parser);
+    size_t pos = 0, used = 0;
+
+    http_parse_result r = http_parser_feed(&parser, buf, sizeof(buf) - 1, &used);
+    pos += used;
+    TEST_ASSERT(r == HTTP_PARSE_DONE && strcmp(parser.req.method, "POST") == 0 &&
+                parser.req.content_length == 11, "POST head parsed with Content-Length");
+
+    // Deliver the body in two pieces to cross a segment boundary inside it
+    r = http_parser_feed(&parser, buf + pos, 4, &used);
+    pos += used;
+    TEST_ASSERT(r == HTTP_PARSE_NEED_MORE && used == 4, "Partial body consumed");
+    TEST_ASSERT(!http_parser_idle(&parser), "Parser busy inside the body");
+
+    r = http_parser_feed(&parser, buf + pos, sizeof(buf) - 1 - pos, &used);
+    TEST_ASSERT(r == HTTP_PARSE_DONE && strcmp(parser.req.path, "/ws") == 0 &&
+                parser.req.content_length == 0, "Next request after the body");
+    TEST_ASSERT(http_parser_idle(&parser), "Parser idle between requests");
+}
+
+// Test 6: Header details: WebSocket handshake, q-values, long headers
+void test_headers() {
+    printf("\nTest: Header Handling\n");
+    http_parser parser;
+    size_t used = 0;
+
+    parse_all(&parser,
+              "GET /ws HTTP/1.1\r\n"
+              "Upgrade: websocket\r\n"
+              "Connection: keep-alive, Upgrade\r\n"
+              "Sec-WebSocket-Key:dGhlIHNhbXBsZSBub25jZQ==  \r\n"
+              "Sec-WebSocket-Version: 13\r\n"
+              "\r\n", &used);
+    TEST_ASSERT(parser.req.upgrade_websocket && parser.req.connection_upgrade,
+                "Upgrade tokens found in lists");
+    TEST_ASSERT(strcmp(parser.req.ws_key, "dGhlIHNhbXBsZSBub25jZQ==") == 0,
+                "Key with no leading and trailing spaces trimmed");
+    TEST_ASSERT(parser.req.ws_version == 13, "WebSocket version");
+
+    parse_all(&parser, "GET / HTTP/1.1\r\nAccept-Encoding: gzip;q=0, deflate\r\n\r\n", &used);
+    TEST_ASSERT(!parser.req.accept_gzip, "gzip;q=0 refuses gzip");
+
+    parse_all(&parser, "GET / HTTP/1.1\r\nAccept-Encoding: br, gzip ; q=0.5\r\n\r\n", &used);
+    TEST_ASSERT(parser.req.accept_gzip, "gzip;q=0.5 accepts gzip");
+
+    parse_all(&parser, "GET / HTTP/1.1\r\nAccept-Encoding: x-gzip\r\n\r\n", &used);
+    TEST_ASSERT(!parser.req.accept_gzip, "Token match is exact");
+
+    // A cookie far larger than the old 512-byte request buffer
+    static char big[3000];
+    int n = snprintf(big, sizeof(big), "GET /app.js HTTP/1.1\r\nCookie: ");
+    memset(big + n, 'c', 2500);
+    strcpy(big + n + 2500, "\r\nIf-None-Match: W/\"abc\"\r\n\r\n");
+    http_parse_result r = parse_all(&parser, big, &used);
+    TEST_ASSERT(r == HTTP_PARSE_DONE && strcmp(parser.req.if_none_match, "W/\"abc\"") == 0,
+                "Long unknown header skipped without buffering");
+
+    // An If-None-Match list too long to keep is dropped rather than truncated
+    n = snprintf(big, sizeof(big), "GET / HTTP/1.1\r\nIf-None-Match: ");
+    memset(big + n, 'e', 200);
+    strcpy(big + n + 200, "\r\n\r\n");
+    r = parse_all(&parser, big, &used);
+    TEST_ASSERT(r == HTTP_PARSE_DONE && parser.req.if_none_match[0] == '\0',
+                "Oversized If-None-Match treated as absent");
+}
+
+// Test 7: Malformed and oversized requests fail with a status code
+void test_errors() {
+    printf("\nTest: Malformed Requests\n");
+    http_parser parser;
+    size_t used = 0;
+
+    TEST_ASSERT(parse_all(&parser, "GET / HTTP/2.0\r\n\r\n", &used) == HTTP_PARSE_ERROR &&
+                parser.error_status == 505, "Unsupported version gets 505");
+    TEST_ASSERT(parse_all(&parser, "GET / FOO/1.1\r\n\r\n", &used) == HTTP_PARSE_ERROR &&
+                parser.error_status == 400, "Garbage version gets 400");
+    TEST_ASSERT(parse_all(&parser, "GET http://x/ HTTP/1.1\r\n\r\n", &used) == HTTP_PARSE_ERROR &&
+                parser.error_status == 400, "Absolute-form target rejected");
+    TEST_ASSERT(parse_all(&parser, "G(T / HTTP/1.1\r\n\r\n", &used) == HTTP_PARSE_ERROR &&
+                parser.error_status == 400, "Invalid method character rejected");
+    TEST_ASSERT(parse_all(&parser, "get / HTTP/1.1\r\n\r\n", &used) == HTTP_PARSE_DONE &&
+                parser.req.method_id == HTTP_METHOD_OTHER, "Lowercase method is not GET");
+    TEST_ASSERT(parse_all(&parser, "VERYLONGMETHOD / HTTP/1.1\r\n\r\n", &used) == HTTP_PARSE_ERROR &&
+                parser.error_status == 501, "Unknown long method gets 501");
+    TEST_ASSERT(parse_all(&parser, "GET / HTTP/1.1\r\nHost: a\r\n folded\r\n\r\n", &used) ==
+                HTTP_PARSE_ERROR && parser.error_status == 400, "Obsolete line folding rejected");
+    TEST_ASSERT(parse_all(&parser, "GET / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n", &used) ==
+                HTTP_PARSE_ERROR && parser.error_status == 400, "Bad Content-Length rejected");
+    TEST_ASSERT(parse_all(&parser, "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n",
+                          &used) == HTTP_PARSE_ERROR && parser.error_status == 501,
+                "Transfer-Encoding gets 501");
+    TEST_ASSERT(parse_all(&parser, "GET / HTTP/1.1\r\nBad Header: x\r\n\r\n", &used) ==
+                HTTP_PARSE_ERROR && parser.error_status == 400, "Space in header name rejected");
+
+    char path[HTTP_PATH_MAX + 32];
+    snprintf(path, sizeof(path), "GET /%0*d HTTP/1.1\r\n\r\n", HTTP_PATH_MAX, 0);
+    TEST_ASSERT(parse_all(&parser, path, &used) == HTTP_PARSE_ERROR &&
+                parser.error_status == 414, "Overlong path gets 414");
+
+    static char huge[HTTP_HEAD_MAX + 64];
+    int n = snprintf(huge, sizeof(huge), "GET / HTTP/1.1\r\nCookie: ");
+    memset(huge + n, 'c', HTTP_HEAD_MAX);
+    huge[n + HTTP_HEAD_MAX] = '\0';
+    TEST_ASSERT(parse_all(&parser, huge, &used) == HTTP_PARSE_ERROR &&
+                parser.error_status == 431, "Oversized head gets 431");
+
+    TEST_ASSERT(http_parser_feed(&parser, "GET / HTTP/1.1\r\n\r\n", 18, &used) ==
+                HTTP_PARSE_ERROR && used == 0, "Parser stays failed");
+}
+
+// Test 8: Query parameters are split and decoded in place
+void test_query_iterator() {
+    printf("\nTest: Query Iterator\n");
+    char query[] = "led=on&&brightness=64&name=Living+Room%21&flag&fields=humidity%2Ctemp_c";
+    char *cursor = query;
+    char *name, *value;
+
+    bool ok = http_query_next(&cursor, &name, &value) == HTTP_QUERY_PARAM &&
+              strcmp(name, "led") == 0 && strcmp(value, "on") == 0;
+    TEST_ASSERT(ok, "First parameter");
+
+    ok = http_query_next(&cursor, &name, &value) == HTTP_QUERY_PARAM &&
+         strcmp(name, "brightness") == 0 && strcmp(value, "64") == 0;
+    TEST_ASSERT(ok, "Empty parameter skipped");
+
+    ok = http_query_next(&cursor, &name, &value) == HTTP_QUERY_PARAM &&
+         strcmp(value, "Living Room!") == 0;
+    TEST_ASSERT(ok, "'+' and %XX decoded");
+
+    ok = http_query_next(&cursor, &name, &value) == HTTP_QUERY_PARAM &&
+         strcmp(name, "flag") == 0 && value[0] == '\0';
+    TEST_ASSERT(ok, "Parameter without '=' has an empty value");
+
+    ok = http_query_next(&cursor, &name, &value) == HTTP_QUERY_PARAM &&
+         strcmp(value, "humidity,temp_c") == 0;
+    TEST_ASSERT(ok, "Encoded comma decoded");
+
+    TEST_ASSERT(http_query_next(&cursor, &name, &value) == HTTP_QUERY_END, "End of query");
+
+    char bad[] = "a=%4";
+    cursor = bad;
+    TEST_ASSERT(http_query_next(&cursor, &name, &value) == HTTP_QUERY_ERROR,
+                "Truncated escape rejected");
+
+    char bad_hex[] = "a%zz=1";
+    cursor = bad_hex;
+    TEST_ASSERT(http_query_next(&cursor, &name, &value) == HTTP_QUERY_ERROR,
+                "Non-hex escape rejected");
+
+    TEST_ASSERT(strcmp(http_method_name(HTTP_METHOD_POST), "POST") == 0 &&
+                http_method_name(HTTP_METHOD_OTHER) == NULL, "Method names");
+}
+
+// Test 9: If-None-Match compares whole tags, ignoring W/ on either side
+void test_etag_matches() {
+    printf("\nTest: ETag Matching\n");
+    TEST_ASSERT(http_etag_matches("\"abc\"", "\"abc\""), "Same strong tag");
+    TEST_ASSERT(http_etag_matches("W/\"abc\"", "\"abc\""), "Weak client tag matches");
+    TEST_ASSERT(http_etag_matches("\"abc\"", "W/\"abc\""), "Weak server tag matches");
+    TEST_ASSERT(http_etag_matches("\"x\", W/\"r12-1-7f\" ,\"y\"", "W/\"r12-1-7f\""),
+                "Tag in the middle of a list");
+    TEST_ASSERT(!http_etag_matches("\"abcd\"", "\"abc\""), "Longer tag doesn't match");
+    TEST_ASSERT(!http_etag_matches("\"r1-1-7f\"", "\"r1-1-7\""), "Tag with our tag as a prefix");
+    TEST_ASSERT(!http_etag_matches("\"ab\"", "\"abc\""), "Shorter tag doesn't match");
+    TEST_ASSERT(!http_etag_matches("abc, \"x\"", "\"abc\""), "Unquoted member ignored");
+    TEST_ASSERT(!http_etag_matches("\"abc", "\"abc\""), "Truncated tag doesn't match");
+    TEST_ASSERT(http_etag_matches("*", "\"abc\"") && http_etag_matches(" * ", "W/\"abc\""),
+                "* matches any tag");
+    TEST_ASSERT(!http_etag_matches("*abc", "\"abc\""), "* must stand alone");
+    TEST_ASSERT(!http_etag_matches(NULL, "\"abc\"") && !http_etag_matches("", "\"abc\""),
+                "No header matches nothing");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("HTTP Parser Host Test Suite\n");
+    printf("========================================\n");
+
+    test_basic_request();
+    test_split_everywhere();
+    test_pipelined();
+    test_keep_alive();
+    test_body_skipped();
+    test_headers();
+    test_errors();
+    test_query_iterator();
+    test_etag_matches();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,136 @@
+/*
+File: test_i2c_queue.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the I2C transaction queue in i2c_queue.c.
+Responsibilities:
+- Test priority order and first-in first-out order within a priority
+- Test taking only transactions at or above a priority, and a full queue
+- Test the per-device bus statistics
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "i2c_queue.h"
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+static i2c_txn make_txn(i2c_device device, i2c_priority priority, uint8_t tag) {
+    i2c_txn txn;
+    memset(&txn, 0, sizeof(txn));
+    txn.device = device;
+    txn.priority = priority;
+    txn.tx[0] = tag;
+    txn.tx_len = 1;
+    return txn;
+}
+
+// Test 1: A sensor transaction overtakes a queued LCD frame
+void test_priority() {
+    printf("\nTest: Priority Order\n");
+    static i2c_queue queue;
+    i2c_queue_init(&queue);
+
+    for (uint8_t i = 0; i < 5; i++) {
+        i2c_txn lcd = make_txn(I2C_DEV_LCD, I2C_PRIORITY_LOW, i);
+        i2c_queue_push(&queue, &lcd, 100 + i);
+    }
+    i2c_txn sensor = make_txn(I2C_DEV_DHT20, I2C_PRIORITY_HIGH, 99);
+    i2c_queue_push(&queue, &sensor, 200);
+    TEST_ASSERT(i2c_queue_count(&queue) == 6, "Six queued");
+
+    i2c_txn out;
+    TEST_ASSERT(i2c_queue_pop(&queue, I2C_PRIORITY_LOW, &out) && out.tx[0] == 99,
+                "High priority runs first");
+    TEST_ASSERT(out.queued_us == 200, "Queue time recorded");
+
+    bool in_order = true;
+    for (uint8_t i = 0; i < 5; i++) {
+        in_order &= i2c_queue_pop(&queue, I2C_PRIORITY_LOW, &out) && out.tx[0] == i;
+    }
+    TEST_ASSERT(in_order, "Equal priorities run in submission order");
+    TEST_ASSERT(!i2c_queue_pop(&queue, I2C_PRIORITY_LOW, &out), "Empty afterwards");
+}
+
+// Test 2: Priority limit, full queue and slot reuse
+void test_limits() {
+    printf("\nTest: Limits\n");
+    static i2c_queue queue;
+    i2c_queue_init(&queue);
+
+    i2c_txn lcd = make_txn(I2C_DEV_LCD, I2C_PRIORITY_LOW, 1);
+    i2c_queue_push(&queue, &lcd, 0);
+    i2c_txn out;
+    TEST_ASSERT(!i2c_queue_pop(&queue, I2C_PRIORITY_HIGH, &out), "Low priority skipped at a high limit");
+    TEST_ASSERT(i2c_queue_count(&queue) == 1, "... and left queued");
+
+    int accepted = 1;
+    for (int i = 0; i < I2C_QUEUE_MAX + 3; i++) {
+        lcd.tx[0] = (uint8_t)(i + 2);
+        accepted += i2c_queue_push(&queue, &lcd, 0);
+    }
+    TEST_ASSERT(accepted == I2C_QUEUE_MAX, "Queue holds I2C_QUEUE_MAX transactions");
+
+    // Free a slot in the middle of the pool, refill it, and check the order still holds
+    i2c_queue_pop(&queue, I2C_PRIORITY_LOW, &out);
+    lcd.tx[0] = 200;
+    TEST_ASSERT(i2c_queue_push(&queue, &lcd, 0), "Freed slot reused");
+    uint8_t last = 0;
+    while (i2c_queue_pop(&queue, I2C_PRIORITY_LOW, &out)) {
+        last = out.tx[0];
+    }
+    TEST_ASSERT(last == 200, "Newest transaction runs last");
+}
+
+// Test 3: Per-device statistics
+void test_stats() {
+    printf("\nTest: Statistics\n");
+    i2c_device_stats stats;
+    memset(&stats, 0, sizeof(stats));
+
+    i2c_txn read = make_txn(I2C_DEV_DHT20, I2C_PRIORITY_HIGH, 0);
+    read.tx_len = 0;
+    read.rx_len = 7;
+    TEST_ASSERT(i2c_txn_bytes(&read) == 7, "Read bytes counted");
+
+    i2c_stats_record(&stats, 50, 900, 12, 7, true);
+    i2c_stats_record(&stats, 3000, 400, 5, 3, false);
+    i2c_stats_record(&stats, 10, 100, 100, 1, true);
+    TEST_ASSERT(stats.transactions == 3 && stats.errors == 1, "Transactions and errors");
+    TEST_ASSERT(stats.bytes == 11 && stats.bus_us == 1400, "Bytes and bus time add up");
+    TEST_ASSERT(stats.cpu_us == 117, "CPU time adds up separately from bus time");
+    TEST_ASSERT(stats.max_wait_us == 3000, "Longest queue wait kept");
+    TEST_ASSERT(strcmp(i2c_device_name(I2C_DEV_LCD), "lcd") == 0, "Device names");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("I2C Queue Host Test Suite\n");
+    printf("========================================\n");
+
+    test_priority();
+    test_limits();
+    test_stats();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
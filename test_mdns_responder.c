@@ -0,0 +1,268 @@
+/*
+File: test_mdns_responder.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the mDNS responder in mdns_responder.c.
+Responsibilities:
+- Test answers to hostname, service browse and service instance queries
+- Test the repeat limit on multicast answers and unicast-response questions
+- Test replies to one-shot queries (echoed question, capped TTLs)
+- Test that responses, other names and malformed queries are ignored
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "mdns_responder.h"
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+#define TYPE_A    1
+#define TYPE_PTR  12
+#define TYPE_TXT  16
+#define TYPE_AAAA 28
+#define TYPE_SRV  33
+
+static const uint8_t DEVICE_IP[4] = { 192, 168, 1, 57 };
+
+static const char *const TXT[] = { "path=/", "fw=1.0.0", "sensors=1" };
+
+static void setup(mdns_responder *r) {
+    mdns_responder_init(r, "pico2w", 80, TXT, 3);
+    mdns_responder_set_ip(r, DEVICE_IP);
+}
+
+// Append a dotted name in wire format
+static size_t put_name(uint8_t *out, const char *name) {
+    size_t len = 0;
+    while (*name) {
+        const char *dot = strchr(name, '.');
+        size_t label = dot ? (size_t)(dot - name) : strlen(name);
+        out[len++] = (uint8_t)label;
+        memcpy(&out[len], name, label);
+        len += label;
+        name += label + (dot ? 1 : 0);
+    }
+    out[len++] = 0;
+    return len;
+}
+
+// Build a one-question query
+static size_t make_query(uint8_t *out, uint16_t id, const char *name, uint16_t type, bool qu) {
+    memset(out, 0, 12);
+    out[0] = (uint8_t)(id >> 8);
+    out[1] = (uint8_t)id;
+    out[5] = 1;
+    size_t len = 12 + put_name(&out[12], name);
+    out[len++] = (uint8_t)(type >> 8);
+    out[len++] = (uint8_t)type;
+    out[len++] = qu ? 0x80 : 0x00;
+    out[len++] = 1;
+    return len;
+}
+
+static uint16_t u16_at(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// Find a record of the given type in a reply (names are never compressed);
+// returns the offset of its type field, or 0
+static size_t find_record(const uint8_t *msg, size_t len, uint16_t type) {
+    size_t pos = 12;
+    for (unsigned q = 0; q < u16_at(&msg[4]); q++) {
+        while (msg[pos] != 0) pos += 1 + msg[pos];
+        pos += 5;
+    }
+    unsigned records = u16_at(&msg[6]) + u16_at(&msg[8]) + u16_at(&msg[10]);
+    for (unsigned i = 0; i < records && pos < len; i++) {
+        while (msg[pos] != 0) pos += 1 + msg[pos];
+        pos++;
+        if (u16_at(&msg[pos]) == type) return pos;
+        pos += 10 + u16_at(&msg[pos + 8]);
+    }
+    return 0;
+}
+
+static bool contains(const uint8_t *msg, size_t len, const char *text) {
+    size_t n = strlen(text);
+    for (size_t i = 0; i + n <= len; i++) {
+        if (memcmp(&msg[i], text, n) == 0) return true;
+    }
+    return false;
+}
+
+// Test 1: Hostname queries and the multicast repeat limit
+void test_host_query() {
+    printf("\nTest: Hostname Query\n");
+    mdns_responder r;
+    uint8_t query[128];
+    const uint8_t *reply;
+    bool unicast;
+    size_t qlen = make_query(query, 0, "pico2w.local", TYPE_A, false);
+
+    TEST_ASSERT(mdns_responder_init(&r, "pico2w", 80, TXT, 3), "Responder configured");
+    TEST_ASSERT(mdns_responder_handle(&r, query, qlen, 5353, 0, &reply, &unicast) == 0,
+                "Nothing answered before an address is set");
+    TEST_ASSERT(mdns_responder_set_ip(&r, DEVICE_IP), "Address set");
+    TEST_ASSERT(!mdns_responder_set_ip(&r, DEVICE_IP), "Same address isn't a change");
+
+    size_t len = mdns_responder_handle(&r, query, qlen, 5353, 1000, &reply, &unicast);
+    TEST_ASSERT(len > 12 && !unicast, "Multicast answer");
+    TEST_ASSERT(u16_at(&reply[2]) == 0x8400 && u16_at(&reply[6]) == 1, "One authoritative answer");
+    size_t a = find_record(reply, len, TYPE_A);
+    TEST_ASSERT(a && memcmp(&reply[a + 10], DEVICE_IP, 4) == 0, "Address record carries the IP");
+    TEST_ASSERT(a && u16_at(&reply[a + 2]) == 0x8001, "Address record flushes caches");
+
+    TEST_ASSERT(mdns_responder_handle(&r, query, qlen, 5353, 1500, &reply, &unicast) == 0,
+                "Repeat within a second suppressed");
+    TEST_ASSERT(mdns_responder_handle(&r, query, qlen, 5353, 2000, &reply, &unicast) == len,
+                "Answered again after a second");
+
+    qlen = make_query(query, 0, "PICO2W.Local", TYPE_A, true);
+    TEST_ASSERT(mdns_responder_handle(&r, query, qlen, 5353, 2100, &reply, &unicast) == len && unicast,
+                "Unicast-response question answered directly, any case");
+
+    uint8_t new_ip[4] = { 192, 168, 4, 1 };
+    TEST_ASSERT(mdns_responder_set_ip(&r, new_ip), "Address changed");
+    qlen = make_query(query, 0, "pico2w.local", TYPE_A, false);
+    len = mdns_responder_handle(&r, query, qlen, 5353, 2200, &reply, &unicast);
+    a = find_record(reply, len, TYPE_A);
+    TEST_ASSERT(a && memcmp(&reply[a + 10], new_ip, 4) == 0, "Cached answer follows the address");
+}
+
+// Test 2: Service discovery
+void test_service_queries() {
+    printf("\nTest: Service Queries\n");
+    mdns_responder r;
+    setup(&r);
+    uint8_t query[128];
+    const uint8_t *reply;
+    bool unicast;
+
+    size_t qlen = make_query(query, 0, "_http._tcp.local", TYPE_PTR, false);
+    size_t len = mdns_responder_handle(&r, query, qlen, 5353, 0, &reply, &unicast);
+    TEST_ASSERT(len && u16_at(&reply[6]) == 1 && u16_at(&reply[10]) == 3,
+                "Browse answered with PTR plus SRV, TXT and A");
+    size_t srv = find_record(reply, len, TYPE_SRV);
+    TEST_ASSERT(srv && u16_at(&reply[srv + 14]) == 80, "SRV gives the web server port");
+    TEST_ASSERT(contains(reply, len, "fw=1.0.0") && contains(reply, len, "sensors=1"),
+                "TXT carries firmware version and sensor count");
+
+    qlen = make_query(query, 0, "pico2w._http._tcp.local", TYPE_TXT, false);
+    len = mdns_responder_handle(&r, query, qlen, 5353, 0, &reply, &unicast);
+    TEST_ASSERT(len && u16_at(&reply[6]) == 2 && find_record(reply, len, TYPE_TXT),
+                "Instance query answered with SRV and TXT");
+
+    qlen = make_query(query, 0, "_services._dns-sd._udp.local", TYPE_PTR, false);
+    len = mdns_responder_handle(&r, query, qlen, 5353, 0, &reply, &unicast);
+    TEST_ASSERT(len && contains(reply, len, "\x05_http"), "Service type listed");
+
+    // Two questions; the second reuses ".local" (offset 19) from the first
+    uint8_t two[128];
+    size_t n = make_query(two, 0, "pico2w.local", TYPE_A, false);
+    two[5] = 2;
+    const uint8_t second[] = { 6, 'p', 'i', 'c', 'o', '2', 'w', 5, '_', 'h', 't', 't', 'p',
+                               4, '_', 't', 'c', 'p', 0xC0, 19, 0, TYPE_TXT, 0, 1 };
+    memcpy(&two[n], second, sizeof(second));
+    n += sizeof(second);
+    len = mdns_responder_handle(&r, two, n, 5353, 0, &reply, &unicast);
+    TEST_ASSERT(len && u16_at(&reply[6]) == 5, "Compressed mixed questions get every record");
+}
+
+// Test 3: One-shot queries from a port other than 5353
+void test_legacy_query() {
+    printf("\nTest: One-Shot Query\n");
+    mdns_responder r;
+    setup(&r);
+    uint8_t query[128];
+    const uint8_t *reply;
+    bool unicast;
+
+    size_t qlen = make_query(query, 0xBEEF, "_http._tcp.local", TYPE_PTR, false);
+    size_t len = mdns_responder_handle(&r, query, qlen, 40000, 0, &reply, &unicast);
+    TEST_ASSERT(len && unicast, "Answered by unicast");
+    TEST_ASSERT(u16_at(&reply[0]) == 0xBEEF && u16_at(&reply[4]) == 1, "ID and question echoed");
+    TEST_ASSERT(memcmp(&reply[12], &query[12], qlen - 12) == 0, "Question copied");
+
+    bool ok = true;
+    size_t pos = qlen;
+    for (unsigned i = 0; i < 4; i++) {
+        while (reply[pos] != 0) pos += 1 + reply[pos];
+        pos++;
+        uint32_t ttl = ((uint32_t)u16_at(&reply[pos + 4]) << 16) | u16_at(&reply[pos + 6]);
+        ok = ok && ttl <= MDNS_LEGACY_TTL_S && (u16_at(&reply[pos + 2]) & 0x8000) == 0;
+        pos += 10 + u16_at(&reply[pos + 8]);
+    }
+    TEST_ASSERT(ok && pos == len, "TTLs capped and cache-flush bits cleared");
+
+    // The cached packet itself is untouched
+    qlen = make_query(query, 0, "pico2w.local", TYPE_A, false);
+    len = mdns_responder_handle(&r, query, qlen, 5353, 0, &reply, &unicast);
+    size_t a = find_record(reply, len, TYPE_A);
+    TEST_ASSERT(a && u16_at(&reply[a + 6]) == MDNS_HOST_TTL_S, "Multicast TTL unchanged");
+}
+
+// Test 4: Queries that get no answer
+void test_ignored() {
+    printf("\nTest: Ignored Messages\n");
+    mdns_responder r;
+    setup(&r);
+    uint8_t query[128];
+    const uint8_t *reply;
+    bool unicast;
+
+    size_t qlen = make_query(query, 0, "other.local", TYPE_A, false);
+    TEST_ASSERT(mdns_responder_handle(&r, query, qlen, 5353, 0, &reply, &unicast) == 0, "Other host");
+    qlen = make_query(query, 0, "pico2w.local", TYPE_AAAA, false);
+    TEST_ASSERT(mdns_responder_handle(&r, query, qlen, 5353, 0, &reply, &unicast) == 0, "No IPv6 address");
+    qlen = make_query(query, 0, "_ipp._tcp.local", TYPE_PTR, false);
+    TEST_ASSERT(mdns_responder_handle(&r, query, qlen, 5353, 0, &reply, &unicast) == 0, "Other service");
+
+    qlen = make_query(query, 0, "pico2w.local", TYPE_A, false);
+    query[2] = 0x84;
+    TEST_ASSERT(mdns_responder_handle(&r, query, qlen, 5353, 0, &reply, &unicast) == 0, "Responses ignored");
+
+    qlen = make_query(query, 0, "pico2w.local", TYPE_A, false);
+    query[12] = 0xC0;   // Pointer to itself
+    query[13] = 12;
+    TEST_ASSERT(mdns_responder_handle(&r, query, qlen, 5353, 0, &reply, &unicast) == 0, "Pointer loop");
+    qlen = make_query(query, 0, "pico2w.local", TYPE_A, false);
+    TEST_ASSERT(mdns_responder_handle(&r, query, qlen - 3, 5353, 0, &reply, &unicast) == 0, "Truncated");
+    TEST_ASSERT(mdns_responder_handle(&r, query, 5, 5353, 0, &reply, &unicast) == 0, "Runt");
+
+    TEST_ASSERT(!mdns_responder_init(&r, "bad.name", 80, NULL, 0) &&
+                !mdns_responder_init(&r, "", 80, NULL, 0), "Invalid hostnames rejected");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("mDNS Responder Host Test Suite\n");
+    printf("========================================\n");
+
+    test_host_query();
+    test_service_queries();
+    test_legacy_query();
+    test_ignored();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
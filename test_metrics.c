@@ -0,0 +1,199 @@
+/*
+File: test_metrics.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the performance counters and their
+    Prometheus text exposition in metrics.c.
+Responsibilities:
+- Test counter, gauge and memory pool lines
+- Test histogram bucket placement, cumulative buckets, sum and count
+- Test that an export split into line-sized pieces matches a single export
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "metrics.h"
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+static char s_out[32768];
+
+// Run a whole export through a buffer of the given size; returns its length
+static size_t export_all(size_t piece) {
+    uint32_t pos = 0;
+    size_t len = 0;
+    size_t n;
+    while (len + piece < sizeof(s_out) && (n = metrics_export(&pos, s_out + len, piece)) > 0) {
+        len += n;
+    }
+    s_out[len] = '\0';
+    return len;
+}
+
+// True if the export contains this exact line
+static bool has_line(const char *line) {
+    size_t len = strlen(line);
+    const char *p = s_out;
+    while ((p = strstr(p, line)) != NULL) {
+        if ((p == s_out || p[-1] == '\n') && p[len] == '\n') {
+            return true;
+        }
+        p += len;
+    }
+    return false;
+}
+
+// Test 1: Counters, including labelled families
+void test_counters() {
+    printf("\nTest: Counters\n");
+    metrics_reset();
+    for (int i = 0; i < 7; i++) metrics_count(METRIC_DHT_READS);
+    metrics_count(METRIC_DHT_CRC_ERRORS);
+    metrics_count(METRIC_LED_FRAMES);
+    metrics_count_http_status("200 OK");
+    metrics_count_http_status("200 OK");
+    metrics_count_http_status("404 Not Found");
+    metrics_count_http_status("bogus");
+    export_all(sizeof(s_out) - 1);
+
+    TEST_ASSERT(has_line("# TYPE dht_reads_total counter"), "TYPE line");
+    TEST_ASSERT(has_line("dht_reads_total 7"), "Plain counter");
+    TEST_ASSERT(has_line("dht_read_errors_total{status=\"crc_error\"} 1"), "CRC error counter");
+    TEST_ASSERT(has_line("dht_read_errors_total{status=\"i2c_error\"} 0"), "Zero counters are exported");
+    TEST_ASSERT(has_line("led_frames_total 1"), "LED frame counter");
+    TEST_ASSERT(has_line("http_responses_total{code=\"2xx\"} 2"), "2xx responses");
+    TEST_ASSERT(has_line("http_responses_total{code=\"4xx\"} 1"), "4xx responses");
+}
+
+// Test 2: Gauges, including values not known yet
+void test_gauges() {
+    printf("\nTest: Gauges\n");
+    metrics_reset();
+    export_all(sizeof(s_out) - 1);
+    TEST_ASSERT(has_line("dht_humidity_percent NaN"), "Unset gauge is NaN");
+
+    metrics_set_gauge(METRIC_HUMIDITY, 45.25f);
+    metrics_set_gauge(METRIC_TEMP_C, -3.5f);
+    export_all(sizeof(s_out) - 1);
+    TEST_ASSERT(has_line("dht_humidity_percent 45.25"), "Humidity gauge");
+    TEST_ASSERT(has_line("dht_temperature_celsius -3.50"), "Negative gauge");
+
+    // A refresh's CPU time is well under the default two decimals
+    metrics_set_gauge(METRIC_I2C_LCD_CPU_S, 0.000125f);
+    export_all(sizeof(s_out) - 1);
+    TEST_ASSERT(has_line("i2c_cpu_seconds_total{device=\"lcd\"} 0.000125"),
+                "I2C times to the microsecond");
+}
+
+// Test 3: Histogram buckets
+void test_histogram() {
+    printf("\nTest: Histogram\n");
+    metrics_reset();
+    metrics_observe(METRIC_TIME_DHT_READ, 100);       // Exactly on a bound
+    metrics_observe(METRIC_TIME_DHT_READ, 101000);    // 0.25 s bucket
+    metrics_observe(METRIC_TIME_DHT_READ, 9000000);   // Above every bound
+    metrics_observe(METRIC_TIME_HTTP, 1500);
+    metrics_observe(METRIC_TIME_WORKER_WIFI, 2000000);
+    export_all(sizeof(s_out) - 1);
+
+    TEST_ASSERT(has_line("# TYPE subsystem_duration_seconds histogram"), "TYPE line");
+    TEST_ASSERT(has_line("subsystem_duration_seconds_bucket{subsystem=\"dht_read\",le=\"0.0001\"} 1"),
+                "Bounds are inclusive");
+    TEST_ASSERT(has_line("subsystem_duration_seconds_bucket{subsystem=\"dht_read\",le=\"0.1\"} 1"),
+                "Buckets below a value don't count it");
+    TEST_ASSERT(has_line("subsystem_duration_seconds_bucket{subsystem=\"dht_read\",le=\"0.25\"} 2"),
+                "Buckets are cumulative");
+    TEST_ASSERT(has_line("subsystem_duration_seconds_bucket{subsystem=\"dht_read\",le=\"2.5\"} 2"),
+                "Largest bound");
+    TEST_ASSERT(has_line("subsystem_duration_seconds_bucket{subsystem=\"dht_read\",le=\"+Inf\"} 3"),
+                "+Inf counts everything");
+    TEST_ASSERT(has_line("subsystem_duration_seconds_sum{subsystem=\"dht_read\"} 9.101100"), "Sum in seconds");
+    TEST_ASSERT(has_line("subsystem_duration_seconds_count{subsystem=\"dht_read\"} 3"), "Count");
+    TEST_ASSERT(has_line("subsystem_duration_seconds_count{subsystem=\"led_show\"} 0"), "Unused series");
+    TEST_ASSERT(has_line("http_request_duration_seconds_bucket{le=\"0.0025\"} 1"), "Unlabelled histogram");
+    TEST_ASSERT(has_line("http_request_duration_seconds_count 1"), "Unlabelled count");
+    TEST_ASSERT(has_line("worker_run_duration_seconds_sum{worker=\"wifi_service\"} 2.000000"),
+                "Last worker series");
+}
+
+// Test 4: Memory pool usage
+void test_pools() {
+    printf("\nTest: Pools\n");
+    metrics_reset();
+    metrics_pool pools[] = {
+        { "HEAP", 1200, 2900, 4000, 0 },
+        { "TCP_PCB", 3, 5, 8, 2 },
+    };
+    metrics_set_pools(pools, 2);
+    export_all(sizeof(s_out) - 1);
+    TEST_ASSERT(has_line("lwip_pool_used{pool=\"HEAP\"} 1200"), "Heap usage");
+    TEST_ASSERT(has_line("lwip_pool_max_used{pool=\"TCP_PCB\"} 5"), "Pool high-water mark");
+    TEST_ASSERT(has_line("lwip_pool_size{pool=\"TCP_PCB\"} 8"), "Pool size");
+    TEST_ASSERT(has_line("lwip_pool_errors_total{pool=\"TCP_PCB\"} 2"), "Pool errors");
+
+    metrics_set_pools(NULL, 0);
+    export_all(sizeof(s_out) - 1);
+    TEST_ASSERT(has_line("# TYPE lwip_pool_used gauge") && strstr(s_out, "lwip_pool_used{") == NULL,
+                "No pools gives an empty family");
+}
+
+// Test 5: Small pieces give the same text as one export
+void test_small_pieces() {
+    printf("\nTest: Small Pieces\n");
+    metrics_reset();
+    metrics_observe(METRIC_TIME_DISPLAY, 123456);
+    metrics_count(METRIC_LCD_FRAMES);
+
+    static char whole[32768];
+    size_t whole_len = export_all(sizeof(s_out) - 1);
+    memcpy(whole, s_out, whole_len + 1);
+    size_t piece_len = export_all(METRICS_LINE_MAX);
+    TEST_ASSERT(piece_len == whole_len && memcmp(whole, s_out, whole_len) == 0,
+                "Line-sized pieces match a single export");
+
+    // Every line is shorter than the minimum piece size and ends with a newline
+    bool lines_ok = whole_len > 0 && whole[whole_len - 1] == '\n';
+    const char *line = whole;
+    const char *nl;
+    while ((nl = strchr(line, '\n')) != NULL) {
+        lines_ok = lines_ok && (size_t)(nl - line) + 1 < METRICS_LINE_MAX;
+        line = nl + 1;
+    }
+    TEST_ASSERT(lines_ok, "All lines fit METRICS_LINE_MAX");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Metrics Host Test Suite\n");
+    printf("========================================\n");
+
+    test_counters();
+    test_gauges();
+    test_histogram();
+    test_pools();
+    test_small_pieces();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+/*
+File: test_mqtt_session.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the MQTT outbox in mqtt_session.c.
+Responsibilities:
+- Test message order, acknowledgement and retry after a lost connection
+- Test that unsent values are replaced per topic and the outbox stays bounded
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "mqtt_session.h"
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+static void put_str(mqtt_outbox *box, const char *topic, const char *payload, uint8_t qos) {
+    mqtt_outbox_put(box, topic, payload, strlen(payload), qos, true);
+}
+
+// Test 1: Messages go out in order and leave once acknowledged
+void test_send_and_ack() {
+    printf("\nTest: Send and Acknowledge\n");
+    mqtt_outbox box;
+    mqtt_outbox_init(&box);
+    put_str(&box, "pico/humidity", "45.2", 1);
+    put_str(&box, "pico/temperature", "21.5", 1);
+
+    mqtt_message *m = mqtt_outbox_next(&box);
+    TEST_ASSERT(m && strcmp(m->topic, "pico/humidity") == 0, "Oldest message first");
+    TEST_ASSERT(m && m->len == 4 && memcmp(m->payload, "45.2", 4) == 0 && m->retain && m->qos == 1,
+                "Payload and flags kept");
+    uint32_t first = m->id;
+    m->in_flight = true;
+
+    m = mqtt_outbox_next(&box);
+    TEST_ASSERT(m && strcmp(m->topic, "pico/temperature") == 0, "In-flight messages are skipped");
+    uint32_t second = m->id;
+    m->in_flight = true;
+    TEST_ASSERT(mqtt_outbox_next(&box) == NULL, "Nothing left to send");
+
+    mqtt_outbox_done(&box, first);
+    TEST_ASSERT(mqtt_outbox_count(&box) == 1, "Acknowledged message removed");
+    mqtt_outbox_done(&box, first);
+    mqtt_outbox_done(&box, 12345);
+    TEST_ASSERT(mqtt_outbox_count(&box) == 1, "Duplicate and unknown acknowledgements ignored");
+
+    mqtt_outbox_retry(&box, second);
+    m = mqtt_outbox_next(&box);
+    TEST_ASSERT(m && m->id == second, "Failed publish is offered again");
+}
+
+// Test 2: A lost connection puts every in-flight message back in line
+void test_retry_all() {
+    printf("\nTest: Retry After Disconnect\n");
+    mqtt_outbox box;
+    mqtt_outbox_init(&box);
+    put_str(&box, "a", "1", 1);
+    put_str(&box, "b", "2", 1);
+    put_str(&box, "c", "3", 1);
+
+    mqtt_message *m;
+    while ((m = mqtt_outbox_next(&box)) != NULL) {
+        m->in_flight = true;
+    }
+    mqtt_outbox_retry_all(&box);
+
+    m = mqtt_outbox_next(&box);
+    TEST_ASSERT(m && strcmp(m->topic, "a") == 0, "Original order kept after reconnect");
+    TEST_ASSERT(mqtt_outbox_count(&box) == 3, "No message lost");
+
+    // A new value for "a" while the old one is in flight is queued separately
+    m->in_flight = true;
+    put_str(&box, "a", "4", 1);
+    TEST_ASSERT(mqtt_outbox_count(&box) == 4, "In-flight message is not replaced");
+}
+
+// Test 3: Unsent values are replaced and a full outbox drops the oldest
+void test_bounded() {
+    printf("\nTest: Bounded Outbox\n");
+    mqtt_outbox box;
+    mqtt_outbox_init(&box);
+
+    // A broker outage: many samples for the same three topics
+    char value[8];
+    for (int i = 0; i < 50; i++) {
+        snprintf(value, sizeof(value), "%d", i);
+        put_str(&box, "pico/readings", value, 1);
+        put_str(&box, "pico/humidity", value, 1);
+        put_str(&box, "pico/temperature", value, 0);
+    }
+    TEST_ASSERT(mqtt_outbox_count(&box) == 3 && box.dropped == 0, "One message per topic kept");
+    mqtt_message *m = mqtt_outbox_next(&box);
+    TEST_ASSERT(m && m->len == 2 && memcmp(m->payload, "49", 2) == 0, "Newest value kept");
+
+    // Distinct topics beyond the capacity push out the oldest
+    mqtt_outbox_init(&box);
+    char topic[16];
+    for (int i = 0; i < MQTT_OUTBOX_LEN + 3; i++) {
+        snprintf(topic, sizeof(topic), "t%d", i);
+        put_str(&box, topic, "x", 1);
+    }
+    m = mqtt_outbox_next(&box);
+    TEST_ASSERT(mqtt_outbox_count(&box) == MQTT_OUTBOX_LEN && box.dropped == 3, "Outbox is bounded");
+    TEST_ASSERT(m && strcmp(m->topic, "t3") == 0, "Oldest messages dropped first");
+
+    uint8_t big[MQTT_PAYLOAD_MAX + 1] = { 0 };
+    TEST_ASSERT(!mqtt_outbox_put(&box, "big", big, sizeof(big), 1, true), "Oversized payload rejected");
+    TEST_ASSERT(mqtt_outbox_put(&box, "big", big, MQTT_PAYLOAD_MAX, 1, true), "Largest payload accepted");
+
+    char long_topic[MQTT_TOPIC_MAX + 10];
+    memset(long_topic, 'x', sizeof(long_topic) - 1);
+    long_topic[sizeof(long_topic) - 1] = '\0';
+    mqtt_outbox_init(&box);
+    put_str(&box, long_topic, "1", 0);
+    m = mqtt_outbox_next(&box);
+    TEST_ASSERT(m && strlen(m->topic) == MQTT_TOPIC_MAX - 1, "Long topic truncated");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("MQTT Session Host Test Suite\n");
+    printf("========================================\n");
+
+    test_send_and_ack();
+    test_retry_all();
+    test_bounded();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
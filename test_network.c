@@ -0,0 +1,399 @@
+/*
+File: test_network.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host tests of network.c's web server, run unchanged on the
+    host build's TCP (hal_tcp_linux.c) with virtual clients and virtual
+    time (sim_network.h). Every event reaches network.c through hal_tcp
+    the way lwIP delivers it on the Pico: http_accept, http_recv,
+    http_sent, http_poll and http_err are the real callbacks, and
+    http_connection_close() the real close path.
+Responsibilities:
+- Test a plain request, keep-alive and the idle timeout
+- Test that a streamed response waits for the client's window and finishes
+- Test the 503 answer when every client slot is busy
+- Test that failing closes are retried from the poll and then aborted
+- Soak test: drive random clients through requests, stalls, resets,
+  half-closes, close failures and idle timeouts, then check that no
+  connection slot, TCP connection or buffer leaked and nothing touched a
+  freed connection
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+The soak test runs SOAK_STEPS steps; pass a larger number as the first
+argument for a longer run, e.g. ./test_network 1000000
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "network.h"
+#include "metrics.h"
+#include "history.h"
+#include "snapshot.h"
+#include "sensor.h"
+#include "sim_network.h"
+#include "hal.h"
+
+#define SOAK_STEPS    20000
+#define SOAK_CLIENTS  8        // Clients alive at once; more than HTTP_MAX_CLIENTS
+#define HTTP_PORT     80
+#define DRAIN_MS      (5 * 60 * 1000)   // Past every idle timeout and unanswered close
+
+// Defined by main.c in the firmware
+snapshot_seqlock g_latest;
+volatile uint32_t g_sample_interval_ms = 2000;
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+static const char GET_READINGS[] = "GET /api/v1/readings HTTP/1.1\r\nHost: pico\r\n\r\n";
+static const char GET_READINGS_CLOSE[] =
+    "GET /api/v1/readings HTTP/1.1\r\nHost: pico\r\nConnection: close\r\n\r\n";
+static const char GET_HISTORY[] = "GET /api/v1/history?format=csv HTTP/1.1\r\nHost: pico\r\n\r\n";
+
+// Publish a reading as main.c does for each sample
+static void publish(float humidity) {
+    static reading_snapshot latest = { .status = DHT_STATUS_OK };
+    latest.seq++;
+    latest.sample_ms = hal_time_ms() ? hal_time_ms() : 1;
+    latest.humidity = humidity;
+    latest.temp_c = 21.5f;
+    latest.temp_f = 70.7f;
+    snapshot_publish(&g_latest, &latest);
+    web_server_publish_reading();
+}
+
+// Everything a client has received so far, appended to buf (NUL-terminated)
+static size_t read_all(int id, char *buf, size_t size, size_t len) {
+    len += sim_tcp_read(id, buf + len, size - 1 - len);
+    buf[len] = '\0';
+    return len;
+}
+
+// Count the occurrences of needle in haystack
+static int count_of(const char *haystack, const char *needle) {
+    int n = 0;
+    for (const char *p = strstr(haystack, needle); p; p = strstr(p + 1, needle)) {
+        n++;
+    }
+    return n;
+}
+
+// Connections and buffers the stack hands out, all back to what they were
+static bool stack_idle(void) {
+    return sim_network_tcp_conns() == 0 && sim_network_tcp_buffers() == 0;
+}
+
+// GET the readings on a fresh client; true if it answered 200
+static bool get_readings_ok(void) {
+    static char buf[8192];
+    int id = sim_tcp_connect(HTTP_PORT);
+    sim_tcp_send(id, GET_READINGS_CLOSE, sizeof(GET_READINGS_CLOSE) - 1);
+    sim_network_run(10);
+    read_all(id, buf, sizeof(buf), 0);
+    sim_tcp_close(id);
+    sim_network_run(10);
+    sim_tcp_release(id);
+    return strncmp(buf, "HTTP/1.1 200", 12) == 0;
+}
+
+// Test 1: A request is answered, the connection stays open and closes when idle
+void test_request() {
+    printf("\nTest: Request and idle timeout\n");
+    static char buf[8192];
+    int id = sim_tcp_connect(HTTP_PORT);
+    sim_tcp_send(id, GET_READINGS, sizeof(GET_READINGS) - 1);
+    sim_network_run(10);
+    size_t len = read_all(id, buf, sizeof(buf), 0);
+    TEST_ASSERT(strncmp(buf, "HTTP/1.1 200 OK", 15) == 0 && strstr(buf, "\"humidity\":48.5"),
+                "GET /api/v1/readings answered with the published reading");
+    TEST_ASSERT(sim_tcp_get_state(id) == SIM_TCP_OPEN && web_server_client_count() == 1,
+                "Keep-alive connection stays open");
+
+    sim_tcp_send(id, GET_READINGS, sizeof(GET_READINGS) - 1);
+    sim_network_run(10);
+    len = read_all(id, buf, sizeof(buf), len);
+    TEST_ASSERT(count_of(buf, "HTTP/1.1 200 OK") == 2, "Second request on the same connection");
+
+    sim_network_run(20000);
+    TEST_ASSERT(sim_tcp_get_state(id) == SIM_TCP_PEER_CLOSED && web_server_client_count() == 0,
+                "Idle connection closed by the server after its timeout");
+    sim_tcp_close(id);
+    sim_network_run(DRAIN_MS);
+    sim_tcp_release(id);
+    TEST_ASSERT(stack_idle(), "Connection, segments and received data all freed");
+}
+
+// Test 2: A streamed response waits for the client's window, then finishes
+void test_backpressure() {
+    printf("\nTest: Streaming backpressure\n");
+    static char buf[65536];
+    for (int i = 0; i < 400; i++) {
+        publish(40.0f + (float)(i % 20));
+        history_add(hal_time_ms(), 40.0f + (float)(i % 20), 21.0f);
+        hal_advance_us(2000000);
+    }
+
+    int id = sim_tcp_connect(HTTP_PORT);
+    sim_tcp_set_window(id, 0);
+    sim_tcp_send(id, GET_HISTORY, sizeof(GET_HISTORY) - 1);
+    sim_network_run(3000);
+    TEST_ASSERT(sim_tcp_unread(id) == 0 && web_server_client_count() == 1,
+                "Nothing sent while the client's window is shut");
+
+    sim_tcp_set_window(id, 512);
+    size_t len = 0;
+    for (int i = 0; i < 2000 && !strstr(buf, "\r\n0\r\n\r\n"); i++) {
+        sim_network_run(5);
+        len = read_all(id, buf, sizeof(buf), len);
+    }
+    TEST_ASSERT(strstr(buf, "Transfer-Encoding: chunked") && strstr(buf, "\r\n0\r\n\r\n"),
+                "Chunked export finished through a 512-byte window");
+    TEST_ASSERT(count_of(buf, "\n") > 400, "Every sample was streamed");
+
+    sim_tcp_close(id);
+    sim_network_run(DRAIN_MS);
+    sim_tcp_release(id);
+    TEST_ASSERT(stack_idle(), "Connection, segments and received data all freed");
+}
+
+// Test 3: With every slot busy the next client is turned away with 503
+void test_full() {
+    printf("\nTest: Every slot busy\n");
+    static char buf[8192];
+    int ids[HTTP_MAX_CLIENTS];
+    for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+        ids[i] = sim_tcp_connect(HTTP_PORT);
+        sim_tcp_set_window(ids[i], 0);
+        sim_tcp_send(ids[i], GET_HISTORY, sizeof(GET_HISTORY) - 1);   // Busy writing
+    }
+    sim_network_run(10);
+    uint32_t rejected = g_metric_counters[METRIC_HTTP_REJECTED];
+    int extra = sim_tcp_connect(HTTP_PORT);
+    sim_network_run(10);
+    read_all(extra, buf, sizeof(buf), 0);
+    TEST_ASSERT(strncmp(buf, "HTTP/1.1 503", 12) == 0 && strstr(buf, "Retry-After:"),
+                "Extra client answered with 503 and Retry-After");
+    TEST_ASSERT(g_metric_counters[METRIC_HTTP_REJECTED] == rejected + 1, "Rejection counted");
+
+    sim_tcp_release(extra);
+    for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+        sim_tcp_release(ids[i]);
+    }
+    sim_network_run(DRAIN_MS);
+    TEST_ASSERT(web_server_client_count() == 0 && stack_idle(), "Resets freed every slot and connection");
+}
+
+// Test 4: A close that the stack refuses is retried from the poll, then aborted
+void test_close_failures() {
+    printf("\nTest: Close failures\n");
+    static char buf[8192];
+
+    // One failure: the poll retries and the close goes through
+    int id = sim_tcp_connect(HTTP_PORT);
+    sim_tcp_fail_closes(1);
+    sim_tcp_send(id, GET_READINGS_CLOSE, sizeof(GET_READINGS_CLOSE) - 1);
+    sim_network_run(3000);
+    read_all(id, buf, sizeof(buf), 0);
+    TEST_ASSERT(strncmp(buf, "HTTP/1.1 200", 12) == 0 &&
+                sim_tcp_get_state(id) == SIM_TCP_PEER_CLOSED,
+                "Response delivered and the retried close sent FIN");
+    sim_tcp_close(id);
+    sim_network_run(10);
+    sim_tcp_release(id);
+
+    // Every close fails: the connection is aborted rather than leaked
+    uint32_t aborted = g_metric_counters[METRIC_HTTP_ABORTED];
+    id = sim_tcp_connect(HTTP_PORT);
+    sim_tcp_fail_closes(100);
+    sim_tcp_send(id, GET_READINGS_CLOSE, sizeof(GET_READINGS_CLOSE) - 1);
+    sim_network_run(30000);
+    sim_tcp_fail_closes(0);
+    TEST_ASSERT(sim_tcp_get_state(id) == SIM_TCP_RESET &&
+                g_metric_counters[METRIC_HTTP_ABORTED] == aborted + 1,
+                "Connection aborted after the close kept failing");
+    sim_tcp_release(id);
+    sim_network_run(DRAIN_MS);
+    TEST_ASSERT(web_server_client_count() == 0 && stack_idle(), "Slot and connection freed");
+}
+
+// Small deterministic generator so a failing soak run can be repeated
+static uint32_t s_rng = 12345;
+static uint32_t next_random(void) {
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return s_rng >> 8;
+}
+
+// Requests a soak client sends: whole, pipelined, split, streamed, upgraded or malformed
+static const char *const SOAK_REQUESTS[] = {
+    "GET /api/v1/readings HTTP/1.1\r\nHost: pico\r\n\r\n",
+    "GET /api/v1/readings HTTP/1.1\r\nHost: pico\r\nConnection: close\r\n\r\n",
+    "GET /api/v1/readings HTTP/1.1\r\nHost: pico\r\n\r\nGET /metrics HTTP/1.1\r\nHost: pico\r\n\r\n",
+    "GET /api/v1/history?format=csv HTTP/1.1\r\nHost: pico\r\n\r\n",
+    "GET /api/v1/history?format=csv HTTP/1.0\r\n\r\n",
+    "GET / HTTP/1.1\r\nHost: pico\r\nAccept-Encoding: gzip\r\n\r\n",
+    "GET /events HTTP/1.1\r\nHost: pico\r\n\r\n",
+    "GET /ws HTTP/1.1\r\nHost: pico\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n",
+    "GET /api/v1/readings HTTP/1.1\r\nHost: pi",
+    "co\r\n\r\n",
+    "BREW /coffee HTCPCP/1.0\r\n\r\n",
+    "GET /nowhere HTTP/1.1\r\nHost: pico\r\n\r\n",
+};
+
+#define SOAK_REQUEST_COUNT (sizeof(SOAK_REQUESTS) / sizeof(SOAK_REQUESTS[0]))
+
+// Test 5: Soak test. Each step is one thing a client or the network does to
+// a random connection, followed by a little time passing.
+void test_soak(long steps) {
+    printf("\nTest: Soak (%ld steps)\n", steps);
+    int ids[SOAK_CLIENTS];
+    for (int i = 0; i < SOAK_CLIENTS; i++) {
+        ids[i] = -1;
+    }
+    uint32_t errors = g_metric_counters[METRIC_HTTP_CONN_ERRORS];
+    uint32_t aborted = g_metric_counters[METRIC_HTTP_ABORTED];
+    uint32_t rejected = g_metric_counters[METRIC_HTTP_REJECTED];
+    uint32_t answered = g_metric_counters[METRIC_HTTP_2XX];
+    long opened = 0;
+    bool bounded = true;
+
+    for (long step = 0; step < steps; step++) {
+        uint32_t r = next_random();
+        int *id = &ids[r % SOAK_CLIENTS];
+        if (*id < 0) {
+            *id = sim_tcp_connect(HTTP_PORT);
+            opened++;
+            continue;
+        }
+
+        switch ((r >> 4) % 16) {
+            case 0: case 1: case 2: case 3: {
+                const char *request = SOAK_REQUESTS[(r >> 8) % SOAK_REQUEST_COUNT];
+                sim_tcp_send(*id, request, strlen(request));
+                break;
+            }
+            case 4: case 5: case 6:
+                sim_tcp_read(*id, NULL, SIZE_MAX);
+                break;
+            case 7:
+                sim_tcp_set_window(*id, (r & 0x100) ? 0 : SIM_TCP_DEFAULT_WINDOW);
+                break;
+            case 8:
+                sim_tcp_set_acking(*id, (r & 0x100) != 0);
+                break;
+            case 9:
+                sim_tcp_close(*id);
+                break;
+            case 10:
+                sim_tcp_reset(*id);
+                break;
+            case 11:
+                sim_tcp_fail_closes((r >> 8) % 8);
+                break;
+            case 12:
+                publish(30.0f + (float)((r >> 8) % 500) / 10.0f);
+                break;
+            case 13:
+                // Let the idle timeouts and close retries run
+                sim_network_run((r >> 8) % 20000);
+                break;
+            default:
+                break;
+        }
+        sim_network_run((r >> 12) % 50);
+
+        // Clients the server or the network has finished with are forgotten
+        sim_tcp_state state = sim_tcp_get_state(*id);
+        if (state == SIM_TCP_RESET || state == SIM_TCP_CLOSED ||
+            (state == SIM_TCP_PEER_CLOSED && (r & 0x10000))) {
+            sim_tcp_release(*id);
+            *id = -1;
+        }
+        bounded &= web_server_client_count() <= HTTP_MAX_CLIENTS;
+    }
+
+    // Drain: every client reads what is left and closes; the stack's timers finish the rest
+    sim_tcp_fail_closes(0);
+    for (int i = 0; i < SOAK_CLIENTS; i++) {
+        if (ids[i] < 0) continue;
+        sim_tcp_set_acking(ids[i], true);
+        sim_tcp_set_window(ids[i], SIM_TCP_DEFAULT_WINDOW);
+        sim_tcp_close(ids[i]);
+    }
+    for (int round = 0; round < 200; round++) {
+        sim_network_run(100);
+        for (int i = 0; i < SOAK_CLIENTS; i++) {
+            if (ids[i] >= 0) sim_tcp_read(ids[i], NULL, SIZE_MAX);
+        }
+    }
+    for (int i = 0; i < SOAK_CLIENTS; i++) {
+        if (ids[i] >= 0) sim_tcp_release(ids[i]);
+    }
+    sim_network_run(DRAIN_MS);
+
+    printf("    opened %ld, answered %lu, errored %lu, aborted %lu, rejected %lu\n", opened,
+           (unsigned long)(g_metric_counters[METRIC_HTTP_2XX] - answered),
+           (unsigned long)(g_metric_counters[METRIC_HTTP_CONN_ERRORS] - errors),
+           (unsigned long)(g_metric_counters[METRIC_HTTP_ABORTED] - aborted),
+           (unsigned long)(g_metric_counters[METRIC_HTTP_REJECTED] - rejected));
+    TEST_ASSERT(bounded, "Never more connections than client slots");
+    TEST_ASSERT(g_metric_counters[METRIC_HTTP_CONN_ERRORS] > errors &&
+                g_metric_counters[METRIC_HTTP_ABORTED] > aborted &&
+                g_metric_counters[METRIC_HTTP_REJECTED] > rejected,
+                "Soak covered TCP errors, aborts and refusals");
+    TEST_ASSERT(sim_network_stale_calls() == 0, "No call on a freed connection");
+    TEST_ASSERT(web_server_client_count() == 0 && stack_idle(),
+                "No slot, connection or buffer leaked");
+    bool all_served = true;
+    for (int i = 0; i < HTTP_MAX_CLIENTS + 1; i++) {
+        all_served &= get_readings_ok();
+    }
+    TEST_ASSERT(all_served, "Every slot serves requests again");
+}
+
+int main(int argc, char **argv) {
+    printf("========================================\n");
+    printf("Network Host Test Suite\n");
+    printf("========================================\n");
+
+    long steps = (argc > 1) ? strtol(argv[1], NULL, 10) : SOAK_STEPS;
+
+    // The firmware's start-up, on virtual clients and virtual time
+    hal_use_virtual_time();
+    sim_network_use_virtual();
+    const reading_snapshot none = { .status = DHT_STATUS_BUSY };
+    snapshot_init(&g_latest, &none);
+    if (!wifi_start_ap("PICO2W-AP", "capstone467") || !web_server_start(HTTP_PORT)) {
+        printf("ERROR: Failed to start the web server\n");
+        return 1;
+    }
+    publish(48.5f);
+
+    test_request();
+    test_backpressure();
+    test_full();
+    test_close_failures();
+    test_soak(steps > 0 ? steps : SOAK_STEPS);
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
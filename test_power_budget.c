@@ -0,0 +1,96 @@
+/*
+File: test_power_budget.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the power state policy and accounting in power_budget.c.
+Responsibilities:
+- Test the clock state chosen for WiFi and non-WiFi builds
+- Test time-in-state accounting, including the current stay
+- Test the time-weighted current estimate
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "power_budget.h"
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+// Test 1: Clock state policy
+void test_policy() {
+    printf("\nTest: Policy\n");
+    TEST_ASSERT(power_policy_state(true, true, true) == POWER_FULL, "WiFi with a client runs at full speed");
+    TEST_ASSERT(power_policy_state(true, true, false) == POWER_REDUCED, "WiFi without clients is reduced");
+    TEST_ASSERT(power_policy_state(true, false, false) == POWER_REDUCED, "WiFi never turns the PLL off");
+    TEST_ASSERT(power_policy_state(false, true, false) == POWER_FULL, "Non-WiFi work runs at full speed");
+    TEST_ASSERT(power_policy_state(false, false, false) == POWER_XOSC, "Non-WiFi idle runs from the crystal");
+    TEST_ASSERT(strcmp(power_state_name(POWER_XOSC), "xosc") == 0, "State names");
+}
+
+// Test 2: Time in each state
+void test_accounting() {
+    printf("\nTest: Time in State\n");
+    power_budget budget;
+    power_budget_init(&budget, POWER_FULL, 1000);
+
+    power_budget_enter(&budget, POWER_XOSC, 1500);      // 500 us full
+    power_budget_enter(&budget, POWER_XOSC, 1700);      // Same state: no change
+    power_budget_enter(&budget, POWER_FULL, 3500);      // 2000 us xosc
+    power_budget_enter(&budget, POWER_XOSC, 3600);      // 100 us full
+
+    TEST_ASSERT(budget.transitions == 3, "Only real changes are counted");
+    TEST_ASSERT(power_budget_time_us(&budget, POWER_FULL, 4000) == 600, "Completed full time");
+    TEST_ASSERT(power_budget_time_us(&budget, POWER_XOSC, 4000) == 2400, "Current stay included");
+    TEST_ASSERT(power_budget_time_us(&budget, POWER_REDUCED, 4000) == 0, "Unused state");
+}
+
+// Test 3: Average current
+void test_average() {
+    printf("\nTest: Average Current\n");
+    const float current_ma[POWER_STATE_COUNT] = { 20.0f, 10.0f, 4.0f };
+    power_budget budget;
+    power_budget_init(&budget, POWER_REDUCED, 0);
+    TEST_ASSERT(power_budget_average_ma(&budget, current_ma, 0) == 10.0f, "No time yet gives the current state");
+
+    power_budget_enter(&budget, POWER_FULL, 0);
+    power_budget_enter(&budget, POWER_XOSC, 1000000);   // 1 s at 20 mA, then 3 s at 4 mA
+    float average = power_budget_average_ma(&budget, current_ma, 4000000);
+    TEST_ASSERT(fabsf(average - 8.0f) < 0.001f, "Weighted by time");
+
+    // An hour at 1 us resolution keeps its precision
+    power_budget_enter(&budget, POWER_FULL, 3600000000ull);
+    average = power_budget_average_ma(&budget, current_ma, 3600000001ull);
+    TEST_ASSERT(fabsf(average - 4.0f) < 0.01f, "Long runs stay accurate");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Power Budget Host Test Suite\n");
+    printf("========================================\n");
+
+    test_policy();
+    test_accounting();
+    test_average();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,143 @@
+/*
+File: test_sample_ring.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the core 1 to core 0 sample ring in sample_ring.c.
+Responsibilities:
+- Test first-in first-out order and wrap-around
+- Test that a full ring drops and counts new samples
+- Test a producer and a consumer thread running concurrently, standing in
+  for the two cores
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+#include "sample_ring.h"
+
+#define THREAD_SAMPLES 1000000
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+// Test 1: Samples come out in order, across the end of the buffer
+void test_order() {
+    printf("\nTest: Order and Wrap-Around\n");
+    static sample_ring ring;
+    sample_ring_init(&ring);
+    ring_sample out;
+
+    TEST_ASSERT(!sample_ring_pop(&ring, &out), "New ring is empty");
+
+    bool in_order = true;
+    uint32_t next_seq = 1;
+    for (uint32_t seq = 1; seq <= 3 * SAMPLE_RING_SIZE; seq++) {
+        ring_sample s = { .seq = seq, .humidity = (float)seq / 2.0f, .status = 0 };
+        in_order &= sample_ring_push(&ring, &s);
+        // Read every other step so the indices wrap while the ring is partly full
+        if (seq % 2 == 0) {
+            while (sample_ring_pop(&ring, &out)) {
+                in_order &= out.seq == next_seq && out.humidity == (float)next_seq / 2.0f;
+                next_seq++;
+            }
+        }
+    }
+    TEST_ASSERT(in_order && next_seq == 3 * SAMPLE_RING_SIZE + 1, "FIFO order across wrap-around");
+    TEST_ASSERT(!sample_ring_pop(&ring, &out) && ring.dropped == 0, "Empty again, nothing dropped");
+}
+
+// Test 2: A full ring keeps the oldest samples
+void test_full() {
+    printf("\nTest: Full Ring\n");
+    static sample_ring ring;
+    sample_ring_init(&ring);
+
+    int accepted = 0;
+    for (uint32_t seq = 1; seq <= SAMPLE_RING_SIZE + 2; seq++) {
+        ring_sample s = { .seq = seq };
+        accepted += sample_ring_push(&ring, &s);
+    }
+    TEST_ASSERT(accepted == SAMPLE_RING_SIZE - 1, "Ring holds SAMPLE_RING_SIZE - 1 samples");
+    TEST_ASSERT(ring.dropped == 3, "Rejected samples are counted");
+
+    ring_sample out;
+    TEST_ASSERT(sample_ring_pop(&ring, &out) && out.seq == 1, "Oldest sample kept");
+    ring_sample s = { .seq = 99 };
+    TEST_ASSERT(sample_ring_push(&ring, &s), "Room again after a pop");
+}
+
+// Test 3: One producer and one consumer thread, like the two cores
+static sample_ring s_shared;
+
+static void *producer(void *arg) {
+    (void)arg;
+    for (uint32_t seq = 1; seq <= THREAD_SAMPLES; ) {
+        // Every field is derived from seq so a torn slot would be noticed
+        ring_sample s = { .seq = seq, .sample_ms = seq * 3u, .produced_us = ~seq,
+                          .humidity = (float)(seq & 0xFFFF), .status = (uint8_t)seq };
+        if (sample_ring_push(&s_shared, &s)) {
+            seq++;
+        } else {
+            sched_yield();   // Let the consumer run on a single-CPU machine
+        }
+    }
+    return NULL;
+}
+
+void test_threads() {
+    printf("\nTest: Concurrent Producer and Consumer\n");
+    sample_ring_init(&s_shared);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, producer, NULL);
+
+    uint32_t expected = 1;
+    bool intact = true;
+    while (expected <= THREAD_SAMPLES) {
+        ring_sample s;
+        if (!sample_ring_pop(&s_shared, &s)) {
+            sched_yield();
+            continue;
+        }
+        intact &= s.seq == expected && s.sample_ms == expected * 3u && s.produced_us == ~expected &&
+                  s.humidity == (float)(expected & 0xFFFF) && s.status == (uint8_t)expected;
+        expected++;
+    }
+    pthread_join(thread, NULL);
+
+    TEST_ASSERT(intact, "Every sample arrived whole and in order");
+    ring_sample s;
+    TEST_ASSERT(!sample_ring_pop(&s_shared, &s), "Nothing left over");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Sample Ring Host Test Suite\n");
+    printf("========================================\n");
+
+    test_order();
+    test_full();
+    test_threads();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,161 @@
+/*
+File: test_sim_devices.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the simulated peripherals in sim_devices.c.
+Responsibilities:
+- Test DHT20 measurements: busy until ready, CRC, and encoded values
+- Test the HD44780 4-bit initialization, characters and cursor moves
+- Test busy violations on the LCD and frames on the WS2812 strip
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "sim_devices.h"
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+#define LCD_RS        0x01
+#define LCD_E         0x04
+#define LCD_BACKLIGHT 0x08
+
+static uint8_t crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Pulse one nibble into the LCD the way display.c does: E high, then E low
+static void lcd_nibble(sim_board *board, uint8_t nibble, uint8_t rs, uint32_t now_us) {
+    uint8_t port = (uint8_t)((nibble << 4) | LCD_BACKLIGHT | rs);
+    uint8_t bytes[3] = { port, (uint8_t)(port | LCD_E), port };
+    sim_board_i2c_write(board, SIM_LCD_ADDR, bytes, sizeof(bytes), now_us);
+}
+
+static void lcd_byte(sim_board *board, uint8_t value, uint8_t rs, uint32_t now_us) {
+    lcd_nibble(board, value >> 4, rs, now_us);
+    lcd_nibble(board, value & 0x0F, rs, now_us);
+}
+
+// Test 1: A measurement reads busy until it is ready, then decodes to the set values
+void test_dht20() {
+    printf("\nTest: DHT20 Measurement\n");
+    static sim_board board;
+    sim_board_init(&board, 62.5f, 24.0f);
+
+    const uint8_t trigger[3] = { 0xAC, 0x33, 0x00 };
+    uint8_t data[7];
+    TEST_ASSERT(sim_board_i2c_write(&board, SIM_DHT20_ADDR, trigger, 3, 1000) == 3, "Trigger accepted");
+    TEST_ASSERT(board.dht20.triggers == 1, "Trigger counted");
+
+    sim_board_i2c_read(&board, SIM_DHT20_ADDR, data, 7, 1000 + SIM_DHT20_MEASURE_US / 2);
+    TEST_ASSERT(data[0] & 0x80, "Busy before the measurement is done");
+    TEST_ASSERT(board.dht20.early_reads == 1, "Early read counted");
+
+    sim_board_i2c_read(&board, SIM_DHT20_ADDR, data, 7, 1000 + SIM_DHT20_MEASURE_US);
+    TEST_ASSERT(data[0] == 0x18, "Ready and calibrated afterwards");
+    TEST_ASSERT(data[6] == crc8(data, 6), "CRC matches");
+
+    // Same conversion as sensor.c
+    uint32_t hum = ((uint32_t)data[1] << 12) | ((uint32_t)data[2] << 4) | (data[3] >> 4);
+    uint32_t temp = ((uint32_t)(data[3] & 0x0F) << 16) | ((uint32_t)data[4] << 8) | data[5];
+    float humidity = hum * 100.0f / 1048576.0f;
+    float temp_c = temp * 200.0f / 1048576.0f - 50.0f;
+    TEST_ASSERT(fabsf(humidity - 62.5f) < 0.01f, "Humidity decodes to the set value");
+    TEST_ASSERT(fabsf(temp_c - 24.0f) < 0.01f, "Temperature decodes to the set value");
+
+    TEST_ASSERT(sim_board_i2c_write(&board, 0x50, trigger, 3, 0) == -1, "No device at another address");
+}
+
+// Test 2: The 4-bit initialization, then characters and a cursor move
+void test_lcd_init() {
+    printf("\nTest: LCD Initialization\n");
+    static sim_board board;
+    sim_board_init(&board, 50.0f, 20.0f);
+    uint32_t t = 0;
+
+    // Three 0x03 pulses in 8-bit mode, then 0x02 switches to 4-bit
+    lcd_nibble(&board, 0x03, 0, t += 5000);
+    lcd_nibble(&board, 0x03, 0, t += 5000);
+    lcd_nibble(&board, 0x03, 0, t += 5000);
+    TEST_ASSERT(!board.lcd.four_bit, "Still 8-bit after 0x03 pulses");
+    lcd_nibble(&board, 0x02, 0, t += 5000);
+    TEST_ASSERT(board.lcd.four_bit, "4-bit after 0x02");
+
+    lcd_byte(&board, 0x28, 0, t += 100);    // Function set: 2 lines
+    lcd_byte(&board, 0x0C, 0, t += 100);    // Display on
+    TEST_ASSERT(board.lcd.four_bit && board.lcd.display_on, "Function set keeps 4-bit, display on");
+
+    for (const char *c = "Hi"; *c; c++) {
+        lcd_byte(&board, (uint8_t)*c, LCD_RS, t += 100);
+    }
+    lcd_byte(&board, 0x80 | 0x40 | 3, 0, t += 100);   // Row 1, column 3
+    lcd_byte(&board, 'x', LCD_RS, t += 100);
+
+    char line[SIM_LCD_COLS + 1];
+    sim_lcd_line(&board.lcd, 0, line);
+    TEST_ASSERT(strcmp(line, "Hi              ") == 0, "First line");
+    sim_lcd_line(&board.lcd, 1, line);
+    TEST_ASSERT(strcmp(line, "   x            ") == 0, "Second line at the cursor");
+    TEST_ASSERT(board.lcd.chars == 3, "Characters counted");
+    TEST_ASSERT(board.lcd.violations == 0, "No instruction sent while busy");
+}
+
+// Test 3: Commands sent during a clear are counted; the strip keeps its last frame
+void test_lcd_busy_and_leds() {
+    printf("\nTest: LCD Busy and LED Frames\n");
+    static sim_board board;
+    sim_board_init(&board, 50.0f, 20.0f);
+    uint32_t t = 0;
+    lcd_nibble(&board, 0x02, 0, t += 5000);
+
+    lcd_byte(&board, 0x01, 0, t += 100);                     // Clear display
+    lcd_byte(&board, 'A', LCD_RS, t + 100);                  // Too soon
+    TEST_ASSERT(board.lcd.violations == 1, "Write during a clear counted");
+    lcd_byte(&board, 'B', LCD_RS, t + 100 + SIM_LCD_CLEAR_US);
+    TEST_ASSERT(board.lcd.violations == 1, "Write after the clear is fine");
+
+    uint32_t frame[8] = { 0x001000, 0x100000, 0, 0, 0, 0, 0, 0x000010 };
+    sim_ws2812_show(&board.leds, frame, 8);
+    sim_ws2812_show(&board.leds, frame, 8);
+    TEST_ASSERT(board.leds.frames == 2, "Frames counted");
+    TEST_ASSERT(board.leds.count == 8 && sim_ws2812_lit(&board.leds) == 3, "Three of eight lit");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Simulated Devices Host Test Suite\n");
+    printf("========================================\n");
+
+    test_dht20();
+    test_lcd_init();
+    test_lcd_busy_and_leds();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
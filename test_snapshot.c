@@ -0,0 +1,165 @@
+/*
+File: test_snapshot.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the shared reading snapshot in snapshot.c.
+Responsibilities:
+- Test that the initial snapshot and each published snapshot read back whole
+- Test that a reader interrupting a half-finished publish gets the previous
+  snapshot without waiting
+- Test a writer and a reader thread running concurrently, standing in for
+  the two cores
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "snapshot.h"
+
+#define THREAD_PUBLISHES 1000000
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+// Every field is derived from seq so a torn snapshot would be noticed
+static reading_snapshot make_snapshot(uint32_t seq) {
+    reading_snapshot s;
+    memset(&s, 0, sizeof(s));
+    s.seq = seq;
+    s.sample_ms = seq * 3u;
+    s.humidity = (float)(seq & 0xFFFF);
+    s.temp_c = (float)(seq & 0xFF) - 40.0f;
+    s.temp_f = s.temp_c * 9.0f / 5.0f + 32.0f;
+    s.status = (uint8_t)seq;
+    return s;
+}
+
+static bool matches(const reading_snapshot *s, uint32_t seq) {
+    reading_snapshot expected = make_snapshot(seq);
+    return s->seq == expected.seq && s->sample_ms == expected.sample_ms &&
+           s->humidity == expected.humidity && s->temp_c == expected.temp_c &&
+           s->temp_f == expected.temp_f && s->status == expected.status;
+}
+
+// Test 1: Initial and published snapshots read back whole
+void test_round_trip() {
+    printf("\nTest: Round Trip\n");
+    static snapshot_seqlock lock;
+    reading_snapshot s = make_snapshot(0);
+    snapshot_init(&lock, &s);
+
+    reading_snapshot out;
+    TEST_ASSERT(snapshot_read(&lock, &out) == 0 && matches(&out, 0), "Initial snapshot read back");
+
+    bool intact = true;
+    for (uint32_t seq = 1; seq <= 5; seq++) {
+        s = make_snapshot(seq);
+        snapshot_publish(&lock, &s);
+        intact &= snapshot_read(&lock, &out) == 0 && matches(&out, seq);
+    }
+    TEST_ASSERT(intact, "Each publish read back without retries");
+}
+
+// Test 2: A reader that interrupts the writer gets the previous snapshot
+void test_interrupted_writer() {
+    printf("\nTest: Reader Interrupting the Writer\n");
+    static snapshot_seqlock lock;
+    reading_snapshot s = make_snapshot(7);
+    snapshot_init(&lock, &s);
+
+    // Replay the first half of a publish by hand, stopping with copy 0
+    // partly overwritten, as if an interrupt fired there
+    reading_snapshot next = make_snapshot(8);
+    atomic_store(&lock.version, 1);
+    atomic_store(&lock.copies[0][0], next.seq);
+
+    reading_snapshot out;
+    TEST_ASSERT(snapshot_read(&lock, &out) == 0, "Read finishes without retrying");
+    TEST_ASSERT(matches(&out, 7), "Read returns the previous snapshot");
+
+    // The writer resumes and finishes
+    snapshot_publish(&lock, &next);
+    TEST_ASSERT(snapshot_read(&lock, &out) == 0 && matches(&out, 8), "Next read sees the new snapshot");
+}
+
+// Test 3: One writer and one reader thread, like the two cores
+static snapshot_seqlock s_shared;
+static _Atomic bool s_done;
+
+static void *writer(void *arg) {
+    (void)arg;
+    for (uint32_t seq = 1; seq <= THREAD_PUBLISHES; seq++) {
+        reading_snapshot s = make_snapshot(seq);
+        snapshot_publish(&s_shared, &s);
+        if (seq % 64 == 0) {
+            sched_yield();   // Let the reader run on a single-CPU machine
+        }
+    }
+    atomic_store(&s_done, true);
+    return NULL;
+}
+
+void test_threads() {
+    printf("\nTest: Concurrent Writer and Reader\n");
+    reading_snapshot s = make_snapshot(0);
+    snapshot_init(&s_shared, &s);
+    atomic_store(&s_done, false);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, writer, NULL);
+
+    bool intact = true;
+    bool ordered = true;
+    uint32_t last_seq = 0;
+    uint32_t reads = 0;
+    while (!atomic_load(&s_done)) {
+        reading_snapshot out;
+        snapshot_read(&s_shared, &out);
+        intact &= matches(&out, out.seq);
+        ordered &= out.seq >= last_seq;
+        last_seq = out.seq;
+        if (++reads % 64 == 0) {
+            sched_yield();
+        }
+    }
+    pthread_join(thread, NULL);
+
+    TEST_ASSERT(intact, "Every snapshot read was whole");
+    TEST_ASSERT(ordered, "Snapshots never went backwards");
+    reading_snapshot out;
+    snapshot_read(&s_shared, &out);
+    TEST_ASSERT(matches(&out, THREAD_PUBLISHES), "Last publish is visible after the writer stops");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Reading Snapshot Host Test Suite\n");
+    printf("========================================\n");
+
+    test_round_trip();
+    test_interrupted_writer();
+    test_threads();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
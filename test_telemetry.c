@@ -0,0 +1,142 @@
+/*
+File: test_telemetry.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the UDP telemetry datagram format in telemetry.c.
+Responsibilities:
+- Test the header and record layout of a single-sample datagram
+- Test batching and sequence numbering across datagrams
+- Test value rounding, clamping and batch size limits
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "telemetry.h"
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+static uint32_t get_le32(const uint8_t *b) {
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+static int16_t get_le16(const uint8_t *b) {
+    return (int16_t)(b[0] | (b[1] << 8));
+}
+
+static telemetry_sample make_sample(uint32_t time_ms, float humidity, float temp) {
+    telemetry_sample s = { time_ms, humidity, temp, 0, TELEMETRY_FLAG_VALID };
+    return s;
+}
+
+// Test 1: One sample per datagram
+void test_single_sample() {
+    printf("\nTest: Single Sample\n");
+    telemetry_batch batch;
+    telemetry_batch_init(&batch, 1);
+    telemetry_sample s = make_sample(182044, 45.25f, -3.46f);
+    s.status = 2;
+    s.flags = TELEMETRY_FLAG_LED | TELEMETRY_FLAG_VALID;
+
+    TEST_ASSERT(telemetry_batch_add(&batch, &s), "Batch of one is full after one sample");
+    size_t len = telemetry_batch_finish(&batch);
+    const uint8_t *d = batch.data;
+    TEST_ASSERT(len == TELEMETRY_HEADER_LEN + TELEMETRY_RECORD_LEN, "Datagram length");
+    TEST_ASSERT(d[0] == 'H' && d[1] == 'T' && d[2] == TELEMETRY_VERSION, "Magic and version");
+    TEST_ASSERT(d[3] == 1 && get_le32(d + 4) == 0, "Count and first sequence number");
+
+    const uint8_t *rec = d + TELEMETRY_HEADER_LEN;
+    TEST_ASSERT(get_le32(rec) == 182044, "Record time");
+    TEST_ASSERT(get_le16(rec + 4) == 453 && get_le16(rec + 6) == -35, "Values in tenths, rounded");
+    TEST_ASSERT(rec[8] == 2 && rec[9] == (TELEMETRY_FLAG_LED | TELEMETRY_FLAG_VALID),
+                "Status and flags");
+    TEST_ASSERT(telemetry_batch_finish(&batch) == 0, "Nothing left to send");
+}
+
+// Test 2: Batches carry consecutive sequence numbers
+void test_batching() {
+    printf("\nTest: Batching\n");
+    telemetry_batch batch;
+    telemetry_batch_init(&batch, 4);
+
+    bool early_full = false;
+    uint32_t first_seqs[3];
+    bool times_ok = true;
+    for (int d = 0; d < 3; d++) {
+        for (int i = 0; i < 4; i++) {
+            telemetry_sample s = make_sample((uint32_t)(d * 4 + i) * 2000, 50.0f, 20.0f);
+            bool full = telemetry_batch_add(&batch, &s);
+            if (full != (i == 3)) early_full = true;
+        }
+        size_t len = telemetry_batch_finish(&batch);
+        first_seqs[d] = get_le32(batch.data + 4);
+        times_ok = times_ok && len == TELEMETRY_HEADER_LEN + 4 * TELEMETRY_RECORD_LEN &&
+                   batch.data[3] == 4 &&
+                   get_le32(batch.data + TELEMETRY_HEADER_LEN + 3 * TELEMETRY_RECORD_LEN) ==
+                       (uint32_t)(d * 4 + 3) * 2000;
+    }
+    TEST_ASSERT(!early_full, "Batch is full exactly at batch_size");
+    TEST_ASSERT(times_ok, "Each datagram holds its four records in order");
+    TEST_ASSERT(first_seqs[0] == 0 && first_seqs[1] == 4 && first_seqs[2] == 8,
+                "Sequence numbers continue across datagrams");
+
+    // A partial batch can be flushed early
+    telemetry_sample s = make_sample(99, 1.0f, 2.0f);
+    telemetry_batch_add(&batch, &s);
+    size_t len = telemetry_batch_finish(&batch);
+    TEST_ASSERT(len == TELEMETRY_HEADER_LEN + TELEMETRY_RECORD_LEN && batch.data[3] == 1 &&
+                get_le32(batch.data + 4) == 12, "Partial batch");
+}
+
+// Test 3: Limits
+void test_limits() {
+    printf("\nTest: Limits\n");
+    telemetry_batch batch;
+    telemetry_batch_init(&batch, 0);
+    TEST_ASSERT(batch.batch_size == 1, "Batch size 0 becomes 1");
+    telemetry_batch_init(&batch, 255);
+    TEST_ASSERT(batch.batch_size == TELEMETRY_BATCH_MAX, "Batch size is capped");
+
+    int added = 0;
+    telemetry_sample s = make_sample(0, 5000.0f, NAN);
+    while (!telemetry_batch_add(&batch, &s)) added++;
+    size_t len = telemetry_batch_finish(&batch);
+    TEST_ASSERT(added + 1 == TELEMETRY_BATCH_MAX &&
+                len == sizeof(batch.data), "Largest datagram fills the buffer exactly");
+    const uint8_t *rec = batch.data + TELEMETRY_HEADER_LEN;
+    TEST_ASSERT(get_le16(rec + 4) == INT16_MAX && get_le16(rec + 6) == INT16_MAX,
+                "Out of range and NaN values are clamped");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("UDP Telemetry Host Test Suite\n");
+    printf("========================================\n");
+
+    test_single_sample();
+    test_batching();
+    test_limits();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
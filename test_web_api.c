@@ -0,0 +1,133 @@
+/*
+File: test_web_api.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the JSON web API serialization in web_api.c.
+Responsibilities:
+- Test the full readings object and its null values before the first sample
+- Test ?fields= parsing, including unknown names and lists that select nothing
+- Test the measuring pass and output split into a buffer that runs out
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "web_api.h"
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+static api_reading sample_reading(void) {
+    api_reading r = {
+        .humidity = 45.24f,
+        .temp_celsius = 21.4f,
+        .temp_fahrenheit = 70.52f,
+        .led_enabled = true,
+        .has_sample = true,
+        .sample_ms = 182044,
+        .now_ms = 182856,
+        .status = "ok",
+    };
+    return r;
+}
+
+// Serialize into a null-terminated string
+static size_t render(char *out, size_t size, uint32_t fields, const api_reading *r) {
+    api_buffer buf = { .data = out, .size = size - 1, .len = 0 };
+    api_sink sink;
+    api_sink_init(&sink, api_buffer_write, &buf);
+    size_t len = api_write_readings_json(&sink, fields, r);
+    out[buf.len] = '\0';
+    return len;
+}
+
+// Test 1: Every field, and nulls before the first sample
+void test_readings_json() {
+    printf("\nTest: Readings JSON\n");
+    char out[256];
+    api_reading r = sample_reading();
+
+    render(out, sizeof(out), API_FIELDS_ALL, &r);
+    TEST_ASSERT(strcmp(out, "{\"humidity\":45.2,\"temp_c\":21.4,\"temp_f\":70.5,\"led\":true,"
+                            "\"timestamp_ms\":182044,\"age_ms\":812,\"status\":\"ok\"}") == 0,
+                "All fields in order");
+
+    r.has_sample = false;
+    r.led_enabled = false;
+    r.status = "busy";
+    render(out, sizeof(out), API_FIELDS_ALL, &r);
+    TEST_ASSERT(strcmp(out, "{\"humidity\":null,\"temp_c\":null,\"temp_f\":null,\"led\":false,"
+                            "\"timestamp_ms\":null,\"age_ms\":null,\"status\":\"busy\"}") == 0,
+                "Values are null before the first sample");
+
+    r = sample_reading();
+    render(out, sizeof(out), API_FIELD_HUMIDITY | API_FIELD_STATUS, &r);
+    TEST_ASSERT(strcmp(out, "{\"humidity\":45.2,\"status\":\"ok\"}") == 0, "Selected fields only");
+}
+
+// Test 2: ?fields= values
+void test_parse_fields() {
+    printf("\nTest: Field Selection\n");
+    TEST_ASSERT(api_parse_fields(NULL) == API_FIELDS_ALL, "No parameter selects every field");
+    TEST_ASSERT(api_parse_fields("humidity,temp_c") == (API_FIELD_HUMIDITY | API_FIELD_TEMP_C),
+                "Two names");
+    TEST_ASSERT(api_parse_fields("age_ms,bogus") == API_FIELD_AGE, "Unknown names are ignored");
+    TEST_ASSERT(api_parse_fields("humidity,,humidity") == API_FIELD_HUMIDITY,
+                "Empty and repeated names");
+    TEST_ASSERT(api_parse_fields("temp") == 0, "A prefix of a name doesn't match");
+    TEST_ASSERT(api_parse_fields("bogus,other") == 0, "Only unknown names select nothing");
+    TEST_ASSERT(api_parse_fields("") == 0, "An empty list selects nothing");
+}
+
+// Test 3: Measuring pass and a buffer that runs out
+void test_sink() {
+    printf("\nTest: Sink Output\n");
+    api_reading r = sample_reading();
+    char full[256];
+    size_t full_len = render(full, sizeof(full), API_FIELDS_ALL, &r);
+    TEST_ASSERT(full_len == strlen(full), "Returned length matches the output");
+
+    api_sink sink;
+    api_sink_init(&sink, NULL, NULL);
+    TEST_ASSERT(api_write_readings_json(&sink, API_FIELDS_ALL, &r) == full_len,
+                "Measuring pass gives the same length");
+
+    char small[20];
+    api_buffer buf = { .data = small, .size = sizeof(small), .len = 0 };
+    api_sink_init(&sink, api_buffer_write, &buf);
+    TEST_ASSERT(api_write_readings_json(&sink, API_FIELDS_ALL, &r) == full_len,
+                "Length is still counted after the buffer fills");
+    TEST_ASSERT(!sink.ok, "Sink reports the failed write");
+    TEST_ASSERT(buf.len <= sizeof(small) && memcmp(small, full, buf.len) == 0,
+                "Output up to the failure is intact");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("Web API Host Test Suite\n");
+    printf("========================================\n");
+
+    test_readings_json();
+    test_parse_fields();
+    test_sink();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
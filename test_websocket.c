@@ -0,0 +1,193 @@
+/*
+File: test_websocket.c
+Language: C
+Author: Andrew Poon
+Date: 10/19/26
+Description: Host unit tests for the WebSocket protocol helpers in websocket.c.
+Responsibilities:
+- Test the handshake accept key against the RFC 6455 example
+- Test parsing of masked, fragmented, control and malformed client frames
+- Test encoding of server frame headers
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "websocket.h"
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+// Build a masked client frame the way a browser would
+static size_t make_client_frame(uint8_t *out, uint8_t first_byte, const char *payload,
+                                size_t len) {
+    static const uint8_t mask[4] = {0x37, 0xfa, 0x21, 0x3d};
+    size_t pos = 0;
+    out[pos++] = first_byte;
+    if (len < 126) {
+        out[pos++] = 0x80 | (uint8_t)len;
+    } else {
+        out[pos++] = 0x80 | 126;
+        out[pos++] = (uint8_t)(len >> 8);
+        out[pos++] = (uint8_t)len;
+    }
+    memcpy(out + pos, mask, 4);
+    pos += 4;
+    for (size_t i = 0; i < len; i++) {
+        out[pos++] = (uint8_t)payload[i] ^ mask[i & 3];
+    }
+    return pos;
+}
+
+// Test 1: Sec-WebSocket-Accept from RFC 6455 section 1.3
+void test_accept_key() {
+    printf("\nTest: Handshake Accept Key\n");
+    const char *key = "dGhlIHNhbXBsZSBub25jZQ==";
+    char accept[WS_ACCEPT_KEY_LEN];
+    ws_accept_key(key, strlen(key), accept);
+    TEST_ASSERT(strcmp(accept, "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") == 0, "RFC 6455 example key");
+}
+
+// Test 2: Masked "Hello" text frame from RFC 6455 section 5.7
+void test_masked_text() {
+    printf("\nTest: Masked Text Frame\n");
+    const uint8_t frame[] = {0x81, 0x85, 0x37, 0xfa, 0x21, 0x3d, 0x7f, 0x9f, 0x4d, 0x51, 0x58};
+    ws_parser parser;
+    ws_parser_init(&parser);
+    size_t used = 0;
+    ws_parse_result r = ws_parser_feed(&parser, frame, sizeof(frame), &used);
+    TEST_ASSERT(r == WS_PARSE_MESSAGE, "Message completed");
+    TEST_ASSERT(used == sizeof(frame), "Whole frame consumed");
+    TEST_ASSERT(parser.opcode == WS_OP_TEXT, "Opcode is text");
+    TEST_ASSERT(parser.message_len == 5 && memcmp(parser.message, "Hello", 5) == 0,
+                "Payload unmasked to 'Hello'");
+}
+
+// Test 3: Frame delivered one byte at a time (split across TCP segments)
+void test_byte_by_byte() {
+    printf("\nTest: Byte-by-byte Delivery\n");
+    uint8_t frame[64];
+    size_t len = make_client_frame(frame, 0x81, "led=on", 6);
+    ws_parser parser;
+    ws_parser_init(&parser);
+    ws_parse_result r = WS_PARSE_NEED_MORE;
+    size_t i = 0;
+    while (i < len && r == WS_PARSE_NEED_MORE) {
+        size_t used = 0;
+        r = ws_parser_feed(&parser, frame + i, 1, &used);
+        i += used;
+    }
+    TEST_ASSERT(r == WS_PARSE_MESSAGE && i == len, "Message completed on last byte");
+    TEST_ASSERT(parser.message_len == 6 && memcmp(parser.message, "led=on", 6) == 0,
+                "Payload reassembled");
+}
+
+// Test 4: Fragmented message with a ping in the middle, then a second message
+void test_fragments_and_control() {
+    printf("\nTest: Fragments and Interleaved Control Frame\n");
+    uint8_t buf[128];
+    size_t len = 0;
+    len += make_client_frame(buf + len, 0x01, "bright", 6);          // text, FIN=0
+    len += make_client_frame(buf + len, 0x89, "hi", 2);              // ping
+    len += make_client_frame(buf + len, 0x80, "ness=9", 6);          // continuation, FIN=1
+    len += make_client_frame(buf + len, 0x81, "led=off", 7);         // next text
+
+    ws_parser parser;
+    ws_parser_init(&parser);
+    size_t pos = 0, used = 0;
+
+    ws_parse_result r = ws_parser_feed(&parser, buf + pos, len - pos, &used);
+    pos += used;
+    TEST_ASSERT(r == WS_PARSE_MESSAGE && parser.opcode == WS_OP_PING, "Ping delivered first");
+    TEST_ASSERT(parser.message_len == 2 && memcmp(parser.message, "hi", 2) == 0,
+                "Ping payload kept separate");
+
+    r = ws_parser_feed(&parser, buf + pos, len - pos, &used);
+    pos += used;
+    TEST_ASSERT(r == WS_PARSE_MESSAGE && parser.opcode == WS_OP_TEXT, "Fragments reassembled");
+    TEST_ASSERT(parser.message_len == 12 && memcmp(parser.message, "brightness=9", 12) == 0,
+                "Fragment payload joined");
+
+    r = ws_parser_feed(&parser, buf + pos, len - pos, &used);
+    pos += used;
+    TEST_ASSERT(r == WS_PARSE_MESSAGE && parser.message_len == 7 &&
+                memcmp(parser.message, "led=off", 7) == 0, "Following message parsed");
+    TEST_ASSERT(pos == len, "All input consumed");
+}
+
+// Test 5: Protocol violations are rejected with the right close code
+void test_errors() {
+    printf("\nTest: Protocol Errors\n");
+    ws_parser parser;
+    size_t used = 0;
+
+    const uint8_t unmasked[] = {0x81, 0x02, 'h', 'i', 0, 0, 0, 0};
+    ws_parser_init(&parser);
+    TEST_ASSERT(ws_parser_feed(&parser, unmasked, sizeof(unmasked), &used) == WS_PARSE_ERROR &&
+                parser.close_code == WS_CLOSE_PROTOCOL, "Unmasked frame rejected");
+
+    uint8_t big[300];
+    char payload[WS_MAX_PAYLOAD + 1];
+    memset(payload, 'x', sizeof(payload));
+    size_t len = make_client_frame(big, 0x81, payload, sizeof(payload));
+    ws_parser_init(&parser);
+    TEST_ASSERT(ws_parser_feed(&parser, big, len, &used) == WS_PARSE_ERROR &&
+                parser.close_code == WS_CLOSE_TOO_BIG, "Oversized message rejected");
+
+    uint8_t cont[16];
+    len = make_client_frame(cont, 0x80, "x", 1);
+    ws_parser_init(&parser);
+    TEST_ASSERT(ws_parser_feed(&parser, cont, len, &used) == WS_PARSE_ERROR,
+                "Continuation without a message rejected");
+
+    uint8_t frag_ping[16];
+    len = make_client_frame(frag_ping, 0x09, "", 0);
+    ws_parser_init(&parser);
+    TEST_ASSERT(ws_parser_feed(&parser, frag_ping, len, &used) == WS_PARSE_ERROR,
+                "Fragmented control frame rejected");
+}
+
+// Test 6: Server frame header encoding
+void test_frame_header() {
+    printf("\nTest: Server Frame Header\n");
+    uint8_t h[WS_FRAME_HEADER_MAX];
+    TEST_ASSERT(ws_frame_header(h, WS_OP_BINARY, 20) == 2 && h[0] == 0x82 && h[1] == 20,
+                "Short binary header");
+    TEST_ASSERT(ws_frame_header(h, WS_OP_TEXT, 300) == 4 && h[1] == 126 &&
+                h[2] == 0x01 && h[3] == 0x2C, "16-bit length header");
+    TEST_ASSERT(ws_frame_header(h, WS_OP_TEXT, 70000) == 10 && h[1] == 127 &&
+                h[7] == 0x01 && h[8] == 0x11 && h[9] == 0x70, "64-bit length header");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("WebSocket Host Test Suite\n");
+    printf("========================================\n");
+
+    test_accept_key();
+    test_masked_text();
+    test_byte_by_byte();
+    test_fragments_and_control();
+    test_errors();
+    test_frame_header();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,161 @@
+/*
+File: test_wifi_sta.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Host unit tests for the WiFi station mode logic in wifi_sta.c.
+Responsibilities:
+- Test joining, connection timing and reconnect counting
+- Test failure handling, backoff, timeouts and the fallback to AP mode
+- Test that the cached BSSID is dropped after a failed join
+- Test the cache record round trip and its validation
+
+Usage:
+Built on the development machine, not the Pico:
+    cmake -S . -B build-host -DBUILD_HOST_TESTS=ON
+    cmake --build build-host
+    ctest --test-dir build-host --output-on-failure
+*/
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "wifi_sta.h"
+
+static int s_failures = 0;
+
+// Helper macro for test result output
+#define TEST_ASSERT(cond, msg) \
+    do { \
+        if (cond) { \
+            printf("[PASS] %s\n", msg); \
+        } else { \
+            printf("[FAIL] %s\n", msg); \
+            s_failures++; \
+        } \
+    } while (0)
+
+// Step until the state machine asks for a join; returns the time it did, or 0
+static uint32_t wait_for_join(wifi_sta *s, uint32_t now_ms) {
+    for (uint32_t t = now_ms; t < now_ms + 2 * WIFI_BACKOFF_MAX_MS; t += 10) {
+        if (wifi_sta_step(s, WIFI_LINK_DOWN, t, 0) == WIFI_ACTION_JOIN) {
+            return t;
+        }
+    }
+    return 0;
+}
+
+// Test 1: Connect, lose the link and reconnect
+void test_connect_and_reconnect() {
+    printf("\nTest: Connect and Reconnect\n");
+    wifi_sta s;
+    wifi_sta_init(&s, 5, true, 1000);
+
+    TEST_ASSERT(wifi_sta_step(&s, WIFI_LINK_DOWN, 1000, 0) == WIFI_ACTION_JOIN, "First step joins");
+    TEST_ASSERT(s.use_cache, "First join uses the cache");
+    TEST_ASSERT(wifi_sta_step(&s, WIFI_LINK_JOINING, 1500, 0) == WIFI_ACTION_NONE, "Still joining");
+    TEST_ASSERT(wifi_sta_step(&s, WIFI_LINK_UP, 1800, 0) == WIFI_ACTION_CONNECTED, "Connected");
+    TEST_ASSERT(s.last_join_ms == 800 && s.outage_ms == 800, "Join time measured");
+    TEST_ASSERT(s.connects == 1 && s.reconnects == 0, "First connection isn't a reconnect");
+    TEST_ASSERT(wifi_sta_step(&s, WIFI_LINK_JOINING, 5000, 0) == WIFI_ACTION_NONE,
+                "Lease renewal isn't a disconnect");
+
+    TEST_ASSERT(wifi_sta_step(&s, WIFI_LINK_DOWN, 10000, 0) == WIFI_ACTION_DISCONNECTED, "Link loss noticed");
+    TEST_ASSERT(wifi_sta_step(&s, WIFI_LINK_DOWN, 10100, 0) == WIFI_ACTION_NONE, "Waits before rejoining");
+    uint32_t joined = wait_for_join(&s, 10100);
+    TEST_ASSERT(joined == 10000 + WIFI_BACKOFF_MIN_MS, "Rejoins after the minimum delay");
+    TEST_ASSERT(s.use_cache, "Rejoin uses the cache");
+    TEST_ASSERT(wifi_sta_step(&s, WIFI_LINK_UP, joined + 300, 0) == WIFI_ACTION_CONNECTED, "Reconnected");
+    TEST_ASSERT(s.reconnects == 1 && s.connects == 2, "Reconnect counted");
+    TEST_ASSERT(s.last_join_ms == 300 && s.outage_ms == WIFI_BACKOFF_MIN_MS + 300, "Outage measured");
+}
+
+// Test 2: Failures back off, then fall back to AP mode
+void test_failures() {
+    printf("\nTest: Failures and Fallback\n");
+    wifi_sta s;
+    wifi_sta_init(&s, 3, true, 0);
+
+    wifi_sta_step(&s, WIFI_LINK_DOWN, 0, 0);
+    TEST_ASSERT(wifi_sta_step(&s, WIFI_LINK_FAILED, 100, 0) == WIFI_ACTION_ABORT, "Failed join aborted");
+    TEST_ASSERT(!s.use_cache, "Cached BSSID dropped after a failure");
+
+    uint32_t first = wait_for_join(&s, 100);
+    TEST_ASSERT(first == 100 + WIFI_BACKOFF_MIN_MS, "First retry after the minimum delay");
+
+    // A join that never completes times out
+    TEST_ASSERT(wifi_sta_step(&s, WIFI_LINK_JOINING, first + WIFI_JOIN_TIMEOUT_MS - 10, 0) ==
+                WIFI_ACTION_NONE, "Join still allowed to finish");
+    uint32_t timeout_at = first + WIFI_JOIN_TIMEOUT_MS;
+    TEST_ASSERT(wifi_sta_step(&s, WIFI_LINK_JOINING, timeout_at, 0) == WIFI_ACTION_ABORT, "Join timed out");
+    uint32_t second = wait_for_join(&s, timeout_at);
+    TEST_ASSERT(second == timeout_at + 2 * WIFI_BACKOFF_MIN_MS, "Delay doubles");
+
+    TEST_ASSERT(wifi_sta_step(&s, WIFI_LINK_FAILED, second + 50, 0) == WIFI_ACTION_FALLBACK,
+                "Falls back to AP mode after max failures");
+    TEST_ASSERT(s.join_failures == 3, "Failures counted");
+    TEST_ASSERT(wifi_sta_step(&s, WIFI_LINK_DOWN, second + 100000, 0) == WIFI_ACTION_NONE &&
+                s.state == WIFI_STA_FALLBACK, "Stays in AP mode");
+
+    // With no limit it keeps trying, and a success resets the delay
+    wifi_sta_init(&s, 0, false, 0);
+    uint32_t t = 0;
+    for (int i = 0; i < 10; i++) {
+        t = wait_for_join(&s, t);
+        wifi_sta_step(&s, WIFI_LINK_FAILED, t, 0);
+    }
+    TEST_ASSERT(s.state == WIFI_STA_WAITING && s.failures == 10, "No fallback when disabled");
+    TEST_ASSERT(s.retry_at_ms - t == WIFI_BACKOFF_MAX_MS, "Delay capped");
+    t = wait_for_join(&s, t);
+    wifi_sta_step(&s, WIFI_LINK_UP, t + 10, 0);
+    wifi_sta_step(&s, WIFI_LINK_DOWN, t + 20, 0);
+    TEST_ASSERT(s.retry_at_ms - (t + 20) == WIFI_BACKOFF_MIN_MS, "Delay reset by a connection");
+}
+
+// Test 3: Cache record
+void test_cache() {
+    printf("\nTest: Cache Record\n");
+    wifi_cache c = {
+        .ssid = "Building-IoT",
+        .bssid = { 0x02, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE },
+        .channel = 11,
+        .ip = { 10, 20, 0, 57 },
+        .netmask = { 255, 255, 252, 0 },
+        .gateway = { 10, 20, 0, 1 },
+    };
+    uint8_t record[WIFI_CACHE_RECORD_LEN];
+    wifi_cache_encode(&c, record);
+
+    wifi_cache out;
+    TEST_ASSERT(wifi_cache_decode(record, "Building-IoT", &out), "Record decodes");
+    TEST_ASSERT(memcmp(&out, &c, sizeof(c)) == 0, "Round trip keeps every field");
+    TEST_ASSERT(!wifi_cache_decode(record, "Building-IoT2", &out) &&
+                !wifi_cache_decode(record, "Building-Io", &out), "Other networks rejected");
+
+    record[12] ^= 0x01;
+    TEST_ASSERT(!wifi_cache_decode(record, "Building-IoT", &out), "Corrupt record rejected");
+
+    memset(record, 0xFF, sizeof(record));
+    TEST_ASSERT(!wifi_cache_decode(record, "Building-IoT", &out), "Erased flash rejected");
+
+    // Longest SSID, which has no terminator in the record
+    memset(c.ssid, 'S', WIFI_SSID_MAX);
+    c.ssid[WIFI_SSID_MAX] = '\0';
+    wifi_cache_encode(&c, record);
+    TEST_ASSERT(wifi_cache_decode(record, c.ssid, &out) && strcmp(out.ssid, c.ssid) == 0,
+                "32-character SSID");
+}
+
+int main() {
+    printf("========================================\n");
+    printf("WiFi Station Host Test Suite\n");
+    printf("========================================\n");
+
+    test_connect_and_reconnect();
+    test_failures();
+    test_cache();
+
+    printf("\n%s (%d failure%s)\n", s_failures ? "FAILED" : "All tests passed",
+           s_failures, s_failures == 1 ? "" : "s");
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""
+File: embed_assets.py
+Language: Python 3 (standard library only)
+Author: Andrew Poon
+Date: 10/20/26
+Description: Build step that embeds the static web assets in web/ into the
+    firmware. Each file is stored both uncompressed and gzip-compressed as
+    const byte arrays (placed in flash) in a generated C file implementing
+    the table declared in web_assets.h. The sizes before and after
+    compression are printed so the savings on the wire are visible in the
+    build log.
+
+    Every asset gets a strong ETag from a hash of its contents. Pages
+    (.html) are revalidated on every load, while the files they reference
+    are cached for a year: references to them inside pages are rewritten
+    to include a ?v=<hash> version, so a new build changes the URL.
+
+Usage:
+    python3 tools/embed_assets.py -o build/web_assets_data.c web/index.html web/style.css ...
+"""
+
+import argparse
+import gzip
+import hashlib
+import os
+import re
+
+CONTENT_TYPES = {
+    ".html": "text/html; charset=UTF-8",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".ico": "image/x-icon",
+}
+
+
+# Cache-Control for pages (always revalidated) and for versioned files they load
+CACHE_PAGE = "no-cache"
+CACHE_VERSIONED = "public, max-age=31536000, immutable"
+
+
+def url_path(filename):
+    """index.html is served at /, everything else under its file name."""
+    name = os.path.basename(filename)
+    return "/" if name == "index.html" else "/" + name
+
+
+def c_identifier(filename):
+    return "ASSET_" + re.sub(r"[^0-9A-Za-z]", "_", os.path.basename(filename)).upper()
+
+
+def c_array(name, data):
+    lines = [f"static const uint8_t {name}[{len(data)}] = {{"]
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join(f"0x{b:02x}" for b in data[i:i + 16]) + ",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Embed gzip-compressed web assets")
+    parser.add_argument("-o", "--output", required=True, help="generated C file")
+    parser.add_argument("files", nargs="+", help="asset files to embed")
+    args = parser.parse_args()
+
+    contents = {}
+    for filename in args.files:
+        with open(filename, "rb") as f:
+            contents[filename] = f.read()
+
+    # Version every non-page asset by content hash and point pages at that version
+    versions = {url_path(name): hashlib.sha1(data).hexdigest()[:8]
+                for name, data in contents.items() if not name.endswith(".html")}
+    for name in contents:
+        if name.endswith(".html"):
+            for path, version in versions.items():
+                contents[name] = contents[name].replace(
+                    f'"{path}"'.encode(), f'"{path}?v={version}"'.encode())
+
+    arrays = []
+    entries = []
+    total_raw = 0
+    total_gz = 0
+
+    # The table is sorted by URL path so the server can binary search it
+    for filename in sorted(args.files, key=url_path):
+        raw = contents[filename]
+        # mtime=0 keeps the output reproducible between builds
+        gz = gzip.compress(raw, compresslevel=9, mtime=0)
+        ident = c_identifier(filename)
+        ext = os.path.splitext(filename)[1].lower()
+        content_type = CONTENT_TYPES.get(ext, "application/octet-stream")
+
+        etag = hashlib.sha1(raw).hexdigest()[:16]
+        cache_control = CACHE_PAGE if ext == ".html" else CACHE_VERSIONED
+
+        arrays.append(c_array(ident, raw))
+        arrays.append(c_array(ident + "_GZ", gz))
+        entries.append(f'    {{ "{url_path(filename)}", "{content_type}", '
+                       f"{ident}, {len(raw)}, {ident}_GZ, {len(gz)}, "
+                       f'"\\"{etag}\\"", "\\"{etag}-gz\\"", "{cache_control}" }},')
+
+        total_raw += len(raw)
+        total_gz += len(gz)
+        print(f"web asset {url_path(filename):<12} {len(raw):6d} -> {len(gz):6d} bytes gzip "
+              f"({100.0 * len(gz) / len(raw):.0f}%)")
+
+    print(f"web assets total   {total_raw:6d} -> {total_gz:6d} bytes gzip "
+          f"({100.0 * total_gz / max(total_raw, 1):.0f}%)")
+
+    source = "\n".join([
+        "// Generated by tools/embed_assets.py from web/ -- do not edit.",
+        f"// Total: {total_raw} bytes uncompressed, {total_gz} bytes gzip.",
+        "",
+        '#include "web_assets.h"',
+        "",
+        "\n\n".join(arrays),
+        "",
+        "const web_asset WEB_ASSETS[] = {",
+        *entries,
+        "};",
+        "",
+        f"const size_t WEB_ASSET_COUNT = {len(entries)};",
+        "",
+    ])
+
+    with open(args.output, "w") as f:
+        f.write(source)
+
+
+if __name__ == "__main__":
+    main()
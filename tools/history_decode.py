@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+File: history_decode.py
+Language: Python 3 (standard library only)
+Author: Andrew Poon
+Date: 10/20/26
+Description: Decoder for the binary history export served by network.c at
+    /api/v1/history?format=bin (layout in history.h). Reads a saved export,
+    or fetches one from the device, and prints the records as CSV or JSON.
+
+Usage:
+    python3 tools/history_decode.py export.bin                    # saved file
+    curl -s 'http://192.168.4.1/api/v1/history?format=bin' | python3 tools/history_decode.py -
+    python3 tools/history_decode.py --host 192.168.4.1 --tier 1m --json
+"""
+
+import argparse
+import json
+import struct
+import sys
+import urllib.request
+
+MAGIC = b"HIST"
+HEADER = struct.Struct("<4sBBH")   # magic, version, tier, record size
+RECORD = struct.Struct("<Ihh")     # time_ms, humidity x10, temp_c x10
+TIER_NAMES = {0: "raw", 1: "1m", 2: "1h"}
+
+
+def decode(data):
+    """Return (tier name, list of records) from a binary export."""
+    if len(data) < HEADER.size:
+        raise ValueError("export is shorter than its header")
+    magic, version, tier, record_size = HEADER.unpack_from(data)
+    if magic != MAGIC:
+        raise ValueError("not a history export (bad magic)")
+    if version != 1 or record_size < RECORD.size:
+        raise ValueError(f"unsupported export version {version}, record size {record_size}")
+
+    records = []
+    body = data[HEADER.size:]
+    if len(body) % record_size:
+        print(f"warning: ignoring {len(body) % record_size} trailing bytes", file=sys.stderr)
+    for offset in range(0, len(body) - record_size + 1, record_size):
+        time_ms, humidity, temp = RECORD.unpack_from(body, offset)
+        records.append({"time_ms": time_ms, "humidity": humidity / 10.0, "temp_c": temp / 10.0})
+    return TIER_NAMES.get(tier, str(tier)), records
+
+
+def fetch(host, port, tier, start, end):
+    """Download a binary export from the device."""
+    query = f"format=bin&tier={tier}"
+    if start is not None:
+        query += f"&from={start}"
+    if end is not None:
+        query += f"&to={end}"
+    with urllib.request.urlopen(f"http://{host}:{port}/api/v1/history?{query}", timeout=30) as r:
+        return r.read()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("file", nargs="?", help="saved export, or - for stdin")
+    parser.add_argument("--host", help="fetch the export from this device instead")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--tier", default="raw", help="raw, 1m or 1h")
+    parser.add_argument("--from", dest="start", type=int, help="oldest time in ms since boot")
+    parser.add_argument("--to", dest="end", type=int, help="newest time in ms since boot")
+    parser.add_argument("--json", action="store_true", help="print JSON instead of CSV")
+    args = parser.parse_args()
+
+    if args.host:
+        data = fetch(args.host, args.port, args.tier, args.start, args.end)
+    elif args.file == "-":
+        data = sys.stdin.buffer.read()
+    elif args.file:
+        with open(args.file, "rb") as f:
+            data = f.read()
+    else:
+        parser.error("give a file or --host")
+
+    try:
+        tier, records = decode(data)
+    except ValueError as e:
+        sys.exit(f"ERROR: {e}")
+
+    if args.json:
+        print(json.dumps({"tier": tier, "records": records}))
+    else:
+        print("time_ms,humidity,temp_c")
+        for rec in records:
+            print(f"{rec['time_ms']},{rec['humidity']:.1f},{rec['temp_c']:.1f}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+"""
+File: latency_report.py
+Language: Python 3 (standard library only)
+Author: Andrew Poon
+Date: 10/20/26
+Description: Measures HTTP latency on a running device and reports the
+    percentiles of the firmware's own histograms over the same period, so
+    builds can be compared before and after a change (for example moving
+    the sensor and LCD work to core 1).
+
+    Polls /api/v1/readings over one keep-alive connection (or one per
+    request with --close) for --duration seconds, timing each round trip
+    on this machine, and scrapes /metrics before and after. The percentiles of http_request_duration_seconds and
+    core_handoff_duration_seconds are estimated from the difference of the
+    two scrapes, taking the upper bound of the bucket a percentile falls in.
+    Run it for longer than the sample interval so LCD refreshes are
+    included.
+
+    It also reports, per I2C device, the time its transfers held the bus
+    and how much of that the CPU spent driving them (i2c_bus_seconds_total
+    and i2c_cpu_seconds_total). For the LCD this is the CPU utilisation
+    of a refresh. Blocking transfers are counted as 100%: the CPU waits
+    on the bus throughout, so there is nothing to measure, and that
+    figure is bookkeeping rather than a measurement.
+
+    To compare two builds, flash each in turn and run the same command
+    against it, e.g. --duration 60 --interval 0.05 at the default 2 s
+    sample interval (30 LCD refreshes). Firmware from before the readings
+    API (such as the original single-core release) answers every path
+    with its page and closes the connection, and has no /metrics, so only
+    the client round trips are reported; pass --close to poll newer
+    firmware the same way, with a new connection per request. The host
+    build (humidity_host) runs it against newer firmware on loopback,
+    never the original release; its I2C and CPU timings are the PC's, so
+    use it to check that the report works, and a board for the figures.
+
+Usage:
+    python3 tools/latency_report.py 192.168.4.1
+    python3 tools/latency_report.py pico2w.local --duration 60 --interval 0.05
+    python3 tools/latency_report.py 192.168.4.1 --duration 60 --interval 0.05 --close
+    ./build-host/humidity_host --run 'python3 tools/latency_report.py 127.0.0.1 --port $HOST_HTTP_PORT --duration 60'
+"""
+
+import argparse
+import http.client
+import re
+import time
+
+HISTOGRAMS = ("http_request_duration_seconds", "core_handoff_duration_seconds")
+BUCKET_RE = re.compile(r'^(\w+)_bucket\{(?:[^}]*,)?le="([^"]+)"\} (\d+)$')
+I2C_COUNTERS = ("i2c_bus_seconds_total", "i2c_cpu_seconds_total")
+I2C_RE = re.compile(r'^(\w+)\{device="(\w+)"\} (\S+)$')
+
+
+def scrape(conn):
+    """Return ({histogram name: [(upper bound, cumulative count), ...]},
+    {(I2C counter name, device): seconds})."""
+    conn.request("GET", "/metrics")
+    body = conn.getresponse().read().decode()
+    buckets = {}
+    i2c = {}
+    for line in body.splitlines():
+        m = BUCKET_RE.match(line)
+        if m and m.group(1) in HISTOGRAMS:
+            bound = float("inf") if m.group(2) == "+Inf" else float(m.group(2))
+            buckets.setdefault(m.group(1), []).append((bound, int(m.group(3))))
+            continue
+        m = I2C_RE.match(line)
+        if m and m.group(1) in I2C_COUNTERS:
+            i2c[(m.group(1), m.group(2))] = float(m.group(3))
+    return buckets, i2c
+
+
+def histogram_percentile(before, after, fraction):
+    """Upper bucket bound holding the given fraction of the new observations."""
+    before = before or [(bound, 0) for bound, _ in after]
+    counts = [(bound, a - b) for (bound, a), (_, b) in zip(after, before)]
+    total = counts[-1][1] if counts else 0
+    if total == 0:
+        return None, 0
+    for bound, count in counts:
+        if count >= fraction * total:
+            return bound, total
+    return float("inf"), total
+
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+def format_seconds(value):
+    if value is None:
+        return "-"
+    return "> largest bucket" if value == float("inf") else f"{value * 1000:.2f} ms"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--duration", type=float, default=30.0, help="seconds to poll for")
+    parser.add_argument("--interval", type=float, default=0.1, help="seconds between polls")
+    parser.add_argument("--close", action="store_true",
+                        help="open a new connection for each request, as older firmware does")
+    args = parser.parse_args()
+
+    conn = http.client.HTTPConnection(args.host, args.port, timeout=10)
+    before, i2c_before = scrape(conn)
+
+    times = []
+    end = time.monotonic() + args.duration
+    while time.monotonic() < end:
+        start = time.perf_counter()
+        conn.request("GET", "/api/v1/readings", headers={"Connection": "close"} if args.close else {})
+        conn.getresponse().read()
+        times.append((time.perf_counter() - start) * 1000.0)
+        time.sleep(args.interval)
+
+    after, i2c_after = scrape(conn)
+    conn.close()
+
+    print(f"client round trips: {len(times)}")
+    if times:
+        print(f"    p50 {percentile(times, 0.50):.2f} ms, p99 {percentile(times, 0.99):.2f} ms, "
+              f"max {max(times):.2f} ms")
+    for name in HISTOGRAMS:
+        if name not in after:
+            print(f"{name}: not reported by this firmware")
+            continue
+        p50, total = histogram_percentile(before.get(name, []), after[name], 0.50)
+        p99, _ = histogram_percentile(before.get(name, []), after[name], 0.99)
+        print(f"{name}: {total} observations")
+        print(f"    p50 <= {format_seconds(p50)}, p99 <= {format_seconds(p99)}")
+
+    devices = sorted({device for (name, device) in i2c_after if name == I2C_COUNTERS[1]})
+    if not devices:
+        print("i2c_cpu_seconds_total: not reported by this firmware (transfers block)")
+    for device in devices:
+        bus, cpu = (i2c_after.get((name, device), 0.0) - i2c_before.get((name, device), 0.0)
+                    for name in I2C_COUNTERS)
+        share = f"{cpu / bus * 100:.2f}% of it" if bus > 0 else "-"
+        print(f"i2c {device}: {bus * 1000:.1f} ms on the bus, CPU {cpu * 1000:.2f} ms ({share})")
+
+
+if __name__ == "__main__":
+    main()
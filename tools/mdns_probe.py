@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""
+File: mdns_probe.py
+Language: Python 3 (standard library only)
+Author: Andrew Poon
+Date: 10/20/26
+Description: Measures how long it takes to discover the device over mDNS
+    (mdns_responder.c). Sends one-shot queries to 224.0.0.251:5353 from an
+    ordinary UDP port, so it runs next to avahi-daemon without root, and
+    prints the records of each answer and the time until it arrived.
+
+    --browse asks for _http._tcp.local (as a service browser would) and
+    prints the instance, port, TXT fields and address; otherwise the
+    hostname's address record is resolved.
+
+Usage:
+    python3 tools/mdns_probe.py pico2w.local                 # resolve 10 times, report timing
+    python3 tools/mdns_probe.py --browse --count 5           # browse for HTTP services
+    python3 tools/mdns_probe.py pico2w.local --interface 192.168.1.20
+"""
+
+import argparse
+import random
+import socket
+import statistics
+import struct
+import time
+
+MDNS_GROUP = "224.0.0.251"
+MDNS_PORT = 5353
+TYPE_NAMES = {1: "A", 12: "PTR", 16: "TXT", 28: "AAAA", 33: "SRV", 47: "NSEC"}
+
+
+def encode_name(name):
+    out = b""
+    for label in name.rstrip(".").split("."):
+        out += bytes([len(label)]) + label.encode()
+    return out + b"\0"
+
+
+def build_query(name, qtype):
+    """A standard query with one question; returns (id, packet)."""
+    query_id = random.randrange(1, 0x10000)
+    header = struct.pack(">HHHHHH", query_id, 0, 1, 0, 0, 0)
+    return query_id, header + encode_name(name) + struct.pack(">HH", qtype, 1)
+
+
+def read_name(msg, pos):
+    """Read a possibly compressed name; returns (name, position after it)."""
+    labels = []
+    end = None
+    for _ in range(64):
+        length = msg[pos]
+        if length == 0:
+            pos += 1
+            break
+        if length & 0xC0 == 0xC0:
+            if end is None:
+                end = pos + 2
+            pos = ((length & 0x3F) << 8) | msg[pos + 1]
+            continue
+        labels.append(msg[pos + 1:pos + 1 + length].decode(errors="replace"))
+        pos += 1 + length
+    return ".".join(labels), (end if end is not None else pos)
+
+
+def parse_reply(msg):
+    """Return the list of (name, type, ttl, value) records in a response."""
+    _, flags, qd, an, ns, ar = struct.unpack_from(">HHHHHH", msg)
+    pos = 12
+    for _ in range(qd):
+        _, pos = read_name(msg, pos)
+        pos += 4
+    records = []
+    for _ in range(an + ns + ar):
+        name, pos = read_name(msg, pos)
+        rtype, _, ttl, rdlen = struct.unpack_from(">HHIH", msg, pos)
+        pos += 10
+        rdata = msg[pos:pos + rdlen]
+        if rtype == 1:
+            value = socket.inet_ntoa(rdata)
+        elif rtype == 12:
+            value = read_name(msg, pos)[0]
+        elif rtype == 33:
+            _, _, port = struct.unpack_from(">HHH", rdata)
+            value = f"{read_name(msg, pos + 6)[0]}:{port}"
+        elif rtype == 16:
+            fields, i = [], 0
+            while i < len(rdata):
+                fields.append(rdata[i + 1:i + 1 + rdata[i]].decode(errors="replace"))
+                i += 1 + rdata[i]
+            value = " ".join(fields)
+        else:
+            value = rdata.hex()
+        records.append((name, TYPE_NAMES.get(rtype, str(rtype)), ttl, value))
+        pos += rdlen
+    return records
+
+
+def probe(sock, name, qtype, timeout):
+    """Send one query; returns (milliseconds, records) or (None, []) on timeout."""
+    query_id, packet = build_query(name, qtype)
+    start = time.perf_counter()
+    sock.sendto(packet, (MDNS_GROUP, MDNS_PORT))
+    deadline = start + timeout
+    while True:
+        remaining = deadline - time.perf_counter()
+        if remaining <= 0:
+            return None, []
+        sock.settimeout(remaining)
+        try:
+            msg, _ = sock.recvfrom(9000)
+        except socket.timeout:
+            return None, []
+        if len(msg) >= 12 and struct.unpack_from(">H", msg)[0] == query_id:
+            return (time.perf_counter() - start) * 1000.0, parse_reply(msg)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("name", nargs="?", default="pico2w.local")
+    parser.add_argument("--browse", action="store_true", help="query _http._tcp.local instead")
+    parser.add_argument("--count", type=int, default=10)
+    parser.add_argument("--timeout", type=float, default=1.0, help="seconds to wait for each answer")
+    parser.add_argument("--interface", help="local IPv4 address to send the queries from")
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, 255)
+    if args.interface:
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_IF, socket.inet_aton(args.interface))
+        sock.bind((args.interface, 0))
+
+    name, qtype = ("_http._tcp.local", 12) if args.browse else (args.name, 1)
+    times = []
+    for i in range(args.count):
+        elapsed_ms, records = probe(sock, name, qtype, args.timeout)
+        if elapsed_ms is None:
+            print(f"{i + 1}: no answer within {args.timeout:.1f} s")
+            continue
+        times.append(elapsed_ms)
+        print(f"{i + 1}: {elapsed_ms:.1f} ms")
+        if i == 0:
+            for rname, rtype, ttl, value in records:
+                print(f"    {rname} {rtype} ttl={ttl} {value}")
+        time.sleep(0.2)
+
+    if times:
+        print(f"answered {len(times)}/{args.count}: min {min(times):.1f} ms, "
+              f"median {statistics.median(times):.1f} ms, max {max(times):.1f} ms")
+
+
+if __name__ == "__main__":
+    main()
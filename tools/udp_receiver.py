@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+File: udp_receiver.py
+Language: Python 3 (standard library only)
+Author: Andrew Poon
+Date: 10/20/26
+Description: Receiver for the UDP telemetry datagrams sent by network.c
+    (layout in telemetry.h). Prints each sample, reports samples lost in
+    transit from gaps in the sequence numbers, and estimates the radio
+    airtime each sample costs compared with polling the HTTP API.
+
+    Airtime is estimated for 802.11g/n OFDM at --rate Mbit/s: every frame
+    pays a fixed access overhead (DIFS, average backoff, preamble, SIFS and
+    the 802.11 ACK) plus its bytes, with MAC, IP and UDP/TCP headers added.
+
+Usage:
+    python3 tools/udp_receiver.py                                 # listen on port 5005
+    python3 tools/udp_receiver.py --http 192.168.4.1              # also compare with an HTTP poll
+    python3 tools/udp_receiver.py --send-test 20 --batch 4        # loopback test (run a listener first)
+"""
+
+import argparse
+import socket
+import struct
+import sys
+import time
+
+HEADER = struct.Struct("<2sBBI")   # magic, version, count, first sequence number
+RECORD = struct.Struct("<IhhBB")   # time_ms, humidity x10, temp_c x10, status, flags
+STATUS_NAMES = {0: "ok", 1: "i2c_error", 2: "busy", 3: "crc_error"}
+
+# Per-frame airtime model (microseconds / bytes)
+FRAME_OVERHEAD_US = 34 + 67.5 + 20 + 16 + 44   # DIFS, mean backoff, preamble, SIFS, ACK at 24 Mbit/s
+MAC_BYTES = 24 + 8 + 4                          # 802.11 header, LLC/SNAP, FCS
+IP_BYTES = 20
+UDP_BYTES = 8
+TCP_BYTES = 20
+TCP_MSS = 1460
+
+
+def frame_airtime_us(payload_bytes, rate_mbps):
+    """Airtime of one data frame carrying payload_bytes above the IP layer."""
+    return FRAME_OVERHEAD_US + (payload_bytes + IP_BYTES + MAC_BYTES) * 8 / rate_mbps
+
+
+def decode(data):
+    """Return (first sequence number, list of sample dicts) from a datagram."""
+    if len(data) < HEADER.size:
+        raise ValueError("datagram shorter than its header")
+    magic, version, count, first_seq = HEADER.unpack_from(data)
+    if magic != b"HT" or version != 1:
+        raise ValueError(f"not a telemetry datagram (magic {magic!r}, version {version})")
+    if len(data) != HEADER.size + count * RECORD.size:
+        raise ValueError(f"length {len(data)} doesn't match {count} records")
+    samples = []
+    for i in range(count):
+        time_ms, humidity, temp, status, flags = RECORD.unpack_from(data, HEADER.size + i * RECORD.size)
+        samples.append({
+            "seq": first_seq + i,
+            "time_ms": time_ms,
+            "humidity": humidity / 10.0,
+            "temp_c": temp / 10.0,
+            "status": STATUS_NAMES.get(status, status),
+            "led": bool(flags & 1),
+            "valid": bool(flags & 2),
+        })
+    return first_seq, samples
+
+
+def http_poll_airtime_us(host, port, rate_mbps):
+    """Fetch /api/v1/readings once over a kept-alive connection and estimate its airtime."""
+    request = (f"GET /api/v1/readings HTTP/1.1\r\nHost: {host}\r\n"
+               f"Connection: keep-alive\r\n\r\n").encode()
+    with socket.create_connection((host, port), timeout=10) as sock:
+        sock.sendall(request)
+        response = b""
+        while b"\r\n\r\n" not in response:
+            chunk = sock.recv(2048)
+            if not chunk:
+                break
+            response += chunk
+        head, _, body = response.partition(b"\r\n\r\n")
+        length = 0
+        for line in head.split(b"\r\n"):
+            if line.lower().startswith(b"content-length:"):
+                length = int(line.split(b":", 1)[1])
+        while len(body) < length:
+            body += sock.recv(2048)
+    response_bytes = len(head) + 4 + length
+
+    # Request, response segment(s), and one pure TCP ACK in each direction
+    airtime = frame_airtime_us(TCP_BYTES + len(request), rate_mbps)
+    for offset in range(0, response_bytes, TCP_MSS):
+        airtime += frame_airtime_us(TCP_BYTES + min(TCP_MSS, response_bytes - offset), rate_mbps)
+    airtime += 2 * frame_airtime_us(TCP_BYTES, rate_mbps)
+    return airtime, len(request), response_bytes
+
+
+def listen(args):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind((args.bind, args.port))
+    print(f"listening on {args.bind}:{args.port}", file=sys.stderr)
+
+    if args.http:
+        http_us, req_len, resp_len = http_poll_airtime_us(args.http, args.http_port, args.rate)
+        print(f"HTTP poll: {req_len} B request + {resp_len} B response, "
+              f"~{http_us:.0f} us airtime per sample", file=sys.stderr)
+
+    expected = None
+    received = lost = 0
+    while args.count == 0 or received < args.count:
+        data, sender = sock.recvfrom(2048)
+        try:
+            first_seq, samples = decode(data)
+        except ValueError as e:
+            print(f"{sender[0]}: ignored: {e}", file=sys.stderr)
+            continue
+
+        if expected is not None and first_seq != expected:
+            if first_seq > expected:
+                lost += first_seq - expected
+                print(f"lost {first_seq - expected} sample(s) before seq {first_seq}", file=sys.stderr)
+            else:
+                print(f"sequence restarted at {first_seq} (device reboot?)", file=sys.stderr)
+        expected = first_seq + len(samples)
+        received += len(samples)
+
+        udp_us = frame_airtime_us(UDP_BYTES + len(data), args.rate) / len(samples)
+        for s in samples:
+            print(f"seq={s['seq']} t={s['time_ms']} humidity={s['humidity']:.1f} "
+                  f"temp_c={s['temp_c']:.1f} status={s['status']} led={int(s['led'])}")
+        print(f"  datagram {len(data)} B, {len(samples)} sample(s), ~{udp_us:.0f} us airtime per sample",
+              file=sys.stderr)
+
+    print(f"received {received} sample(s), lost {lost}", file=sys.stderr)
+    return 0 if lost == 0 else 1
+
+
+def send_test(args):
+    """Send synthetic datagrams in the device's format, for loopback testing."""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    seq = 0
+    for d in range(args.send_test):
+        records = b"".join(
+            RECORD.pack((seq + i) * 2000, 450 + i, 215, 0, 3) for i in range(args.batch))
+        datagram = HEADER.pack(b"HT", 1, args.batch, seq) + records
+        if d not in args.drop:
+            sock.sendto(datagram, (args.host, args.port))
+        seq += args.batch
+        time.sleep(0.01)
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=5005)
+    parser.add_argument("--bind", default="0.0.0.0", help="address to listen on")
+    parser.add_argument("--count", type=int, default=0, help="stop after this many samples")
+    parser.add_argument("--rate", type=float, default=54.0, help="PHY rate in Mbit/s for airtime estimates")
+    parser.add_argument("--http", metavar="HOST", help="device to poll once over HTTP for comparison")
+    parser.add_argument("--http-port", type=int, default=80)
+    parser.add_argument("--send-test", type=int, metavar="N", help="send N test datagrams instead")
+    parser.add_argument("--host", default="127.0.0.1", help="destination for --send-test")
+    parser.add_argument("--batch", type=int, default=1, help="samples per test datagram")
+    parser.add_argument("--drop", type=int, nargs="*", default=[], help="test datagrams to skip")
+    args = parser.parse_args()
+
+    sys.exit(send_test(args) if args.send_test else listen(args))
+
+
+if __name__ == "__main__":
+    main()
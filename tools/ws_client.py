@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""
+File: ws_client.py
+Language: Python 3 (standard library only)
+Author: Andrew Poon
+Date: 10/19/26
+Description: Minimal WebSocket client for the /ws endpoint served by network.c.
+    Prints each binary telemetry frame and can send control messages,
+    reporting the round-trip time until the updated state comes back.
+    Exits with status 1 if the device answers a command with an error.
+
+Usage:
+    python3 tools/ws_client.py 192.168.4.1                 # watch telemetry
+    python3 tools/ws_client.py 192.168.4.1 led=off led=on  # send commands, time round trips
+    python3 tools/ws_client.py --port 8080 127.0.0.1 led=off  # the host build (humidity_host)
+"""
+
+import argparse
+import base64
+import hashlib
+import os
+import socket
+import struct
+import sys
+import time
+
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+STATUS_NAMES = {0: "ok", 1: "i2c_error", 2: "busy", 3: "crc_error"}
+
+
+def connect(host, port, path):
+    """Open a TCP connection and perform the opening handshake."""
+    sock = socket.create_connection((host, port), timeout=10)
+    sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    key = base64.b64encode(os.urandom(16)).decode()
+    request = (f"GET {path} HTTP/1.1\r\nHost: {host}\r\nUpgrade: websocket\r\n"
+               f"Connection: Upgrade\r\nSec-WebSocket-Key: {key}\r\n"
+               f"Sec-WebSocket-Version: 13\r\n\r\n")
+    sock.sendall(request.encode())
+
+    response = b""
+    while b"\r\n\r\n" not in response:
+        chunk = sock.recv(1024)
+        if not chunk:
+            raise ConnectionError("connection closed during handshake")
+        response += chunk
+    head, _, rest = response.partition(b"\r\n\r\n")
+    if not head.startswith(b"HTTP/1.1 101"):
+        raise ConnectionError(head.decode(errors="replace"))
+
+    expected = base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+    if f"Sec-WebSocket-Accept: {expected}".encode() not in head:
+        raise ConnectionError("bad Sec-WebSocket-Accept")
+    return sock, bytearray(rest)
+
+
+def send_frame(sock, opcode, payload):
+    """Send one masked client frame."""
+    mask = os.urandom(4)
+    header = bytes([0x80 | opcode])
+    if len(payload) < 126:
+        header += bytes([0x80 | len(payload)])
+    else:
+        header += bytes([0x80 | 126]) + struct.pack(">H", len(payload))
+    masked = bytes(b ^ mask[i & 3] for i, b in enumerate(payload))
+    sock.sendall(header + mask + masked)
+
+
+def recv_frame(sock, buf):
+    """Read one server frame, returning (opcode, payload)."""
+    def need(n):
+        while len(buf) < n:
+            chunk = sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("connection closed")
+            buf.extend(chunk)
+
+    need(2)
+    opcode = buf[0] & 0x0F
+    length = buf[1] & 0x7F
+    pos = 2
+    if length == 126:
+        need(4)
+        length = struct.unpack(">H", buf[2:4])[0]
+        pos = 4
+    elif length == 127:
+        need(10)
+        length = struct.unpack(">Q", buf[2:10])[0]
+        pos = 10
+    need(pos + length)
+    payload = bytes(buf[pos:pos + length])
+    del buf[:pos + length]
+    return opcode, payload
+
+
+def decode_telemetry(payload):
+    """Decode the 20-byte binary telemetry frame (see ws_build_telemetry in network.c)."""
+    version, status, flags, brightness, ts, hum, temp_c, interval = struct.unpack(
+        "<BBBBIffI", payload[:20])
+    return {
+        "version": version,
+        "status": STATUS_NAMES.get(status, status),
+        "led": bool(flags & 1),
+        "valid": bool(flags & 2),
+        "brightness": brightness,
+        "timestamp_ms": ts,
+        "humidity": round(hum, 1),
+        "temp_c": round(temp_c, 1),
+        "interval_ms": interval,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host")
+    parser.add_argument("commands", nargs="*", help="control messages such as led=on")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--path", default="/ws")
+    args = parser.parse_args()
+
+    sock, buf = connect(args.host, args.port, args.path)
+    opcode, payload = recv_frame(sock, buf)
+    print("initial:", decode_telemetry(payload))
+
+    if not args.commands:
+        while True:
+            opcode, payload = recv_frame(sock, buf)
+            if opcode == 0x2:
+                print(decode_telemetry(payload))
+            elif opcode == 0x9:
+                send_frame(sock, 0xA, payload)
+
+    failed = False
+    for command in args.commands:
+        start = time.perf_counter()
+        send_frame(sock, 0x1, command.encode())
+        while True:
+            opcode, payload = recv_frame(sock, buf)
+            if opcode in (0x1, 0x2):
+                break
+        elapsed_ms = (time.perf_counter() - start) * 1000.0
+        reply = decode_telemetry(payload) if opcode == 0x2 else payload.decode()
+        print(f"{command}: {elapsed_ms:.1f} ms -> {reply}")
+        failed |= opcode != 0x2   # Text replies are errors
+
+    send_frame(sock, 0x8, struct.pack(">H", 1000))
+    sock.close()
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
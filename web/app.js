@@ -0,0 +1,24 @@
+// Static page logic: all readings arrive as JSON from the device
+function $(id) { return document.getElementById(id); }
+
+// Update the page from a readings object (see /api/v1/readings)
+function show(d) {
+    if (d.humidity !== null) $('hum').textContent = d.humidity.toFixed(1);
+    if (d.temp_f !== null) $('tmp').textContent = d.temp_f.toFixed(1);
+    $('led').textContent = d.led ? 'On' : 'Off';
+    $('tgl').textContent = d.led ? 'Turn LEDs Off' : 'Turn LEDs On';
+    $('tgl').href = d.led ? '/set?led=off' : '/set?led=on';
+}
+
+// Toggle without reloading; /set answers with the updated readings
+$('tgl').onclick = function (e) {
+    e.preventDefault();
+    fetch(this.getAttribute('href'))
+        .then(function (r) { return r.json(); })
+        .then(show);
+};
+
+// The stream sends the current reading on connect, then every new sample
+new EventSource('/events').onmessage = function (e) {
+    show(JSON.parse(e.data));
+};
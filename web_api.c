@@ -0,0 +1,179 @@
+/*
+File: web_api.c
+Language: C
+Author: Andrew Poon
+Date: 10/18/26
+Description:
+    Provides the JSON serialization used by the web API in network.c. Output
+    is produced in small pieces through an api_sink so it can be written
+    straight into the TCP send buffer instead of being staged in a body
+    buffer first.
+
+Responsibilities:
+- Parse the ?fields= parameter value into a field mask
+- Serialize the latest reading as a compact JSON object
+
+Requires the following modules:
+- web_api.h: for interface definitions
+*/
+
+#include "web_api.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Field names, indexed by bit position of the matching API_FIELD_* flag
+static const char *const API_FIELD_NAMES[] = {
+    "humidity",
+    "temp_c",
+    "temp_f",
+    "led",
+    "timestamp_ms",
+    "age_ms",
+    "status",
+};
+
+#define API_FIELD_COUNT (sizeof(API_FIELD_NAMES) / sizeof(API_FIELD_NAMES[0]))
+
+void api_sink_init(api_sink *sink, api_write_fn write, void *ctx) {
+    sink->write = write;
+    sink->ctx = ctx;
+    sink->length = 0;
+    sink->ok = true;
+}
+
+bool api_buffer_write(void *ctx, const char *data, uint16_t len) {
+    api_buffer *buf = (api_buffer *)ctx;
+    if (len > buf->size - buf->len) {
+        return false;
+    }
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+    return true;
+}
+
+// Append raw bytes to the sink
+static void sink_put(api_sink *sink, const char *data, size_t len) {
+    sink->length += len;
+    if (sink->write && sink->ok) {
+        sink->ok = sink->write(sink->ctx, data, (uint16_t)len);
+    }
+}
+
+static void sink_puts(api_sink *sink, const char *s) {
+    sink_put(sink, s, strlen(s));
+}
+
+// Append a float with one decimal place, or null if it is not a number
+static void sink_put_float(api_sink *sink, float value) {
+    if (isnan(value) || isinf(value)) {
+        sink_puts(sink, "null");
+        return;
+    }
+    char num[16];
+    int len = snprintf(num, sizeof(num), "%.1f", value);
+    if (len > 0) {
+        sink_put(sink, num, (size_t)len);
+    }
+}
+
+static void sink_put_uint(api_sink *sink, uint32_t value) {
+    char num[12];
+    int len = snprintf(num, sizeof(num), "%lu", (unsigned long)value);
+    if (len > 0) {
+        sink_put(sink, num, (size_t)len);
+    }
+}
+
+// Append the "key": prefix, with a comma when it is not the first member
+static void sink_put_key(api_sink *sink, uint32_t bit, bool *first) {
+    if (!*first) {
+        sink_put(sink, ",", 1);
+    }
+    *first = false;
+    sink_put(sink, "\"", 1);
+    sink_puts(sink, API_FIELD_NAMES[bit]);
+    sink_put(sink, "\":", 2);
+}
+
+// Look up a field name of the given length and return its flag, or 0
+static uint32_t field_from_name(const char *name, size_t len) {
+    for (uint32_t i = 0; i < API_FIELD_COUNT; i++) {
+        if (strlen(API_FIELD_NAMES[i]) == len && strncmp(API_FIELD_NAMES[i], name, len) == 0) {
+            return 1u << i;
+        }
+    }
+    return 0;
+}
+
+uint32_t api_parse_fields(const char *list) {
+    if (!list) {
+        return API_FIELDS_ALL;
+    }
+
+    // Split on ',' and collect known names
+    uint32_t mask = 0;
+    const char *start = list;
+    while (true) {
+        const char *end = strchr(start, ',');
+        size_t len = end ? (size_t)(end - start) : strlen(start);
+        mask |= field_from_name(start, len);
+        if (!end) {
+            break;
+        }
+        start = end + 1;
+    }
+
+    return mask;
+}
+
+size_t api_write_readings_json(api_sink *sink, uint32_t fields, const api_reading *r) {
+    size_t start_len = sink->length;
+    bool first = true;
+
+    sink_put(sink, "{", 1);
+
+    if (fields & API_FIELD_HUMIDITY) {
+        sink_put_key(sink, 0, &first);
+        sink_put_float(sink, r->has_sample ? r->humidity : NAN);
+    }
+    if (fields & API_FIELD_TEMP_C) {
+        sink_put_key(sink, 1, &first);
+        sink_put_float(sink, r->has_sample ? r->temp_celsius : NAN);
+    }
+    if (fields & API_FIELD_TEMP_F) {
+        sink_put_key(sink, 2, &first);
+        sink_put_float(sink, r->has_sample ? r->temp_fahrenheit : NAN);
+    }
+    if (fields & API_FIELD_LED) {
+        sink_put_key(sink, 3, &first);
+        sink_puts(sink, r->led_enabled ? "true" : "false");
+    }
+    if (fields & API_FIELD_TIMESTAMP) {
+        sink_put_key(sink, 4, &first);
+        if (r->has_sample) {
+            sink_put_uint(sink, r->sample_ms);
+        } else {
+            sink_puts(sink, "null");
+        }
+    }
+    if (fields & API_FIELD_AGE) {
+        sink_put_key(sink, 5, &first);
+        if (r->has_sample) {
+            sink_put_uint(sink, r->now_ms - r->sample_ms);
+        } else {
+            sink_puts(sink, "null");
+        }
+    }
+    if (fields & API_FIELD_STATUS) {
+        sink_put_key(sink, 6, &first);
+        sink_put(sink, "\"", 1);
+        sink_puts(sink, r->status ? r->status : "unknown");
+        sink_put(sink, "\"", 1);
+    }
+
+    sink_put(sink, "}", 1);
+
+    return sink->length - start_len;
+}
@@ -0,0 +1,113 @@
+/*
+File: web_api.h
+Language: C
+Author: Andrew Poon
+Date: 10/18/26
+Description: Public interface for the JSON web API served by network.c.
+    Declares the output sink used to stream serialized JSON straight into
+    the TCP send buffer, the reading structure the serializer consumes,
+    and the field selection flags used by the ?fields= query parameter.
+*/
+
+#ifndef WEB_API_H
+#define WEB_API_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Fields selectable through ?fields=name1,name2 (names match the JSON keys)
+#define API_FIELD_HUMIDITY   (1u << 0)   // "humidity"
+#define API_FIELD_TEMP_C     (1u << 1)   // "temp_c"
+#define API_FIELD_TEMP_F     (1u << 2)   // "temp_f"
+#define API_FIELD_LED        (1u << 3)   // "led"
+#define API_FIELD_TIMESTAMP  (1u << 4)   // "timestamp_ms"
+#define API_FIELD_AGE        (1u << 5)   // "age_ms"
+#define API_FIELD_STATUS     (1u << 6)   // "status"
+#define API_FIELDS_ALL       0x7Fu
+
+/**
+ * @brief Callback that receives serialized output
+ *
+ * @param ctx   Opaque pointer given to api_sink_init()
+ * @param data  Bytes to append (not null-terminated)
+ * @param len   Number of bytes in data
+ * @return true if the bytes were accepted, false to stop further writes
+ */
+typedef bool (*api_write_fn)(void *ctx, const char *data, uint16_t len);
+
+/**
+ * @brief Destination for serialized API output
+ *
+ * A sink with a NULL write function only counts bytes, which lets the
+ * caller compute Content-Length before writing the body for real.
+ */
+typedef struct {
+    api_write_fn write;  // Output callback, or NULL to only measure
+    void *ctx;           // Passed through to write
+    size_t length;       // Number of bytes emitted so far
+    bool ok;             // Cleared once a write fails
+} api_sink;
+
+/**
+ * @brief Fixed memory buffer that an api_sink can write into
+ */
+typedef struct {
+    char *data;     // Destination buffer
+    size_t size;    // Capacity of data in bytes
+    size_t len;     // Number of bytes written so far
+} api_buffer;
+
+/**
+ * @brief Values reported by the readings endpoint
+ */
+typedef struct {
+    float humidity;          // Relative humidity in percent
+    float temp_celsius;      // Temperature in Celsius
+    float temp_fahrenheit;   // Temperature in Fahrenheit
+    bool led_enabled;        // Current LED array output state
+    bool has_sample;         // false until the first sample was taken
+    uint32_t sample_ms;      // Time of the sample in ms since boot
+    uint32_t now_ms;         // Current time in ms since boot (for the age)
+    const char *status;      // Sensor status name, e.g. "ok"
+} api_reading;
+
+/**
+ * @brief Prepare a sink for serialization
+ *
+ * @param sink   Sink to initialize
+ * @param write  Output callback, or NULL to only count bytes
+ * @param ctx    Opaque pointer passed to write
+ */
+void api_sink_init(api_sink *sink, api_write_fn write, void *ctx);
+
+/**
+ * @brief api_write_fn that appends to an api_buffer passed as ctx
+ *
+ * @return false once the buffer is full (the output is then incomplete)
+ */
+bool api_buffer_write(void *ctx, const char *data, uint16_t len);
+
+/**
+ * @brief Parse the value of a ?fields= parameter
+ *
+ * Names are separated by commas; the value must already be percent-decoded
+ * (see http_query_next()). Unknown names are ignored, but a list with no
+ * known name at all selects nothing, so the caller can reject it.
+ *
+ * @param list  Decoded comma-separated field names, or NULL for every field
+ * @return Bitmask of API_FIELD_* flags, 0 if list names no known field
+ */
+uint32_t api_parse_fields(const char *list);
+
+/**
+ * @brief Serialize a reading as a compact JSON object
+ *
+ * @param sink    Destination for the output
+ * @param fields  Bitmask of API_FIELD_* flags to include
+ * @param r       Reading to serialize
+ * @return Number of bytes emitted by this call
+ */
+size_t api_write_readings_json(api_sink *sink, uint32_t fields, const api_reading *r);
+
+#endif // WEB_API_H
@@ -0,0 +1,38 @@
+/*
+File: web_assets.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Interface to the static web assets embedded in flash. The
+    table itself (web_assets_data.c) is generated at build time by
+    tools/embed_assets.py from the files in web/, which stores each asset
+    both as-is and gzip-compressed so network.c can serve either straight
+    from flash.
+*/
+
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief One static file served by the web server
+ */
+typedef struct {
+    const char *path;          // URL path, e.g. "/" or "/style.css"
+    const char *content_type;  // Value for the Content-Type header
+    const uint8_t *data;       // Uncompressed contents (in flash)
+    uint32_t len;              // Length of data in bytes
+    const uint8_t *gzip_data;  // gzip-compressed contents (in flash)
+    uint32_t gzip_len;         // Length of gzip_data in bytes
+    const char *etag;          // Strong ETag of the uncompressed contents (quoted)
+    const char *gzip_etag;     // Strong ETag of the gzip contents (quoted)
+    const char *cache_control; // Value for the Cache-Control header
+} web_asset;
+
+// Generated table of every embedded asset, sorted by path (strcmp order)
+extern const web_asset WEB_ASSETS[];
+extern const size_t WEB_ASSET_COUNT;
+
+#endif // WEB_ASSETS_H
@@ -0,0 +1,343 @@
+/*
+File: websocket.c
+Language: C
+Author: Andrew Poon
+Date: 10/19/26
+Description:
+    Provides the protocol pieces of a minimal RFC 6455 WebSocket server:
+    the SHA-1 and base64 steps of the opening handshake, an incremental
+    frame parser that unmasks client frames in place as they arrive, and
+    the header encoder for unmasked server frames. Connection handling
+    lives in network.c.
+
+Responsibilities:
+- Compute Sec-WebSocket-Accept from the client's Sec-WebSocket-Key
+- Parse, validate, unmask and reassemble client frames
+- Encode server frame headers
+
+Requires the following modules:
+- websocket.h: for interface definitions
+*/
+
+#include "websocket.h"
+
+#include <string.h>
+
+// GUID appended to the client key (RFC 6455 section 1.3)
+static const char WS_GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+// Parser states
+#define WS_STATE_HEADER   0
+#define WS_STATE_PAYLOAD  1
+
+// SHA-1 (FIPS 180-4), only used for the handshake so kept small over fast
+typedef struct {
+    uint32_t h[5];
+    uint8_t block[64];
+    size_t block_len;
+    uint64_t total_len;
+} sha1_ctx;
+
+static inline uint32_t rol32(uint32_t v, int n) {
+    return (v << n) | (v >> (32 - n));
+}
+
+static void sha1_init(sha1_ctx *ctx) {
+    ctx->h[0] = 0x67452301;
+    ctx->h[1] = 0xEFCDAB89;
+    ctx->h[2] = 0x98BADCFE;
+    ctx->h[3] = 0x10325476;
+    ctx->h[4] = 0xC3D2E1F0;
+    ctx->block_len = 0;
+    ctx->total_len = 0;
+}
+
+// Process one full 64-byte block
+static void sha1_block(sha1_ctx *ctx) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)ctx->block[i * 4] << 24) | ((uint32_t)ctx->block[i * 4 + 1] << 16) |
+               ((uint32_t)ctx->block[i * 4 + 2] << 8) | ctx->block[i * 4 + 3];
+    }
+    for (int i = 16; i < 80; i++) {
+        w[i] = rol32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+
+    uint32_t a = ctx->h[0], b = ctx->h[1], c = ctx->h[2], d = ctx->h[3], e = ctx->h[4];
+    for (int i = 0; i < 80; i++) {
+        uint32_t f, k;
+        if (i < 20) {
+            f = (b & c) | (~b & d);
+            k = 0x5A827999;
+        } else if (i < 40) {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1;
+        } else if (i < 60) {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8F1BBCDC;
+        } else {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6;
+        }
+        uint32_t t = rol32(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = rol32(b, 30);
+        b = a;
+        a = t;
+    }
+
+    ctx->h[0] += a;
+    ctx->h[1] += b;
+    ctx->h[2] += c;
+    ctx->h[3] += d;
+    ctx->h[4] += e;
+}
+
+static void sha1_update(sha1_ctx *ctx, const uint8_t *data, size_t len) {
+    ctx->total_len += len;
+    while (len--) {
+        ctx->block[ctx->block_len++] = *data++;
+        if (ctx->block_len == 64) {
+            sha1_block(ctx);
+            ctx->block_len = 0;
+        }
+    }
+}
+
+static void sha1_final(sha1_ctx *ctx, uint8_t digest[20]) {
+    uint64_t bit_len = ctx->total_len * 8;
+
+    // Pad with 0x80, zeros, then the 64-bit big-endian message length
+    uint8_t pad = 0x80;
+    sha1_update(ctx, &pad, 1);
+    pad = 0x00;
+    while (ctx->block_len != 56) {
+        sha1_update(ctx, &pad, 1);
+    }
+    uint8_t len_be[8];
+    for (int i = 0; i < 8; i++) {
+        len_be[i] = (uint8_t)(bit_len >> (56 - 8 * i));
+    }
+    sha1_update(ctx, len_be, 8);
+
+    for (int i = 0; i < 5; i++) {
+        digest[i * 4]     = (uint8_t)(ctx->h[i] >> 24);
+        digest[i * 4 + 1] = (uint8_t)(ctx->h[i] >> 16);
+        digest[i * 4 + 2] = (uint8_t)(ctx->h[i] >> 8);
+        digest[i * 4 + 3] = (uint8_t)(ctx->h[i]);
+    }
+}
+
+// Standard base64 encoding with padding; out must hold 4 * ceil(len / 3) + 1 bytes
+static void base64_encode(const uint8_t *data, size_t len, char *out) {
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    size_t i = 0;
+    while (i + 2 < len) {
+        uint32_t v = ((uint32_t)data[i] << 16) | ((uint32_t)data[i + 1] << 8) | data[i + 2];
+        *out++ = alphabet[(v >> 18) & 0x3F];
+        *out++ = alphabet[(v >> 12) & 0x3F];
+        *out++ = alphabet[(v >> 6) & 0x3F];
+        *out++ = alphabet[v & 0x3F];
+        i += 3;
+    }
+    if (i < len) {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < len) {
+            v |= (uint32_t)data[i + 1] << 8;
+        }
+        *out++ = alphabet[(v >> 18) & 0x3F];
+        *out++ = alphabet[(v >> 12) & 0x3F];
+        *out++ = (i + 1 < len) ? alphabet[(v >> 6) & 0x3F] : '=';
+        *out++ = '=';
+    }
+    *out = '\0';
+}
+
+void ws_accept_key(const char *client_key, size_t key_len, char out[WS_ACCEPT_KEY_LEN]) {
+    sha1_ctx ctx;
+    uint8_t digest[20];
+
+    sha1_init(&ctx);
+    sha1_update(&ctx, (const uint8_t *)client_key, key_len);
+    sha1_update(&ctx, (const uint8_t *)WS_GUID, sizeof(WS_GUID) - 1);
+    sha1_final(&ctx, digest);
+
+    base64_encode(digest, sizeof(digest), out);
+}
+
+void ws_parser_init(ws_parser *parser) {
+    memset(parser, 0, sizeof(*parser));
+    parser->state = WS_STATE_HEADER;
+    parser->header_need = 2;
+}
+
+// Fail parsing with the given close status
+static ws_parse_result ws_fail(ws_parser *parser, uint16_t code) {
+    parser->close_code = code;
+    return WS_PARSE_ERROR;
+}
+
+// Validate a complete frame header and prepare to read its payload
+static ws_parse_result ws_begin_frame(ws_parser *parser) {
+    const uint8_t *h = parser->header;
+
+    parser->frame_fin = (h[0] & 0x80) != 0;
+    parser->frame_opcode = h[0] & 0x0F;
+    parser->frame_pos = 0;
+
+    // Extensions are never negotiated, so reserved bits must be clear
+    if (h[0] & 0x70) {
+        return ws_fail(parser, WS_CLOSE_PROTOCOL);
+    }
+    // Clients must mask every frame (RFC 6455 section 5.1)
+    if (!(h[1] & 0x80)) {
+        return ws_fail(parser, WS_CLOSE_PROTOCOL);
+    }
+
+    uint8_t len7 = h[1] & 0x7F;
+    size_t pos = 2;
+    if (len7 == 126) {
+        parser->frame_len = ((uint64_t)h[2] << 8) | h[3];
+        pos = 4;
+    } else if (len7 == 127) {
+        parser->frame_len = 0;
+        for (int i = 0; i < 8; i++) {
+            parser->frame_len = (parser->frame_len << 8) | h[2 + i];
+        }
+        pos = 10;
+    } else {
+        parser->frame_len = len7;
+    }
+    memcpy(parser->mask, &h[pos], 4);
+
+    uint8_t op = parser->frame_opcode;
+    if (op & 0x08) {
+        // Control frames: close, ping or pong, never fragmented
+        if (op > WS_OP_PONG || !parser->frame_fin || parser->frame_len > WS_MAX_CONTROL) {
+            return ws_fail(parser, WS_CLOSE_PROTOCOL);
+        }
+        parser->control_len = 0;
+    } else {
+        if (op > WS_OP_BINARY) {
+            return ws_fail(parser, WS_CLOSE_PROTOCOL);
+        }
+        if (op == WS_OP_CONTINUATION) {
+            if (!parser->in_message) {
+                return ws_fail(parser, WS_CLOSE_PROTOCOL);
+            }
+        } else {
+            if (parser->in_message) {
+                return ws_fail(parser, WS_CLOSE_PROTOCOL);
+            }
+            parser->msg_opcode = op;
+            parser->payload_len = 0;
+            parser->in_message = true;
+        }
+        if (parser->frame_len > WS_MAX_PAYLOAD - parser->payload_len) {
+            return ws_fail(parser, WS_CLOSE_TOO_BIG);
+        }
+    }
+
+    parser->state = WS_STATE_PAYLOAD;
+    return WS_PARSE_NEED_MORE;
+}
+
+// Finish the current frame and report a message if one is complete
+static ws_parse_result ws_end_frame(ws_parser *parser) {
+    parser->state = WS_STATE_HEADER;
+    parser->header_len = 0;
+    parser->header_need = 2;
+
+    if (parser->frame_opcode & 0x08) {
+        parser->opcode = parser->frame_opcode;
+        parser->message = parser->control;
+        parser->message_len = parser->control_len;
+        return WS_PARSE_MESSAGE;
+    }
+    if (parser->frame_fin) {
+        parser->in_message = false;
+        parser->opcode = parser->msg_opcode;
+        parser->message = parser->payload;
+        parser->message_len = parser->payload_len;
+        return WS_PARSE_MESSAGE;
+    }
+    return WS_PARSE_NEED_MORE;
+}
+
+ws_parse_result ws_parser_feed(ws_parser *parser, const uint8_t *data, size_t len,
+                               size_t *consumed) {
+    size_t i = 0;
+    ws_parse_result result = WS_PARSE_NEED_MORE;
+
+    while (i < len && result == WS_PARSE_NEED_MORE) {
+        if (parser->state == WS_STATE_HEADER) {
+            parser->header[parser->header_len++] = data[i++];
+
+            // The second byte tells how long the rest of the header is
+            if (parser->header_len == 2) {
+                uint8_t len7 = parser->header[1] & 0x7F;
+                parser->header_need = 2 + 4;
+                if (len7 == 126) {
+                    parser->header_need += 2;
+                } else if (len7 == 127) {
+                    parser->header_need += 8;
+                }
+            }
+            if (parser->header_len == parser->header_need) {
+                result = ws_begin_frame(parser);
+                if (result == WS_PARSE_NEED_MORE && parser->frame_len == 0) {
+                    result = ws_end_frame(parser);
+                }
+            }
+        } else {
+            // Copy and unmask as much of the payload as is available
+            uint8_t *dest = (parser->frame_opcode & 0x08)
+                                ? parser->control + parser->control_len
+                                : parser->payload + parser->payload_len;
+            size_t avail = len - i;
+            uint64_t remaining = parser->frame_len - parser->frame_pos;
+            size_t n = (remaining < avail) ? (size_t)remaining : avail;
+
+            for (size_t k = 0; k < n; k++) {
+                dest[k] = data[i + k] ^ parser->mask[(parser->frame_pos + k) & 3];
+            }
+            i += n;
+            parser->frame_pos += n;
+            if (parser->frame_opcode & 0x08) {
+                parser->control_len += n;
+            } else {
+                parser->payload_len += n;
+            }
+
+            if (parser->frame_pos == parser->frame_len) {
+                result = ws_end_frame(parser);
+            }
+        }
+    }
+
+    *consumed = i;
+    return result;
+}
+
+size_t ws_frame_header(uint8_t *out, uint8_t opcode, size_t payload_len) {
+    out[0] = 0x80 | (opcode & 0x0F);  // FIN set, server frames are never fragmented
+    if (payload_len < 126) {
+        out[1] = (uint8_t)payload_len;
+        return 2;
+    }
+    if (payload_len <= 0xFFFF) {
+        out[1] = 126;
+        out[2] = (uint8_t)(payload_len >> 8);
+        out[3] = (uint8_t)payload_len;
+        return 4;
+    }
+    out[1] = 127;
+    uint64_t len64 = payload_len;
+    for (int i = 0; i < 8; i++) {
+        out[2 + i] = (uint8_t)(len64 >> (56 - 8 * i));
+    }
+    return 10;
+}
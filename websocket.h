@@ -0,0 +1,127 @@
+/*
+File: websocket.h
+Language: C
+Author: Andrew Poon
+Date: 10/19/26
+Description: Public interface for the minimal RFC 6455 WebSocket support
+    used by network.c. Declares the opening handshake helper, an
+    incremental frame parser that works on data as it arrives from lwIP,
+    and a frame header encoder for server-to-client frames.
+
+    This module has no hardware or lwIP dependencies so it can be unit
+    tested on the host (see test_websocket.c).
+*/
+
+#ifndef WEBSOCKET_H
+#define WEBSOCKET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Largest data message accepted from a client (control commands are tiny)
+#define WS_MAX_PAYLOAD      128
+
+// Largest control frame payload allowed by RFC 6455
+#define WS_MAX_CONTROL      125
+
+// Length of a Sec-WebSocket-Accept value, plus the null terminator
+#define WS_ACCEPT_KEY_LEN   29
+
+// Largest frame header produced by ws_frame_header()
+#define WS_FRAME_HEADER_MAX 10
+
+// Frame opcodes (RFC 6455 section 5.2)
+#define WS_OP_CONTINUATION  0x0
+#define WS_OP_TEXT          0x1
+#define WS_OP_BINARY        0x2
+#define WS_OP_CLOSE         0x8
+#define WS_OP_PING          0x9
+#define WS_OP_PONG          0xA
+
+// Close status codes (RFC 6455 section 7.4.1)
+#define WS_CLOSE_NORMAL     1000
+#define WS_CLOSE_PROTOCOL   1002
+#define WS_CLOSE_TOO_BIG    1009
+
+/**
+ * @brief Outcome of feeding bytes to the frame parser
+ */
+typedef enum {
+    WS_PARSE_NEED_MORE = 0,  // All input consumed, no complete message yet
+    WS_PARSE_MESSAGE,        // A message is ready (opcode, message, message_len)
+    WS_PARSE_ERROR,          // Protocol violation; close with close_code
+} ws_parse_result;
+
+/**
+ * @brief Incremental parser state for frames received from one client
+ *
+ * When ws_parser_feed() returns WS_PARSE_MESSAGE, opcode, message and
+ * message_len describe the complete (unmasked, defragmented) message.
+ * Control frames may arrive in the middle of a fragmented data message,
+ * so they are collected in their own buffer.
+ */
+typedef struct {
+    uint8_t state;                    // Internal parser state
+    uint8_t header[14];               // Frame header bytes collected so far
+    uint8_t header_len;               // Number of bytes in header
+    uint8_t header_need;              // Header size once the length is known
+    uint8_t frame_opcode;             // Opcode of the frame being read
+    bool frame_fin;                   // FIN bit of the frame being read
+    uint8_t mask[4];                  // Masking key of the frame being read
+    uint64_t frame_len;               // Payload length of the frame being read
+    uint64_t frame_pos;               // Payload bytes of the frame read so far
+    uint8_t msg_opcode;               // Opcode of the data message in progress
+    bool in_message;                  // A fragmented data message is in progress
+    uint8_t payload[WS_MAX_PAYLOAD];  // Data message payload
+    size_t payload_len;               // Number of bytes in payload
+    uint8_t control[WS_MAX_CONTROL];  // Control frame payload
+    size_t control_len;               // Number of bytes in control
+    uint8_t opcode;                   // Opcode of the completed message
+    const uint8_t *message;           // Payload of the completed message
+    size_t message_len;               // Number of bytes in message
+    uint16_t close_code;              // Status to close with after WS_PARSE_ERROR
+} ws_parser;
+
+/**
+ * @brief Compute the Sec-WebSocket-Accept value for a handshake
+ *
+ * @param client_key  Sec-WebSocket-Key sent by the client
+ * @param key_len     Length of client_key in bytes
+ * @param out         Receives the null-terminated base64 accept value
+ */
+void ws_accept_key(const char *client_key, size_t key_len, char out[WS_ACCEPT_KEY_LEN]);
+
+/**
+ * @brief Reset a parser before the first frame of a connection
+ *
+ * @param parser  Parser to reset
+ */
+void ws_parser_init(ws_parser *parser);
+
+/**
+ * @brief Feed received bytes to the parser
+ *
+ * Parsing stops after each complete message so the caller can handle it;
+ * call again with the remaining bytes (data + consumed).
+ *
+ * @param parser    Parser state for the connection
+ * @param data      Received bytes
+ * @param len       Number of bytes in data
+ * @param consumed  Receives how many bytes of data were used
+ * @return Whether a message is ready, more data is needed, or an error occurred
+ */
+ws_parse_result ws_parser_feed(ws_parser *parser, const uint8_t *data, size_t len,
+                               size_t *consumed);
+
+/**
+ * @brief Encode an unmasked, final server frame header
+ *
+ * @param out          Receives the header (at least WS_FRAME_HEADER_MAX bytes)
+ * @param opcode       Frame opcode (WS_OP_*)
+ * @param payload_len  Number of payload bytes that will follow the header
+ * @return Number of header bytes written
+ */
+size_t ws_frame_header(uint8_t *out, uint8_t opcode, size_t payload_len);
+
+#endif // WEBSOCKET_H
@@ -0,0 +1,172 @@
+/*
+File: wifi_sta.c
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description:
+    Provides the WiFi station mode logic used by network.c. The state
+    machine is stepped from a periodic timer with the driver's link state
+    and tells the caller what to do next; the cache record is a small
+    fixed layout protected by a CRC-32 so erased or half-written flash
+    is never mistaken for network parameters.
+
+    Cache record layout (little-endian):
+        0   'W' 'C'           magic
+        2   u8  version       WIFI_CACHE_VERSION
+        3   u8  channel
+        4   u8[6] bssid
+        10  u8[4] ip, netmask, gateway (12 bytes)
+        22  u8  ssid length
+        23  char[32] ssid
+        55  zero padding
+        60  u32 CRC-32 of bytes 0-59
+
+Responsibilities:
+- Join, detect failures and timeouts, and back off between attempts
+- Fall back to AP mode after too many consecutive failures
+- Count connects, reconnects and failures and time each connection
+- Serialize and validate the cached network parameters
+
+Requires the following modules:
+- wifi_sta.h: for interface definitions
+- backoff.h: for rejoin delays
+*/
+
+#include "wifi_sta.h"
+
+#include <string.h>
+
+#define WIFI_CACHE_VERSION  1
+#define CACHE_CRC_OFFSET    (WIFI_CACHE_RECORD_LEN - 4)
+
+void wifi_sta_init(wifi_sta *s, uint8_t max_failures, bool have_cache, uint32_t now_ms) {
+    memset(s, 0, sizeof(*s));
+    backoff_init(&s->backoff, WIFI_BACKOFF_MIN_MS, WIFI_BACKOFF_MAX_MS);
+    s->state = WIFI_STA_WAITING;
+    s->state_ms = now_ms;
+    s->down_since_ms = now_ms;
+    s->retry_at_ms = now_ms;
+    s->max_failures = max_failures;
+    s->use_cache = have_cache;
+}
+
+static void enter(wifi_sta *s, wifi_sta_state state, uint32_t now_ms) {
+    s->state = state;
+    s->state_ms = now_ms;
+}
+
+static wifi_action join_failed(wifi_sta *s, uint32_t now_ms, uint32_t random) {
+    s->failures++;
+    s->join_failures++;
+    s->use_cache = false;  // The access point may have moved; scan next time
+
+    if (s->max_failures != 0 && s->failures >= s->max_failures) {
+        enter(s, WIFI_STA_FALLBACK, now_ms);
+        return WIFI_ACTION_FALLBACK;
+    }
+    enter(s, WIFI_STA_WAITING, now_ms);
+    s->retry_at_ms = now_ms + backoff_next(&s->backoff, random);
+    return WIFI_ACTION_ABORT;
+}
+
+wifi_action wifi_sta_step(wifi_sta *s, wifi_link link, uint32_t now_ms, uint32_t random) {
+    switch (s->state) {
+        case WIFI_STA_WAITING:
+            if ((int32_t)(now_ms - s->retry_at_ms) >= 0) {
+                enter(s, WIFI_STA_JOINING, now_ms);
+                return WIFI_ACTION_JOIN;
+            }
+            return WIFI_ACTION_NONE;
+
+        case WIFI_STA_JOINING:
+            if (link == WIFI_LINK_UP) {
+                s->last_join_ms = now_ms - s->state_ms;
+                s->outage_ms = now_ms - s->down_since_ms;
+                s->failures = 0;
+                s->connects++;
+                if (s->was_connected) {
+                    s->reconnects++;
+                }
+                s->was_connected = true;
+                backoff_reset(&s->backoff);
+                enter(s, WIFI_STA_CONNECTED, now_ms);
+                return WIFI_ACTION_CONNECTED;
+            }
+            if (link == WIFI_LINK_FAILED || link == WIFI_LINK_DOWN ||
+                now_ms - s->state_ms >= WIFI_JOIN_TIMEOUT_MS) {
+                return join_failed(s, now_ms, random);
+            }
+            return WIFI_ACTION_NONE;
+
+        case WIFI_STA_CONNECTED:
+            // JOINING here means still associated while the lease is renewed
+            if (link == WIFI_LINK_DOWN || link == WIFI_LINK_FAILED) {
+                s->down_since_ms = now_ms;
+                s->use_cache = true;  // Same access point is the best first guess
+                enter(s, WIFI_STA_WAITING, now_ms);
+                s->retry_at_ms = now_ms + backoff_next(&s->backoff, random);
+                return WIFI_ACTION_DISCONNECTED;
+            }
+            return WIFI_ACTION_NONE;
+
+        case WIFI_STA_FALLBACK:
+        default:
+            return WIFI_ACTION_NONE;
+    }
+}
+
+// CRC-32 (IEEE 802.3, reflected, as used by zlib)
+static uint32_t crc32(const uint8_t *data, size_t len) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+void wifi_cache_encode(const wifi_cache *c, uint8_t *out) {
+    memset(out, 0, WIFI_CACHE_RECORD_LEN);
+    out[0] = 'W';
+    out[1] = 'C';
+    out[2] = WIFI_CACHE_VERSION;
+    out[3] = c->channel;
+    memcpy(&out[4], c->bssid, 6);
+    memcpy(&out[10], c->ip, 4);
+    memcpy(&out[14], c->netmask, 4);
+    memcpy(&out[18], c->gateway, 4);
+    const char *end = memchr(c->ssid, '\0', WIFI_SSID_MAX);
+    size_t ssid_len = end ? (size_t)(end - c->ssid) : WIFI_SSID_MAX;
+    out[22] = (uint8_t)ssid_len;
+    memcpy(&out[23], c->ssid, ssid_len);
+
+    uint32_t crc = crc32(out, CACHE_CRC_OFFSET);
+    for (int i = 0; i < 4; i++) {
+        out[CACHE_CRC_OFFSET + i] = (uint8_t)(crc >> (8 * i));
+    }
+}
+
+bool wifi_cache_decode(const uint8_t *in, const char *ssid, wifi_cache *c) {
+    uint32_t stored = 0;
+    for (int i = 0; i < 4; i++) {
+        stored |= (uint32_t)in[CACHE_CRC_OFFSET + i] << (8 * i);
+    }
+    if (in[0] != 'W' || in[1] != 'C' || in[2] != WIFI_CACHE_VERSION ||
+        in[22] > WIFI_SSID_MAX || stored != crc32(in, CACHE_CRC_OFFSET)) {
+        return false;
+    }
+    if (strlen(ssid) != in[22] || memcmp(&in[23], ssid, in[22]) != 0) {
+        return false;  // Parameters for a different network
+    }
+
+    memset(c, 0, sizeof(*c));
+    memcpy(c->ssid, &in[23], in[22]);
+    c->channel = in[3];
+    memcpy(c->bssid, &in[4], 6);
+    memcpy(c->ip, &in[10], 4);
+    memcpy(c->netmask, &in[14], 4);
+    memcpy(c->gateway, &in[18], 4);
+    return true;
+}
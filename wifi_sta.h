@@ -0,0 +1,138 @@
+/*
+File: wifi_sta.h
+Language: C
+Author: Andrew Poon
+Date: 10/20/26
+Description: Public interface for the WiFi station mode logic used by
+    network.c: the connection state machine that decides when to join,
+    back off or give up and fall back to AP mode, and the record of
+    network parameters (BSSID, channel, last DHCP lease) that network.c
+    keeps in flash so the next join can skip the scan and the DHCP
+    DISCOVER/OFFER round trip.
+
+    This module has no hardware dependencies so it can be unit tested on
+    the host (see test_wifi_sta.c).
+*/
+
+#ifndef WIFI_STA_H
+#define WIFI_STA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "backoff.h"
+
+#define WIFI_JOIN_TIMEOUT_MS   15000   // Give up on a join attempt after this long
+#define WIFI_BACKOFF_MIN_MS    500     // First delay before rejoining
+#define WIFI_BACKOFF_MAX_MS    30000   // Rejoin delay cap
+
+#define WIFI_SSID_MAX          32      // Longest SSID (802.11)
+#define WIFI_CACHE_RECORD_LEN  64      // Size of a serialized wifi_cache
+
+/**
+ * @brief Link state as reported by the WiFi driver
+ */
+typedef enum {
+    WIFI_LINK_DOWN = 0,     // Not joined
+    WIFI_LINK_JOINING,      // Joining, or joined and waiting for an address
+    WIFI_LINK_UP,           // Joined with an address
+    WIFI_LINK_FAILED,       // Join failed (no network, bad password, ...)
+} wifi_link;
+
+/**
+ * @brief Connection state
+ */
+typedef enum {
+    WIFI_STA_WAITING = 0,   // Waiting to (re)join
+    WIFI_STA_JOINING,
+    WIFI_STA_CONNECTED,
+    WIFI_STA_FALLBACK,      // Gave up; running as an access point instead
+} wifi_sta_state;
+
+/**
+ * @brief What the caller should do after a step
+ */
+typedef enum {
+    WIFI_ACTION_NONE = 0,
+    WIFI_ACTION_JOIN,           // Start joining (with the cached BSSID and channel if use_cache)
+    WIFI_ACTION_ABORT,          // The join failed or timed out; cancel it
+    WIFI_ACTION_CONNECTED,      // Now connected; last_join_ms and outage_ms are set
+    WIFI_ACTION_DISCONNECTED,   // The connection was lost
+    WIFI_ACTION_FALLBACK,       // Too many failures; switch to AP mode
+} wifi_action;
+
+/**
+ * @brief Station mode connection state machine
+ */
+typedef struct {
+    wifi_sta_state state;
+    backoff backoff;
+    uint32_t state_ms;        // When the current state began
+    uint32_t down_since_ms;   // When the device was last connected (or booted)
+    uint32_t retry_at_ms;     // When WAITING ends
+    uint8_t failures;         // Consecutive failed joins
+    uint8_t max_failures;     // Failures before falling back to AP mode (0 = never)
+    bool use_cache;           // Next join targets the cached BSSID and channel
+    bool was_connected;       // A later join counts as a reconnect
+    uint32_t connects;        // Successful joins
+    uint32_t reconnects;      // Successful joins after a lost connection
+    uint32_t join_failures;   // Failed join attempts
+    uint32_t last_join_ms;    // Duration of the last successful join attempt
+    uint32_t outage_ms;       // Time from losing the connection (or boot) until it was back
+} wifi_sta;
+
+/**
+ * @brief Network parameters remembered between boots
+ */
+typedef struct {
+    char ssid[WIFI_SSID_MAX + 1];   // Network the rest belongs to
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t ip[4];                  // Last DHCP lease
+    uint8_t netmask[4];
+    uint8_t gateway[4];
+} wifi_cache;
+
+/**
+ * @brief Start the state machine; the first step joins right away
+ *
+ * @param s             State machine
+ * @param max_failures  Consecutive failed joins before falling back to AP mode (0 = never)
+ * @param have_cache    Cached network parameters are available for the first join
+ * @param now_ms        Current time
+ */
+void wifi_sta_init(wifi_sta *s, uint8_t max_failures, bool have_cache, uint32_t now_ms);
+
+/**
+ * @brief Advance the state machine; call periodically
+ *
+ * A join with the cached BSSID and channel that fails is retried with a
+ * full scan, since the access point may have moved.
+ *
+ * @param s       State machine
+ * @param link    Current link state
+ * @param now_ms  Current time
+ * @param random  Any random value, used for backoff jitter
+ * @return Action for the caller to take
+ */
+wifi_action wifi_sta_step(wifi_sta *s, wifi_link link, uint32_t now_ms, uint32_t random);
+
+/**
+ * @brief Serialize network parameters for storage
+ *
+ * @param c    Parameters to store
+ * @param out  Output buffer of WIFI_CACHE_RECORD_LEN bytes
+ */
+void wifi_cache_encode(const wifi_cache *c, uint8_t *out);
+
+/**
+ * @brief Read back stored network parameters
+ *
+ * @param in    WIFI_CACHE_RECORD_LEN stored bytes (erased flash is rejected)
+ * @param ssid  Network about to be joined; parameters for another network are rejected
+ * @param c     Decoded parameters
+ * @return true if the record is intact and belongs to ssid
+ */
+bool wifi_cache_decode(const uint8_t *in, const char *ssid, wifi_cache *c);
+
+#endif // WIFI_STA_H